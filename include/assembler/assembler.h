@@ -12,6 +12,7 @@
 
 #include "assembler/lexer.h"
 #include "assembler/parser.h"
+#include "assembler/object_file.h"
 
 #include "code_generator.h"
 #include "vm_asm_mw.h"
@@ -24,9 +25,106 @@
  * generateBTypeMachineCode, generateUTypeMachineCode, and generateJTypeMachineCode to generate the
  * machine code for each block.
  * 
+ * A statically linked RV64 ELF executable is read with readElfFile() instead of being assembled.
+ *
  * @param IntermediateCode A vector of pairs containing ICUnit and a boolean flag.
  * @return A vector of strings representing the machine code.
  */
 AssembledProgram assemble(const std::string &filename);
 
+/**
+ * @brief Assembles a file straight into an RV64 ELF executable, without holding the program.
+ *
+ * The file is lexed a line at a time and parsed in a single pass; each instruction is encoded
+ * and written to the output as soon as it is parsed, and references to labels further down are
+ * patched in the file once the end is reached. Memory use grows with the number of labels,
+ * forward references and the size of the data section, not with the length of the text, so
+ * generated programs far larger than memory can be assembled. The output is the same as
+ * generateElfFile() on the result of assemble(), but no disassembly is written. An ELF input
+ * is checked as for assemble() and copied to the output unchanged.
+ *
+ * @param filename The assembly source.
+ * @param output_filename The executable to write; removed again if assembly fails.
+ * @throws std::runtime_error if the file cannot be read or written, or has errors, which are
+ *         dumped as by assemble().
+ */
+void assembleElfFile(const std::string &filename, const std::string &output_filename);
+
+/**
+ * @brief Assembles one file into a relocatable object.
+ *
+ * Errors are dumped and reported the same way as by assemble().
+ *
+ * @param filename The assembly source.
+ * @return The object, ready for writeObjectFile() or linkObjects().
+ */
+ObjectFile assembleObject(const std::string &filename);
+
+/**
+ * @brief Assembles several files into relocatable objects concurrently.
+ *
+ * Each file is lexed, parsed and encoded on a pool of up to one thread per hardware thread.
+ * If any file fails, the errors of the first failing file in argument order are dumped.
+ *
+ * @param filenames The assembly sources.
+ * @return One object per file, in the same order.
+ */
+std::vector<ObjectFile> assembleObjects(const std::vector<std::string> &filenames);
+
+/**
+ * @brief Assembles and links a program made of several translation units.
+ *
+ * Sources are assembled with assembleObjects(), `.o` files are read with readObjectFile(), and
+ * everything is linked with linkObjects() in argument order, so the first file holds the entry
+ * point and its lines are the ones breakpoints refer to. A single source file is assembled
+ * exactly as by assemble(const std::string &).
+ *
+ * @param filenames Assembly sources and object files, entry first.
+ * @return The linked program.
+ */
+AssembledProgram assemble(const std::vector<std::string> &filenames);
+
+/**
+ * @brief Builds a program from a file parsed without errors.
+ *
+ * Encodes the intermediate code and fills in the line mappings, symbol table and data image.
+ * The disassembly mapping is filled in later by DumpDisasssembly().
+ *
+ * @param parser The parser, after parse() reported no errors.
+ * @param filename The assembled file.
+ * @return The program.
+ */
+AssembledProgram buildProgram(Parser &parser, const std::string &filename);
+
+/**
+ * @brief Dumps a parser's errors, printing them too if verbose errors are enabled.
+ * @param parser The parser that reported errors.
+ * @param filename The file being parsed.
+ * @throws std::runtime_error always, naming the file.
+ */
+[[noreturn]] void reportParseErrors(const Parser &parser, const std::string &filename);
+
+/**
+ * @brief Maps every source line to the first instruction at or after it.
+ *
+ * Used to place breakpoints on lines that hold no instruction.
+ *
+ * @param instruction_number_line_number_mapping The line of each instruction.
+ * @return The instruction for each line up to the last instruction's line.
+ */
+std::map<unsigned int, unsigned int> buildLineNumberInstructionNumberMapping(
+    const std::map<unsigned int, unsigned int> &instruction_number_line_number_mapping);
+
+/**
+ * @brief Lays out data directives as they appear in memory.
+ *
+ * Every value is placed at the next multiple of its natural alignment; strings and bytes are
+ * unaligned. Padding is zero-filled.
+ *
+ * @param data_buffer The data directives in source order.
+ * @return The bytes of the data section, starting at the data section start.
+ */
+std::vector<uint8_t> layoutDataSection(
+    const std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data_buffer);
+
 #endif // ASSEMBLER_H
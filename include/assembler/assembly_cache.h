@@ -0,0 +1,59 @@
+/**
+ * @file assembly_cache.h
+ * @brief Persistent cache of assembled programs, keyed by source contents and assembler configuration.
+ */
+
+#ifndef ASSEMBLY_CACHE_H
+#define ASSEMBLY_CACHE_H
+
+#include "vm_asm_mw.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief A program read back from the cache, with the disassembly listing it was stored with.
+ */
+struct CachedAssembly {
+  AssembledProgram program; ///< The program; filename is left empty.
+  std::string disassembly; ///< The text of disassembly.txt.
+};
+
+/**
+ * @class AssemblyCache
+ * @brief Directory of assembled programs, one file per distinct source and configuration.
+ *
+ * An entry is named after a 64-bit hash of the source bytes and of every configuration value the
+ * assembler reads (enabled extensions and section start addresses). The entry repeats those
+ * values and holds the whole source, which a lookup compares byte for byte, so a hash collision
+ * or an entry from a different configuration is a miss rather than the wrong program. Entries
+ * are written to a temporary file and renamed into place, so concurrent runs never read a
+ * partial entry.
+ */
+class AssemblyCache {
+ private:
+  std::filesystem::path directory_; ///< Where entries are kept.
+
+ public:
+  explicit AssemblyCache(std::filesystem::path directory) : directory_(std::move(directory)) {}
+
+  /**
+   * @brief Looks up a program assembled from the same source under the current configuration.
+   * @param source The complete source text.
+   * @return The cached program, or nothing on a miss or an unreadable entry.
+   */
+  [[nodiscard]] std::optional<CachedAssembly> find(std::string_view source) const;
+
+  /**
+   * @brief Stores a program. Failures are ignored, since the cache is only an accelerator.
+   * @param source The complete source text the program was assembled from.
+   * @param program The assembled program, including its disassembly mapping.
+   * @param disassembly The text of disassembly.txt.
+   */
+  void store(std::string_view source, const AssembledProgram &program, std::string_view disassembly) const;
+};
+
+#endif // ASSEMBLY_CACHE_H
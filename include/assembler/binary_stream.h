@@ -0,0 +1,122 @@
+/**
+ * @file binary_stream.h
+ * @brief Little-endian encoding of assembler output, shared by object files and the assembly cache.
+ */
+
+#ifndef BINARY_STREAM_H
+#define BINARY_STREAM_H
+
+#include "assembler/parser.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Appends values to an in-memory buffer, which is then written out in one call.
+ *
+ * Integers and floats are stored in host (little-endian) order, strings and arrays are
+ * prefixed by a 32-bit count and data buffer entries by their variant index.
+ */
+class BinaryWriter {
+ private:
+  std::string buffer_; ///< The encoded bytes.
+
+ public:
+  template <typename T>
+  void write(T value) {
+    static_assert(std::is_arithmetic_v<T>);
+    buffer_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void write(std::string_view value);
+  void write(const std::string &value) {
+    write(std::string_view(value));
+  }
+  void write(const std::vector<uint8_t> &bytes);
+  void write(const std::vector<uint32_t> &words);
+  void write(const std::vector<std::pair<ICUnit, bool>> &intermediate_code, const LabelTable &labels);
+  void write(const std::map<unsigned int, unsigned int> &mapping);
+  void write(const std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data);
+  void write(const std::map<std::string, SymbolData> &symbol_table);
+
+  /**
+   * @brief Appends raw bytes with no length prefix.
+   */
+  void writeRaw(std::string_view bytes) {
+    buffer_.append(bytes);
+  }
+
+  const std::string &getBuffer() const {
+    return buffer_;
+  }
+
+  /**
+   * @brief Writes the buffer to a file, replacing it.
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  void writeFile(const std::filesystem::path &filename) const;
+};
+
+/**
+ * @brief Decodes values written by BinaryWriter from an in-memory buffer.
+ *
+ * Every read checks the remaining length, so a truncated or corrupt buffer raises
+ * std::runtime_error rather than reading out of bounds.
+ */
+class BinaryReader {
+ private:
+  std::string_view buffer_; ///< The bytes not consumed yet.
+  std::string name_; ///< Used in error messages.
+
+  void require(size_t size) const {
+    if (buffer_.size() < size) {
+      throw std::runtime_error("Truncated file: " + name_);
+    }
+  }
+
+ public:
+  BinaryReader(std::string_view buffer, std::string name) : buffer_(buffer), name_(std::move(name)) {}
+
+  template <typename T>
+  T read() {
+    static_assert(std::is_arithmetic_v<T>);
+    require(sizeof(T));
+    T value;
+    std::memcpy(&value, buffer_.data(), sizeof(T));
+    buffer_.remove_prefix(sizeof(T));
+    return value;
+  }
+
+  std::string readString();
+  std::string_view readRaw(size_t size);
+  void read(std::vector<uint8_t> &bytes);
+  void read(std::vector<uint32_t> &words);
+  void read(std::vector<std::pair<ICUnit, bool>> &intermediate_code, LabelTable &labels);
+  void read(std::map<unsigned int, unsigned int> &mapping);
+  void read(std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data);
+  void read(std::map<std::string, SymbolData> &symbol_table);
+
+  /**
+   * @brief Raises the same error as a truncated read, for a value that fails validation.
+   */
+  [[noreturn]] void fail() const {
+    throw std::runtime_error("Corrupt file: " + name_);
+  }
+};
+
+/**
+ * @brief Reads a whole file into memory.
+ * @throws std::runtime_error if the file cannot be read.
+ */
+std::string readBinaryFile(const std::filesystem::path &filename);
+
+#endif // BINARY_STREAM_H
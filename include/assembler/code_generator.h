@@ -7,60 +7,141 @@
 #ifndef CODE_GENERATOR_H
 #define CODE_GENERATOR_H
 
-#include <array>
+#include "common/instructions.h"
+
+#include <charconv>
 #include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstring>
+#include <functional>
 #include <iomanip>
+#include <unordered_map>
+
+/**
+ * @brief The label names the intermediate code of one parser, program or object refers to.
+ *
+ * Every distinct name gets the next id the first time it is interned; the empty name is id 0.
+ * The table lives next to the intermediate code whose ICUnits hold its ids, so it is copied and
+ * freed with it, and each parser interns into its own without any locking.
+ */
+class LabelTable {
+ public:
+  /**
+   * @brief Returns the id of a label, adding it if it is new.
+   */
+  uint32_t intern(std::string_view name) {
+    if (name.empty()) {
+      return 0;
+    }
+    auto it = ids_.find(name);
+    if (it!=ids_.end()) {
+      return it->second;
+    }
+    auto id = static_cast<uint32_t>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(names_.back(), id);
+    return id;
+  }
+
+  /**
+   * @brief Returns the name interned under an id returned by intern().
+   */
+  [[nodiscard]] const std::string &name(uint32_t id) const {
+    return names_[id];
+  }
+
+ private:
+  struct Hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const noexcept {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+
+  std::vector<std::string> names_{std::string()};
+  std::unordered_map<std::string, uint32_t, Hash, std::equal_to<>> ids_;
+};
 
 /**
  * @brief Represents a unit of intermediate code used for generating machine code.
  * 
  * This struct stores the details of an intermediate code block, including the line number, 
- * opcode, register destinations, immediate values, and labels. It provides setter and getter 
- * methods to manage the data safely.
+ * opcode, register destinations, immediate values, and labels. Everything is kept in encoded
+ * form (the instruction's id in the instruction table, register numbers, the immediate as an
+ * integer and the label's id in the LabelTable of the code the block belongs to), so a block is a
+ * few words that copy cheaply and the code generator reads its fields without parsing text. The
+ * string setters and getters convert from and to the names used in the source and in the
+ * disassembly; those for the label take the table.
  */
 struct ICUnit {
+  /// Marks a register operand the instruction does not have.
+  static constexpr uint8_t kNoRegister = 0xFF;
+  /// Added to a floating point register's number; 0-31 are the integer registers.
+  static constexpr uint8_t kFprBase = 32;
+
   unsigned int line_number; ///< Line number in the source code corresponding to this block.
   unsigned int instruction_index; ///< Index of the instruction in the intermediate code.
-  std::array<char, 21> opcode;  ///< Opcode string (up to 20 characters, null-terminated).
-  std::array<char, 6> rd;      ///< Destination register name (up to 20 characters, null-terminated). Eg: "x1", "f4", etc.
-  std::array<char, 6> rs1;     ///< Source register 1 name (up to 20 characters, null-terminated).
-  std::array<char, 6> rs2;     ///< Source register 2 name (up to 20 characters, null-terminated).
-  std::array<char, 6> rs3;     ///< Immediate value (up to 32 characters, null-terminated).
-  uint32_t csr;           ///< Control and Status Register (CSR) value.
-  std::array<char, 33> imm;     ///< Immediate value (up to 32 characters, null-terminated).
-  std::string label;            ///< Label associated with this code block, if any.
-  uint8_t rm;       ///< Rounding mode (up to 4 characters, null-terminated).
-
-  ICUnit() : line_number{}, opcode{}, rd{}, rs1{}, rs2{}, rs3{}, csr{}, imm{}, label{}, rm{} {
-    opcode.fill('\0');
-    rd.fill('\0');
-    rs1.fill('\0');
-    rs2.fill('\0');
-    rs3.fill('\0');
-    imm.fill('\0');
+  int32_t imm;                  ///< Immediate value, if has_imm is set.
+  uint32_t label;               ///< Id of the label this block refers to in its LabelTable, 0 if none.
+  instruction_set::InstructionId opcode; ///< Instruction table id, kNoInstruction if unset.
+  uint16_t csr;                 ///< Control and Status Register (CSR) number.
+  uint8_t rd;                   ///< Destination register, kNoRegister if none. Eg: x1 is 1, f4 is 36.
+  uint8_t rs1;                  ///< Source register 1, kNoRegister if none.
+  uint8_t rs2;                  ///< Source register 2, kNoRegister if none.
+  uint8_t rs3;                  ///< Source register 3, kNoRegister if none.
+  uint8_t rm;                   ///< Rounding mode.
+  bool has_imm;                 ///< Whether the block has an immediate operand.
+
+  ICUnit()
+      : line_number{}, instruction_index{}, imm{}, label{}, opcode{instruction_set::kNoInstruction}, csr{},
+        rd{kNoRegister}, rs1{kNoRegister}, rs2{kNoRegister}, rs3{kNoRegister}, rm{}, has_imm{} {}
+
+  /**
+   * @brief Parses a register name as the parser writes it ("x5", "f12") into its encoded form.
+   * @return The register, or kNoRegister for an empty or malformed name.
+   */
+  static uint8_t parseRegister(std::string_view name) {
+    if (name.size() < 2 || (name[0]!='x' && name[0]!='f')) {
+      return kNoRegister;
+    }
+    unsigned int number = 0;
+    auto [end, ec] = std::from_chars(name.data() + 1, name.data() + name.size(), number);
+    if (ec!=std::errc() || end!=name.data() + name.size() || number > 31) {
+      return kNoRegister;
+    }
+    return static_cast<uint8_t>(number + (name[0]=='f' ? kFprBase : 0));
+  }
+
+  /**
+   * @brief Returns the name of an encoded register, or "" for kNoRegister.
+   */
+  static std::string registerName(uint8_t reg) {
+    if (reg==kNoRegister) {
+      return {};
+    }
+    std::string name(1, reg >= kFprBase ? 'f' : 'x');
+    name += std::to_string(reg & 0x1F);
+    return name;
   }
 
-  friend std::ostream &operator<<(std::ostream &os, const ICUnit &unit) {
-    auto emit_if_filled = [&os](const std::array<char, 6> &field,
-                                bool &first_operand) {
-      if (field[0] != '\0') {                  
-        os << (first_operand ? " " : ", ")      
-          << field.data();
+  /**
+   * @brief Writes the block as the disassembly shows it, its label looked up in labels.
+   */
+  void print(std::ostream &os, const LabelTable &labels) const {
+    const ICUnit &unit = *this;
+    auto emit_if_filled = [&os](uint8_t reg, bool &first_operand) {
+      if (reg != kNoRegister) {
+        os << (first_operand ? " " : ", ")
+           << (reg >= kFprBase ? 'f' : 'x') << static_cast<int>(reg & 0x1F);
         first_operand = false;
       }
     };
 
-    // 1. line number + opcode
-    os 
-    // << std::hex 
-    //    << unit.instruction_index * 4
-    //    << std::setw(0) << std::dec 
-    //    << ": " 
-       << unit.opcode.data();
+    // 1. opcode
+    os << unit.getOpcode();
 
     // 2. operands
     bool first = true;
@@ -69,9 +150,9 @@ struct ICUnit {
     emit_if_filled(unit.rs2, first);
     emit_if_filled(unit.rs3, first);
 
-    // 3. immediates (33‑byte array so treat separately)
-    if (unit.imm[0] != '\0') {
-      os << (first ? " " : ", ") << unit.imm.data();
+    // 3. immediate
+    if (unit.has_imm) {
+      os << (first ? " " : ", ") << unit.imm;
       first = false;
     }
 
@@ -88,11 +169,9 @@ struct ICUnit {
     }
 
     // 6. label (if any) — put at the end in angle brackets
-    if (!unit.label.empty()) {
-      os << " <" << unit.label << '>';
+    if (unit.label != 0) {
+      os << " <" << labels.name(unit.label) << '>';
     }
-
-    return os;
   }
 
 
@@ -104,42 +183,47 @@ struct ICUnit {
     instruction_index = value;
   }
 
-  void setOpcode(const std::string &value) {
-    strncpy(opcode.data(), value.c_str(), 20);
-    opcode[20] = '\0';
+  void setOpcode(std::string_view value) {
+    opcode = instruction_set::findInstructionId(value);
   }
 
-  void setRd(const std::string &value) {
-    strncpy(rd.data(), value.c_str(), 5);
-    rd[5] = '\0';
+  void setRd(std::string_view value) {
+    rd = parseRegister(value);
   }
 
-  void setRs1(const std::string &value) {
-    strncpy(rs1.data(), value.c_str(), 5);
-    rs1[5] = '\0';
+  void setRs1(std::string_view value) {
+    rs1 = parseRegister(value);
   }
 
-  void setRs2(const std::string &value) {
-    strncpy(rs2.data(), value.c_str(), 5);
-    rs2[5] = '\0';
+  void setRs2(std::string_view value) {
+    rs2 = parseRegister(value);
   }
 
-  void setRs3(const std::string &value) {
-    strncpy(rs3.data(), value.c_str(), 5);
-    rs3[5] = '\0';
+  void setRs3(std::string_view value) {
+    rs3 = parseRegister(value);
   }
 
   void setCsr(uint32_t value) {
-    csr = value;
+    csr = static_cast<uint16_t>(value);
   }
 
-  void setImm(const std::string &value) {
-    strncpy(imm.data(), value.c_str(), 32);
-    imm[32] = '\0';
+  void setImm(int64_t value) {
+    imm = static_cast<int32_t>(value);
+    has_imm = true;
   }
 
-  void setLabel(const std::string &value) {
-    label = value;
+  void setLabel(LabelTable &labels, std::string_view value) {
+    label = labels.intern(value);
+  }
+
+  /**
+   * @brief Moves the block's label from the table of the code it came from to that of the code
+   * it is copied into.
+   */
+  void relabel(const LabelTable &from, LabelTable &to) {
+    if (label!=0) {
+      label = to.intern(from.name(label));
+    }
   }
 
   void setRm(uint8_t value) {
@@ -154,36 +238,55 @@ struct ICUnit {
     return instruction_index;
   }
 
-  [[nodiscard]] std::string getOpcode() const {
-    return opcode.data();
+  /**
+   * @brief Returns the instruction's record, or nullptr if no known opcode was set.
+   */
+  [[nodiscard]] const instruction_set::InstructionInfo *getInstructionInfo() const {
+    return opcode==instruction_set::kNoInstruction ? nullptr : &instruction_set::getInstructionInfo(opcode);
+  }
+
+  [[nodiscard]] std::string_view getOpcode() const {
+    const instruction_set::InstructionInfo *info = getInstructionInfo();
+    return info ? info->name : std::string_view();
   }
 
   [[nodiscard]] std::string getRd() const {
-    return rd.data();
+    return registerName(rd);
   }
 
   [[nodiscard]] std::string getRs1() const {
-    return rs1.data();
+    return registerName(rs1);
   }
 
   [[nodiscard]] std::string getRs2() const {
-    return rs2.data();
+    return registerName(rs2);
   }
 
   [[nodiscard]] std::string getRs3() const {
-    return rs3.data();
+    return registerName(rs3);
   }
 
   [[nodiscard]] uint32_t getCsr() const {
     return csr;
   }
 
+  [[nodiscard]] bool hasImm() const {
+    return has_imm;
+  }
+
+  /**
+   * @brief Returns the immediate as text, or "" if there is none.
+   */
   [[nodiscard]] std::string getImm() const {
-    return imm.data();
+    return has_imm ? std::to_string(imm) : std::string();
   }
 
-  [[nodiscard]] std::string getLabel() const {
-    return label;
+  [[nodiscard]] bool hasLabel() const {
+    return label!=0;
+  }
+
+  [[nodiscard]] const std::string &getLabel(const LabelTable &labels) const {
+    return labels.name(label);
   }
 
   [[nodiscard]] uint8_t getRm() const {
@@ -191,90 +294,113 @@ struct ICUnit {
   }
 };
 
+static_assert(sizeof(ICUnit) <= 32, "ICUnit should stay a few words");
+
 // TODO: use uint32_t instead of std::bitset<32>
 
 /**
  * @brief Prints the intermediate code to a vector of strings.
  * 
  * @param IntermediateCode A vector of pairs containing ICUnit and a boolean flag.
+ * @param labels The label table the intermediate code refers to.
  * @return A vector of strings representing the intermediate code.
  */
-std::vector<std::string> printIntermediateCode(const std::vector<std::pair<ICUnit, bool>> &IntermediateCode);
+std::vector<std::string> printIntermediateCode(const std::vector<std::pair<ICUnit, bool>> &IntermediateCode,
+                                               const LabelTable &labels);
 
 /**
  * @brief Generates machine code for an R-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateRTypeMachineCode(const ICUnit &block);
+uint32_t generateRTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
 
 /**
  * @brief Generates machine code for an I1-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateI1TypeMachineCode(const ICUnit &block);
+uint32_t generateI1TypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
 
 /**
  * @brief Generates machine code for an I2-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateI2TypeMachineCode(const ICUnit &block);
+uint32_t generateI2TypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
 
 /**
  * @brief Generates machine code for an I3-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateI3TypeMachineCode(const ICUnit &block);
+uint32_t generateI3TypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
 
 /**
  * @brief Generates machine code for an S-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateSTypeMachineCode(const ICUnit &block);
+uint32_t generateSTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
 
 /**
  * @brief Generates machine code for a B-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateBTypeMachineCode(const ICUnit &block);
+uint32_t generateBTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
 
 /**
  * @brief Generates machine code for a U-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateUTypeMachineCode(const ICUnit &block);
+uint32_t generateUTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
 
 /**
  * @brief Generates machine code for a J-type instruction.
  * 
  * @param block The ICUnit representing the instruction.
+ * @param info The instruction's encoding record.
  * @return The machine code bitset<32>.
  */
-uint32_t generateJTypeMachineCode(const ICUnit &block);
-
-uint32_t generateCSRRTypeMachineCode(const ICUnit &block);
-uint32_t generateCSRITypeMachineCode(const ICUnit &block);
-
-uint32_t generateFDRTypeMachineCode(const ICUnit &block);
-uint32_t generateFDR1TypeMachineCode(const ICUnit &block);
-uint32_t generateFDR2TypeMachineCode(const ICUnit &block);
-uint32_t generateFDR3TypeMachineCode(const ICUnit &block);
-uint32_t generateFDR4TypeMachineCode(const ICUnit &block);
-uint32_t generateFDITypeMachineCode(const ICUnit &block);
-uint32_t generateFDSTypeMachineCode(const ICUnit &block);
+uint32_t generateJTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+
+uint32_t generateCSRRTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+uint32_t generateCSRITypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+
+uint32_t generateFDRTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+uint32_t generateFDR1TypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+uint32_t generateFDR2TypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+uint32_t generateFDR3TypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+uint32_t generateFDR4TypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+uint32_t generateFDITypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+uint32_t generateFDSTypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+
+uint32_t generateATypeMachineCode(const ICUnit &block, const instruction_set::InstructionInfo &info);
+
+/**
+ * @brief Encodes one intermediate code block.
+ *
+ * @param block The block, with its immediate resolved.
+ * @return The instruction word.
+ * @throws std::runtime_error if the opcode is not known.
+ */
+uint32_t generateMachineCode(const ICUnit &block);
 
 /**
  * @brief Generates machine code from a vector of intermediate code blocks.
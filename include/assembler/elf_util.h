@@ -9,36 +9,112 @@
 
 #include "../vm_asm_mw.h"
 
-struct ElfHeader {
-  uint8_t e_ident[16] = {0x7F, 'E', 'L', 'F', 1, 1, 1, 0}; // ELF magic number
-  uint16_t e_type = 2;        // Executable file
-  uint16_t e_machine = 0xF3;  // RISC-V
-  uint32_t e_version = 1;
-  uint32_t e_entry = 0x1000;  // Entry point (adjust later)
-  uint32_t e_phoff = 0;       // No program headers for now
-  uint32_t e_shoff = 0;       // Section headers offset (to be calculated)
-  uint32_t e_flags = 0;       // Architecture-specific flags
-  uint16_t e_ehsize = sizeof(ElfHeader);
-  uint16_t e_phentsize = 0;
-  uint16_t e_phnum = 0;
-  uint16_t e_shentsize = 40;  // Section header entry size
-  uint16_t e_shnum = 3;       // Number of sections
-  uint16_t e_shstrndx = 2;    // Section header string table index
-};
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
-struct ElfSectionHeader {
-  uint32_t sh_name;      // Index into string table
-  uint32_t sh_type;      // Section type (e.g., SHT_PROGBITS)
-  uint32_t sh_flags;     // Flags (e.g., executable, writable)
-  uint32_t sh_addr;      // Memory address (for executables)
-  uint32_t sh_offset;    // Offset in ELF file
-  uint32_t sh_size;      // Section size
-  uint32_t sh_link;
-  uint32_t sh_info;
-  uint32_t sh_addralign; // Alignment requirements
-  uint32_t sh_entsize;   // Entry size for symbol tables
-};
+/// Initial stack pointer of ELF executables, which expect the loader to provide a stack.
+constexpr uint64_t kElfStackTop = 0x7ffffff0;
 
+/**
+ * @brief Writes an assembled program as a statically linked RV64 ELF executable.
+ *
+ * The text is placed at address 0 and the data image at the data section start, each in its own
+ * PT_LOAD segment, exactly where VmBase::LoadProgram puts them. The symbol table is written
+ * to .symtab, with text labels as untyped symbols in .text and data labels as objects in .data;
+ * labels named by .globl are global symbols, the others local ones ahead of them.
+ *
+ * @param program The assembled program.
+ * @param output_filename The file to write.
+ * @throws std::runtime_error if the file cannot be written.
+ */
 void generateElfFile(const AssembledProgram &program, const std::string &output_filename);
 
-#endif // ELF_UTIL_H
\ No newline at end of file
+/**
+ * @class ElfFileWriter
+ * @brief Writes an ELF executable whose text arrives one instruction at a time.
+ *
+ * Text words go to the file through a small buffer, so the text is never held in memory as a
+ * whole; words already written can still be read back and patched in place. finish() adds the
+ * data, symbols and headers, producing the same file as generateElfFile() for the same program.
+ * A file that was not finished is removed when the writer is destroyed.
+ */
+class ElfFileWriter {
+ private:
+  static constexpr size_t kBufferWords = 16384; ///< Text words buffered before they are written.
+
+  std::string filename_; ///< The file being written.
+  int fd_ = -1; ///< Its descriptor, until finish().
+  std::vector<uint32_t> buffer_; ///< Text words not written yet.
+  uint64_t flushed_words_ = 0; ///< Text words already in the file.
+
+  void writeAt(uint64_t offset, std::string_view bytes);
+  void flush();
+
+ public:
+  /**
+   * @brief Creates or truncates the output file.
+   * @throws std::runtime_error if the file cannot be created.
+   */
+  explicit ElfFileWriter(std::string filename);
+
+  ~ElfFileWriter();
+
+  ElfFileWriter(const ElfFileWriter &) = delete;
+  ElfFileWriter &operator=(const ElfFileWriter &) = delete;
+
+  /**
+   * @brief Appends a word to the text.
+   */
+  void appendText(uint32_t word);
+
+  /**
+   * @brief Reads consecutive text words that have been appended.
+   * @param index The index of the first word.
+   * @param words Receives the words.
+   */
+  void readText(size_t index, std::span<uint32_t> words);
+
+  /**
+   * @brief Overwrites consecutive text words that have been appended.
+   * @param index The index of the first word.
+   * @param words The new words.
+   */
+  void writeText(size_t index, std::span<const uint32_t> words);
+
+  /**
+   * @brief Writes the rest of the file and closes it.
+   * @param data_image The bytes of the data section.
+   * @param symbol_table The program's labels.
+   * @param global_symbols The labels named by .globl, written as global symbols.
+   * @param entry_point The entry address.
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  void finish(const std::vector<uint8_t> &data_image, const std::map<std::string, SymbolData> &symbol_table,
+              const std::set<std::string> &global_symbols, uint64_t entry_point);
+};
+
+/**
+ * @brief Reads a statically linked RV64 little-endian ELF executable.
+ *
+ * Every PT_LOAD segment becomes a ProgramSegment, and defined function, object and untyped
+ * symbols from .symtab are entered in the symbol table at their absolute addresses. Dynamically
+ * linked executables, relocatable objects and other machines are rejected.
+ *
+ * @param filename The executable.
+ * @return A program with segments, an entry point and a symbol table, but no intermediate code.
+ * @throws std::runtime_error if the file cannot be read or is not a supported executable.
+ */
+AssembledProgram readElfFile(const std::filesystem::path &filename);
+
+/**
+ * @brief Checks whether a file starts with the ELF magic number.
+ */
+bool isElfFile(const std::filesystem::path &filename);
+
+#endif // ELF_UTIL_H
@@ -0,0 +1,96 @@
+/**
+ * @file incremental_assembler.h
+ * @brief Re-assembles an edited source file by re-encoding only the lines that changed.
+ */
+
+#ifndef INCREMENTAL_ASSEMBLER_H
+#define INCREMENTAL_ASSEMBLER_H
+
+#include "assembler/parser.h"
+#include "assembler/source_file.h"
+#include "vm_asm_mw.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class IncrementalAssembler
+ * @brief Keeps the last program assembled from a file and patches it when the file is reloaded.
+ *
+ * The new source is compared line by line with the previous one. When every changed line holds
+ * only instructions (no labels, directives or strings) inside the text section, just those lines
+ * are lexed, parsed and encoded. The new instructions are spliced into the program, labels after
+ * them move with the text, and branches, jumps and `la`/load-from-label pairs whose offsets
+ * crossed the edit are re-resolved. Anything else, such as an edit to a label or to the data
+ * section, or a change to the assembler configuration, falls back to a full assembly. Either way
+ * the result, the disassembly and the dumped errors are the same as from assemble().
+ */
+class IncrementalAssembler {
+ private:
+  /// Configuration values that change the output of the assembler.
+  struct Settings {
+    uint64_t data_section_start = 0;
+    uint64_t text_section_start = 0;
+    bool m_extension = false;
+    bool f_extension = false;
+    bool d_extension = false;
+
+    bool operator==(const Settings &) const = default;
+  };
+
+  std::string filename_; ///< The file the program was assembled from.
+  std::unique_ptr<SourceFile> source_; ///< Its text at that time, split into lines.
+  Settings settings_; ///< The configuration it was assembled with.
+  AssembledProgram program_; ///< The program.
+  std::vector<unsigned int> instruction_lines_; ///< The line of each instruction.
+  std::vector<Relocation> data_references_; ///< The `la` and load-from-label pairs, by auipc index.
+  std::vector<unsigned int> changed_words_; ///< Text words that differ from the previous program.
+  bool incremental_ = false; ///< Whether the last call patched the previous program.
+
+  static Settings currentSettings();
+
+  /**
+   * @brief Assembles the whole file and records what later edits are compared against.
+   * @throws std::runtime_error on parse errors, after dumping them.
+   */
+  void assembleAll(const std::string &filename, std::string text);
+
+  /**
+   * @brief Patches the program for an edit of instruction lines only.
+   * @return False if the edit needs a full assembly; the state is then stale.
+   */
+  bool assembleChanges(std::string text);
+
+ public:
+  /**
+   * @brief Assembles a file, reusing the previous program if the file was assembled before.
+   *
+   * ELF executables are read with assemble() and are never patched.
+   *
+   * @param filename The assembly source.
+   * @return The program, valid until the next call.
+   * @throws std::runtime_error if the file cannot be read or has errors.
+   */
+  const AssembledProgram &assemble(const std::string &filename);
+
+  /**
+   * @brief Returns the indices of the text words changed by the last call, if it was incremental.
+   *
+   * Words past the end of the previous text are included; words past the end of a shrunk text
+   * are not.
+   */
+  [[nodiscard]] const std::vector<unsigned int> &getChangedWords() const {
+    return changed_words_;
+  }
+
+  /**
+   * @brief Returns whether the last call patched the previously assembled program.
+   */
+  [[nodiscard]] bool wasIncremental() const {
+    return incremental_;
+  }
+};
+
+#endif // INCREMENTAL_ASSEMBLER_H
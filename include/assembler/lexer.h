@@ -7,25 +7,31 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include "assembler/source_file.h"
 #include "assembler/tokens.h"
+
+#include <deque>
+#include <string_view>
 #include <vector>
-#include <fstream>
 
 /**
  * @class Lexer
  * @brief A class responsible for tokenizing the input source code.
  * 
- * This class reads an input file, processes its contents, and generates a sequence of tokens.
+ * This class maps an input file, processes its contents, and generates a sequence of tokens.
  * It handles various types of tokens such as identifiers, numbers, directives, and string literals.
+ * Token values are views into the mapped file, which the lexer owns.
  */
 class Lexer {
  private:
-  std::string filename_; ///< The name of the input file.
-  std::ifstream input_; ///< Input stream for reading the source code.
-  std::string current_line_; ///< The current line being processed.
+  SourceFile source_; ///< The mapped source code.
+  std::string_view current_line_; ///< The current line being processed.
   unsigned int line_number_; ///< The current line number in the source code.
   unsigned int column_number_; ///< The current column number in the source code.
   size_t pos_; ///< The current position within the current line.
+  size_t next_line_offset_ = 0; ///< Byte offset of the line after the current one.
+  bool at_end_ = false; ///< Whether lexLine() has handed out the EOF token.
+  bool after_comma_ = false; ///< Whether the last token was a comma, which makes a name a label reference.
 
   std::vector<Token> tokens_; ///< A list of tokens generated during the lexing process.
 
@@ -65,9 +71,11 @@ class Lexer {
   /**
    * @brief Tokenizes a number.
    *
-   * This function handles numeric literals in the source code.
+   * Scans decimal, hexadecimal (0x), binary (0b) and octal (0o) integers and decimal
+   * floats in a single pass, storing the parsed value in the token's int_value or
+   * float_value. Literals that overflow 64 bits or run into other characters are INVALID.
    *
-   * @return A Token object representing the number.
+   * @return A NUM, FLOAT or INVALID token.
    */
   Token number();
 
@@ -98,6 +106,22 @@ class Lexer {
    */
 
   Token getNextToken();
+
+  /**
+   * @brief Moves to the next line of the source.
+   *
+   * @return False once every line has been read.
+   */
+  bool nextLine();
+
+  /**
+   * @brief Appends the tokens of the current line.
+   *
+   * @param tokens The container to append to.
+   */
+  template <typename Tokens>
+  void tokenizeLine(Tokens &tokens);
+
  public:
   /**
    * @brief Constructs a Lexer object for a given file.
@@ -109,9 +133,14 @@ class Lexer {
   explicit Lexer(std::string filename);
 
   /**
-   * @brief Destructor that closes the input file stream.
+   * @brief Constructs a Lexer over source text that is already in memory.
+   *
+   * @param filename The name used in error messages.
+   * @param text The source code to be tokenized.
    */
-  ~Lexer();
+  Lexer(std::string filename, std::string text);
+
+  ~Lexer() = default;
 
   /**
    * @brief Retrieves the name of the input file.
@@ -122,15 +151,35 @@ class Lexer {
    */
   std::string getFilename() const;
 
+  /**
+   * @brief Retrieves the mapped source file the tokens point into.
+   *
+   * @return The source file, valid for the lifetime of the lexer.
+   */
+  const SourceFile &getSource() const;
+
   /**
    * @brief Retrieves the complete list of tokens.
    *
-   * This function returns a vector of all tokens generated during the lexing process.
+   * This function lexes the whole file and hands over the tokens. Their values
+   * remain valid only while this lexer is alive.
    *
    * @return A vector containing all the tokens.
    */
   std::vector<Token> getTokenList();
 
+  /**
+   * @brief Lexes the next line and appends its tokens.
+   *
+   * Used to stream a file through the parser without holding all of its tokens. After the
+   * last line, one more call appends the EOF token. Tokens point into the source and remain
+   * valid while this lexer is alive.
+   *
+   * @param tokens The container to append to.
+   * @return False once the EOF token has been appended.
+   */
+  bool lexLine(std::deque<Token> &tokens);
+
 };
 
 #endif // LEXER_H
@@ -0,0 +1,59 @@
+/**
+ * @file linker.h
+ * @brief Combines relocatable objects into one loadable program.
+ */
+
+#ifndef LINKER_H
+#define LINKER_H
+
+#include "assembler/object_file.h"
+#include "vm_asm_mw.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Links objects into a program.
+ *
+ * Text is laid out in the order of the objects, so the first object holds the entry point at
+ * address 0 and supplies the filename. Every object's instruction lines are kept, and each
+ * object is listed in source_files with its first instruction. Each object's data starts on an
+ * 8-byte boundary of the data section, which keeps the alignment its parser assumed. A local
+ * symbol whose name is already taken is kept as "file:name". Symbols are looked up in the
+ * referencing object first and then among the symbols the objects export with .globl.
+ * Relocated fields are patched directly in the machine code and mirrored into the intermediate
+ * code for the disassembly.
+ *
+ * @param objects The objects to link, entry object first.
+ * @return The linked program, without a disassembly mapping.
+ * @throws std::runtime_error on an undefined or multiply defined symbol, or an offset out of range.
+ */
+AssembledProgram linkObjects(const std::vector<ObjectFile> &objects);
+
+/**
+ * @brief Encodes a resolved PC-relative offset into instruction words.
+ *
+ * @param words The instruction to patch, followed by the instruction after it for
+ *              RelocationType::kPcrelHiLo.
+ * @param type How the offset is encoded.
+ * @param offset The target address minus the address of the first word.
+ * @return False, leaving the words unchanged, if the offset does not fit the encoding.
+ */
+bool patchRelocation(std::span<uint32_t> words, RelocationType type, int64_t offset);
+
+/**
+ * @brief Encodes a resolved PC-relative offset into an instruction, or into an auipc and the
+ * instruction after it for RelocationType::kPcrelHiLo.
+ *
+ * The immediates in the intermediate code are updated to match, for the disassembly.
+ *
+ * @param program The program to patch.
+ * @param index The index of the instruction.
+ * @param type How the offset is encoded.
+ * @param offset The target address minus the instruction's address.
+ * @return False, leaving the program unchanged, if the offset does not fit the encoding.
+ */
+bool applyRelocation(AssembledProgram &program, size_t index, RelocationType type, int64_t offset);
+
+#endif // LINKER_H
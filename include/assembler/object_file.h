@@ -0,0 +1,61 @@
+/**
+ * @file object_file.h
+ * @brief Relocatable object produced by assembling one translation unit, and its on-disk form.
+ */
+
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+#include "assembler/parser.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief One assembled translation unit whose text starts at address 0 and whose data starts at
+ * offset 0 of the data section, as if it were the only unit.
+ *
+ * References that depend on where the linker places the unit are encoded with a zero immediate
+ * and listed in `relocations`. Branches and jumps between labels of the same unit are already
+ * resolved, since they are PC-relative within the unit's text.
+ */
+struct ObjectFile {
+  std::string filename; ///< The source the unit was assembled from.
+  std::vector<uint32_t> text_buffer; ///< Machine code, relocated fields zeroed.
+  std::vector<std::pair<ICUnit, bool>> intermediate_code; ///< Intermediate code, kept for the disassembly.
+  LabelTable labels; ///< Names of the labels the intermediate code refers to.
+  std::map<unsigned int, unsigned int> instruction_number_line_number_mapping; ///< Unit-relative instruction to source line.
+  std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> data_buffer;
+  uint64_t data_size = 0; ///< Bytes of data the unit occupies, including alignment padding.
+  std::map<std::string, SymbolData> symbol_table; ///< Every label of the unit, unit-relative.
+  std::vector<std::string> global_symbols; ///< Symbols named by .globl; those defined here are exported.
+  std::vector<Relocation> relocations; ///< Fields the linker patches.
+};
+
+/**
+ * @brief Writes an object file.
+ * @param filename The output path.
+ * @param object The object to write.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeObjectFile(const std::filesystem::path &filename, const ObjectFile &object);
+
+/**
+ * @brief Reads an object file written by writeObjectFile.
+ * @param filename The object path.
+ * @return The object.
+ * @throws std::runtime_error if the file cannot be read or is not an object file.
+ */
+ObjectFile readObjectFile(const std::filesystem::path &filename);
+
+/**
+ * @brief Returns true if the path names an object file rather than assembly source.
+ */
+bool isObjectFile(const std::filesystem::path &filename);
+
+#endif // OBJECT_FILE_H
@@ -8,11 +8,14 @@
 #define PARSER_H
 
 
+#include "assembler/source_file.h"
 #include "assembler/tokens.h"
 #include "assembler/code_generator.h"
 #include "assembler/errors.h"
 
+#include <deque>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <variant>
@@ -59,13 +62,72 @@ struct SymbolData {
   bool isData; ///< Indicates if the symbol represents data or code.
 };
 
+/**
+ * @brief Kinds of relocation left for the linker in a relocatable object.
+ */
+enum class RelocationType {
+  kBranch, ///< B-type offset to a text symbol.
+  kJal, ///< J-type offset to a text symbol.
+  kPcrelHiLo, ///< auipc at the index plus the I-type instruction after it, forming a PC-relative address.
+};
+
+/**
+ * @brief A symbol reference that can only be resolved once the final layout is known.
+ */
+struct Relocation {
+  unsigned int instruction_index; ///< Index of the instruction to patch within its unit.
+  RelocationType type; ///< How the immediate is encoded.
+  std::string symbol; ///< The referenced symbol.
+  unsigned int line_number = 0; ///< Line of the reference, for errors; 0 when read from an object file.
+};
+
+class Lexer;
+
+/**
+ * @brief Receives the output of a streaming parse as it is produced.
+ *
+ * A parser built with a sink keeps no intermediate code: each instruction and each run of
+ * data directives is handed over as soon as it is parsed, and references to labels not
+ * seen yet are patched through the sink once the whole file has been read.
+ */
+class ParserSink {
+ public:
+  virtual ~ParserSink() = default;
+
+  /**
+   * @brief Takes the next instruction.
+   * @param block The instruction. A reference to a label not seen yet has a zero immediate.
+   */
+  virtual void instruction(const ICUnit &block) = 0;
+
+  /**
+   * @brief Takes the data directives parsed since the last call, in source order.
+   * @param data The directives; the parser clears them after the call.
+   */
+  virtual void data(
+      const std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data) = 0;
+
+  /**
+   * @brief Patches an instruction handed over earlier.
+   * @param reference The reference, with the index of the instruction to patch.
+   * @param offset The offset from the instruction to the symbol.
+   * @return False if the offset does not fit the instruction.
+   */
+  virtual bool patch(const Relocation &reference, int64_t offset) = 0;
+};
+
 /**
  * @brief The Parser class is responsible for parsing tokens and generating intermediate code and symbol tables.
  */
 class Parser {
  private:
+  const SourceFile &source_; ///< The source the tokens point into.
   std::string filename_; ///< The filename being parsed.
   std::vector<Token> tokens_; ///< The list of tokens to parse.
+  Lexer *lexer_ = nullptr; ///< The lexer tokens are pulled from when streaming.
+  std::deque<Token> window_; ///< The tokens lexed but not yet consumed when streaming.
+  ParserSink *sink_ = nullptr; ///< Where a streaming parse sends its output.
+  Token eof_token_{TokenType::EOF_, "", 1, 1}; ///< Returned when looking past the end of the token list.
   size_t pos_ = 0; ///< The current position in the token list.
   unsigned int instruction_index_ = 0; ///< The current instruction index.
 
@@ -79,41 +141,89 @@ class Parser {
   std::map<std::string, SymbolData> symbol_table_; ///< The symbol table mapping symbol names to their data.
 
   std::vector<unsigned int> back_patch_; ///< List of instructions requiring backpatching.
+
+  bool relocatable_ = false; ///< Leave references outside the unit's text to the linker.
+  std::set<std::string> global_symbols_; ///< Symbols named by .globl/.global.
+  std::vector<Relocation> relocations_; ///< References for the linker to patch, and resolved PC-relative data references; when streaming, the references to labels not seen yet.
   std::vector<std::pair<ICUnit, bool>> intermediate_code_; ///< The generated intermediate code.
+  LabelTable labels_; ///< Names of the labels the intermediate code refers to.
 
   std::map<unsigned int, unsigned int>
       instruction_number_line_number_mapping_; ///< Maps instruction numbers to line numbers.
 
+  /**
+   * @brief Returns the token at a position, lexing ahead as needed when streaming.
+   * @param index The position in the token list.
+   * @return The token, or the EOF token past the end.
+   */
+  const Token &tokenAt(size_t index);
+
   /**
    * @brief Returns the previous token in the token list.
    * @return The previous token.
    */
-  Token prevToken();
+  const Token &prevToken();
 
   /**
    * @brief Returns the current token in the token list.
    * @return The current token.
    */
-  Token currentToken();
+  const Token &currentToken();
 
   /**
    * @brief Moves to the next token and returns it.
    * @return The next token.
    */
-  Token nextToken();
+  const Token &nextToken();
 
   /**
    * @brief Peeks ahead by n tokens without advancing the position.
    * @param n The number of tokens to peek ahead.
    * @return The nth token from the current position.
    */
-  Token peekToken(int n);
+  const Token &peekToken(int n);
 
   /**
    * @brief Skips the current line during parsing.
    */
   void skipCurrentLine();
 
+  /**
+   * @brief Returns a source line for an error message.
+   * @param line_number The 1-based line number.
+   * @return The line, without its newline.
+   */
+  std::string getSourceLine(unsigned int line_number) const;
+
+  /**
+   * @brief Adds an instruction at the current instruction index.
+   * @param block The instruction.
+   * @param resolved False if it references a label not defined yet.
+   */
+  void emitInstruction(const ICUnit &block, bool resolved);
+
+  /**
+   * @brief Returns whether a reference to a label not defined yet is resolved later rather than an error.
+   */
+  bool defersUndefinedSymbols() const {
+    return relocatable_ || sink_!=nullptr;
+  }
+
+  /**
+   * @brief Hands the buffered data directives to the sink, when streaming.
+   */
+  void flushData();
+
+  /**
+   * @brief Parses the whole file in one pass, sending its output to the sink.
+   */
+  void parseStream();
+
+  /**
+   * @brief Patches the references a streaming parse left behind, now that every label is known.
+   */
+  void resolveReferences();
+
   /**
    * @brief Records a parse error.
    * @param error The parse error to record.
@@ -148,6 +258,9 @@ class Parser {
   bool parse_O_GPR_C_FPR_C_FPR();
   bool parse_O_FPR_C_I_LP_GPR_RP();
 
+  bool parse_O_GPR_C_LP_GPR_RP();
+  bool parse_O_GPR_C_GPR_C_LP_GPR_RP();
+
   /**
    * @brief Parses a data directive.
    */
@@ -163,20 +276,61 @@ class Parser {
    */
   void parseBSSDirective();
 
+  /**
+   * @brief Returns true if the current token is .globl, .global or .extern.
+   */
+  bool isSymbolDirective();
+
+  /**
+   * @brief Parses a .globl, .global or .extern line and records the exported symbols.
+   *
+   * .extern only documents a reference; any symbol a relocatable unit does not define
+   * is left to the linker.
+   */
+  void parseSymbolDirective();
+
  public:
   /**
    * @brief Constructs a Parser instance.
-   * @param filename The name of the file to parse.
+   * @param source The source file the tokens were lexed from; must outlive the parser.
    * @param tokens The list of tokens to parse.
    */
-  explicit Parser(std::string filename, const std::vector<Token> &tokens)
-      : filename_(std::move(filename)), tokens_(tokens) {
+  explicit Parser(const SourceFile &source, std::vector<Token> tokens)
+      : source_(source), filename_(source.getFilename()), tokens_(std::move(tokens)) {
   }
 
+  /**
+   * @brief Constructs a Parser that streams a file from a lexer to a sink.
+   *
+   * Tokens are lexed a line at a time as the parser reaches them and dropped once passed,
+   * so memory use does not grow with the length of the text section. Data, text and
+   * symbol directives are handled in one pass in file order.
+   *
+   * @param lexer The lexer to pull tokens from; must outlive the parser.
+   * @param sink Receives the instructions and data.
+   */
+  Parser(Lexer &lexer, ParserSink &sink);
+
   ~Parser() = default;
 
+  /**
+   * @brief Selects relocatable output.
+   *
+   * Branches and jumps to symbols not defined in the unit, and every `la` or load from
+   * a data label, are emitted with a zero immediate and a Relocation instead of an
+   * error or an absolute address, because the unit's final text and data placement is
+   * only known to the linker.
+   * @param relocatable True to produce a relocatable unit.
+   */
+  void setRelocatable(bool relocatable) {
+    relocatable_ = relocatable;
+  }
+
   /**
    * @brief Parses the tokens to generate intermediate code and symbol tables.
+   *
+   * A streaming parser sends its output to the sink instead and resolves its forward
+   * references at the end; getIntermediateCode() and the data buffer stay empty.
    */
   void parse();
 
@@ -200,10 +354,39 @@ class Parser {
    */
   [[nodiscard]] const std::vector<std::pair<ICUnit, bool>> &getIntermediateCode() const;
 
+  /**
+   * @brief Returns the labels the intermediate code's blocks refer to by id.
+   */
+  [[nodiscard]] const LabelTable &getLabels() const {
+    return labels_;
+  }
+
   [[nodiscard]] const std::map<unsigned int, unsigned int> &getInstructionNumberLineNumberMapping() const;
 
   [[nodiscard]] const std::map<std::string, SymbolData> &getSymbolTable() const;
 
+  /**
+   * @brief Returns the number of bytes of data the unit allocates.
+   */
+  [[nodiscard]] uint64_t getDataSize() const {
+    return data_index_;
+  }
+
+  [[nodiscard]] const std::set<std::string> &getGlobalSymbols() const {
+    return global_symbols_;
+  }
+
+  /**
+   * @brief Returns the references whose encoding depends on where code and data are placed.
+   *
+   * In a relocatable unit these are left for the linker. Otherwise they are the `la` and
+   * load-from-label pairs, already resolved, which must be re-resolved if the code before
+   * them changes size.
+   */
+  [[nodiscard]] const std::vector<Relocation> &getRelocations() const {
+    return relocations_;
+  }
+
   /**
    * @brief Prints the list of errors to the console.
    */
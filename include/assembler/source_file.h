@@ -0,0 +1,92 @@
+/**
+ * @file source_file.h
+ * @brief Read-only, memory-mapped view of an assembly source file with a line index.
+ */
+
+#ifndef SOURCE_FILE_H
+#define SOURCE_FILE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class SourceFile
+ * @brief Maps an input file into memory once and serves its text and lines as views.
+ *
+ * Text that is already in memory can be wrapped instead of mapped.
+ *
+ * Tokens produced by the Lexer point into this buffer, so a SourceFile must outlive
+ * every Token and the Parser built from it. The offset of each line start is recorded
+ * the first time a line is asked for, so fetching a line for an error message is constant
+ * time, and a file that is only lexed never pays for the index.
+ */
+class SourceFile {
+ private:
+  std::string filename_; ///< The name of the mapped file.
+  const char *data_ = nullptr; ///< Start of the mapping, or null for an empty file.
+  size_t size_ = 0; ///< Length of the file in bytes.
+  mutable std::vector<size_t> line_offsets_; ///< Byte offset of the first character of each line.
+  mutable bool indexed_ = false; ///< Whether line_offsets_ has been built.
+  std::string text_; ///< Contents of an in-memory source; empty for a mapped file.
+  bool mapped_ = false; ///< Whether data_ is a mapping to release.
+
+  /**
+   * @brief Records the offset of every line start, once.
+   */
+  void indexLines() const;
+
+ public:
+  /**
+   * @brief Opens and maps a file.
+   * @param filename The name of the file to map.
+   * @throws std::runtime_error if the file cannot be opened or mapped.
+   */
+  explicit SourceFile(std::string filename);
+
+  /**
+   * @brief Wraps source text held in memory, such as an edited fragment of a file.
+   * @param filename The name used in error messages.
+   * @param text The source text.
+   */
+  SourceFile(std::string filename, std::string text);
+
+  /**
+   * @brief Unmaps the file.
+   */
+  ~SourceFile();
+
+  SourceFile(const SourceFile &) = delete;
+  SourceFile &operator=(const SourceFile &) = delete;
+
+  /**
+   * @brief Returns the name of the mapped file.
+   */
+  const std::string &getFilename() const {
+    return filename_;
+  }
+
+  /**
+   * @brief Returns the whole file.
+   */
+  std::string_view getText() const {
+    return {data_, size_};
+  }
+
+  /**
+   * @brief Returns the number of lines, counting a final line without a newline.
+   */
+  unsigned int getLineCount() const {
+    indexLines();
+    return static_cast<unsigned int>(line_offsets_.size());
+  }
+
+  /**
+   * @brief Returns a line without its terminating newline.
+   * @param line_number The 1-based line number.
+   * @throws std::out_of_range if the line does not exist.
+   */
+  std::string_view getLine(unsigned int line_number) const;
+};
+
+#endif // SOURCE_FILE_H
@@ -7,7 +7,9 @@
 #ifndef TOKENS_H
 #define TOKENS_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 /**
  * @brief Enum class representing the type of a token.
@@ -39,12 +41,15 @@ enum class TokenType {
  * @brief Structure representing a token.
  * 
  * A token consists of a type, its value, and its position in the source code (line and column).
+ * The value is a view into the SourceFile the token was lexed from.
  */
 struct Token {
   TokenType type;         ///< Type of the token (e.g., IDENTIFIER, OPCODE)
-  std::string value;      ///< The value of the token (e.g., the actual string or number)
+  std::string_view value; ///< The value of the token (e.g., the actual string, or the source text of a number)
   unsigned int line_number; ///< Line number where the token appears
   unsigned int column_number; ///< Column number where the token appears
+  int64_t int_value = 0;    ///< Parsed value of a NUM token (two's complement for values above INT64_MAX)
+  double float_value = 0.0; ///< Parsed value of a FLOAT token
 
   /**
    * @brief Constructs a Token object.
@@ -57,7 +62,7 @@ struct Token {
    * @param column The column number of the token (default is 0).
    */
   Token(TokenType type = TokenType::INVALID,
-        const std::string &value = "",
+        std::string_view value = "",
         unsigned int line = 0,
         unsigned int column = 0)
       : type(type), value(value), line_number(line), column_number(column) {}
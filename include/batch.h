@@ -0,0 +1,30 @@
+/**
+ * @file batch.h
+ * @brief Batch simulation: many programs and configurations run concurrently in one process
+ */
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+
+/**
+ * @brief Runs every job of a manifest on its own VM and writes one report for all of them.
+ *
+ * Each non-empty line of the manifest that does not start with '#' is a job: the files of one
+ * program, as for --run, followed by any number of `Section.key=value` overrides of the loaded
+ * configuration, e.g. `fib.s Execution.processor_type=multi_stage Execution.forwarding=true`.
+ * Relative paths are taken from the manifest's directory. The jobs run on [Batch] `threads`
+ * host threads that steal work from each other, each job with its own configuration bound to
+ * its thread; nothing is written to vm_state, the program's output is not shown, reads from
+ * stdin get empty lines and the exit syscall only stops the job. instruction_execution_limit
+ * bounds every job, a multi_stage one in cycles. The report has one row per job, in manifest
+ * order, with its status, instructions, cycles, CPI, stalls, mispredictions, cache accesses
+ * and misses and wall time; it is JSON if report_path ends in .json, CSV otherwise.
+ *
+ * @param manifest_path The job list.
+ * @param report_path Where the report goes.
+ * @return Process exit code: 0 if every job ran, 1 otherwise.
+ */
+int RunBatchSimulation(const std::string &manifest_path, const std::string &report_path);
+
+#endif // BATCH_H
@@ -0,0 +1,32 @@
+/**
+ * @file bp_bench.h
+ * @brief Branch predictor benchmark: records branch traces and compares predictors by MPKI
+ */
+#ifndef BP_BENCH_H
+#define BP_BENCH_H
+
+#include "vm/branch_predictor/branch_trace.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Programs are cut off after this many instructions so looping examples still produce a trace
+constexpr uint64_t kMaxTraceInstructions = 1000000;
+
+/**
+ * @brief Assembles a program and runs it on the single-cycle VM, recording every conditional branch.
+ * @throws std::runtime_error if the program does not assemble.
+ */
+branch_predictor::BranchTrace RecordBranchTrace(const std::string &filename, uint64_t max_instructions = kMaxTraceInstructions);
+
+/**
+ * @brief Replays each program's trace through every predictor and prints an MPKI table.
+ *
+ * Paths may be assembly files, trace files written by --record-branch-trace
+ * (.bptrace), or directories searched recursively for both.
+ * @return Process exit code.
+ */
+int RunBranchPredictorBenchmark(const std::vector<std::string> &paths);
+
+#endif // BP_BENCH_H
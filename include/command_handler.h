@@ -22,6 +22,11 @@ enum class CommandType {
   UNDO,
   REDO,
   RESET,
+  SNAPSHOT,
+  RESTORE_SNAPSHOT,
+  DELETE_SNAPSHOT,
+  REVERSE_STEP,
+  REVERSE_CONTINUE,
   MODIFY_REGISTER,
   GET_REGISTER,
   MODIFY_MEMORY,
@@ -7,10 +7,11 @@
 #ifndef INSTRUCTIONS_H
 #define INSTRUCTIONS_H
 
-#include <bitset>
 #include <cstdint>
 #include <vector>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <array>
 #include <type_traits>
@@ -440,150 +441,6 @@ extern std::unordered_map<std::string, Instruction> instruction_string_map;
 
 
 
-struct RTypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-  std::bitset<7> funct7;
-
-  RTypeInstructionEncoding(unsigned int opcode, unsigned int funct3, unsigned int funct7)
-      : opcode(opcode), funct3(funct3), funct7(funct7) {}
-};
-
-struct I1TypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-
-  I1TypeInstructionEncoding(unsigned int opcode, unsigned int funct3)
-      : opcode(opcode), funct3(funct3) {}
-};
-
-struct I2TypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-  std::bitset<6> funct6;
-
-  I2TypeInstructionEncoding(unsigned int opcode, unsigned int funct3, unsigned int funct6)
-      : opcode(opcode), funct3(funct3), funct6(funct6) {}
-};
-
-struct I3TypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-  std::bitset<7> funct7;
-
-  I3TypeInstructionEncoding(unsigned int opcode, unsigned int funct3, unsigned int funct7)
-      : opcode(opcode), funct3(funct3), funct7(funct7) {}
-};
-
-struct STypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-
-  STypeInstructionEncoding(unsigned int opcode, unsigned int funct3)
-      : opcode(opcode), funct3(funct3) {}
-};
-
-struct BTypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-
-  BTypeInstructionEncoding(unsigned int opcode, unsigned int funct3)
-      : opcode(opcode), funct3(funct3) {}
-};
-
-struct UTypeInstructionEncoding {
-  std::bitset<7> opcode;
-
-  UTypeInstructionEncoding(unsigned int opcode)
-      : opcode(opcode) {}
-};
-
-struct JTypeInstructionEncoding {
-  std::bitset<7> opcode;
-
-  JTypeInstructionEncoding(unsigned int opcode)
-      : opcode(opcode) {}
-};
-
-struct CSR_RTypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-
-  CSR_RTypeInstructionEncoding(unsigned int opcode, unsigned int funct3)
-      : opcode(opcode), funct3(funct3) {}
-};
-
-struct CSR_ITypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-
-  CSR_ITypeInstructionEncoding(unsigned int opcode, unsigned int funct3)
-      : opcode(opcode), funct3(funct3) {}
-};
-
-// Fextension instructions===========================================================================
-
-struct FDRTypeInstructionEncoding { // fsgnj
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-  std::bitset<7> funct7;
-
-  FDRTypeInstructionEncoding(unsigned int opcode, unsigned int funct3, unsigned int funct7)
-      : opcode(opcode), funct3(funct3), funct7(funct7) {}
-};
-
-struct FDR1TypeInstructionEncoding { // fadd, fsub, fmul
-  std::bitset<7> opcode;
-  std::bitset<7> funct7;
-
-  FDR1TypeInstructionEncoding(unsigned int opcode, unsigned int funct7)
-      : opcode(opcode), funct7(funct7) {}
-};
-
-struct FDR2TypeInstructionEncoding { //fsqrt, have funct5 instead of rs2
-  std::bitset<7> opcode;
-  std::bitset<5> funct5;
-  std::bitset<7> funct7;
-
-  FDR2TypeInstructionEncoding(unsigned int opcode, unsigned int funct5, unsigned int funct7)
-      : opcode(opcode), funct5(funct5), funct7(funct7) {}
-};
-
-struct FDR3TypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-  std::bitset<5> funct5;
-  std::bitset<7> funct7;
-
-  FDR3TypeInstructionEncoding(unsigned int opcode, unsigned int funct3, unsigned int funct5, unsigned int funct7)
-      : opcode(opcode), funct3(funct3), funct5(funct5), funct7(funct7) {}
-
-};
-
-struct FDR4TypeInstructionEncoding { //fmadd
-  std::bitset<7> opcode;
-  std::bitset<2> funct2;
-
-  FDR4TypeInstructionEncoding(unsigned int opcode, unsigned int funct2)
-      : opcode(opcode), funct2(funct2) {}
-};
-
-struct FDITypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-
-  FDITypeInstructionEncoding(unsigned int opcode, unsigned int funct3)
-      : opcode(opcode), funct3(funct3) {}
-};
-
-struct FDSTypeInstructionEncoding {
-  std::bitset<7> opcode;
-  std::bitset<3> funct3;
-
-  FDSTypeInstructionEncoding(unsigned int opcode, unsigned int funct3)
-      : opcode(opcode), funct3(funct3) {}
-};
-
 /**
  * @brief Enum that represents different syntax types for instructions.
  */
@@ -615,68 +472,135 @@ enum class SyntaxType {
   O_GPR_C_FPR_C_RM,       ///< Opcode general-register , floating-point-register , rounding_mode
   O_GPR_C_FPR_C_FPR,       ///< Opcode general-register , floating-point-register , floating-point-register
   O_FPR_C_I_LP_GPR_RP,    ///< Opcode floating-point-register , immediate , lparen ( general-register ) rparen
+
+  O_GPR_C_LP_GPR_RP,       ///< Opcode general-register , lparen ( general-register ) rparen
+  O_GPR_C_GPR_C_LP_GPR_RP,   ///< Opcode general-register , general-register , lparen ( general-register ) rparen
 };
 
-extern std::unordered_map<std::string, RTypeInstructionEncoding> R_type_instruction_encoding_map;
-extern std::unordered_map<std::string, I1TypeInstructionEncoding> I1_type_instruction_encoding_map;
-extern std::unordered_map<std::string, I2TypeInstructionEncoding> I2_type_instruction_encoding_map;
-extern std::unordered_map<std::string, I3TypeInstructionEncoding> I3_type_instruction_encoding_map;
-extern std::unordered_map<std::string, STypeInstructionEncoding> S_type_instruction_encoding_map;
-extern std::unordered_map<std::string, BTypeInstructionEncoding> B_type_instruction_encoding_map;
-extern std::unordered_map<std::string, UTypeInstructionEncoding> U_type_instruction_encoding_map;
-extern std::unordered_map<std::string, JTypeInstructionEncoding> J_type_instruction_encoding_map;
-extern std::unordered_map<std::string, CSR_RTypeInstructionEncoding> CSR_R_type_instruction_encoding_map;
-extern std::unordered_map<std::string, CSR_ITypeInstructionEncoding> CSR_I_type_instruction_encoding_map;
-
-extern std::unordered_map<std::string, FDRTypeInstructionEncoding> F_D_R_type_instruction_encoding_map;
-extern std::unordered_map<std::string, FDR1TypeInstructionEncoding> F_D_R1_type_instruction_encoding_map;
-extern std::unordered_map<std::string, FDR2TypeInstructionEncoding> F_D_R2_type_instruction_encoding_map;
-extern std::unordered_map<std::string, FDR3TypeInstructionEncoding> F_D_R3_type_instruction_encoding_map;
-extern std::unordered_map<std::string, FDR4TypeInstructionEncoding> F_D_R4_type_instruction_encoding_map;
-extern std::unordered_map<std::string, FDITypeInstructionEncoding> F_D_I_type_instruction_encoding_map;
-extern std::unordered_map<std::string, FDSTypeInstructionEncoding> F_D_S_type_instruction_encoding_map;
+/**
+ * @brief Encoding format of an instruction, which selects its machine code generator.
+ */
+enum class InstructionFormat : uint8_t {
+  R,       ///< add, mul, ...: funct7, funct3
+  I1,      ///< addi, loads, jalr: funct3
+  I2,      ///< Shifts by immediate: funct6, funct3
+  I3,      ///< ecall
+  S,       ///< Stores: funct3
+  B,       ///< Branches: funct3
+  U,       ///< lui, auipc
+  J,       ///< jal
+  CsrR,    ///< csrrw, csrrs, csrrc: funct3
+  CsrI,    ///< csrrwi, csrrsi, csrrci: funct3
+  FdR,     ///< fsgnj, fmin/fmax, compares: funct7, funct3
+  FdR1,    ///< fadd, fsub, fmul, fdiv: funct7, rounding mode
+  FdR2,    ///< fsqrt and conversions: funct7, funct5 in rs2, rounding mode
+  FdR3,    ///< fmv and fclass: funct7, funct5, funct3
+  FdR4,    ///< Fused multiply-add: funct2, rs3, rounding mode
+  FdI,     ///< flw, fld: funct3
+  FdS,     ///< fsw, fsd: funct3
+  A,       ///< lr, sc and AMOs: funct5, funct3
+  Pseudo,  ///< Expanded by the parser, never encoded directly
+};
 
 /**
- * @brief A map that associates instruction names with their expected syntax.
- * 
- * This map stores the expected syntax for various instructions, indexed by their names.
+ * @brief Extension an instruction belongs to.
  */
-extern std::unordered_map<std::string, std::vector<SyntaxType>> instruction_syntax_map;
+enum class InstructionExtension : uint8_t {
+  kBase,
+  kM,
+  kCsr,
+  kF,
+  kD,
+  kA,
+  kPseudo,
+};
+
+/**
+ * @brief Everything the assembler needs to know about one mnemonic.
+ *
+ * Encoding fields an instruction format does not use are zero.
+ */
+struct InstructionInfo {
+  std::string_view name;
+  InstructionFormat format;
+  InstructionExtension extension;
+  uint8_t opcode;
+  uint8_t funct2;
+  uint8_t funct3;
+  uint8_t funct5;
+  uint8_t funct6;
+  uint8_t funct7;
+  std::array<SyntaxType, 2> syntax_list; ///< Accepted operand syntaxes, tried in order
+  uint8_t syntax_count;
+
+  constexpr std::span<const SyntaxType> syntaxes() const {
+    return {syntax_list.data(), syntax_count};
+  }
+};
+
+/**
+ * @brief Looks up a mnemonic in the compile-time instruction table.
+ *
+ * @param name The mnemonic, e.g. "add" or "fcvt.w.s".
+ * @return The instruction's record, or nullptr if it is not a known instruction.
+ */
+const InstructionInfo *findInstruction(std::string_view name);
+
+/// Position of an instruction's record in the instruction table.
+using InstructionId = uint16_t;
+
+/// The id of no instruction.
+inline constexpr InstructionId kNoInstruction = UINT16_MAX;
+
+/**
+ * @brief Looks up the table id of a mnemonic.
+ *
+ * @param name The mnemonic.
+ * @return Its id, or kNoInstruction if it is not a known instruction.
+ */
+InstructionId findInstructionId(std::string_view name);
+
+/**
+ * @brief Returns the record of an id returned by findInstructionId(), other than kNoInstruction.
+ */
+const InstructionInfo &getInstructionInfo(InstructionId id);
+
+bool isValidInstruction(std::string_view instruction);
 
-bool isValidInstruction(const std::string &instruction);
+bool isValidRTypeInstruction(std::string_view instruction);
+bool isValidITypeInstruction(std::string_view instruction);
+bool isValidI1TypeInstruction(std::string_view instruction);
+bool isValidI2TypeInstruction(std::string_view instruction);
+bool isValidI3TypeInstruction(std::string_view instruction);
+bool isValidSTypeInstruction(std::string_view instruction);
+bool isValidBTypeInstruction(std::string_view instruction);
+bool isValidUTypeInstruction(std::string_view instruction);
+bool isValidJTypeInstruction(std::string_view instruction);
 
-bool isValidRTypeInstruction(const std::string &name);
-bool isValidITypeInstruction(const std::string &instruction);
-bool isValidI1TypeInstruction(const std::string &instruction);
-bool isValidI2TypeInstruction(const std::string &instruction);
-bool isValidI3TypeInstruction(const std::string &instruction);
-bool isValidSTypeInstruction(const std::string &instruction);
-bool isValidBTypeInstruction(const std::string &instruction);
-bool isValidUTypeInstruction(const std::string &instruction);
-bool isValidJTypeInstruction(const std::string &instruction);
+bool isValidPseudoInstruction(std::string_view instruction);
 
-bool isValidPseudoInstruction(const std::string &instruction);
+bool isValidBaseExtensionInstruction(std::string_view instruction);
 
-bool isValidBaseExtensionInstruction(const std::string &instruction);
+bool isValidMExtensionInstruction(std::string_view instruction);
 
-bool isValidMExtensionInstruction(const std::string &instruction);
+bool isValidCSRRTypeInstruction(std::string_view instruction);
+bool isValidCSRITypeInstruction(std::string_view instruction);
+bool isValidCSRInstruction(std::string_view instruction);
 
-bool isValidCSRRTypeInstruction(const std::string &instruction);
-bool isValidCSRITypeInstruction(const std::string &instruction);
-bool isValidCSRInstruction(const std::string &instruction);
+bool isValidFDRTypeInstruction(std::string_view instruction);
+bool isValidFDR1TypeInstruction(std::string_view instruction);
+bool isValidFDR2TypeInstruction(std::string_view instruction);
+bool isValidFDR3TypeInstruction(std::string_view instruction);
+bool isValidFDR4TypeInstruction(std::string_view instruction);
+bool isValidFDITypeInstruction(std::string_view instruction);
+bool isValidFDSTypeInstruction(std::string_view instruction);
 
-bool isValidFDRTypeInstruction(const std::string &instruction);
-bool isValidFDR1TypeInstruction(const std::string &instruction);
-bool isValidFDR2TypeInstruction(const std::string &instruction);
-bool isValidFDR3TypeInstruction(const std::string &instruction);
-bool isValidFDR4TypeInstruction(const std::string &instruction);
-bool isValidFDITypeInstruction(const std::string &instruction);
-bool isValidFDSTypeInstruction(const std::string &instruction);
+bool isValidATypeInstruction(std::string_view instruction);
 
 bool isFInstruction(const uint32_t &instruction);
 bool isDInstruction(const uint32_t &instruction);
 
-std::string getExpectedSyntaxes(const std::string &opcode);
+std::string getExpectedSyntaxes(std::string_view opcode);
 
 } // namespace instruction_set
 
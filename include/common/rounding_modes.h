@@ -9,6 +9,7 @@
 #include <unordered_map>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 enum class RoundingMode {
   RNE,  // Round to Nearest, ties to Even
@@ -37,8 +38,8 @@ inline const std::unordered_map<RoundingMode, int> roundingModeEncoding = {
     {RoundingMode::DYN, 0b111}
 };
 
-inline bool isValidRoundingMode(const std::string &mode) {
-  return stringToRoundingMode.find(mode)!=stringToRoundingMode.end();
+inline bool isValidRoundingMode(std::string_view mode) {
+  return mode=="rne" || mode=="rtz" || mode=="rdn" || mode=="rup" || mode=="rmm" || mode=="dyn";
 }
 
 inline int getRoundingModeEncoding(const std::string &mode) {
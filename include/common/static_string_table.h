@@ -0,0 +1,113 @@
+/**
+ * @file static_string_table.h
+ * @brief Open-addressed string lookup table built entirely at compile time.
+ */
+
+#ifndef STATIC_STRING_TABLE_H
+#define STATIC_STRING_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief FNV-1a hash of a string, usable in constant expressions.
+ */
+constexpr uint32_t HashStaticString(std::string_view text) {
+  uint32_t hash = 2166136261u;
+  for (char c : text) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * @brief Immutable table of entries keyed by their `name` member.
+ *
+ * The slot index is computed by the constructor, so declaring the table
+ * `constexpr` places both the entries and the index in read-only data with no
+ * start-up cost. Slots is a power of two larger than the entry count; keeping
+ * the load factor low bounds the probe sequence, which maxProbeLength() lets
+ * callers check with a static_assert.
+ *
+ * @tparam Entry Aggregate with a `std::string_view name` member.
+ * @tparam N Number of entries.
+ * @tparam Slots Number of hash slots.
+ */
+template <typename Entry, size_t N, size_t Slots>
+class StaticStringTable {
+  static_assert((Slots & (Slots - 1))==0, "Slots must be a power of two");
+  static_assert(N < Slots, "Slots must exceed the number of entries");
+  static_assert(N < UINT16_MAX, "Too many entries");
+
+  static constexpr uint16_t kEmpty = UINT16_MAX;
+
+  std::array<Entry, N> entries_;
+  std::array<uint16_t, Slots> slots_{};
+
+ public:
+  constexpr explicit StaticStringTable(const std::array<Entry, N> &entries) : entries_(entries) {
+    for (uint16_t &slot : slots_) {
+      slot = kEmpty;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      size_t slot = HashStaticString(entries_[i].name) & (Slots - 1);
+      while (slots_[slot]!=kEmpty) {
+        slot = (slot + 1) & (Slots - 1);
+      }
+      slots_[slot] = static_cast<uint16_t>(i);
+    }
+  }
+
+  /**
+   * @brief Returns the entry with the given name, or nullptr.
+   */
+  constexpr const Entry *find(std::string_view name) const {
+    size_t slot = HashStaticString(name) & (Slots - 1);
+    while (slots_[slot]!=kEmpty) {
+      const Entry &entry = entries_[slots_[slot]];
+      if (entry.name==name) {
+        return &entry;
+      }
+      slot = (slot + 1) & (Slots - 1);
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Longest run of slots a successful lookup compares against.
+   */
+  constexpr size_t maxProbeLength() const {
+    size_t longest = 0;
+    for (size_t i = 0; i < N; ++i) {
+      size_t slot = HashStaticString(entries_[i].name) & (Slots - 1);
+      size_t probes = 1;
+      while (slots_[slot]!=i) {
+        slot = (slot + 1) & (Slots - 1);
+        ++probes;
+      }
+      longest = probes > longest ? probes : longest;
+    }
+    return longest;
+  }
+
+  /**
+   * @brief True if two entries share a name; the later one would be unreachable.
+   */
+  constexpr bool hasDuplicates() const {
+    for (size_t i = 0; i < N; ++i) {
+      if (find(entries_[i].name)!=&entries_[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  constexpr const std::array<Entry, N> &entries() const {
+    return entries_;
+  }
+};
+
+#endif // STATIC_STRING_TABLE_H
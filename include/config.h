@@ -14,6 +14,7 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <memory>
 
 /**
  * @namespace vm_config
@@ -22,7 +23,9 @@
 namespace vm_config {
 enum class VmTypes {
   SINGLE_STAGE,
-  MULTI_STAGE
+  MULTI_STAGE,
+  IN_ORDER,
+  OUT_OF_ORDER
 };
 
 // Branch Prediction Types
@@ -31,6 +34,15 @@ enum class BranchPredictionType {
   STATIC,
   DYNAMIC1BIT,
   DYNAMIC2BIT,
+  GSHARE,
+  TOURNAMENT,
+  TAGE,
+};
+
+// How --sample picks the windows simulated in detail
+enum class SamplingMode {
+  WINDOW,   // one window after fast_forward instructions
+  PERIODIC, // a window every period instructions, extrapolated over the whole run
 };
 
 struct VmConfig {
@@ -64,15 +76,83 @@ struct VmConfig {
 
   uint64_t instruction_execution_limit = 100;
 
+  // Reverse execution: steps between checkpoints, and how many are kept before thinning
+  uint64_t checkpoint_interval = 100000;
+  uint64_t max_checkpoints = 64;
+
   bool m_extension_enabled = true;
   bool f_extension_enabled = true;
   bool d_extension_enabled = true;
 
+  // [Assembler] reuse assembled programs from vm_state/assembly_cache
+  bool assembly_cache_enabled = false;
+
   // Pipeline Toggles
   bool hazard_detection_enabled = false;
   bool forwarding_enabled = false;
   BranchPredictionType branch_prediction_type = BranchPredictionType::NONE;
 
+  // Branch Predictor Table Sizes (entries, powers of two)
+  // [BranchPrediction]
+  uint64_t one_bit_table_size = 1024;
+  uint64_t bimodal_table_size = 1024;
+  uint64_t gshare_table_size = 4096;
+  uint64_t gshare_history_bits = 12;
+  uint64_t chooser_table_size = 1024;
+  uint64_t tage_table_size = 1024;
+  uint64_t tage_num_tables = 4;
+  uint64_t tage_min_history = 4;
+  uint64_t tage_max_history = 64;
+
+  // [Pipeline] shape of the in_order pipeline model
+  uint64_t issue_width = 1;
+  uint64_t frontend_stages = 2;
+  uint64_t execute_stages = 1;
+  uint64_t memory_stages = 1;
+
+  // [OutOfOrder] window sizes of the out_of_order core
+  uint64_t ooo_width = 4;
+  uint64_t rob_size = 64;
+  uint64_t issue_queue_size = 32;
+  uint64_t lsq_size = 16;
+  uint64_t physical_registers = 128;
+
+  // [Sampling] fast-forward and detailed windows of --sample, in instructions
+  SamplingMode sampling_mode = SamplingMode::PERIODIC;
+  uint64_t sampling_fast_forward = 0;
+  uint64_t sampling_warmup = 2000;
+  uint64_t sampling_window = 1000;
+  uint64_t sampling_period = 100000;
+  double sampling_confidence = 0.95;
+
+  // [SimPoint] intervals and clustering of --simpoint
+  uint64_t simpoint_interval = 100000;
+  uint64_t simpoint_max_clusters = 10;
+  uint64_t simpoint_dimensions = 15;
+
+  // [Multicore] harts of --multicore and their coherent L1s
+  uint64_t multicore_harts = 2;
+  VmTypes multicore_core = VmTypes::SINGLE_STAGE; // single_stage or multi_stage
+  uint64_t multicore_l1_lines = 64;
+  uint64_t multicore_l1_block_size = 64;
+  uint64_t multicore_l1_associativity = 4;
+  uint64_t multicore_stack_spacing = 0x10000; // hart i starts with sp lowered by i times this
+  uint64_t multicore_quantum = 0; // cycles between barriers of the threaded mode, 0 for lockstep on one thread
+  uint64_t multicore_threads = 0; // host threads of the threaded mode, 0 for one per hart
+  bool multicore_deterministic = true;
+
+  uint64_t batch_threads = 0; // host threads of --batch, 0 for one per hardware thread
+
+  // [Syscalls] host directory the guest's file syscalls are confined to, empty for no file access
+  std::string syscall_sandbox_directory;
+
+  // Jump target prediction in the fetch stage
+  bool btb_enabled = true;
+  uint64_t btb_entries = 64;
+  uint64_t btb_associativity = 4;
+  bool ras_enabled = true;
+  uint64_t ras_size = 16;
+
   void setVmType(const VmTypes &type) {
     vm_type = type;
   }
@@ -86,6 +166,10 @@ struct VmConfig {
         return "single_stage";
       case VmTypes::MULTI_STAGE:
         return "multi_stage";
+      case VmTypes::IN_ORDER:
+        return "in_order";
+      case VmTypes::OUT_OF_ORDER:
+        return "out_of_order";
       default:
         return "unknown";
     }
@@ -140,6 +224,22 @@ struct VmConfig {
     return instruction_execution_limit;
   }
 
+  void setCheckpointInterval(uint64_t interval) {
+    checkpoint_interval = interval;
+  }
+
+  uint64_t getCheckpointInterval() const {
+    return checkpoint_interval;
+  }
+
+  void setMaxCheckpoints(uint64_t count) {
+    max_checkpoints = count;
+  }
+
+  uint64_t getMaxCheckpoints() const {
+    return max_checkpoints;
+  }
+
   void setMExtensionEnabled(bool enabled) {
     m_extension_enabled = enabled;
   }
@@ -164,6 +264,14 @@ struct VmConfig {
     return d_extension_enabled;
   }
 
+  void setAssemblyCacheEnabled(bool enabled) {
+    assembly_cache_enabled = enabled;
+  }
+
+  bool getAssemblyCacheEnabled() const {
+    return assembly_cache_enabled;
+  }
+
   //why so many get set functions = encapsulation
 
   void setHazardDetectionEnabled(bool enabled){
@@ -200,11 +308,326 @@ struct VmConfig {
         return "dynamic_1bit";
       case BranchPredictionType::DYNAMIC2BIT:
         return "dynamic_2bit";
+      case BranchPredictionType::GSHARE:
+        return "gshare";
+      case BranchPredictionType::TOURNAMENT:
+        return "tournament";
+      case BranchPredictionType::TAGE:
+        return "tage";
       default:
         return "none";
     }
   }
 
+  // Getters and Setters for Branch Predictor Configuration
+
+  uint64_t getOneBitTableSize() const {
+    return one_bit_table_size;
+  }
+  void setOneBitTableSize(uint64_t size) {
+    one_bit_table_size = size;
+  }
+
+  uint64_t getBimodalTableSize() const {
+    return bimodal_table_size;
+  }
+  void setBimodalTableSize(uint64_t size) {
+    bimodal_table_size = size;
+  }
+
+  uint64_t getGshareTableSize() const {
+    return gshare_table_size;
+  }
+  void setGshareTableSize(uint64_t size) {
+    gshare_table_size = size;
+  }
+
+  uint64_t getGshareHistoryBits() const {
+    return gshare_history_bits;
+  }
+  void setGshareHistoryBits(uint64_t bits) {
+    gshare_history_bits = bits;
+  }
+
+  uint64_t getChooserTableSize() const {
+    return chooser_table_size;
+  }
+  void setChooserTableSize(uint64_t size) {
+    chooser_table_size = size;
+  }
+
+  uint64_t getTageTableSize() const {
+    return tage_table_size;
+  }
+  void setTageTableSize(uint64_t size) {
+    tage_table_size = size;
+  }
+
+  uint64_t getTageNumTables() const {
+    return tage_num_tables;
+  }
+  void setTageNumTables(uint64_t tables) {
+    tage_num_tables = tables;
+  }
+
+  uint64_t getTageMinHistory() const {
+    return tage_min_history;
+  }
+  void setTageMinHistory(uint64_t length) {
+    tage_min_history = length;
+  }
+
+  uint64_t getTageMaxHistory() const {
+    return tage_max_history;
+  }
+  void setTageMaxHistory(uint64_t length) {
+    tage_max_history = length;
+  }
+
+  uint64_t getIssueWidth() const {
+    return issue_width;
+  }
+  void setIssueWidth(uint64_t width) {
+    issue_width = width;
+  }
+
+  uint64_t getFrontendStages() const {
+    return frontend_stages;
+  }
+  void setFrontendStages(uint64_t stages) {
+    frontend_stages = stages;
+  }
+
+  uint64_t getExecuteStages() const {
+    return execute_stages;
+  }
+  void setExecuteStages(uint64_t stages) {
+    execute_stages = stages;
+  }
+
+  uint64_t getMemoryStages() const {
+    return memory_stages;
+  }
+  void setMemoryStages(uint64_t stages) {
+    memory_stages = stages;
+  }
+
+  uint64_t getOooWidth() const {
+    return ooo_width;
+  }
+  void setOooWidth(uint64_t width) {
+    ooo_width = width;
+  }
+
+  uint64_t getRobSize() const {
+    return rob_size;
+  }
+  void setRobSize(uint64_t size) {
+    rob_size = size;
+  }
+
+  uint64_t getIssueQueueSize() const {
+    return issue_queue_size;
+  }
+  void setIssueQueueSize(uint64_t size) {
+    issue_queue_size = size;
+  }
+
+  uint64_t getLsqSize() const {
+    return lsq_size;
+  }
+  void setLsqSize(uint64_t size) {
+    lsq_size = size;
+  }
+
+  uint64_t getPhysicalRegisters() const {
+    return physical_registers;
+  }
+  void setPhysicalRegisters(uint64_t count) {
+    physical_registers = count;
+  }
+
+  bool getBtbEnabled() const {
+    return btb_enabled;
+  }
+  void setBtbEnabled(bool enabled) {
+    btb_enabled = enabled;
+  }
+
+  uint64_t getBtbEntries() const {
+    return btb_entries;
+  }
+  void setBtbEntries(uint64_t entries) {
+    btb_entries = entries;
+  }
+
+  uint64_t getBtbAssociativity() const {
+    return btb_associativity;
+  }
+  void setBtbAssociativity(uint64_t associativity) {
+    btb_associativity = associativity;
+  }
+
+  bool getRasEnabled() const {
+    return ras_enabled;
+  }
+  void setRasEnabled(bool enabled) {
+    ras_enabled = enabled;
+  }
+
+  uint64_t getRasSize() const {
+    return ras_size;
+  }
+  void setRasSize(uint64_t size) {
+    ras_size = size;
+  }
+
+  SamplingMode getSamplingMode() const {
+    return sampling_mode;
+  }
+  std::string getSamplingModeString() const {
+    return sampling_mode == SamplingMode::WINDOW ? "window" : "periodic";
+  }
+  void setSamplingMode(SamplingMode mode) {
+    sampling_mode = mode;
+  }
+
+  uint64_t getSamplingFastForward() const {
+    return sampling_fast_forward;
+  }
+  void setSamplingFastForward(uint64_t instructions) {
+    sampling_fast_forward = instructions;
+  }
+
+  uint64_t getSamplingWarmup() const {
+    return sampling_warmup;
+  }
+  void setSamplingWarmup(uint64_t instructions) {
+    sampling_warmup = instructions;
+  }
+
+  uint64_t getSamplingWindow() const {
+    return sampling_window;
+  }
+  void setSamplingWindow(uint64_t instructions) {
+    sampling_window = instructions;
+  }
+
+  uint64_t getSamplingPeriod() const {
+    return sampling_period;
+  }
+  void setSamplingPeriod(uint64_t instructions) {
+    sampling_period = instructions;
+  }
+
+  double getSamplingConfidence() const {
+    return sampling_confidence;
+  }
+  void setSamplingConfidence(double confidence) {
+    sampling_confidence = confidence;
+  }
+
+  uint64_t getSimPointInterval() const {
+    return simpoint_interval;
+  }
+  void setSimPointInterval(uint64_t instructions) {
+    simpoint_interval = instructions;
+  }
+
+  uint64_t getSimPointMaxClusters() const {
+    return simpoint_max_clusters;
+  }
+  void setSimPointMaxClusters(uint64_t clusters) {
+    simpoint_max_clusters = clusters;
+  }
+
+  uint64_t getSimPointDimensions() const {
+    return simpoint_dimensions;
+  }
+  void setSimPointDimensions(uint64_t dimensions) {
+    simpoint_dimensions = dimensions;
+  }
+
+  uint64_t getMulticoreHarts() const {
+    return multicore_harts;
+  }
+  void setMulticoreHarts(uint64_t harts) {
+    multicore_harts = harts;
+  }
+
+  VmTypes getMulticoreCore() const {
+    return multicore_core;
+  }
+  std::string getMulticoreCoreString() const {
+    return multicore_core == VmTypes::MULTI_STAGE ? "multi_stage" : "single_stage";
+  }
+  void setMulticoreCore(VmTypes type) {
+    multicore_core = type;
+  }
+
+  uint64_t getMulticoreL1Lines() const {
+    return multicore_l1_lines;
+  }
+  void setMulticoreL1Lines(uint64_t lines) {
+    multicore_l1_lines = lines;
+  }
+
+  uint64_t getMulticoreL1BlockSize() const {
+    return multicore_l1_block_size;
+  }
+  void setMulticoreL1BlockSize(uint64_t block_size) {
+    multicore_l1_block_size = block_size;
+  }
+
+  uint64_t getMulticoreL1Associativity() const {
+    return multicore_l1_associativity;
+  }
+  void setMulticoreL1Associativity(uint64_t associativity) {
+    multicore_l1_associativity = associativity;
+  }
+
+  uint64_t getMulticoreStackSpacing() const {
+    return multicore_stack_spacing;
+  }
+  void setMulticoreStackSpacing(uint64_t bytes) {
+    multicore_stack_spacing = bytes;
+  }
+
+  uint64_t getMulticoreQuantum() const {
+    return multicore_quantum;
+  }
+  void setMulticoreQuantum(uint64_t cycles) {
+    multicore_quantum = cycles;
+  }
+
+  uint64_t getMulticoreThreads() const {
+    return multicore_threads;
+  }
+  void setMulticoreThreads(uint64_t threads) {
+    multicore_threads = threads;
+  }
+
+  bool getMulticoreDeterministic() const {
+    return multicore_deterministic;
+  }
+  void setMulticoreDeterministic(bool deterministic) {
+    multicore_deterministic = deterministic;
+  }
+
+  uint64_t getBatchThreads() const {
+    return batch_threads;
+  }
+  void setBatchThreads(uint64_t threads) {
+    batch_threads = threads;
+  }
+
+  const std::string &getSyscallSandboxDirectory() const {
+    return syscall_sandbox_directory;
+  }
+  void setSyscallSandboxDirectory(const std::string &directory) {
+    syscall_sandbox_directory = directory;
+  }
+
   // Getters and Setters for Cache Configuration
 
   bool getCacheEnabled() const {
@@ -273,6 +696,48 @@ struct VmConfig {
 
 extern VmConfig config;
 
+// Configuration bound to this thread by a ScopedConfig, if any
+inline thread_local const VmConfig *bound_config = nullptr;
+
+/**
+ * @brief The configuration simulations on this thread use: the one bound by the innermost
+ * ScopedConfig, else the process-wide config loaded from config.ini.
+ */
+inline const VmConfig &current() {
+  return bound_config ? *bound_config : config;
+}
+
+/**
+ * @brief Binds a configuration to the calling thread for as long as it lives.
+ *
+ * Lets several differently configured simulations run on different threads of one process;
+ * the bound configuration must outlive the binding.
+ */
+class ScopedConfig {
+ public:
+  explicit ScopedConfig(const VmConfig &bound) : previous_(bound_config) {
+    bound_config = &bound;
+  }
+  ~ScopedConfig() {
+    bound_config = previous_;
+  }
+  ScopedConfig(const ScopedConfig &) = delete;
+  ScopedConfig &operator=(const ScopedConfig &) = delete;
+
+ private:
+  const VmConfig *previous_;
+};
+
+/// A configuration nobody changes any more, the kind a VM is built with and runs on.
+using ConfigSnapshot = std::shared_ptr<const VmConfig>;
+
+/**
+ * @brief Copies the configuration current() returns, so it can be handed to a VM.
+ */
+inline ConfigSnapshot snapshot() {
+  return std::make_shared<const VmConfig>(current());
+}
+
 
 } // namespace vm_config
 
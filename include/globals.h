@@ -10,15 +10,22 @@
 
 namespace globals {
 extern std::filesystem::path invokation_path;
-extern std::filesystem::path vm_state_directory;
 extern std::filesystem::path config_file_path;
-extern std::filesystem::path disassembly_file_path;
-extern std::filesystem::path errors_dump_file_path;
-extern std::filesystem::path registers_dump_file_path;
-extern std::filesystem::path memory_dump_file_path;
-extern std::filesystem::path cache_dump_file_path;
-extern std::filesystem::path vm_state_dump_file_path;
-extern std::filesystem::path pipeline_registers_dump_file_path;
+extern std::filesystem::path assembly_cache_directory;
+
+// Where simulations write their state. Each thread has its own set, all in vm_state at first,
+// so simulations running side by side in one process can be pointed at different places.
+extern thread_local std::filesystem::path vm_state_directory;
+extern thread_local std::filesystem::path disassembly_file_path;
+extern thread_local std::filesystem::path errors_dump_file_path;
+extern thread_local std::filesystem::path registers_dump_file_path;
+extern thread_local std::filesystem::path memory_dump_file_path;
+extern thread_local std::filesystem::path cache_dump_file_path;
+extern thread_local std::filesystem::path vm_state_dump_file_path;
+extern thread_local std::filesystem::path pipeline_registers_dump_file_path;
+extern thread_local std::filesystem::path simpoint_bbv_file_path;
+extern thread_local std::filesystem::path simpoint_file_path;
+extern thread_local std::filesystem::path simpoint_weights_file_path;
 //extern std::string output_file;
 
 extern bool verbose_errors_print;
@@ -28,6 +35,10 @@ extern bool vm_as_backend;
 extern unsigned int text_section_start;
 
 void initGlobals();
+
+// Points this thread's state files into directory, which is not created; an empty directory
+// empties every path, and nothing is written to an empty path
+void setStateDirectory(const std::filesystem::path &directory);
 }
 
 #endif // GLOBALS_H
\ No newline at end of file
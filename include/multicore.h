@@ -0,0 +1,35 @@
+/**
+ * @file multicore.h
+ * @brief Several harts with private coherent L1 caches over one shared memory
+ */
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs one program on several harts sharing memory and reports per-hart and bus statistics.
+ *
+ * Every hart is a single-cycle (RVSSVM) or 5-stage (RV5SVM) core, as [Multicore] `core` says,
+ * with its own registers, pc and predictors. All harts use the memory of hart 0; their accesses
+ * go through private L1 caches that a cache::MesiSystem keeps coherent. Each hart starts at the
+ * entry point with its id in a0 and in the mhartid CSR (RV5SVM has no CSR instructions, so a0
+ * is the portable one) and with sp lowered by id times `stack_spacing`, so the program can give
+ * the harts different work. The harts are stepped round-robin, one instruction (single_stage) or
+ * one clock (multi_stage) each, until every one has reached the end of the text or, on a
+ * single-cycle core, an exit syscall, or run instruction_execution_limit steps.
+ * Registers of each hart are written to vm_state/registers_dump_hart<id>.json.
+ *
+ * With a nonzero [Multicore] `quantum` the single-cycle harts run on host threads instead, each on
+ * a private copy of memory, synchronised by a barrier every `quantum` steps where the logged
+ * accesses are replayed through the L1s and merged into the shared memory in hart order. In
+ * `deterministic` mode AMOs are redone at the barrier; otherwise atomics go to the shared memory
+ * at once under a lock. The run is timed on one thread and on `threads` to report the speedup.
+ *
+ * @param filenames Sources, objects or an ELF executable, as for --run.
+ * @return Process exit code.
+ */
+int RunMulticoreSimulation(const std::vector<std::string> &filenames);
+
+#endif // MULTICORE_H
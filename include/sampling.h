@@ -0,0 +1,46 @@
+/**
+ * @file sampling.h
+ * @brief Sampled simulation: functional fast-forward with detailed 5-stage pipeline windows
+ */
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs a program on the single-cycle VM and simulates windows of it on the 5-stage pipeline.
+ *
+ * Between windows the single-cycle VM executes instructions functionally while keeping the
+ * cache and the branch/target predictors warm. At each sample point its state is handed to a
+ * RV5SVM, which starts with an empty pipeline, simulates `warmup` instructions unmeasured and
+ * then measures `window` instructions; the single-cycle VM then carries on from where it was.
+ * With mode=window a single window is taken after `fast_forward` instructions. With
+ * mode=periodic (SMARTS-style) a window starts every `period` instructions from there until the
+ * program ends, and the CPI and cache miss rate are extrapolated from the samples with
+ * confidence intervals. Settings come from the [Sampling] section; the pipeline, cache and
+ * predictors are configured as for processor_type=multi_stage.
+ *
+ * @param filenames Sources, objects or an ELF executable, as for --run.
+ * @return Process exit code.
+ */
+int RunSampledSimulation(const std::vector<std::string> &filenames);
+
+/**
+ * @brief Reconstructs whole-program CPI from a few intervals chosen SimPoint-style.
+ *
+ * The single-cycle VM runs the program once, recording a basic block vector for every
+ * [SimPoint] `interval` instructions into vm_state/simpoint.bb. The vectors are randomly
+ * projected to `dimensions` dimensions and clustered with k-means (k up to `max_clusters`,
+ * picked by BIC); the interval closest to each centroid represents its cluster, weighted by the
+ * cluster's share of the instructions (vm_state/simpoint.simpoints and simpoint.weights). A
+ * second functional run, warming the cache and predictors, checkpoints the start of each chosen
+ * interval, and RV5SVM simulates each interval from its checkpoint. The weighted CPIs give the
+ * whole-program estimate.
+ *
+ * @param filenames Sources, objects or an ELF executable, as for --run.
+ * @return Process exit code.
+ */
+int RunSimPointSimulation(const std::vector<std::string> &filenames);
+
+#endif // SAMPLING_H
@@ -0,0 +1,112 @@
+/**
+ * @file simpoint.h
+ * @brief Basic block vector profiling and SimPoint-style selection of representative intervals
+ */
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace simpoint {
+
+/**
+ * @brief Splits a run into intervals of a fixed number of retired instructions and records a
+ * basic block vector for each.
+ *
+ * A basic block starts at the target of a branch or jump (or at the first instruction) and ends
+ * with the next branch or jump; its entry in a vector is the number of instructions executed in
+ * it during the interval. Every vector is written to the output in the SimPoint `.bb` format
+ * (`T:<block>:<count> ...`, blocks numbered from 1 in order of first execution) and is kept only
+ * as a random projection of its normalised form, so memory grows with the number of intervals
+ * and distinct blocks, not with the length of the run.
+ */
+class BbvProfiler {
+  public:
+    /**
+     * @param interval Instructions per interval.
+     * @param dimensions Length of the projected vectors.
+     * @param output Where the `.bb` lines are written.
+     */
+    BbvProfiler(uint64_t interval, unsigned int dimensions, std::ostream &output);
+
+    /**
+     * @brief Accounts one retired instruction.
+     * @param pc Its address.
+     * @param ends_block Whether it is a branch or jump, so the next instruction starts a block.
+     */
+    void Retire(uint64_t pc, bool ends_block);
+
+    /**
+     * @brief Closes the last, possibly partial, interval.
+     */
+    void Finish();
+
+    /**
+     * @brief Projected vectors, one per completed interval.
+     */
+    [[nodiscard]] const std::vector<std::vector<double>> &GetProjections() const {
+        return projections_;
+    }
+
+    /**
+     * @brief Instructions retired in each interval; all but the last equal the interval length.
+     */
+    [[nodiscard]] const std::vector<uint64_t> &GetIntervalSizes() const {
+        return interval_sizes_;
+    }
+
+  private:
+    uint64_t interval_;
+    unsigned int dimensions_;
+    std::ostream &output_;
+    std::mt19937_64 random_;
+
+    std::unordered_map<uint64_t, uint32_t> block_ids_; ///< Entry pc to block number
+    std::vector<std::vector<double>> block_projections_; ///< Random row of each block
+    std::unordered_map<uint32_t, uint64_t> counts_; ///< Block number to instructions, this interval
+
+    bool in_block_ = false;
+    uint64_t block_start_ = 0;
+    uint64_t block_instructions_ = 0;
+    uint64_t interval_instructions_ = 0;
+
+    std::vector<std::vector<double>> projections_;
+    std::vector<uint64_t> interval_sizes_;
+
+    void EndBlock();
+    void EndInterval();
+};
+
+/**
+ * @brief Representative intervals chosen by SelectSimPoints().
+ */
+struct Selection {
+    std::vector<size_t> labels;        ///< Cluster of each interval
+    std::vector<size_t> simpoints;     ///< Representative interval of each cluster
+    std::vector<double> weights;       ///< Share of the run's instructions in each cluster
+};
+
+/**
+ * @brief Clusters projected basic block vectors with k-means and picks one interval per cluster.
+ *
+ * k-means (k-means++ seeding, several restarts) is run for every k up to max_clusters and each
+ * clustering is scored with the Bayesian Information Criterion; as in SimPoint, the smallest k
+ * scoring at least 90% of the way from the worst to the best score is kept. Each cluster is
+ * represented by the interval closest to its centroid and weighted by the instructions of its
+ * intervals.
+ *
+ * @param points One projected vector per interval.
+ * @param sizes Instructions retired in each interval.
+ * @param max_clusters Largest k tried.
+ * @param seed Seed of the k-means initialisation, for repeatable results.
+ */
+Selection SelectSimPoints(const std::vector<std::vector<double>> &points, const std::vector<uint64_t> &sizes,
+                          size_t max_clusters, uint64_t seed);
+
+} // namespace simpoint
+
+#endif // SIMPOINT_H
@@ -14,6 +14,7 @@
 
 #include <string>
 #include <filesystem>
+#include <iostream>
 
 void setupVmStateDirectory();
 
@@ -45,6 +46,15 @@ std::string GetLineFromFile(const std::string &fileName, unsigned int lineNumber
  */
 std::string ParseEscapedString(const std::string &input);
 
+/**
+ * @brief Quotes a string for a JSON document, escaping what JSON requires.
+ *
+ * @param text The string to quote.
+ * @return The JSON string literal, quotes included.
+ */
+std::string JsonString(const std::string &text);
+
+// The Dump functions write nothing when filename is empty, see globals::setStateDirectory()
 void DumpErrors(const std::filesystem::path &filename, const std::vector<ParseError> &errors);
 
 void DumpNoErrors(const std::filesystem::path &filename);
@@ -53,6 +63,28 @@ void DumpRegisters(const std::filesystem::path &filename, RegisterFile &register
 
 void DumpDisasssembly(const std::filesystem::path &filename, AssembledProgram &program);
 
+void WriteDisassembly(std::ostream &out, AssembledProgram &program);
+
 void SetupConfigFile();
 
+/**
+ * @brief Discards what is written to std::cout while it lives.
+ *
+ * The VMs log every step. Drivers that run a program without a console (--sample, --multicore)
+ * and reverse execution, which re-executes steps already shown, keep that off the console.
+ */
+class ConsoleMute {
+  public:
+    ConsoleMute() : console_(std::cout.rdbuf(nullptr)) {}
+    ~ConsoleMute() {
+        std::cout.rdbuf(console_);
+        std::cout.clear();
+    }
+    ConsoleMute(const ConsoleMute &) = delete;
+    ConsoleMute &operator=(const ConsoleMute &) = delete;
+
+  private:
+    std::streambuf *console_;
+};
+
 #endif // UTILS_H
@@ -0,0 +1,281 @@
+/**
+ * @file branch_predictor.h
+ * @brief Dynamic branch direction predictors built on fixed-size, power-of-two tables
+ */
+#ifndef BRANCH_PREDICTOR_H
+#define BRANCH_PREDICTOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace branch_predictor {
+
+enum class PredictorKind {
+  OneBit,     ///< Last outcome per PC, cold entries fall back to backward-taken/forward-not-taken
+  Bimodal,    ///< 2-bit saturating counters indexed by PC
+  Gshare,     ///< 2-bit saturating counters indexed by PC xor global history
+  Tournament, ///< Bimodal and gshare components arbitrated by a 2-bit chooser table
+  Tage,       ///< Bimodal base plus tagged tables indexed with geometric history lengths
+};
+
+struct BranchPredictorConfig {
+  uint64_t one_bit_table_size = 1024;  ///< Entries in the 1-bit history table
+  uint64_t bimodal_table_size = 1024;  ///< Entries in the bimodal counter table
+  uint64_t gshare_table_size = 4096;   ///< Entries in the gshare counter table
+  uint64_t gshare_history_bits = 12;   ///< Length of the global history register
+  uint64_t chooser_table_size = 1024;  ///< Entries in the tournament chooser table
+  uint64_t tage_table_size = 1024;     ///< Entries in each TAGE tagged table
+  uint64_t tage_num_tables = 4;        ///< Number of TAGE tagged tables
+  uint64_t tage_min_history = 4;       ///< History length of the shortest TAGE table
+  uint64_t tage_max_history = 64;      ///< History length of the longest TAGE table
+
+  bool operator==(const BranchPredictorConfig &) const = default;
+};
+
+struct PredictorStats {
+  uint64_t predictions = 0; ///< Conditional branches the predictor was consulted for
+  uint64_t correct = 0;     ///< Predictions that matched the resolved direction
+};
+
+/**
+ * @brief One table entry or history register change made while training a predictor.
+ *
+ * Recorded so the pipeline's undo/redo can rewind predictor state exactly.
+ */
+struct StateWrite {
+  uint8_t predictor = 0;  ///< Index of the predictor inside the BranchPredictorUnit
+  uint8_t table = 0;      ///< Table number, or kHistoryTable for the history register
+  uint32_t index = 0;     ///< Entry index within the table
+  uint64_t old_value = 0;
+  uint64_t new_value = 0;
+};
+
+constexpr uint8_t kHistoryTable = 0xFF;
+
+/**
+ * @brief Everything a single branch resolution changed in the predictor unit.
+ */
+struct ResolveRecord {
+  bool occurred = false;
+  uint64_t correct_mask = 0;     ///< Bit i set if predictor i predicted correctly
+  std::vector<StateWrite> writes;
+};
+
+/**
+ * @brief Base class for all direction predictors.
+ *
+ * State is kept in plain tables of small counters plus one history register so
+ * that every write can be journaled in a ResolveRecord.
+ */
+class BranchPredictor {
+  public:
+    explicit BranchPredictor(PredictorKind kind);
+    virtual ~BranchPredictor() = default;
+
+    virtual bool Predict(uint64_t pc, uint64_t target) const = 0;
+    virtual void Update(uint64_t pc, uint64_t target, bool taken) = 0;
+
+    void Reset();
+
+    PredictorKind GetKind() const {
+      return kind_;
+    }
+
+    const std::string &GetName() const {
+      return name_;
+    }
+
+    PredictorStats &GetStats() {
+      return stats_;
+    }
+
+    const PredictorStats &GetStats() const {
+      return stats_;
+    }
+
+    void SetJournal(std::vector<StateWrite> *journal, uint8_t id) {
+      journal_ = journal;
+      id_ = id;
+    }
+
+    void ApplyWrite(const StateWrite &write, bool undo);
+
+    /**
+     * @brief Table contents, history register and statistics, for VM snapshots.
+     */
+    struct State {
+      std::vector<std::vector<uint16_t>> tables;
+      uint64_t history = 0;
+      PredictorStats stats;
+    };
+
+    State SaveState() const;
+    void RestoreState(const State &state);
+
+  protected:
+    void AddTable(uint64_t size, uint16_t initial_value);
+    void Write(uint8_t table, uint64_t index, uint16_t value);
+    void WriteHistory(uint64_t value);
+
+    std::vector<std::vector<uint16_t>> tables_; ///< Counter tables, sizes are powers of two
+    std::vector<uint16_t> initial_values_;      ///< Reset value for each table
+    uint64_t history_ = 0;                      ///< Global history register, newest outcome in bit 0
+
+  private:
+    PredictorKind kind_;
+    std::string name_;
+    PredictorStats stats_;
+    std::vector<StateWrite> *journal_ = nullptr;
+    uint8_t id_ = 0;
+};
+
+class OneBitPredictor : public BranchPredictor {
+  public:
+    explicit OneBitPredictor(uint64_t table_size);
+    bool Predict(uint64_t pc, uint64_t target) const override;
+    void Update(uint64_t pc, uint64_t target, bool taken) override;
+
+  private:
+    uint64_t mask_;
+};
+
+class BimodalPredictor : public BranchPredictor {
+  public:
+    explicit BimodalPredictor(uint64_t table_size);
+    bool Predict(uint64_t pc, uint64_t target) const override;
+    void Update(uint64_t pc, uint64_t target, bool taken) override;
+
+  private:
+    uint64_t mask_;
+};
+
+class GsharePredictor : public BranchPredictor {
+  public:
+    GsharePredictor(uint64_t table_size, uint64_t history_bits);
+    bool Predict(uint64_t pc, uint64_t target) const override;
+    void Update(uint64_t pc, uint64_t target, bool taken) override;
+
+  private:
+    uint64_t mask_;
+    uint64_t history_mask_;
+};
+
+class TournamentPredictor : public BranchPredictor {
+  public:
+    TournamentPredictor(uint64_t bimodal_size, uint64_t gshare_size, uint64_t history_bits, uint64_t chooser_size);
+    bool Predict(uint64_t pc, uint64_t target) const override;
+    void Update(uint64_t pc, uint64_t target, bool taken) override;
+
+  private:
+    enum Table : uint8_t { kBimodal = 0, kGshare = 1, kChooser = 2 };
+
+    uint64_t bimodal_mask_;
+    uint64_t gshare_mask_;
+    uint64_t history_mask_;
+    uint64_t chooser_mask_;
+
+    bool PredictBimodal(uint64_t pc) const;
+    bool PredictGshare(uint64_t pc) const;
+};
+
+/**
+ * @brief TAGE-lite: a bimodal base predictor backed by tagged tables whose
+ * history lengths form a geometric series.
+ *
+ * Each tagged entry packs a valid bit, a 9-bit partial tag, a 2-bit useful
+ * counter and a 3-bit prediction counter into one table word, so updates go
+ * through the same journaled writes as the other predictors. The longest
+ * matching table provides the prediction; a misprediction allocates an entry
+ * in a longer table. The statistical corrector and loop predictor of full
+ * TAGE-SC-L are left out.
+ */
+class TagePredictor : public BranchPredictor {
+  public:
+    TagePredictor(uint64_t base_size, uint64_t table_size, uint64_t num_tables,
+                  uint64_t min_history, uint64_t max_history);
+    bool Predict(uint64_t pc, uint64_t target) const override;
+    void Update(uint64_t pc, uint64_t target, bool taken) override;
+
+    const std::vector<uint64_t> &GetHistoryLengths() const {
+      return history_lengths_;
+    }
+
+  private:
+    struct Lookup {
+      int provider = -1;  ///< Longest matching tagged table, -1 if none
+      int alternate = -1; ///< Next longest matching tagged table, -1 if none
+      bool prediction = false;
+      bool alternate_prediction = false;
+    };
+
+    uint64_t base_mask_;
+    uint64_t index_bits_;
+    uint64_t index_mask_;
+    uint64_t history_mask_;
+    std::vector<uint64_t> history_lengths_; ///< Per tagged table, shortest first
+
+    uint64_t Index(size_t table, uint64_t pc) const;
+    uint16_t Tag(size_t table, uint64_t pc) const;
+    Lookup Find(uint64_t pc) const;
+};
+
+/**
+ * @brief Owns every predictor design and trains all of them on each resolved branch.
+ *
+ * The pipeline asks the configured predictor for a direction in fetch; the rest
+ * run in shadow so their accuracy on the same branch stream can be compared in
+ * a single run.
+ */
+class BranchPredictorUnit {
+  public:
+    BranchPredictorUnit() = default;
+    ~BranchPredictorUnit() = default;
+
+    void Initialize(const BranchPredictorConfig &config);
+    void Reset();
+
+    bool Predict(PredictorKind kind, uint64_t pc, uint64_t target) const;
+    ResolveRecord Resolve(uint64_t pc, uint64_t target, bool taken);
+
+    // Same training and statistics as Resolve without journaling, for trace replay
+    void Train(uint64_t pc, uint64_t target, bool taken);
+
+    void Rollback(const ResolveRecord &record);
+    void Replay(const ResolveRecord &record);
+
+    /**
+     * @brief The configuration and the state of every predictor, for VM snapshots.
+     */
+    struct State {
+      BranchPredictorConfig config;
+      std::vector<BranchPredictor::State> predictors;
+    };
+
+    State SaveState() const;
+    // Rebuilds the predictors first if they were reconfigured since the state was saved
+    void RestoreState(const State &state);
+
+    const std::vector<std::unique_ptr<BranchPredictor>> &GetPredictors() const {
+      return predictors_;
+    }
+
+    BranchPredictorConfig GetConfig() const {
+      return config_;
+    }
+
+  private:
+    BranchPredictorConfig config_;
+    std::vector<std::unique_ptr<BranchPredictor>> predictors_;
+};
+
+std::string PredictorKindToString(PredictorKind kind);
+
+inline bool IsPowerOfTwo(uint64_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+} // namespace branch_predictor
+
+#endif // BRANCH_PREDICTOR_H
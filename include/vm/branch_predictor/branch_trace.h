@@ -0,0 +1,54 @@
+/**
+ * @file branch_trace.h
+ * @brief Recorded conditional branch streams and their replay through the predictor unit
+ */
+#ifndef BRANCH_TRACE_H
+#define BRANCH_TRACE_H
+
+#include "vm/branch_predictor/branch_predictor.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace branch_predictor {
+
+struct BranchRecord {
+  uint64_t pc = 0;
+  uint64_t target = 0; ///< Taken target, recorded even when the branch falls through
+  bool taken = false;
+};
+
+struct BranchTrace {
+  std::string name;          ///< Program the trace was recorded from
+  uint64_t instructions = 0; ///< Instructions executed while recording, for MPKI
+  std::vector<BranchRecord> branches;
+};
+
+struct ReplayResult {
+  std::string predictor;
+  uint64_t branches = 0;
+  uint64_t mispredictions = 0;
+  double mpki = 0.0; ///< Mispredictions per thousand instructions
+};
+
+/**
+ * @brief Writes a trace as text: a header line, then "pc taken target" in hex per branch.
+ */
+void WriteBranchTrace(const std::filesystem::path &path, const BranchTrace &trace);
+
+/**
+ * @brief Reads a trace written by WriteBranchTrace.
+ * @throws std::runtime_error if the file cannot be opened or is malformed.
+ */
+BranchTrace ReadBranchTrace(const std::filesystem::path &path);
+
+/**
+ * @brief Trains a fresh predictor unit on the trace and reports every predictor's MPKI.
+ */
+std::vector<ReplayResult> ReplayBranchTrace(const BranchTrace &trace, const BranchPredictorConfig &config);
+
+} // namespace branch_predictor
+
+#endif // BRANCH_TRACE_H
@@ -0,0 +1,181 @@
+/**
+ * @file target_predictor.h
+ * @brief Set-associative branch target buffer and return address stack used by the fetch stage
+ */
+#ifndef TARGET_PREDICTOR_H
+#define TARGET_PREDICTOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace branch_predictor {
+
+struct TargetPredictorConfig {
+  bool btb_enabled = true;        ///< Predict jalr targets from the branch target buffer
+  uint64_t btb_entries = 64;      ///< Total BTB entries, power of two
+  uint64_t btb_associativity = 4; ///< Ways per BTB set, power of two, at most btb_entries
+  bool ras_enabled = true;        ///< Predict return targets from the return address stack
+  uint64_t ras_size = 16;         ///< Return address stack depth
+};
+
+struct TargetPredictorStats {
+  uint64_t btb_lookups = 0;  ///< Indirect jumps fetched with the BTB consulted
+  uint64_t btb_hits = 0;     ///< BTB lookups that supplied the correct target
+  uint64_t ras_lookups = 0;  ///< Returns fetched with a non-empty return address stack
+  uint64_t ras_hits = 0;     ///< RAS predictions that supplied the correct target
+  uint64_t cycles_saved = 0; ///< Flush cycles avoided by correct target predictions
+};
+
+/**
+ * @brief Which structure supplied the target the fetch stage redirected to.
+ */
+enum class TargetSource : uint8_t {
+  None, ///< No target prediction, fetch falls through to pc + 4
+  Btb,
+  Ras,
+};
+
+struct BtbEntry {
+  bool valid = false;
+  uint64_t tag = 0;
+  uint64_t target = 0;
+  uint64_t last_used = 0; ///< LRU timestamp within the set
+};
+
+/**
+ * @brief Everything a single jump resolution changed in the target predictor.
+ *
+ * A resolution touches at most one BTB slot and one RAS slot, so the old and
+ * new values are enough for the pipeline's undo/redo to rewind it exactly.
+ */
+struct TargetUpdateRecord {
+  bool occurred = false;
+
+  bool btb_written = false;
+  uint32_t btb_slot = 0;
+  BtbEntry old_btb_entry;
+  BtbEntry new_btb_entry;
+  uint64_t old_btb_clock = 0;
+  uint64_t new_btb_clock = 0;
+
+  bool ras_slot_written = false;
+  uint32_t ras_slot = 0;
+  uint64_t old_ras_value = 0;
+  uint64_t new_ras_value = 0;
+  uint32_t old_ras_top = 0;
+  uint32_t new_ras_top = 0;
+  uint32_t old_ras_count = 0;
+  uint32_t new_ras_count = 0;
+
+  TargetPredictorStats old_stats;
+  TargetPredictorStats new_stats;
+};
+
+/**
+ * @brief Set-associative BTB with LRU replacement, tagged by the full PC.
+ */
+class BranchTargetBuffer {
+  public:
+    void Initialize(uint64_t entries, uint64_t associativity);
+    void Reset();
+
+    bool Lookup(uint64_t pc, uint64_t &target) const;
+
+    // Installs or refreshes the entry for pc, journaling the change into record
+    void Update(uint64_t pc, uint64_t target, TargetUpdateRecord &record);
+
+    void RestoreSlot(uint32_t slot, const BtbEntry &entry, uint64_t clock);
+
+  private:
+    std::vector<BtbEntry> entries_; ///< sets_ * ways_ entries, set-major
+    uint64_t sets_ = 0;
+    uint64_t ways_ = 0;
+    uint64_t clock_ = 0;            ///< Monotonic counter used as the LRU timestamp
+};
+
+/**
+ * @brief Circular return address stack; overflowing pushes overwrite the oldest entry.
+ */
+class ReturnAddressStack {
+  public:
+    void Initialize(uint64_t size);
+    void Reset();
+
+    bool Peek(uint64_t &address) const;
+    void Push(uint64_t address, TargetUpdateRecord &record);
+    void Pop();
+
+    uint32_t GetTop() const {
+      return top_;
+    }
+
+    uint32_t GetCount() const {
+      return count_;
+    }
+
+    void Restore(uint32_t top, uint32_t count);
+    void RestoreSlot(uint32_t slot, uint64_t value);
+
+  private:
+    std::vector<uint64_t> entries_;
+    uint32_t top_ = 0;   ///< Slot the next push writes to
+    uint32_t count_ = 0; ///< Valid entries, saturates at the stack size
+};
+
+/**
+ * @brief Supplies jump targets to the fetch stage.
+ *
+ * Direct targets (jal, conditional branches) are computed from the fetched
+ * instruction word, so only jalr needs a prediction: returns are served by the
+ * RAS and other indirect jumps by the BTB. Both structures are trained when the
+ * jump resolves in decode, which keeps them free of wrong-path updates.
+ */
+class TargetPredictor {
+  public:
+    void Initialize(const TargetPredictorConfig &config);
+    void Reset();
+
+    TargetSource Predict(uint64_t pc, bool is_return, uint64_t &target) const;
+
+    /**
+     * @brief Trains the BTB/RAS with a resolved jal or jalr and records hit statistics.
+     * @param flush_penalty Cycles a target misprediction costs the pipeline.
+     */
+    TargetUpdateRecord Resolve(uint64_t pc, uint64_t target, bool is_jalr, uint8_t rd, uint8_t rs1,
+                               TargetSource source, uint64_t predicted_target, uint64_t flush_penalty);
+
+    void Rollback(const TargetUpdateRecord &record);
+    void Replay(const TargetUpdateRecord &record);
+
+    const TargetPredictorStats &GetStats() const {
+      return stats_;
+    }
+
+    TargetPredictorConfig GetConfig() const {
+      return config_;
+    }
+
+  private:
+    TargetPredictorConfig config_;
+    TargetPredictorStats stats_;
+    BranchTargetBuffer btb_;
+    ReturnAddressStack ras_;
+};
+
+// x1 (ra) and x5 (t0) are the link registers of the RISC-V calling convention
+inline bool IsLinkRegister(uint8_t reg) {
+  return reg == 1 || reg == 5;
+}
+
+// Return-address hints from the RISC-V spec: jalr with a link rs1 pops, unless rd == rs1
+inline bool IsReturn(bool is_jalr, uint8_t rd, uint8_t rs1) {
+  return is_jalr && IsLinkRegister(rs1) && !(IsLinkRegister(rd) && rd == rs1);
+}
+
+inline bool IsCall(uint8_t rd) {
+  return IsLinkRegister(rd);
+}
+
+} // namespace branch_predictor
+
+#endif // TARGET_PREDICTOR_H
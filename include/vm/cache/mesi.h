@@ -0,0 +1,121 @@
+/**
+ * @file mesi.h
+ * @brief Private L1 caches of several harts kept coherent with the MESI protocol
+ */
+#ifndef MESI_H
+#define MESI_H
+
+#include "cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace cache {
+
+enum class MesiState : uint8_t {
+  Invalid,
+  Shared,    ///< Clean, other L1s may hold it too
+  Exclusive, ///< Clean, no other L1 holds it
+  Modified   ///< Dirty, no other L1 holds it
+};
+
+/**
+ * @brief What one hart's L1 saw.
+ */
+struct L1Stats {
+  unsigned long accesses = 0;
+  unsigned long hits = 0;
+  unsigned long misses = 0;
+  unsigned long coherence_misses = 0; ///< Misses on lines another hart's write had invalidated here
+  unsigned long evictions = 0;
+  unsigned long upgrades = 0;         ///< Writes that hit a Shared line and had to invalidate the other copies
+  unsigned long invalidations = 0;    ///< Lines invalidated here by other harts' writes
+  unsigned long writebacks = 0;       ///< Modified lines written back, on eviction or when another hart asked for them
+};
+
+/**
+ * @brief Transactions on the shared bus.
+ */
+struct BusStats {
+  unsigned long bus_reads = 0;       ///< BusRd, for read misses
+  unsigned long bus_read_exclusives = 0; ///< BusRdX, for write misses
+  unsigned long bus_upgrades = 0;    ///< BusUpgr, for writes to Shared lines
+  unsigned long cache_to_cache = 0;  ///< Misses served by another L1 that held the line
+  unsigned long memory_fetches = 0;  ///< Misses served by memory
+  unsigned long invalidations = 0;   ///< Copies invalidated in other L1s
+};
+
+/**
+ * @brief Tag-only L1 caches, one per hart, on a snooping bus over one shared memory.
+ *
+ * Like Cache, this only tracks which lines are where; the data itself always lives in the
+ * shared Memory. Every access is broadcast the way a snooping MESI (Illinois) protocol would:
+ * a read miss issues BusRd and fills Exclusive if no other L1 has the line, Shared otherwise
+ * (a Modified or Exclusive copy elsewhere is downgraded to Shared, a Modified one being written
+ * back); a write miss issues BusRdX and a write to a Shared line BusUpgr, both invalidating every
+ * other copy. Caches are write-allocate with LRU replacement whatever the CacheConfig says.
+ *
+ * The lr/sc reservations of the harts are kept here as well, since a write by any hart to a
+ * reserved line must break the reservation.
+ */
+class MesiSystem {
+  public:
+    MesiSystem(unsigned int harts, const CacheConfig &config);
+
+    void Access(unsigned int hart, uint64_t address, bool is_write);
+
+    // Reservation of lr on the line holding address, replacing the hart's previous one
+    void Reserve(unsigned int hart, uint64_t address);
+    // Whether sc may store to address: the hart holds a reservation on its line that no other
+    // hart has written since. The reservation is dropped either way.
+    bool ConsumeReservation(unsigned int hart, uint64_t address);
+
+    [[nodiscard]] MesiState GetState(unsigned int hart, uint64_t address) const;
+
+    [[nodiscard]] unsigned int GetHartCount() const {
+      return static_cast<unsigned int>(caches_.size());
+    }
+
+    [[nodiscard]] const L1Stats &GetL1Stats(unsigned int hart) const {
+      return caches_[hart].stats;
+    }
+
+    [[nodiscard]] const BusStats &GetBusStats() const {
+      return bus_stats_;
+    }
+
+    [[nodiscard]] const CacheConfig &GetConfig() const {
+      return config_;
+    }
+
+  private:
+    struct Line {
+      uint64_t block = 0;     ///< Address divided by the block size
+      MesiState state = MesiState::Invalid;
+      bool invalidated = false; ///< Invalid because another hart wrote the line, not because it was never filled
+      uint64_t last_use = 0;
+    };
+
+    struct L1 {
+      std::vector<Line> lines; ///< Set after set, associativity lines each
+      L1Stats stats;
+      std::optional<uint64_t> reservation; ///< Block reserved by lr
+    };
+
+    CacheConfig config_;
+    unsigned long num_sets_ = 1;
+    uint64_t clock_ = 0; ///< Orders accesses for LRU
+    std::vector<L1> caches_;
+    BusStats bus_stats_;
+
+    Line *Find(unsigned int hart, uint64_t block);
+    const Line *Find(unsigned int hart, uint64_t block) const;
+    // Picks the line a miss fills: an invalid one if the set has one, else the least recently used
+    Line &Victim(unsigned int hart, uint64_t block);
+    void InvalidateOthers(unsigned int hart, uint64_t block);
+};
+
+} // namespace cache
+
+#endif // MESI_H
@@ -7,37 +7,45 @@
 #ifndef MAIN_MEMORY_H
 #define MAIN_MEMORY_H
 
-#include "config.h"
-
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <stdexcept>
+#include <algorithm>
 
 /**
  * @brief Represents a memory block containing 1 KB of memory.
  */
 struct MemoryBlock {
   std::vector<uint8_t> data; ///< A vector representing the memory block data.
-  unsigned int block_size = vm_config::config.getMemoryBlockSize(); ///< The size of the memory block in bytes.
+  unsigned int block_size; ///< The size of the memory block in bytes.
 
   /**
-   * @brief Constructs a MemoryBlock with a size of 1 KB initialized to 0.
+   * @brief Constructs a MemoryBlock of the given size initialized to 0.
+   * @param size The size of the block in bytes, the Memory's block size.
    */
-  MemoryBlock() {
+  explicit MemoryBlock(unsigned int size) : block_size(size) {
     data.resize(block_size, 0);
   }
 };
 
 /**
  * @brief Represents a memory management system with dynamic memory block allocation.
+ *
+ * Blocks are reference counted so that snapshots can share them: a block is copied before it is
+ * written only while a snapshot still holds it.
  */
 class Memory {
+ public:
+  /// The blocks present at one point, shared with the Memory they were taken from.
+  using Image = std::unordered_map<uint64_t, std::shared_ptr<MemoryBlock>>;
+
  private:
-  std::unordered_map<uint64_t, MemoryBlock> blocks_; ///< A map storing memory blocks, indexed by block index.
+  Image blocks_; ///< A map storing memory blocks, indexed by block index.
   unsigned int block_size_; ///< The size of each memory block in bytes.
-  uint64_t memory_size_ = vm_config::config.getMemorySize(); ///< The total memory size in bytes.
+  uint64_t memory_size_; ///< The total memory size in bytes.
 
   /**
    * @brief Gets the block index for a given memory address.
@@ -62,9 +70,12 @@ class Memory {
 
   /**
    * @brief Ensures that a memory block exists at the specified index, if not then adds it.
+   *
+   * A block still shared with a snapshot is copied first, so the result can be written.
    * @param block_index The index of the block to check or create.
+   * @return The block.
    */
-  void EnsureBlockExists(uint64_t block_index);
+  MemoryBlock &EnsureBlockExists(uint64_t block_index);
 
   /**
    * @brief Generic function to read data of type T from the memory.
@@ -87,10 +98,12 @@ class Memory {
  public:
   /**
    * @brief Constructs a Memory object.
+   *
+   * Both sizes are fixed for the lifetime of the object, so blocks allocated at any point agree.
+   * @param memory_size The total memory size in bytes.
+   * @param block_size The size of each memory block in bytes.
    */
-  Memory() {
-    block_size_ = vm_config::config.getMemoryBlockSize();
-  }
+  Memory(uint64_t memory_size, unsigned int block_size) : block_size_(block_size), memory_size_(memory_size) {}
   /**
    * @brief Destroys the Memory object.
    */
@@ -100,6 +113,25 @@ class Memory {
     blocks_.clear();
   }
 
+  /**
+   * @brief Captures the current contents without copying any block.
+   *
+   * The image holds a reference to every present block; later writes to either side copy the
+   * affected block, so the cost of a snapshot is paid by the blocks written after it.
+   * @return The blocks present now.
+   */
+  Image Snapshot() const {
+    return blocks_;
+  }
+
+  /**
+   * @brief Returns to contents captured by Snapshot(), again without copying any block.
+   * @param image The blocks to present.
+   */
+  void Restore(const Image &image) {
+    blocks_ = image;
+  }
+
   /**
    * @brief Reads a single byte from the given memory address.
    * @param address The memory address to read from.
@@ -178,6 +210,55 @@ class Memory {
 
   void WriteDouble(uint64_t address, double value);
 
+  /**
+   * @brief Copies a contiguous range of bytes into memory, one block at a time.
+   *
+   * Blocks that are not present and would only receive zeros are left unallocated, since
+   * they already read as zero.
+   * @param address The memory address of the first byte.
+   * @param bytes The bytes to copy.
+   * @param size The number of bytes.
+   */
+  void LoadSegment(uint64_t address, const uint8_t *bytes, size_t size);
+
+  /**
+   * @brief Sets a contiguous range of memory to zero.
+   *
+   * Blocks the range covers entirely are dropped, since an absent block reads as zero; only
+   * the partly covered blocks at either end are written.
+   * @param address The memory address of the first byte.
+   * @param size The number of bytes.
+   */
+  void ClearSegment(uint64_t address, uint64_t size);
+
+  /**
+   * @brief Copies a contiguous range of memory out, one block at a time.
+   * @param address The memory address of the first byte.
+   * @param bytes Where the bytes go.
+   * @param size The number of bytes.
+   */
+  void ReadSegment(uint64_t address, uint8_t *bytes, size_t size) const;
+
+  /**
+   * @brief Hands a range of memory to visit as the contiguous host spans it is stored in.
+   *
+   * visit(const uint8_t *data, size_t size) is called once per block the range touches, in
+   * address order, with a pointer into the block itself; ranges without a block come from a
+   * static page of zeros. The pointers are valid until the memory is next written.
+   * @param address The memory address of the first byte.
+   * @param size The number of bytes.
+   * @param visit Called for each span.
+   */
+  template<typename Visit>
+  void VisitSegment(uint64_t address, size_t size, Visit &&visit) const;
+
+  /**
+   * @brief Gets the length of the NUL-terminated string at address, searching a block at a time.
+   * @param address The memory address of the first character.
+   * @return The number of bytes before the NUL.
+   */
+  uint64_t StringLength(uint64_t address) const;
+
   void PrintMemory(uint64_t address, unsigned int rows);
 
   void DumpMemory(std::vector<std::string> args);
@@ -187,4 +268,27 @@ class Memory {
   void printMemoryUsage() const;
 };
 
+template<typename Visit>
+void Memory::VisitSegment(uint64_t address, size_t size, Visit &&visit) const {
+  static constexpr uint8_t kZeros[4096] = {};
+  if (size==0) {
+    return;
+  }
+  if (address >= memory_size_ || size > memory_size_ - address) {
+    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address + size - 1));
+  }
+  while (size > 0) {
+    size_t chunk = std::min<size_t>(size, block_size_ - GetBlockOffset(address));
+    auto block = blocks_.find(GetBlockIndex(address));
+    if (block!=blocks_.end()) {
+      visit(block->second->data.data() + GetBlockOffset(address), chunk);
+    } else {
+      chunk = std::min(chunk, sizeof(kZeros));
+      visit(kZeros, chunk);
+    }
+    address += chunk;
+    size -= chunk;
+  }
+}
+
 #endif // MAIN_MEMORY_H
@@ -10,36 +10,149 @@
 #include "../config.h"
 #include "main_memory.h"
 #include "cache/cache.h"
+#include "cache/mesi.h"
 
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 
+/**
+ * @brief One load or store as a MemoryController logs it, see MemoryController::LogAccesses().
+ */
+struct MemoryAccess {
+    uint64_t address = 0;
+    uint64_t value = 0;   ///< Value stored, for writes; rs2 for the write of an AMO
+    uint8_t size = 0;     ///< Bytes stored, for writes
+    bool is_write = false;
+    uint32_t atomic = 0;  ///< The AMO whose write this is, for whoever merges the log to redo it
+    bool merged = false;  ///< The write already reached the memory the log is merged into
+};
+
 /**
  * @brief The MemoryController class is responsible for managing memory in the VM.
  */
 class MemoryController {
 private:
-    Memory memory_; ///< The main memory object.
+    std::shared_ptr<Memory> memory_; ///< The main memory object, shared by the harts of a multicore system.
     cache::Cache cache_; ///< The cache object.
+    cache::MesiSystem *coherence_ = nullptr; ///< When set, accesses go to this hart's L1 in it instead of cache_
+    unsigned int hart_ = 0;
+    std::optional<uint64_t> reservation_; ///< Address reserved by lr, without a coherence system
+    std::vector<MemoryAccess> *access_log_ = nullptr; ///< When set, accesses are appended here instead of going to a cache
 
     void Probe(uint64_t address, bool is_write) {
+        if (access_log_) {
+            access_log_->push_back({address, 0, 0, is_write, 0, false});
+            return;
+        }
+        if (coherence_) {
+            coherence_->Access(hart_, address, is_write);
+            return;
+        }
         cache_.Access(address, is_write);
     }
+
+    void LogStore(uint64_t value, uint8_t size) {
+        if (access_log_) {
+            access_log_->back().value = value;
+            access_log_->back().size = size;
+        }
+    }
 public:
-    MemoryController() = default;
+    // Memory sized by the [Memory] section of config
+    explicit MemoryController(const vm_config::VmConfig &config)
+        : memory_(std::make_shared<Memory>(config.getMemorySize(), config.getMemoryBlockSize())) {}
+    MemoryController() : MemoryController(vm_config::current()) {}
+
+    // Makes this controller use the memory of another, so that both see every write at once
+    void ShareMemory(const MemoryController &other) {
+        memory_ = other.memory_;
+    }
+
+    // Replaces the contents of this controller's memory with those of another's, sharing the
+    // blocks copy-on-write; unlike ShareMemory(), later writes on either side stay private
+    void CopyMemoryFrom(const MemoryController &other) {
+        memory_->Restore(other.memory_->Snapshot());
+    }
+
+    // Logs every access, with the values stored, instead of probing the cache or L1. A hart
+    // whose memory is a private copy uses this so its stores can be merged into the shared
+    // memory, and its accesses replayed through the coherence model, later.
+    void LogAccesses(std::vector<MemoryAccess> *log) {
+        access_log_ = log;
+    }
+
+    // Routes accesses through a hart's private L1 in a coherent multicore system
+    void AttachCoherence(cache::MesiSystem *system, unsigned int hart) {
+        coherence_ = system;
+        hart_ = hart;
+    }
+
+    // Reservation of lr.w/lr.d
+    void Reserve(uint64_t address) {
+        if (coherence_) {
+            coherence_->Reserve(hart_, address);
+            return;
+        }
+        reservation_ = address;
+    }
+
+    // Drops the reservation if it lies in the same granule-byte block as address, as another
+    // hart's write there does
+    void BreakReservation(uint64_t address, uint64_t granule) {
+        if (reservation_ && *reservation_ / granule == address / granule) {
+            reservation_.reset();
+        }
+    }
+
+    // Whether sc.w/sc.d on address may store; drops the reservation either way
+    bool ConsumeReservation(uint64_t address) {
+        if (coherence_) {
+            return coherence_->ConsumeReservation(hart_, address);
+        }
+        const bool held = reservation_ == address;
+        reservation_.reset();
+        return held;
+    }
 
     void Init(const cache::CacheConfig& config) {
       cache_.Initialize(config);
     }
 
     void Reset() {
-        memory_.Reset();
+        memory_->Reset();
         cache_.Reset();
+        reservation_.reset();
+    }
+
+    /**
+     * @brief Memory contents and cache state at one point, see Snapshot().
+     */
+    struct State {
+        Memory::Image memory; ///< Blocks shared with the memory until either side writes them
+        cache::Cache cache;   ///< Tags, replacement order and statistics
+        std::optional<uint64_t> reservation;
+    };
+
+    // Captures memory copy-on-write and the cache by value
+    State Snapshot() const {
+        return {memory_->Snapshot(), cache_, reservation_};
+    }
+
+    void Restore(const State &state) {
+        memory_->Restore(state.memory);
+        cache_ = state.cache;
+        reservation_ = state.reservation;
     }
 
     cache::CacheStats GetCacheStats() const {
+      if (coherence_) {
+        const cache::L1Stats &l1 = coherence_->GetL1Stats(hart_);
+        return {l1.accesses, l1.hits, l1.misses, l1.evictions};
+      }
       return cache_.GetStats();
     }
 
@@ -58,89 +171,135 @@ public:
 
     void WriteByte(uint64_t address, uint8_t value) {
       Probe(address, true);
-      memory_.WriteByte(address, value);
+      memory_->WriteByte(address, value);
+      LogStore(value, 1);
     }
 
     void WriteHalfWord(uint64_t address, uint16_t value) {
       Probe(address, true);
-      memory_.WriteHalfWord(address, value);
+      memory_->WriteHalfWord(address, value);
+      LogStore(value, 2);
     }
 
     void WriteWord(uint64_t address, uint32_t value) {
       Probe(address, true);
-      memory_.WriteWord(address, value);
+      memory_->WriteWord(address, value);
+      LogStore(value, 4);
     }
 
     void WriteDoubleWord(uint64_t address, uint64_t value) {
       Probe(address, true);
-      memory_.WriteDoubleWord(address, value);
+      memory_->WriteDoubleWord(address, value);
+      LogStore(value, 8);
     }
 
     // Write functions bypassing cache
     void WriteByte_d(uint64_t address, uint8_t value) {
-        memory_.WriteByte(address, value);
+        memory_->WriteByte(address, value);
     }
 
     void WriteHalfWord_d(uint64_t address, uint16_t value) {
-        memory_.WriteHalfWord(address, value);
+        memory_->WriteHalfWord(address, value);
     }
 
     void WriteWord_d(uint64_t address, uint32_t value) {
-        memory_.WriteWord(address, value);
+        memory_->WriteWord(address, value);
     }
 
     void WriteDoubleWord_d(uint64_t address, uint64_t value) {
-        memory_.WriteDoubleWord(address, value);
+        memory_->WriteDoubleWord(address, value);
+    }
+
+    void LoadSegment_d(uint64_t address, const uint8_t *bytes, size_t size) {
+        memory_->LoadSegment(address, bytes, size);
+    }
+
+    // Bulk transfers for syscalls, bypassing the cache the way a device would. Stores are
+    // still logged byte by byte when accesses are, so they reach the shared memory
+    void StoreSegment_d(uint64_t address, const uint8_t *bytes, size_t size) {
+        if (access_log_) {
+            for (size_t i = 0; i < size; ++i) {
+                memory_->WriteByte(address + i, bytes[i]);
+                access_log_->push_back({address + i, bytes[i], 1, true, 0, false});
+            }
+            return;
+        }
+        memory_->LoadSegment(address, bytes, size);
+    }
+
+    // Zeroes a range, as a fresh anonymous mapping reads; logged like StoreSegment_d()
+    void ClearSegment_d(uint64_t address, uint64_t size) {
+        if (access_log_) {
+            for (uint64_t i = 0; i < size; ++i) {
+                memory_->WriteByte(address + i, 0);
+                access_log_->push_back({address + i, 0, 1, true, 0, false});
+            }
+            return;
+        }
+        memory_->ClearSegment(address, size);
+    }
+
+    void ReadSegment_d(uint64_t address, uint8_t *bytes, size_t size) const {
+        memory_->ReadSegment(address, bytes, size);
+    }
+
+    template<typename Visit>
+    void VisitSegment_d(uint64_t address, size_t size, Visit &&visit) const {
+        memory_->VisitSegment(address, size, std::forward<Visit>(visit));
+    }
+
+    [[nodiscard]] uint64_t StringLength_d(uint64_t address) const {
+        return memory_->StringLength(address);
     }
 
     [[nodiscard]] uint8_t ReadByte(uint64_t address) {
         Probe(address, false);
-        return memory_.ReadByte(address);
+        return memory_->ReadByte(address);
     }
 
     [[nodiscard]] uint16_t ReadHalfWord(uint64_t address) {
         Probe(address, false);
-        return memory_.ReadHalfWord(address);
+        return memory_->ReadHalfWord(address);
     }
 
     [[nodiscard]] uint32_t ReadWord(uint64_t address) {
         Probe(address, false);
-        return memory_.ReadWord(address);
+        return memory_->ReadWord(address);
     }
 
     [[nodiscard]] uint64_t ReadDoubleWord(uint64_t address) {
         Probe(address, false);
-        return memory_.ReadDoubleWord(address);
+        return memory_->ReadDoubleWord(address);
     }
 
     // Functions to read memory directly with cache bypass
 
     [[nodiscard]] uint8_t ReadByte_d(uint64_t address) {
-        return memory_.ReadByte(address);
+        return memory_->ReadByte(address);
     }
 
     [[nodiscard]] uint16_t ReadHalfWord_d(uint64_t address) {
-        return memory_.ReadHalfWord(address);
+        return memory_->ReadHalfWord(address);
     }
 
     [[nodiscard]] uint32_t ReadWord_d(uint64_t address) {
-        return memory_.ReadWord(address);
+        return memory_->ReadWord(address);
     }
 
     [[nodiscard]] uint64_t ReadDoubleWord_d(uint64_t address) {
-        return memory_.ReadDoubleWord(address);
+        return memory_->ReadDoubleWord(address);
     }
 
     void PrintMemory(const uint64_t address, unsigned int rows) {
-      memory_.PrintMemory(address, rows);
+      memory_->PrintMemory(address, rows);
     }
 
     void DumpMemory(std::vector<std::string> args) {
-      memory_.DumpMemory(args);
+      memory_->DumpMemory(args);
     }
 
     void GetMemoryPoint(std::string address) {
-      return memory_.GetMemoryPoint(address);
+      return memory_->GetMemoryPoint(address);
     }
 
 };
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include "vm/alu.h"
+#include "vm/branch_predictor/target_predictor.h"
 
 // --- IF/ID Register ---
 // Holds the output of the Fetch stage, needed by Decode.
@@ -14,6 +15,8 @@ struct IF_ID_Register {
 
     // Branch / Jump Prediction Signals
     bool predictedTaken = false; // Was the branch/jump predicted taken?
+    uint64_t predictedTarget = 0; // Where fetch was redirected when predictedTaken
+    branch_predictor::TargetSource targetSource = branch_predictor::TargetSource::None; // BTB/RAS that supplied a jalr target
 
     // Default constructor to initialize
     IF_ID_Register() : instruction(0x00000013), pc_plus_4(0), valid(false) {}
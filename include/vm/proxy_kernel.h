@@ -0,0 +1,165 @@
+/**
+ * @file proxy_kernel.h
+ * @brief Host side of the Linux syscalls a guest program makes: its files, heap and mappings
+ */
+#ifndef PROXY_KERNEL_H
+#define PROXY_KERNEL_H
+
+#include "memory_controller.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace proxy_kernel {
+
+/// Start of the anonymous mappings, which grow down from here; the 8 MiB above are the stack
+constexpr uint64_t kMmapTop = 0x7f800000;
+constexpr uint64_t kPageSize = 4096;
+constexpr int64_t kAtFdcwd = -100;
+
+constexpr uint64_t RoundUpToPage(uint64_t value) {
+    return (value + kPageSize - 1) & ~(kPageSize - 1);
+}
+
+/// struct stat as the riscv64 Linux ABI lays it out
+using GuestStat = std::array<uint8_t, 128>;
+/// struct timespec of the riscv64 Linux ABI
+using GuestTimespec = std::array<uint8_t, 16>;
+
+/**
+ * @brief A host descriptor the guest opened, closed when the last guest descriptor, snapshot
+ * or recorded reply holding it lets go, so going back can bring back a file closed since.
+ */
+class HostFile {
+public:
+    explicit HostFile(int fd) : fd_(fd) {}
+    ~HostFile();
+    HostFile(const HostFile &) = delete;
+    HostFile &operator=(const HostFile &) = delete;
+
+    int Descriptor() const {
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
+
+/// A guest descriptor. The offset is kept here rather than by the host descriptor, so that it
+/// is part of a snapshot and moves back with one
+struct GuestFile {
+    std::shared_ptr<const HostFile> host;
+    int64_t offset = 0;
+    bool append = false;
+};
+
+/// What the host answered one call, recorded so that re-executing the call gets the same answer
+struct HostReply {
+    int64_t result = 0;
+    std::vector<uint8_t> bytes;            ///< Data read, or the stat or time filled in
+    int64_t offset = 0;                    ///< Where an appending write left the file offset
+    std::shared_ptr<const HostFile> file;  ///< The file an openat opened
+};
+
+/**
+ * @brief Files, program break and anonymous mappings of one guest program.
+ *
+ * The guest sees the host's files only under one sandbox directory, which is its root and its
+ * working directory. Paths are resolved by the host kernel from a descriptor of that directory,
+ * and symlinks are refused, so no path or link can lead out of it. Guest file descriptors 0-2 are the VM's console and stay with the VM;
+ * every other one maps to a host descriptor opened here. Results follow the Linux convention:
+ * a negative errno on failure.
+ *
+ * Everything a call changes is in State, and every answer that comes from the host is recorded
+ * as a HostReply. Calls re-executed after going back to a State take the recorded replies in
+ * order instead of asking the host again, so they neither see a different answer nor open,
+ * truncate or write a host file a second time.
+ */
+class ProxyKernel {
+public:
+    ProxyKernel() = default;
+    ~ProxyKernel();
+    ProxyKernel(const ProxyKernel &) = delete;
+    ProxyKernel &operator=(const ProxyKernel &) = delete;
+
+    /// The guest's descriptors, break and mappings, see SaveState()
+    struct State {
+        std::map<int64_t, GuestFile> files;
+        uint64_t break_start = 0;
+        uint64_t program_break = 0;
+        std::map<uint64_t, uint64_t> mappings;
+        uint64_t mmap_bottom = kMmapTop;
+    };
+
+    // Host descriptors are shared with the state, so this copies no file
+    State SaveState() const;
+    void RestoreState(const State &state);
+
+    // Position in the recorded replies: the next call that asks the host takes the reply there,
+    // or asks the host and records its answer if there is none
+    size_t ReplyPosition() const {
+        return reply_position_;
+    }
+    void RewindReplies(size_t position) {
+        reply_position_ = position;
+    }
+    // Forgets the replies from the current position on, for a run that has left the recorded one
+    void TruncateReplies();
+    void ClearReplies();
+
+    // Closes the guest's files and starts the break at program_break, for a newly loaded program
+    void Reset(uint64_t program_break);
+
+    // openat(2) of a guest path inside sandbox; no file can be opened while sandbox is empty
+    int64_t OpenAt(const std::filesystem::path &sandbox, int64_t dirfd, const std::string &path,
+                   uint64_t flags, uint64_t mode);
+    int64_t Close(int64_t fd);
+    // read(2) into a host buffer, for descriptors opened by OpenAt()
+    int64_t Read(int64_t fd, uint8_t *buffer, uint64_t length);
+    // write(2) of length guest bytes at address, gathered straight from the memory blocks
+    int64_t Write(int64_t fd, const MemoryController &memory, uint64_t address, uint64_t length);
+    int64_t Seek(int64_t fd, int64_t offset, uint64_t whence);
+    int64_t Stat(int64_t fd, GuestStat &stat);
+
+    // brk(2): moves the break if address lies between its start and the mappings, and
+    // returns the break either way
+    uint64_t Brk(uint64_t address);
+    // mmap(2), anonymous private mappings only: picks the range, or takes address with
+    // MAP_FIXED, and leaves zeroing it to the caller, who owns the memory
+    int64_t Mmap(uint64_t address, uint64_t length, uint64_t prot, uint64_t flags, int64_t fd, uint64_t offset);
+    // munmap(2): gives the range back to later Mmap() calls
+    int64_t Munmap(uint64_t address, uint64_t length);
+
+    int64_t ClockGettime(uint64_t clock_id, GuestTimespec &time);
+
+private:
+    std::map<int64_t, GuestFile> files_; ///< Guest descriptors other than the console
+    uint64_t break_start_ = 0;
+    uint64_t break_ = 0;
+    std::map<uint64_t, uint64_t> mappings_; ///< Start to end of each mapped range, none overlapping
+    uint64_t mmap_bottom_ = kMmapTop; ///< Lowest mapped byte, which the break may not pass
+    int sandbox_root_ = -1; ///< Host descriptor of the sandbox directory, which every path resolves from
+    std::filesystem::path sandbox_path_; ///< The configured directory sandbox_root_ was opened for
+    std::vector<HostReply> replies_; ///< Every answer the host gave since the history started
+    size_t reply_position_ = 0;      ///< Next reply of replies_ a call gets
+
+    GuestFile *FindFile(int64_t fd);
+    // The recorded reply at the current position, or the one ask fills in from the host, recorded
+    template<typename Ask>
+    const HostReply &Reply(Ask ask);
+    // Descriptor of the sandbox directory, opened on first use and again whenever it changes
+    int SandboxRoot(const std::filesystem::path &sandbox);
+    void CloseSandbox();
+    // Removes [start, end) from the mappings, splitting any that straddle it
+    void Unmap(uint64_t start, uint64_t end);
+    void CloseAll();
+};
+
+} // namespace proxy_kernel
+
+#endif // PROXY_KERNEL_H
@@ -9,9 +9,9 @@
 
 #include <array>
 #include <vector>
-#include <unordered_set>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <cstdint>
 
 /**
@@ -94,12 +94,6 @@ class RegisterFile {
 
 };
 
-extern const std::unordered_set<std::string> valid_general_purpose_registers;
-
-extern const std::unordered_set<std::string> valid_floating_point_registers;
-
-extern const std::unordered_set<std::string> valid_csr_registers;
-
 extern const std::unordered_map<std::string, int> csr_to_address;
 
 /**
@@ -107,10 +101,10 @@ extern const std::unordered_map<std::string, int> csr_to_address;
  */
 extern const std::unordered_map<std::string, std::string> reg_alias_to_name;
 
-bool IsValidGeneralPurposeRegister(const std::string &reg);
+bool IsValidGeneralPurposeRegister(std::string_view reg);
 
-bool IsValidFloatingPointRegister(const std::string &reg);
+bool IsValidFloatingPointRegister(std::string_view reg);
 
-bool IsValidCsr(const std::string &reg);
+bool IsValidCsr(std::string_view reg);
 
 #endif // REGISTERS_H
\ No newline at end of file
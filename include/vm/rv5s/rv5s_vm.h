@@ -11,7 +11,6 @@
 #include "vm/rv5s/rv5s_control_unit.h"
 #include "vm/pipeline_registers.h"
 #include <stack>
-#include <unordered_map>
 
 struct WbWriteInfo {
     bool occurred = false;
@@ -50,6 +49,11 @@ struct CycleDelta {
     WbWriteInfo wb_write;
     MemWriteInfo mem_write;
 
+    // Predictor table/history writes made by the branch resolved in this cycle
+    branch_predictor::ResolveRecord predictor_update;
+    // BTB/RAS writes made by the jump resolved in this cycle
+    branch_predictor::TargetUpdateRecord target_update;
+
     // Other internal variables
     bool old_id_stall = false;
     uint64_t old_stall_cycles = 0;
@@ -100,19 +104,26 @@ class RV5SVM : public VmBase {
         std::stack<CycleDelta> undo_stack_;
         std::stack<CycleDelta> redo_stack_;
 
-        RV5SVM();
+        explicit RV5SVM(vm_config::ConfigSnapshot config = vm_config::snapshot());
         ~RV5SVM();
 
-        void PipelinedStep();
+        // Advances one clock cycle; the cycle is recorded for undo unless record_undo is false
+        void PipelinedStep(bool record_undo = true);
+
+        // Whether the program has ended: fetch is past it and every instruction in flight has retired
+        bool IsDrained() const {
+            return program_counter_ >= program_size_ && !if_id_reg_.valid && !id_ex_reg_.valid
+                   && !ex_mem_reg_.valid && !mem_wb_reg_.valid;
+        }
 
     private:
 
         // the flag that pipelineDecode will use to tell pipelineStep whether to stall or not
         bool id_stall_ = false;
 
-        // For 1-Bit Branch Prediction
-        // Branch History Table: maps PC addresses to prediction bits
-        std::unordered_map<uint64_t, bool> branch_history_table_;
+        // Predictor training done by pipelineDecode this cycle, moved into the CycleDelta
+        branch_predictor::ResolveRecord pending_predictor_update_;
+        branch_predictor::TargetUpdateRecord pending_target_update_;
 
         ForwardSource forward_a_ = ForwardSource::kNone;
         ForwardSource forward_b_ = ForwardSource::kNone;
@@ -142,6 +153,32 @@ class RV5SVM : public VmBase {
             std::cout << "rv5svm" << std::endl;
         }
 
+    protected:
+        /// Pipeline latches, hazard and forwarding state, for snapshots.
+        struct CoreState {
+            IF_ID_Register if_id_reg;
+            ID_EX_Register id_ex_reg;
+            EX_MEM_Register ex_mem_reg;
+            MEM_WB_Register mem_wb_reg;
+            RV5SControlUnit control_unit;
+            bool id_stall = false;
+            ForwardSource forward_a = ForwardSource::kNone;
+            ForwardSource forward_b = ForwardSource::kNone;
+            ForwardSource forward_branch_a = ForwardSource::kNone;
+            ForwardSource forward_branch_b = ForwardSource::kNone;
+            uint64_t instruction_sequence_counter = 0;
+            uint64_t last_retired_sequence_id = 0;
+        };
+
+        std::any SaveCoreState() const override;
+        void RestoreCoreState(const std::any &state) override;
+        // One clock cycle
+        uint64_t StepCount() const override {
+            return cycle_s_;
+        }
+        void ReplayStep() override;
+        void DumpCoreState() override;
+
 };
 
 #endif // RV5S_VM_H
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ * @file pipeline_model.h
+ * @brief Timing model of a parametrised in-order, N-wide issue pipeline
+ */
+#ifndef PIPELINE_MODEL_H
+#define PIPELINE_MODEL_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace pipeline_model {
+
+// GPRs x0-x31 map to 0-31 and FPRs f0-f31 to 32-63; x0 is never a dependency
+constexpr unsigned int kNumTrackedRegisters = 64;
+constexpr uint8_t kNoRegister = 0;
+constexpr uint64_t kMaxIssueWidth = 8;
+
+struct PipelineModelConfig {
+  uint64_t issue_width = 1;     ///< Instructions issued into the first execute stage per cycle
+  uint64_t frontend_stages = 2; ///< Stages before execute (IF, ID, ...), the refill cost of a redirect
+  uint64_t execute_stages = 1;  ///< Stages an ALU result takes to be produced
+  uint64_t memory_stages = 1;   ///< Stages after execute before load data is available
+  bool forwarding = true;       ///< Bypass results to dependent instructions instead of waiting for writeback
+};
+
+// Functional unit an instruction needs, which sets its execute latency
+enum class OpClass {
+  Alu,
+  Multiply,
+  Divide,
+  Float,
+  FloatDivide,
+  Load,
+  Store,
+  System
+};
+
+/**
+ * @brief What a timing model needs to know about one retired instruction.
+ */
+struct MicroOp {
+  std::array<uint8_t, 3> sources{}; ///< Unified register ids read, kNoRegister if unused
+  uint8_t dest = kNoRegister;       ///< Unified register id written, kNoRegister if none
+  OpClass op_class = OpClass::Alu;
+  uint64_t address = 0;             ///< Effective address of a load or store
+  uint8_t access_size = 0;          ///< Bytes accessed by a load or store
+  bool is_load = false;
+  bool is_store = false;
+  bool is_control = false;     ///< Branch or jump
+  bool taken = false;          ///< Control left the sequential path, ending the fetch group
+  bool mispredicted = false;   ///< Fetch went the wrong way and must refill from the resolved target
+  bool serializing = false;    ///< Issues alone (ecall)
+};
+
+struct PipelineModelStats {
+  uint64_t instructions = 0;
+  uint64_t data_stall_cycles = 0;       ///< Issue delayed waiting for an operand
+  uint64_t control_stall_cycles = 0;    ///< Issue delayed refilling the front end after a misprediction
+  uint64_t structural_stall_cycles = 0; ///< Issue delayed by the pairing rules of a wider group
+  std::vector<uint64_t> issue_histogram; ///< Index k: cycles in which k instructions issued
+};
+
+// Operands, destination and unit of an instruction; address and control outcome are left to the caller
+MicroOp DecodeMicroOp(uint32_t instruction);
+
+/**
+ * @brief Scoreboard model of an in-order pipeline with configurable depth and issue width.
+ *
+ * Instructions are fed in program order after they executed functionally; each
+ * is assigned the earliest cycle it can enter the first execute stage given
+ * in-order issue, operand readiness, front-end refills and the pairing rules:
+ * one memory operation per group, a taken or serializing instruction closes
+ * its group, and dependent instructions never share a group. Control
+ * transfers resolve at the end of their first execute stage.
+ */
+class PipelineModel {
+  public:
+    void Initialize(const PipelineModelConfig &config);
+    void Reset();
+
+    void Issue(const MicroOp &op);
+
+    // Cycles until the last issued instruction leaves writeback
+    uint64_t GetCycles() const;
+
+    uint64_t GetStageCount() const {
+      return config_.frontend_stages + config_.execute_stages + config_.memory_stages + 1;
+    }
+
+    // Statistics including the issue group still being filled
+    PipelineModelStats GetStats() const;
+
+    PipelineModelConfig GetConfig() const {
+      return config_;
+    }
+
+  private:
+    PipelineModelConfig config_;
+    PipelineModelStats stats_;
+
+    std::array<uint64_t, kNumTrackedRegisters> ready_{}; ///< First cycle a consumer may execute with the value
+    uint64_t fetch_ready_ = 0;    ///< Earliest issue cycle allowed by the front end
+    uint64_t group_cycle_ = 0;    ///< Cycle of the group currently being filled
+    uint64_t group_size_ = 0;
+    uint64_t group_memory_ops_ = 0;
+    bool group_closed_ = false;
+    uint64_t last_writeback_ = 0;
+};
+
+} // namespace pipeline_model
+
+#endif // PIPELINE_MODEL_H
@@ -0,0 +1,86 @@
+/**
+ * @file rvio_vm.h
+ * @brief In-order superscalar VM: the single-cycle core timed by a parametrised pipeline model
+ */
+
+#ifndef RVIO_VM_H
+#define RVIO_VM_H
+
+#include "vm/rvss/rvss_vm.h"
+#include "vm/rvio/pipeline_model.h"
+
+#include <stack>
+
+/**
+ * @brief Timing state changed by one instruction, kept alongside the functional StepDelta.
+ */
+struct TimingDelta {
+    pipeline_model::PipelineModel old_model;
+    pipeline_model::PipelineModel new_model;
+
+    branch_predictor::ResolveRecord predictor_update;
+    branch_predictor::TargetUpdateRecord target_update;
+
+    unsigned int old_num_branches = 0;
+    unsigned int new_num_branches = 0;
+    unsigned int old_branch_mispredictions = 0;
+    unsigned int new_branch_mispredictions = 0;
+};
+
+/**
+ * @brief Executes instructions on the single-cycle datapath and feeds each one
+ * to a PipelineModel configured from the [Pipeline] section.
+ *
+ * Architectural state is exactly that of RVSSVM; cycle counts, CPI/IPC and
+ * stall breakdowns come from the model, so different depths and issue widths
+ * can be compared on the same workload. [Pipeline] changes take effect on
+ * reset or when a fresh program starts running.
+ */
+class RVIOVM : public RVSSVM {
+  public:
+    explicit RVIOVM(vm_config::ConfigSnapshot config = vm_config::snapshot());
+    ~RVIOVM();
+
+    void Run() override;
+    void DebugRun() override;
+    void Step() override;
+    void Undo() override;
+    void Redo() override;
+    void Reset() override;
+
+    const pipeline_model::PipelineModel &GetPipelineModel() const {
+        return model_;
+    }
+
+    void PrintType() {
+        std::cout << "rviovm" << std::endl;
+    }
+
+  protected:
+    /// The RVSSVM state plus the pipeline model, for snapshots.
+    struct TimedState {
+        std::any functional;
+        pipeline_model::PipelineModel model;
+    };
+
+    std::any SaveCoreState() const override;
+    void RestoreCoreState(const std::any &state) override;
+    void ReplayStep() override;
+
+  private:
+    pipeline_model::PipelineModel model_;
+
+    std::stack<TimingDelta> timing_undo_stack_;
+    std::stack<TimingDelta> timing_redo_stack_;
+
+    // Rebuilds the model and predictors from the current configuration
+    void ConfigureModel();
+    // Runs one instruction functionally and issues it to the model; delta may be null
+    void ExecuteTimed(TimingDelta *delta);
+    // Runs one instruction and records it for undo/redo
+    void RecordedStep();
+    void UpdateMetrics();
+    void PrintStats();
+};
+
+#endif // RVIO_VM_H
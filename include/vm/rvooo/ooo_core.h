@@ -0,0 +1,152 @@
+/**
+ * @file ooo_core.h
+ * @brief Cycle-level model of an out-of-order core: rename, reorder buffer, issue queue and load/store queue
+ */
+#ifndef OOO_CORE_H
+#define OOO_CORE_H
+
+#include "vm/rvio/pipeline_model.h"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ooo_core {
+
+constexpr uint64_t kNotReady = std::numeric_limits<uint64_t>::max();
+constexpr uint16_t kNoPhysicalRegister = std::numeric_limits<uint16_t>::max();
+constexpr uint64_t kMaxWidth = 8;
+
+struct OooCoreConfig {
+  uint64_t width = 4;               ///< Instructions fetched, renamed, issued and committed per cycle
+  uint64_t rob_size = 64;           ///< Reorder buffer entries
+  uint64_t issue_queue_size = 32;   ///< Instructions waiting for operands
+  uint64_t lsq_size = 16;           ///< Loads and stores in flight
+  uint64_t physical_registers = 128; ///< Unified GPR + FPR physical register file
+  uint64_t frontend_stages = 2;     ///< Fetch to rename latency, the refill cost of a redirect
+
+  uint64_t alu_latency = 1;
+  uint64_t multiply_latency = 3;
+  uint64_t divide_latency = 20;
+  uint64_t float_latency = 4;
+  uint64_t float_divide_latency = 12;
+  uint64_t load_latency = 2;        ///< Address generation plus a data cache hit
+  uint64_t forward_latency = 1;     ///< Load satisfied from an older store in the LSQ
+};
+
+// Why rename could not fill its slots in a cycle, first blocking reason wins
+enum class StallReason {
+  FrontEnd,       ///< Nothing fetched yet: redirect refill or end of program
+  RobFull,
+  IssueQueueFull,
+  LsqFull,
+  NoFreeRegister,
+  Serialize,      ///< ecall/CSR waits for the window to drain
+  Count
+};
+
+struct OooCoreStats {
+  uint64_t cycles = 0;
+  uint64_t fetched = 0;
+  uint64_t committed = 0;
+  uint64_t rob_occupancy_sum = 0;  ///< Sum over cycles, divided by cycles for the average
+  uint64_t rob_occupancy_max = 0;
+  uint64_t issue_queue_occupancy_sum = 0;
+  uint64_t forwarded_loads = 0;    ///< Loads that took their value from an older store
+  uint64_t memory_order_stalls = 0; ///< Load-cycles a ready load was held back by an older store with an unknown or partial address
+  std::array<uint64_t, static_cast<size_t>(StallReason::Count)> stall_cycles{};
+};
+
+struct RobEntry {
+  uint64_t sequence = 0;
+  pipeline_model::MicroOp op;
+  std::array<uint16_t, 3> sources{kNoPhysicalRegister, kNoPhysicalRegister, kNoPhysicalRegister};
+  uint16_t dest = kNoPhysicalRegister;
+  uint16_t previous_dest = kNoPhysicalRegister; ///< Mapping freed when this instruction commits
+  bool issued = false;
+  uint64_t complete_cycle = kNotReady;
+};
+
+struct FetchedOp {
+  pipeline_model::MicroOp op;
+  uint64_t ready_cycle = 0; ///< First cycle rename may take it
+};
+
+/**
+ * @brief Out-of-order timing model fed by an already executed instruction stream.
+ *
+ * Each Cycle() runs commit, issue (wakeup/select), rename/dispatch and fetch in
+ * that order. Fetch pulls instructions from a supplier that executes them on the
+ * functional core, so only correct-path instructions enter the window; a
+ * mispredicted branch stops fetch until it executes, after which the front end
+ * refills. Architectural registers map onto a physical register file through a
+ * rename table with a free list, and instructions commit in program order from
+ * the reorder buffer. Loads wait for every older store address, take their data
+ * from the youngest covering older store, and otherwise go to memory.
+ */
+class OooCore {
+  public:
+    using FetchSupplier = std::function<bool(pipeline_model::MicroOp &)>;
+
+    void Initialize(const OooCoreConfig &config);
+    void Reset();
+
+    // Advances one clock; fetch asks the supplier for up to width instructions
+    void Cycle(const FetchSupplier &fetch);
+
+    // No instruction fetched but not yet committed
+    bool Drained() const {
+      return rob_.empty() && fetch_queue_.empty();
+    }
+
+    size_t GetRobOccupancy() const {
+      return rob_.size();
+    }
+
+    const OooCoreStats &GetStats() const {
+      return stats_;
+    }
+
+    OooCoreConfig GetConfig() const {
+      return config_;
+    }
+
+  private:
+    OooCoreConfig config_;
+    OooCoreStats stats_;
+    uint64_t cycle_ = 0;
+    uint64_t next_sequence_ = 0;
+
+    std::deque<FetchedOp> fetch_queue_;
+    std::deque<RobEntry> rob_;
+    std::vector<uint64_t> issue_queue_;        ///< Sequence numbers in age order
+    std::deque<uint64_t> load_store_queue_;    ///< Sequence numbers in age order
+
+    std::array<uint16_t, pipeline_model::kNumTrackedRegisters> rename_table_{};
+    std::vector<uint64_t> register_ready_;     ///< Cycle each physical register's value can be consumed
+    std::deque<uint16_t> free_list_;
+
+    bool awaiting_redirect_ = false;           ///< A mispredicted branch has not executed yet
+    uint64_t fetch_resume_cycle_ = 0;
+    bool serializing_in_flight_ = false;
+
+    void Commit();
+    void Issue();
+    void Dispatch();
+    void Fetch(const FetchSupplier &fetch);
+
+    RobEntry &Entry(uint64_t sequence);
+    uint64_t Latency(const RobEntry &entry) const;
+    // Earliest completion of a ready load given older stores, false if it must wait
+    bool ResolveLoad(const RobEntry &load, uint64_t &complete_cycle, bool &forwarded);
+};
+
+std::string StallReasonToString(StallReason reason);
+
+} // namespace ooo_core
+
+#endif // OOO_CORE_H
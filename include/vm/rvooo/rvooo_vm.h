@@ -0,0 +1,98 @@
+/**
+ * @file rvooo_vm.h
+ * @brief Out-of-order VM: the single-cycle core feeding a cycle-level out-of-order model
+ */
+
+#ifndef RVOOO_VM_H
+#define RVOOO_VM_H
+
+#include "vm/rvss/rvss_vm.h"
+#include "vm/rvooo/ooo_core.h"
+
+#include <stack>
+#include <vector>
+
+/**
+ * @brief Everything one clock of the out-of-order VM changed.
+ */
+struct OooCycleDelta {
+    ooo_core::OooCore old_core;
+    ooo_core::OooCore new_core;
+
+    std::vector<StepDelta> fetched_steps; ///< Instructions executed by fetch this cycle, oldest first
+    std::vector<branch_predictor::ResolveRecord> predictor_updates;
+    std::vector<branch_predictor::TargetUpdateRecord> target_updates;
+
+    unsigned int old_num_branches = 0;
+    unsigned int new_num_branches = 0;
+    unsigned int old_branch_mispredictions = 0;
+    unsigned int new_branch_mispredictions = 0;
+};
+
+/**
+ * @brief Runs an OooCore from the [OutOfOrder] section, one Step per clock.
+ *
+ * Fetch executes instructions on the single-cycle datapath (alu::Alu and the
+ * MemoryController) and hands them to the core, which renames, issues out of
+ * order and commits in order. The register file therefore holds the state of
+ * the youngest fetched instruction while the window is full, and equals the
+ * RVSSVM result once the core drains at the end of the program.
+ */
+class RVOOOVM : public RVSSVM {
+  public:
+    explicit RVOOOVM(vm_config::ConfigSnapshot config = vm_config::snapshot());
+    ~RVOOOVM();
+
+    void Run() override;
+    void DebugRun() override;
+    void Step() override;
+    void Undo() override;
+    void Redo() override;
+    void Reset() override;
+
+    const ooo_core::OooCore &GetCore() const {
+        return core_;
+    }
+
+    void PrintType() {
+        std::cout << "rvooovm" << std::endl;
+    }
+
+  protected:
+    /// The RVSSVM state plus the out-of-order window, for snapshots.
+    struct OooState {
+        std::any functional;
+        ooo_core::OooCore core;
+        uint64_t instructions_fetched = 0;
+    };
+
+    std::any SaveCoreState() const override;
+    void RestoreCoreState(const std::any &state) override;
+    // One clock of the core
+    uint64_t StepCount() const override {
+        return cycle_s_;
+    }
+    void ReplayStep() override;
+
+  private:
+    ooo_core::OooCore core_;
+    uint64_t instructions_fetched_ = 0; ///< Fetched during the current run, for the execution limit
+    std::vector<uint64_t> limit_restarts_; ///< Cycles at which a command restarted the limit, for replay
+
+    std::stack<OooCycleDelta> cycle_undo_stack_;
+    std::stack<OooCycleDelta> cycle_redo_stack_;
+
+    // Rebuilds the core and predictors from the current configuration
+    void ConfigureCore();
+    // Starts counting fetched instructions against the execution limit again
+    void RestartExecutionLimit();
+    // Executes the next instruction for the core's fetch stage; delta may be null
+    bool FetchInstruction(pipeline_model::MicroOp &op, OooCycleDelta *delta);
+    // Advances one clock; delta may be null
+    void CoreCycle(OooCycleDelta *delta);
+    bool Finished() const;
+    void UpdateMetrics();
+    void PrintStats();
+};
+
+#endif // RVOOO_VM_H
@@ -131,17 +131,30 @@ class RVSSVM : public VmBase {
   void ExecuteDouble();
   void ExecuteCsr();
   void HandleSyscall();
+  // Sets a0 to a syscall's result, recording the change for undo
+  void SetSyscallResult(uint64_t value);
+  // Copies what a syscall returns into guest memory, bypassing the cache, recording the change for undo
+  void StoreSyscallBytes(uint64_t address, const uint8_t *bytes, size_t size);
+  // Zeroes a range a syscall maps, recording for undo only the blocks that held anything
+  void ClearSyscallBytes(uint64_t address, uint64_t size);
+  static constexpr uint64_t kMaxSyscallTransfer = 1 << 24; ///< Bytes one read syscall may return
+  static constexpr uint64_t kMaxSyscallPath = 4096;        ///< PATH_MAX of the guest
 
   void WriteMemory();
   void WriteMemoryFloat();
   void WriteMemoryDouble();
+  void WriteMemoryAtomic();
 
   void WriteBack();
   void WriteBackFloat();
   void WriteBackDouble();
   void WriteBackCsr();
 
-  RVSSVM();
+  // Write the old / new values recorded in a StepDelta back to registers, memory and pc
+  void RevertStep(const StepDelta &delta);
+  void ReapplyStep(const StepDelta &delta);
+
+  explicit RVSSVM(vm_config::ConfigSnapshot config = vm_config::snapshot());
   ~RVSSVM();
 
   void Run() override;
@@ -151,9 +164,32 @@ class RVSSVM : public VmBase {
   void Redo() override;
   void Reset() override;
 
+  // Runs one instruction without undo records, checkpoints or dumps, and trains the branch and
+  // target predictors on it the way fetch would have; fast-forwards to a sampled window
+  void WarmStep();
+
   void PrintType() {
     std::cout << "rvssvm" << std::endl;
   }
+
+ protected:
+  /// Control signals and the values carried between the stages of a step, for snapshots.
+  struct CoreState {
+    RVSSControlUnit control_unit;
+    int64_t execution_result = 0;
+    int64_t memory_result = 0;
+    uint64_t return_address = 0;
+    bool branch_flag = false;
+    int64_t next_pc = 0;
+    uint16_t csr_target_address = 0;
+    uint64_t csr_old_value = 0;
+    uint64_t csr_write_val = 0;
+    uint8_t csr_uimm = 0;
+  };
+
+  std::any SaveCoreState() const override;
+  void RestoreCoreState(const std::any &state) override;
+  void ReplayStep() override;
 };
 
 #endif // RVSS_VM_H
@@ -9,10 +9,15 @@
 
 #include "registers.h"
 #include "memory_controller.h"
+#include "proxy_kernel.h"
 #include "alu.h"
+#include "branch_predictor/branch_predictor.h"
+#include "branch_predictor/target_predictor.h"
+#include "branch_predictor/branch_trace.h"
 
 #include "vm_asm_mw.h"
 
+#include <any>
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -22,21 +27,91 @@
 #include <queue>
 #include <atomic>
 
+// The simulator's own console calls, then those of the riscv64 Linux ABI (see proxy_kernel.h)
 enum SyscallCode {
     SYSCALL_PRINT_INT = 1,
     SYSCALL_PRINT_FLOAT = 2,
     SYSCALL_PRINT_DOUBLE = 3,
     SYSCALL_PRINT_STRING = 4,
     SYSCALL_EXIT = 10,
+    SYSCALL_OPENAT = 56,
+    SYSCALL_CLOSE = 57,
+    SYSCALL_LSEEK = 62,
     SYSCALL_READ = 63,
     SYSCALL_WRITE = 64,
+    SYSCALL_FSTAT = 80,
+    SYSCALL_LINUX_EXIT = 93,
+    SYSCALL_EXIT_GROUP = 94,
+    SYSCALL_CLOCK_GETTIME = 113,
+    SYSCALL_BRK = 214,
+    SYSCALL_MUNMAP = 215,
+    SYSCALL_MMAP = 222,
 };
 
+// Whether a syscall ends the program
+inline bool IsExitSyscall(uint64_t number) {
+    return number == SYSCALL_EXIT || number == SYSCALL_LINUX_EXIT || number == SYSCALL_EXIT_GROUP;
+}
+
+
+/**
+ * @brief Everything a VM needs to continue from one point of a run, see VmBase::TakeSnapshot().
+ *
+ * Memory blocks are shared with the VM and with other snapshots until one of them writes a
+ * block, so many snapshots of one run cost little more than the blocks written between them.
+ */
+struct VmSnapshot {
+    uint64_t program_counter = 0;
+    uint32_t current_instruction = 0;
+
+    unsigned int cycle_s = 0;
+    unsigned int instructions_retired = 0;
+    float cpi = 0;
+    float ipc = 0;
+    unsigned int stall_cycles = 0;
+    unsigned int branch_mispredictions = 0;
+    unsigned int forwarding_events = 0;
+    unsigned int num_branches = 0;
+    std::string output_status;
+
+    RegisterFile registers;
+    MemoryController::State memory;
+    alu::Alu alu;
+    branch_predictor::BranchPredictorUnit::State branch_predictor;
+    branch_predictor::TargetPredictor target_predictor;
+    proxy_kernel::ProxyKernel::State proxy_kernel; ///< Open files share their host descriptors
+
+    std::any core; ///< State only the derived VM knows about, from SaveCoreState()
+};
+
+/**
+ * @brief A snapshot taken automatically during a run, for reverse execution.
+ */
+struct Checkpoint {
+    uint64_t step = 0; ///< VmBase::StepCount() when it was taken
+    size_t input_position = 0; ///< Lines of stdin the program had read by then
+    size_t host_reply_position = 0; ///< Host replies its syscalls had used by then
+    VmSnapshot snapshot;
+};
+
+class VmBase;
+
+/**
+ * @brief Takes over a hart's lr, sc and AMOs, for harts whose memory is shared with others
+ * in ways the hart's own MemoryController cannot see.
+ */
+class AtomicPort {
+public:
+    virtual ~AtomicPort() = default;
+    // Does what VmBase::ExecuteAtomic() would and returns what goes to rd
+    virtual uint64_t Execute(VmBase &hart, uint32_t instruction, uint64_t address, uint64_t value) = 0;
+};
 
 class VmBase {
 public:
-    VmBase() = default;
-    ~VmBase() = default;
+    // Runs on the given configuration, a copy of the current one by default
+    explicit VmBase(vm_config::ConfigSnapshot config = vm_config::snapshot());
+    virtual ~VmBase() = default;
 
     AssembledProgram program_;
     std::atomic<bool> stop_requested_ = false;
@@ -59,13 +134,46 @@ public:
     unsigned int num_branches_{};
 
     std::string output_status_;
+    bool exit_ends_process_ = true; ///< Whether the exit syscall ends the host process or only stops this VM
+    bool empty_input_when_idle_ = false; ///< Whether a read of stdin with nothing queued gets an empty line instead of waiting
+    uint64_t exit_code_ = 0;        ///< a0 of the exit syscall
+
+    // The configuration this VM runs on. It never changes under a running step: the VM thread
+    // swaps in one passed to Reconfigure() only where a run, step or reset begins
+    const vm_config::VmConfig &GetConfig() const {
+        return *config_;
+    }
+    // Hands the VM a new configuration; safe to call from any thread while the VM runs.
+    // Memory size and block size stay those the VM was built with
+    void Reconfigure(vm_config::ConfigSnapshot config);
 
     MemoryController memory_controller_;
+    proxy_kernel::ProxyKernel proxy_kernel_; ///< Files, break and mappings of the loaded program
     RegisterFile registers_;
     
     alu::Alu alu_;
+    branch_predictor::BranchPredictorUnit branch_predictor_;
+    branch_predictor::TargetPredictor target_predictor_;
+    branch_predictor::BranchTrace *branch_trace_ = nullptr; ///< When set, resolved conditional branches are appended here
+
+    // Rebuilds the direction and target predictors from the VM's configuration and clears their state
+    void ResetBranchPredictors();
+    // Predictor steering fetch for the configured branch_prediction, false for none/static
+    bool GetSteeringPredictor(branch_predictor::PredictorKind &kind) const;
+    static branch_predictor::BranchPredictorConfig PredictorConfigFromVmConfig(const vm_config::VmConfig &config);
+    // Cache geometry and policies from the [Cache] section
+    static cache::CacheConfig CacheConfigFromVmConfig(const vm_config::VmConfig &config);
+    // Predicts and trains on an executed branch or jump the way fetch would have seen it and
+    // counts it; returns true when fetch had to be redirected. Records are kept for undo.
+    bool ResolveControlTransfer(uint64_t pc, uint32_t instruction, uint64_t next_pc, unsigned int flush_penalty,
+                                branch_predictor::ResolveRecord &predictor_update,
+                                branch_predictor::TargetUpdateRecord &target_update);
 
     void LoadProgram(const AssembledProgram &program);
+    // Loads a re-assembled version of the current program, copying only the text words that
+    // changed; the data section is reloaded, the files, break and mappings are reset and execution
+    // restarts at the entry point as for LoadProgram
+    void UpdateProgram(const AssembledProgram &program, const std::vector<unsigned int> &changed_words);
     uint64_t program_size_ = 0;
 
     uint64_t GetProgramCounter() const;
@@ -75,6 +183,9 @@ public:
 
     void AddBreakpoint(uint64_t val, bool is_line = true);
     void RemoveBreakpoint(uint64_t val, bool is_line = true);
+    // Breakpoints on the address of a text symbol, for programs without line information
+    void AddBreakpoint(const std::string &symbol);
+    void RemoveBreakpoint(const std::string &symbol);
     bool CheckBreakpoint(uint64_t address);
 
     // void fetchInstruction();
@@ -85,6 +196,44 @@ public:
 
     // void HandleSyscall();
     void PrintString(uint64_t address);
+    // Writes length bytes of guest memory to stream straight from the blocks holding them
+    void WriteGuestBuffer(std::ostream &stream, uint64_t address, uint64_t length);
+
+    // Performs the memory side of an lr, sc or AMO (opcode 0101111) on address, with value being
+    // rs2, and returns what goes to rd: the loaded or old value, or 0/1 for sc succeeding/failing.
+    // Goes to atomic_port_ when one is set.
+    uint64_t ExecuteAtomic(uint32_t instruction, uint64_t address, uint64_t value);
+    // ExecuteAtomic() on this hart's own memory controller
+    uint64_t ExecuteAtomicLocally(uint32_t instruction, uint64_t address, uint64_t value);
+    // Value an AMO leaves in memory given the old one (sign-extended for .w) and rs2
+    static uint64_t AtomicOperation(uint32_t instruction, uint64_t old_value, uint64_t value);
+    AtomicPort *atomic_port_ = nullptr;
+
+    // Captures registers, pc, counters, memory, cache and predictors, plus the derived VM's
+    // pipeline state. Memory is shared copy-on-write, so this copies no memory block.
+    VmSnapshot TakeSnapshot() const;
+    // Returns to a snapshot taken with the same program loaded. The undo/redo history and the
+    // checkpoints are cleared, since they describe steps taken after the point being left.
+    void RestoreSnapshot(const VmSnapshot &snapshot);
+
+    // Reverse execution. Every checkpoint_interval steps the VM takes a checkpoint; going back
+    // restores the closest checkpoint at or before the target and re-executes forward from it,
+    // with the stdin lines the program read and the answers the host gave its syscalls the
+    // first time. When max_checkpoints is exceeded
+    // every other checkpoint is dropped and the interval doubles, so memory stays flat however
+    // long the run. A step is whatever one Step() advances: an instruction, or a clock cycle
+    // on the pipelined VMs.
+    // Goes back n steps, or to the start of the recorded history if that is closer
+    void ReverseStep(uint64_t n = 1);
+    // Goes back to the last point before the current one where the pc was on a breakpoint,
+    // or to the start of the recorded history if there is none
+    void ReverseContinue();
+    // Forgets all checkpoints, recorded input and host replies; the next step starts a new history
+    void ClearHistory();
+    // Called after registers or memory were changed by hand: checkpoints from here on no
+    // longer describe this run, so they and the input and host replies after this point are dropped and
+    // a checkpoint of the current state is taken instead
+    void TruncateHistory();
 
     virtual void Run() = 0;
     virtual void DebugRun() = 0;
@@ -96,6 +245,10 @@ public:
     void DumpCacheState(const std::filesystem::path &filename);
 
     void ModifyRegister(const std::string &reg_name, uint64_t value);
+    // Next line of stdin for a read syscall: a recorded line while re-executing steps that
+    // have run before, otherwise one pushed by PushInput(), waiting for it if necessary unless
+    // empty_input_when_idle_ is set
+    std::string ReadInput();
     void PushInput(const std::string& input) {
         std::lock_guard<std::mutex> lock(input_mutex_);
         input_queue_.push(input);
@@ -114,6 +267,50 @@ public:
         stop_requested_ = false;
     }
 
+protected:
+    // Derived VMs save and restore their own state here; RestoreCoreState is given what
+    // SaveCoreState returned and must also clear the undo/redo history. RV5SVM also accepts
+    // an empty state, so a snapshot of another VM with its core cleared can be continued there
+    virtual std::any SaveCoreState() const {
+        return {};
+    }
+
+    virtual void RestoreCoreState(const std::any &) {}
+
+    // Steps taken since the program started, the position checkpoints are kept by
+    virtual uint64_t StepCount() const {
+        return instructions_retired_;
+    }
+    // Advances one step the way Step() does, but without undo records, dumps or checks
+    virtual void ReplayStep() = 0;
+    // Writes the dumps only the derived VM has, after ReverseStep()/ReverseContinue()
+    virtual void DumpCoreState() {}
+    // Takes a checkpoint if the last one is checkpoint_interval steps behind; called by the
+    // derived VMs before every step
+    void CheckpointIfDue();
+
+    bool replaying_ = false; ///< Set while ReverseStep()/ReverseContinue() re-execute steps
+
+    // Takes up the configuration last passed to Reconfigure(), if any; called by the derived
+    // VMs on their own thread where Run(), DebugRun(), Step() and Reset() begin
+    void ApplyPendingConfig();
+
+private:
+    vm_config::ConfigSnapshot config_;
+    std::atomic<vm_config::ConfigSnapshot> pending_config_;
+    std::atomic<bool> config_pending_ = false; ///< Lets the VM thread skip pending_config_ when it is empty
+
+    std::vector<Checkpoint> checkpoints_; ///< Oldest first, at least checkpoint_interval_ apart
+    uint64_t checkpoint_interval_ = 0;
+    std::vector<std::string> input_log_; ///< Every stdin line read since the history started
+    size_t input_position_ = 0; ///< Next line of input_log_ a read syscall gets
+
+    void ApplySnapshot(const VmSnapshot &snapshot);
+    void AddCheckpoint();
+    // Restores the last checkpoint at or before step and returns the step it was taken at
+    uint64_t RestoreCheckpoint(uint64_t step);
+    // Restores the last checkpoint at or before step and re-executes up to it
+    void ReplayTo(uint64_t step);
 };
 
 #endif // VM_BASE_H
@@ -8,6 +8,7 @@
 #define VM_ASM_MW_H
 
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -16,21 +17,46 @@
 
 #include "assembler/parser.h"
 
+/**
+ * @brief A contiguous range of guest memory initialised from a program file.
+ */
+struct ProgramSegment {
+  uint64_t address = 0; ///< The guest address of the first byte.
+  uint64_t memory_size = 0; ///< The size in memory; bytes past the file contents are zero.
+  bool executable = false; ///< Whether the segment holds code.
+  std::vector<uint8_t> bytes; ///< The contents taken from the file.
+};
+
 struct AssembledProgram {
   std::map<unsigned int, unsigned int> line_number_instruction_number_mapping;
   std::map<unsigned int, unsigned int> instruction_number_line_number_mapping;
   std::map<unsigned int, unsigned int> instruction_number_disassembly_mapping;
 
   std::vector<std::pair<ICUnit, bool>> intermediate_code;
+  LabelTable labels; ///< Names of the labels the intermediate code refers to.
 
   // std::vector<std::pair<std::string, SymbolData>> symbol_table;
   
 
   std::map<std::string, SymbolData> symbol_table;
+  // Labels named by .globl (or bound globally in an ELF input); the others are local to their unit
+  std::set<std::string> global_symbols;
 
   std::string filename;
+  // Files a linked program was assembled from, in link order, each with the index of its first
+  // instruction. The line an instruction maps to is in the last file starting at or before it;
+  // empty when the program comes from filename alone
+  std::vector<std::pair<unsigned int, std::string>> source_files;
   std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> data_buffer;
   std::vector<uint32_t> text_buffer;
+
+  // The data section as it appears in memory, with alignment applied, loaded at the data section start
+  std::vector<uint8_t> data_image;
+
+  // Loadable segments of a program read from an ELF executable, used instead of text_buffer and data_image.
+  // Such programs have no intermediate code, and their symbol table holds absolute addresses.
+  std::vector<ProgramSegment> segments;
+  uint64_t entry_point = 0;
 };
 
 #endif // VM_ASM_MW_H
\ No newline at end of file
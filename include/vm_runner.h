@@ -16,6 +16,13 @@
 #include <stdexcept>
 #include <sstream>
 
+/**
+ * @brief Creates a VM of the given type, announcing it on stdout.
+ * @param vmType The processor model.
+ * @return The VM, running on the configuration of the calling thread.
+ */
+std::unique_ptr<VmBase> createVMInstance(vm_config::VmTypes vmType);
+
 // inline std::unique_ptr<VmBase> createVM(vm_config::VmTypes vmType) {
 //   if (vmType==vm_config::VmTypes::SINGLE_STAGE) {
 //     return std::make_unique<RVSSVM>();
@@ -7,6 +7,10 @@
 /** @endcond */
 
 #include "assembler/assembler.h"
+#include "assembler/assembly_cache.h"
+#include "assembler/elf_util.h"
+#include "assembler/linker.h"
+#include "config.h"
 #include "utils.h"
 #include "globals.h"
 
@@ -17,8 +21,141 @@
 #include <map>
 #include <iostream>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Lays out data directives after those already in the image, aligned relative to its start
+void appendDataSection(
+    std::vector<uint8_t> &image,
+    const std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data_buffer) {
+  for (const auto &data : data_buffer) {
+    std::visit([&image](auto &&value) {
+      using T = std::decay_t<decltype(value)>;
+      if constexpr (std::is_same_v<T, std::string>) {
+        image.insert(image.end(), value.begin(), value.end());
+      } else {
+        // Little-endian, like the memory write functions
+        size_t offset = (image.size() + sizeof(T) - 1)/sizeof(T)*sizeof(T);
+        image.resize(offset + sizeof(T), 0);
+        std::memcpy(image.data() + offset, &value, sizeof(T));
+      }
+    }, data);
+  }
+}
+
+/**
+ * @brief Encodes a streaming parse straight into an ELF file.
+ *
+ * Only the data image is kept in memory; instructions are written as they are parsed and
+ * forward references are patched in the file.
+ */
+class ElfStreamSink : public ParserSink {
+ private:
+  ElfFileWriter &writer_;
+  std::vector<uint8_t> data_image_;
+
+ public:
+  explicit ElfStreamSink(ElfFileWriter &writer) : writer_(writer) {}
+
+  void instruction(const ICUnit &block) override {
+    writer_.appendText(generateMachineCode(block));
+  }
+
+  void data(const std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data)
+      override {
+    appendDataSection(data_image_, data);
+  }
+
+  bool patch(const Relocation &reference, int64_t offset) override {
+    std::array<uint32_t, 2> words{};
+    std::span<uint32_t> patched(words.data(), reference.type==RelocationType::kPcrelHiLo ? 2 : 1);
+    writer_.readText(reference.instruction_index, patched);
+    if (!patchRelocation(patched, reference.type, offset)) {
+      return false;
+    }
+    writer_.writeText(reference.instruction_index, patched);
+    return true;
+  }
+
+  [[nodiscard]] const std::vector<uint8_t> &getDataImage() const {
+    return data_image_;
+  }
+};
+
+void writeTextFile(const std::filesystem::path &filename, std::string_view text) {
+  if (filename.empty()) {
+    return;
+  }
+  std::ofstream out(filename);
+  if (!out) {
+    std::cerr << "Failed to open output file: " << filename << std::endl;
+    return;
+  }
+  out << text;
+}
+
+/**
+ * @brief State of one translation unit while it is assembled on a worker thread.
+ *
+ * The lexer and parser are kept so that errors can be reported after all workers finish,
+ * from the calling thread and in argument order.
+ */
+struct TranslationUnit {
+  std::unique_ptr<Lexer> lexer;
+  std::unique_ptr<Parser> parser;
+  ObjectFile object;
+  std::exception_ptr failure;
+};
+
+void assembleTranslationUnit(const std::string &filename, TranslationUnit &unit) {
+  try {
+    try {
+      unit.lexer = std::make_unique<Lexer>(filename);
+    } catch (const std::runtime_error &e) {
+      throw std::runtime_error("Failed to open file: " + filename);
+    }
+    unit.parser = std::make_unique<Parser>(unit.lexer->getSource(), unit.lexer->getTokenList());
+    unit.parser->setRelocatable(true);
+    unit.parser->parse();
+    if (unit.parser->getErrorCount()!=0) {
+      return;
+    }
+
+    ObjectFile &object = unit.object;
+    object.filename = filename;
+    object.intermediate_code = unit.parser->getIntermediateCode();
+    object.labels = unit.parser->getLabels();
+    object.text_buffer = generateMachineCode(object.intermediate_code);
+    object.instruction_number_line_number_mapping = unit.parser->getInstructionNumberLineNumberMapping();
+    object.data_buffer = std::move(unit.parser->getDataBuffer());
+    object.data_size = unit.parser->getDataSize();
+    object.symbol_table = unit.parser->getSymbolTable();
+    object.global_symbols.assign(unit.parser->getGlobalSymbols().begin(), unit.parser->getGlobalSymbols().end());
+    object.relocations = unit.parser->getRelocations();
+  } catch (...) {
+    unit.failure = std::current_exception();
+  }
+}
+
+} // namespace
 
 AssembledProgram assemble(const std::string &filename) {
+  if (isElfFile(filename)) {
+    AssembledProgram program = readElfFile(filename);
+    DumpNoErrors(globals::errors_dump_file_path);
+    return program;
+  }
+
   std::unique_ptr<Lexer> lexer;
   try {
     lexer = std::make_unique<Lexer>(filename);
@@ -26,6 +163,17 @@ AssembledProgram assemble(const std::string &filename) {
     throw std::runtime_error("Failed to open file: " + filename);
   }
 
+  std::optional<AssemblyCache> cache;
+  if (vm_config::current().getAssemblyCacheEnabled()) {
+    cache.emplace(globals::assembly_cache_directory);
+    if (std::optional<CachedAssembly> cached = cache->find(lexer->getSource().getText())) {
+      cached->program.filename = filename;
+      writeTextFile(globals::disassembly_file_path, cached->disassembly);
+      DumpNoErrors(globals::errors_dump_file_path);
+      return std::move(cached->program);
+    }
+  }
+
   std::vector<Token> tokens = lexer->getTokenList();
   // int previous_line = -1;
   // for (const Token& token : tokens) {
@@ -38,58 +186,188 @@ AssembledProgram assemble(const std::string &filename) {
   //     std::cout << token << std::endl;
   // }
 
-  Parser parser(lexer->getFilename(), tokens);
+  Parser parser(lexer->getSource(), std::move(tokens));
   parser.parse();
 
-  AssembledProgram program;
-  program.filename = filename;
+  if (parser.getErrorCount()!=0) {
+    reportParseErrors(parser, filename);
+  }
 
-  if (parser.getErrorCount()==0) {
+  AssembledProgram program = buildProgram(parser, filename);
 
-    std::vector<uint32_t> machine_code_bits = generateMachineCode(parser.getIntermediateCode());
+  if (cache) {
+    std::ostringstream disassembly;
+    WriteDisassembly(disassembly, program);
+    writeTextFile(globals::disassembly_file_path, disassembly.view());
+    cache->store(lexer->getSource().getText(), program, disassembly.view());
+  } else {
+    DumpDisasssembly(globals::disassembly_file_path, program);
+  }
 
-    program.data_buffer = parser.getDataBuffer();
-    program.intermediate_code = parser.getIntermediateCode();
-    program.text_buffer = machine_code_bits;
-    program.instruction_number_line_number_mapping = parser.getInstructionNumberLineNumberMapping();
+  DumpNoErrors(globals::errors_dump_file_path);
+  return program;
+}
 
-    program.line_number_instruction_number_mapping = [&]() {
-      std::map<unsigned int, unsigned int> line_number_instruction_number_mapping;
-      if (program.instruction_number_line_number_mapping.empty()) {
-        return line_number_instruction_number_mapping;
-      }
-      unsigned int prev_instruction = 0;
-      unsigned int prev_line = 1;
-
-      for (const auto &[instruction, line] : program.instruction_number_line_number_mapping) {
-        for (unsigned int i = prev_line; i <= line; ++i) {
-          line_number_instruction_number_mapping[i] = prev_instruction;
-        }
-        prev_instruction += 1;
-        prev_line = line + 1;
+void assembleElfFile(const std::string &filename, const std::string &output_filename) {
+  if (isElfFile(filename)) {
+    // Already an executable, and readElfFile() keeps only its segments, so it is copied as it is
+    readElfFile(filename);
+    std::error_code error;
+    if (!std::filesystem::equivalent(filename, output_filename, error)) {
+      std::filesystem::copy_file(filename, output_filename, std::filesystem::copy_options::overwrite_existing, error);
+      if (error) {
+        throw std::runtime_error("Failed to write file: " + output_filename);
       }
-      return line_number_instruction_number_mapping;
-    }();
+    }
+    DumpNoErrors(globals::errors_dump_file_path);
+    return;
+  }
 
-    program.symbol_table = parser.getSymbolTable();
+  std::unique_ptr<Lexer> lexer;
+  try {
+    lexer = std::make_unique<Lexer>(filename);
+  } catch (const std::runtime_error &e) {
+    throw std::runtime_error("Failed to open file: " + filename);
+  }
 
-    
-    DumpDisasssembly(globals::disassembly_file_path, program);
+  ElfFileWriter writer(output_filename);
+  ElfStreamSink sink(writer);
+  Parser parser(*lexer, sink);
+  parser.parse();
+  if (parser.getErrorCount()!=0) {
+    reportParseErrors(parser, filename);
+  }
 
-    DumpNoErrors(globals::errors_dump_file_path);
+  writer.finish(sink.getDataImage(), parser.getSymbolTable(), parser.getGlobalSymbols(), AssembledProgram{}.entry_point);
+  DumpNoErrors(globals::errors_dump_file_path);
+}
 
-  } else {
-    DumpErrors(globals::errors_dump_file_path, parser.getErrors());
-    if (globals::verbose_errors_print) {
-      parser.printErrors();
+ObjectFile assembleObject(const std::string &filename) {
+  ObjectFile object = std::move(assembleObjects({filename}).front());
+  DumpNoErrors(globals::errors_dump_file_path);
+  return object;
+}
+
+std::vector<ObjectFile> assembleObjects(const std::vector<std::string> &filenames) {
+  std::vector<TranslationUnit> units(filenames.size());
+
+  // Workers take the next unassembled file until none are left; the caller is one of them.
+  // They assemble with the caller's configuration.
+  std::atomic<size_t> next{0};
+  const vm_config::VmConfig &config = vm_config::current();
+  auto worker = [&]() {
+    vm_config::ScopedConfig bind(config);
+    for (size_t i = next++; i < units.size(); i = next++) {
+      assembleTranslationUnit(filenames[i], units[i]);
+    }
+  };
+  size_t thread_count = std::min<size_t>(filenames.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<ObjectFile> objects;
+  objects.reserve(units.size());
+  for (size_t i = 0; i < units.size(); ++i) {
+    TranslationUnit &unit = units[i];
+    if (unit.failure) {
+      std::rethrow_exception(unit.failure);
+    }
+    if (unit.parser->getErrorCount()!=0) {
+      reportParseErrors(*unit.parser, filenames[i]);
+    }
+    objects.push_back(std::move(unit.object));
+  }
+  return objects;
+}
+
+AssembledProgram assemble(const std::vector<std::string> &filenames) {
+  if (filenames.size()==1 && !isObjectFile(filenames.front())) {
+    return assemble(filenames.front());
+  }
+
+  std::vector<std::string> sources;
+  for (const std::string &filename : filenames) {
+    if (!isObjectFile(filename)) {
+      sources.push_back(filename);
+    }
+  }
+  std::vector<ObjectFile> assembled = assembleObjects(sources);
+
+  std::vector<ObjectFile> objects;
+  objects.reserve(filenames.size());
+  auto next_assembled = assembled.begin();
+  for (const std::string &filename : filenames) {
+    if (isObjectFile(filename)) {
+      objects.push_back(readObjectFile(filename));
+    } else {
+      objects.push_back(std::move(*next_assembled++));
     }
-    throw std::runtime_error("Failed to parse file: " + filename);
   }
 
+  AssembledProgram program = linkObjects(objects);
+  program.data_image = layoutDataSection(program.data_buffer);
+  // Breakpoints are set by line in the first file, whose instructions come first
+  program.line_number_instruction_number_mapping =
+      buildLineNumberInstructionNumberMapping(objects.front().instruction_number_line_number_mapping);
+
+  DumpDisasssembly(globals::disassembly_file_path, program);
+  DumpNoErrors(globals::errors_dump_file_path);
   return program;
 }
 
+std::vector<uint8_t> layoutDataSection(
+    const std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data_buffer) {
+  std::vector<uint8_t> image;
+  appendDataSection(image, data_buffer);
+  return image;
+}
 
+AssembledProgram buildProgram(Parser &parser, const std::string &filename) {
+  AssembledProgram program;
+  program.filename = filename;
+  program.data_buffer = parser.getDataBuffer();
+  program.data_image = layoutDataSection(program.data_buffer);
+  program.intermediate_code = parser.getIntermediateCode();
+  program.labels = parser.getLabels();
+  program.text_buffer = generateMachineCode(program.intermediate_code);
+  program.instruction_number_line_number_mapping = parser.getInstructionNumberLineNumberMapping();
+  program.line_number_instruction_number_mapping =
+      buildLineNumberInstructionNumberMapping(program.instruction_number_line_number_mapping);
+  program.symbol_table = parser.getSymbolTable();
+  program.global_symbols = parser.getGlobalSymbols();
+  return program;
+}
 
+void reportParseErrors(const Parser &parser, const std::string &filename) {
+  DumpErrors(globals::errors_dump_file_path, parser.getErrors());
+  if (globals::verbose_errors_print) {
+    parser.printErrors();
+  }
+  throw std::runtime_error("Failed to parse file: " + filename);
+}
 
+std::map<unsigned int, unsigned int> buildLineNumberInstructionNumberMapping(
+    const std::map<unsigned int, unsigned int> &instruction_number_line_number_mapping) {
+  std::map<unsigned int, unsigned int> line_number_instruction_number_mapping;
+  if (instruction_number_line_number_mapping.empty()) {
+    return line_number_instruction_number_mapping;
+  }
+  unsigned int prev_instruction = 0;
+  unsigned int prev_line = 1;
 
+  for (const auto &[instruction, line] : instruction_number_line_number_mapping) {
+    for (unsigned int i = prev_line; i <= line; ++i) {
+      line_number_instruction_number_mapping.emplace_hint(line_number_instruction_number_mapping.end(),
+                                                          i, prev_instruction);
+    }
+    prev_instruction += 1;
+    prev_line = line + 1;
+  }
+  return line_number_instruction_number_mapping;
+}
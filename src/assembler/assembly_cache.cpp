@@ -0,0 +1,174 @@
+/**
+ * @file assembly_cache.cpp
+ * @brief Implementation of the AssemblyCache.
+ */
+
+#include "assembler/assembly_cache.h"
+#include "assembler/binary_stream.h"
+#include "config.h"
+
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+
+constexpr std::string_view kCacheMagic{"RVASMC03"};
+
+// Bump whenever the assembler's output for the same source changes
+constexpr uint32_t kAssemblerOutputVersion = 2;
+
+/**
+ * @brief Everything an entry's contents depend on besides the source text.
+ */
+struct CacheKey {
+  uint64_t source_hash = 0;
+  uint64_t source_size = 0;
+  uint64_t data_section_start = 0;
+  uint64_t text_section_start = 0;
+  uint32_t version = kAssemblerOutputVersion;
+  uint8_t m_extension = 0;
+  uint8_t f_extension = 0;
+  uint8_t d_extension = 0;
+
+  void write(BinaryWriter &writer) const {
+    writer.write(source_hash);
+    writer.write(source_size);
+    writer.write(data_section_start);
+    writer.write(text_section_start);
+    writer.write(version);
+    writer.write(m_extension);
+    writer.write(f_extension);
+    writer.write(d_extension);
+  }
+
+  bool matches(BinaryReader &reader) const {
+    return reader.read<uint64_t>()==source_hash
+        && reader.read<uint64_t>()==source_size
+        && reader.read<uint64_t>()==data_section_start
+        && reader.read<uint64_t>()==text_section_start
+        && reader.read<uint32_t>()==version
+        && reader.read<uint8_t>()==m_extension
+        && reader.read<uint8_t>()==f_extension
+        && reader.read<uint8_t>()==d_extension;
+  }
+};
+
+// FNV-1a over the source
+uint64_t hashBytes(std::string_view bytes, uint64_t hash = 14695981039346656037ull) {
+  for (char c : bytes) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+CacheKey makeKey(std::string_view source) {
+  CacheKey key;
+  key.source_size = source.size();
+  key.data_section_start = vm_config::current().getDataSectionStart();
+  key.text_section_start = vm_config::current().getTextSectionStart();
+  key.m_extension = vm_config::current().getMExtensionEnabled();
+  key.f_extension = vm_config::current().getFExtensionEnabled();
+  key.d_extension = vm_config::current().getDExtensionEnabled();
+
+  BinaryWriter fields;
+  key.write(fields);
+  key.source_hash = hashBytes(fields.getBuffer(), hashBytes(source));
+  return key;
+}
+
+std::filesystem::path entryPath(const std::filesystem::path &directory, const CacheKey &key) {
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << key.source_hash << ".asm";
+  return directory/name.str();
+}
+
+} // namespace
+
+std::optional<CachedAssembly> AssemblyCache::find(std::string_view source) const {
+  CacheKey key = makeKey(source);
+  std::filesystem::path path = entryPath(directory_, key);
+
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(path, error)) {
+    return std::nullopt;
+  }
+
+  try {
+    std::string contents = readBinaryFile(path);
+    if (!std::string_view(contents).starts_with(kCacheMagic)) {
+      return std::nullopt;
+    }
+    BinaryReader reader(contents, path.string());
+    reader.readRaw(kCacheMagic.size());
+    // The hash only names the entry; two sources with the same hash are told apart here
+    if (!key.matches(reader) || reader.readString()!=source) {
+      return std::nullopt;
+    }
+
+    CachedAssembly cached;
+    AssembledProgram &program = cached.program;
+    reader.read(program.text_buffer);
+    reader.read(program.intermediate_code, program.labels);
+    reader.read(program.instruction_number_line_number_mapping);
+    reader.read(program.line_number_instruction_number_mapping);
+    reader.read(program.instruction_number_disassembly_mapping);
+    reader.read(program.symbol_table);
+    auto global_count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < global_count; ++i) {
+      program.global_symbols.insert(reader.readString());
+    }
+    reader.read(program.data_buffer);
+    reader.read(program.data_image);
+    cached.disassembly = reader.readString();
+    return cached;
+  } catch (const std::runtime_error &) {
+    // A damaged entry is rebuilt by the caller
+    return std::nullopt;
+  }
+}
+
+void AssemblyCache::store(std::string_view source, const AssembledProgram &program, std::string_view disassembly) const {
+  CacheKey key = makeKey(source);
+
+  BinaryWriter writer;
+  writer.writeRaw(kCacheMagic);
+  key.write(writer);
+  writer.write(source);
+  writer.write(program.text_buffer);
+  writer.write(program.intermediate_code, program.labels);
+  writer.write(program.instruction_number_line_number_mapping);
+  writer.write(program.line_number_instruction_number_mapping);
+  writer.write(program.instruction_number_disassembly_mapping);
+  writer.write(program.symbol_table);
+  writer.write(static_cast<uint32_t>(program.global_symbols.size()));
+  for (const std::string &name : program.global_symbols) {
+    writer.write(name);
+  }
+  writer.write(program.data_buffer);
+  writer.write(program.data_image);
+  writer.write(disassembly);
+
+  std::filesystem::path path = entryPath(directory_, key);
+  std::filesystem::path temporary = path;
+  // Unique per process and thread, since --batch assembles on several threads at once
+  temporary += ".tmp" + std::to_string(::getpid()) + "."
+               + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  try {
+    writer.writeFile(temporary);
+  } catch (const std::runtime_error &) {
+    std::filesystem::remove(temporary, error);
+    return;
+  }
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+  }
+}
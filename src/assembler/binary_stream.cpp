@@ -0,0 +1,200 @@
+/**
+ * @file binary_stream.cpp
+ * @brief Implementation of BinaryWriter and BinaryReader.
+ */
+
+#include "assembler/binary_stream.h"
+
+#include <bit>
+#include <charconv>
+#include <fstream>
+
+static_assert(std::endian::native==std::endian::little, "Binary files are written in host byte order");
+
+void BinaryWriter::write(std::string_view value) {
+  write(static_cast<uint32_t>(value.size()));
+  buffer_.append(value);
+}
+
+void BinaryWriter::write(const std::vector<uint8_t> &bytes) {
+  write(static_cast<uint32_t>(bytes.size()));
+  buffer_.append(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+void BinaryWriter::write(const std::vector<uint32_t> &words) {
+  write(static_cast<uint32_t>(words.size()));
+  buffer_.append(reinterpret_cast<const char *>(words.data()), words.size()*sizeof(uint32_t));
+}
+
+void BinaryWriter::write(const std::vector<std::pair<ICUnit, bool>> &intermediate_code, const LabelTable &labels) {
+  write(static_cast<uint32_t>(intermediate_code.size()));
+  for (const auto &[block, resolved] : intermediate_code) {
+    write(static_cast<uint8_t>(resolved));
+    write(block.line_number);
+    write(block.instruction_index);
+    write(block.getOpcode());
+    write(block.getRd());
+    write(block.getRs1());
+    write(block.getRs2());
+    write(block.getRs3());
+    write(block.getCsr());
+    write(block.getImm());
+    write(block.getLabel(labels));
+    write(block.rm);
+  }
+}
+
+void BinaryWriter::write(const std::map<unsigned int, unsigned int> &mapping) {
+  write(static_cast<uint32_t>(mapping.size()));
+  for (const auto &[key, value] : mapping) {
+    write(key);
+    write(value);
+  }
+}
+
+void BinaryWriter::write(const std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data) {
+  write(static_cast<uint32_t>(data.size()));
+  for (const auto &entry : data) {
+    write(static_cast<uint8_t>(entry.index()));
+    std::visit([this](auto &&value) {
+      using T = std::decay_t<decltype(value)>;
+      if constexpr (std::is_same_v<T, std::string>) {
+        write(std::string_view(value));
+      } else {
+        write(value);
+      }
+    }, entry);
+  }
+}
+
+void BinaryWriter::write(const std::map<std::string, SymbolData> &symbol_table) {
+  write(static_cast<uint32_t>(symbol_table.size()));
+  for (const auto &[name, symbol] : symbol_table) {
+    write(std::string_view(name));
+    write(symbol.address);
+    write(symbol.line_number);
+    write(static_cast<uint8_t>(symbol.isData));
+  }
+}
+
+void BinaryWriter::writeFile(const std::filesystem::path &filename) const {
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  out.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  if (!out) {
+    throw std::runtime_error("Failed to write file: " + filename.string());
+  }
+}
+
+std::string BinaryReader::readString() {
+  return std::string(readRaw(read<uint32_t>()));
+}
+
+std::string_view BinaryReader::readRaw(size_t size) {
+  require(size);
+  std::string_view bytes = buffer_.substr(0, size);
+  buffer_.remove_prefix(size);
+  return bytes;
+}
+
+void BinaryReader::read(std::vector<uint8_t> &bytes) {
+  std::string_view raw = readRaw(read<uint32_t>());
+  bytes.assign(raw.begin(), raw.end());
+}
+
+void BinaryReader::read(std::vector<uint32_t> &words) {
+  auto count = read<uint32_t>();
+  std::string_view bytes = readRaw(static_cast<size_t>(count)*sizeof(uint32_t));
+  words.resize(count);
+  std::memcpy(words.data(), bytes.data(), bytes.size());
+}
+
+void BinaryReader::read(std::vector<std::pair<ICUnit, bool>> &intermediate_code, LabelTable &labels) {
+  auto count = read<uint32_t>();
+  intermediate_code.clear();
+  intermediate_code.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    bool resolved = read<uint8_t>()!=0;
+    ICUnit block;
+    block.setLineNumber(read<unsigned int>());
+    block.setInstructionIndex(read<unsigned int>());
+    block.setOpcode(readString());
+    block.setRd(readString());
+    block.setRs1(readString());
+    block.setRs2(readString());
+    block.setRs3(readString());
+    block.setCsr(read<uint32_t>());
+    std::string imm = readString();
+    if (!imm.empty()) {
+      int64_t value = 0;
+      auto [end, ec] = std::from_chars(imm.data(), imm.data() + imm.size(), value);
+      if (ec!=std::errc() || end!=imm.data() + imm.size()) {
+        fail();
+      }
+      block.setImm(value);
+    }
+    block.setLabel(labels, readString());
+    block.setRm(read<uint8_t>());
+    intermediate_code.emplace_back(std::move(block), resolved);
+  }
+}
+
+void BinaryReader::read(std::map<unsigned int, unsigned int> &mapping) {
+  auto count = read<uint32_t>();
+  mapping.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    auto key = read<unsigned int>();
+    mapping.emplace_hint(mapping.end(), key, read<unsigned int>());
+  }
+}
+
+void BinaryReader::read(std::vector<std::variant<uint8_t, uint16_t, uint32_t, uint64_t, std::string, float, double>> &data) {
+  auto count = read<uint32_t>();
+  data.clear();
+  data.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    switch (read<uint8_t>()) {
+      case 0: data.emplace_back(read<uint8_t>());
+        break;
+      case 1: data.emplace_back(read<uint16_t>());
+        break;
+      case 2: data.emplace_back(read<uint32_t>());
+        break;
+      case 3: data.emplace_back(read<uint64_t>());
+        break;
+      case 4: data.emplace_back(readString());
+        break;
+      case 5: data.emplace_back(read<float>());
+        break;
+      case 6: data.emplace_back(read<double>());
+        break;
+      default: fail();
+    }
+  }
+}
+
+void BinaryReader::read(std::map<std::string, SymbolData> &symbol_table) {
+  auto count = read<uint32_t>();
+  symbol_table.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string name = readString();
+    SymbolData symbol{};
+    symbol.address = read<uint64_t>();
+    symbol.line_number = read<uint64_t>();
+    symbol.isData = read<uint8_t>()!=0;
+    symbol_table.emplace_hint(symbol_table.end(), std::move(name), symbol);
+  }
+}
+
+std::string readBinaryFile(const std::filesystem::path &filename) {
+  std::ifstream in(filename, std::ios::binary | std::ios::ate);
+  if (!in) {
+    throw std::runtime_error("Failed to open file: " + filename.string());
+  }
+  std::string buffer(static_cast<size_t>(in.tellg()), '\0');
+  in.seekg(0);
+  in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  if (!in) {
+    throw std::runtime_error("Failed to read file: " + filename.string());
+  }
+  return buffer;
+}
@@ -1,77 +1,418 @@
-
 #include "assembler/elf_util.h"
+#include "assembler/binary_stream.h"
 
 #include "vm_asm_mw.h"
+#include "config.h"
+
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-#include <iostream>
-#include <fstream>
-#include <variant>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
 
-void generateElfFile(const AssembledProgram &program, const std::string &output_filename) {
-  std::ofstream elfFile(output_filename, std::ios::binary);
+namespace {
+
+constexpr uint64_t kPageSize = 0x1000;
+
+enum SectionIndex : uint16_t {
+  kNullSection,
+  kTextSection,
+  kDataSection,
+  kSymtabSection,
+  kStrtabSection,
+  kShstrtabSection,
+  kSectionCount
+};
+
+constexpr uint64_t alignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1)/alignment*alignment;
+}
+
+template <typename T>
+void writeStruct(BinaryWriter &writer, const T &value) {
+  writer.writeRaw(std::string_view(reinterpret_cast<const char *>(&value), sizeof(T)));
+}
+
+// Pads with zeros up to a file offset; base is the file offset of the writer's first byte
+void padTo(BinaryWriter &writer, uint64_t base, uint64_t offset) {
+  writer.writeRaw(std::string(offset - base - writer.getBuffer().size(), '\0'));
+}
 
-  if (!elfFile) {
-    std::cerr << "Failed to open ELF file for writing!" << std::endl;
+// Loadable contents start on page boundaries so that file offsets and addresses agree modulo the page size
+constexpr uint64_t textOffset(uint16_t segment_count) {
+  return alignUp(sizeof(Elf64_Ehdr) + segment_count*sizeof(Elf64_Phdr), kPageSize);
+}
+
+// The text is written before the data size, and so the segment count, is known
+static_assert(textOffset(1)==textOffset(2));
+constexpr uint64_t kTextOffset = textOffset(2);
+
+uint32_t addString(std::string &table, std::string_view name) {
+  auto offset = static_cast<uint32_t>(table.size());
+  table.append(name);
+  table.push_back('\0');
+  return offset;
+}
+
+// Reads a header at a file offset, rejecting offsets past the end
+template <typename T>
+T readStruct(std::string_view file, uint64_t offset, const std::filesystem::path &filename) {
+  if (offset > file.size() || file.size() - offset < sizeof(T)) {
+    throw std::runtime_error("Truncated ELF file: " + filename.string());
+  }
+  T value;
+  std::memcpy(&value, file.data() + offset, sizeof(T));
+  return value;
+}
+
+[[noreturn]] void unsupported(const std::filesystem::path &filename, const std::string &reason) {
+  throw std::runtime_error("Unsupported ELF file " + filename.string() + ": " + reason);
+}
+
+void readSymbols(std::string_view file, const Elf64_Ehdr &header, const std::filesystem::path &filename,
+                 AssembledProgram &program) {
+  if (header.e_shoff==0 || header.e_shnum==0) {
     return;
   }
+  if (header.e_shentsize!=sizeof(Elf64_Shdr)) {
+    unsupported(filename, "unexpected section header size");
+  }
+  auto section = [&](uint64_t index) {
+    if (index >= header.e_shnum) {
+      unsupported(filename, "section index out of range");
+    }
+    return readStruct<Elf64_Shdr>(file, header.e_shoff + index*sizeof(Elf64_Shdr), filename);
+  };
+
+  for (uint16_t i = 0; i < header.e_shnum; ++i) {
+    Elf64_Shdr symtab = section(i);
+    if (symtab.sh_type!=SHT_SYMTAB) {
+      continue;
+    }
+    Elf64_Shdr strtab = section(symtab.sh_link);
+    if (strtab.sh_offset > file.size() || file.size() - strtab.sh_offset < strtab.sh_size) {
+      throw std::runtime_error("Truncated ELF file: " + filename.string());
+    }
+    std::string_view names = file.substr(strtab.sh_offset, strtab.sh_size);
+
+    for (uint64_t offset = 0; offset + sizeof(Elf64_Sym) <= symtab.sh_size; offset += sizeof(Elf64_Sym)) {
+      auto symbol = readStruct<Elf64_Sym>(file, symtab.sh_offset + offset, filename);
+      unsigned char type = ELF64_ST_TYPE(symbol.st_info);
+      if (symbol.st_shndx==SHN_UNDEF || symbol.st_name==0 || symbol.st_name >= names.size()
+          || (type!=STT_NOTYPE && type!=STT_FUNC && type!=STT_OBJECT)) {
+        continue;
+      }
+      std::string_view name = names.substr(symbol.st_name);
+      name = name.substr(0, name.find('\0'));
+      // Mapping symbols ($x, $d) and assembler temporaries are not useful to the user
+      if (name.empty() || name.starts_with('$') || name.starts_with(".L")) {
+        continue;
+      }
+      program.symbol_table.emplace(std::string(name), SymbolData{symbol.st_value, 0, type==STT_OBJECT});
+      if (ELF64_ST_BIND(symbol.st_info)!=STB_LOCAL) {
+        program.global_symbols.emplace(name);
+      }
+    }
+  }
+}
+
+// Everything in the file but the text, laid out for a text of a given size
+struct ElfLayout {
+  Elf64_Ehdr header{};
+  Elf64_Phdr text_segment{};
+  Elf64_Phdr data_segment{};
+  std::vector<Elf64_Sym> symbols;
+  std::string strtab;
+  std::string shstrtab;
+  std::vector<Elf64_Shdr> sections;
+  uint64_t data_offset = 0;
+  uint64_t symtab_offset = 0;
+  uint64_t section_header_offset = 0;
+  uint32_t first_global = 1; ///< Index of the first global symbol, the .symtab sh_info
+};
+
+ElfLayout layoutElf(uint64_t text_size, uint64_t data_size, const std::map<std::string, SymbolData> &symbol_table,
+                    const std::set<std::string> &global_symbols, uint64_t entry_point) {
+  uint64_t data_start = vm_config::current().getDataSectionStart();
+  uint16_t segment_count = data_size==0 ? 1 : 2;
+  ElfLayout layout;
+
+  // Symbol table; labels named by .globl are global, the rest local, and the locals come first
+  layout.strtab.assign(1, '\0');
+  layout.symbols.assign(1, Elf64_Sym{});
+  for (unsigned char binding : {STB_LOCAL, STB_GLOBAL}) {
+    if (binding==STB_GLOBAL) {
+      layout.first_global = static_cast<uint32_t>(layout.symbols.size());
+    }
+    for (const auto &[name, symbol] : symbol_table) {
+      if ((global_symbols.count(name)!=0)!=(binding==STB_GLOBAL)) {
+        continue;
+      }
+      Elf64_Sym entry{};
+      entry.st_name = addString(layout.strtab, name);
+      entry.st_info = ELF64_ST_INFO(binding, symbol.isData ? STT_OBJECT : STT_NOTYPE);
+      entry.st_shndx = symbol.isData ? kDataSection : kTextSection;
+      entry.st_value = symbol.isData ? data_start + symbol.address : symbol.address;
+      layout.symbols.push_back(entry);
+    }
+  }
+
+  std::string &shstrtab = layout.shstrtab;
+  shstrtab.assign(1, '\0');
+  uint32_t text_name = addString(shstrtab, ".text");
+  uint32_t data_name = addString(shstrtab, ".data");
+  uint32_t symtab_name = addString(shstrtab, ".symtab");
+  uint32_t strtab_name = addString(shstrtab, ".strtab");
+  uint32_t shstrtab_name = addString(shstrtab, ".shstrtab");
+
+  uint64_t text_offset = textOffset(segment_count);
+  layout.data_offset = alignUp(text_offset + text_size, kPageSize);
+  layout.symtab_offset = alignUp(layout.data_offset + data_size, 8);
+  uint64_t strtab_offset = layout.symtab_offset + layout.symbols.size()*sizeof(Elf64_Sym);
+  uint64_t shstrtab_offset = strtab_offset + layout.strtab.size();
+  layout.section_header_offset = alignUp(shstrtab_offset + shstrtab.size(), 8);
+
+  Elf64_Ehdr &header = layout.header;
+  std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+  header.e_ident[EI_CLASS] = ELFCLASS64;
+  header.e_ident[EI_DATA] = ELFDATA2LSB;
+  header.e_ident[EI_VERSION] = EV_CURRENT;
+  header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+  header.e_type = ET_EXEC;
+  header.e_machine = EM_RISCV;
+  header.e_version = EV_CURRENT;
+  header.e_entry = entry_point;
+  header.e_phoff = sizeof(Elf64_Ehdr);
+  header.e_shoff = layout.section_header_offset;
+  header.e_ehsize = sizeof(Elf64_Ehdr);
+  header.e_phentsize = sizeof(Elf64_Phdr);
+  header.e_phnum = segment_count;
+  header.e_shentsize = sizeof(Elf64_Shdr);
+  header.e_shnum = kSectionCount;
+  header.e_shstrndx = kShstrtabSection;
+
+  Elf64_Phdr &text_segment = layout.text_segment;
+  text_segment.p_type = PT_LOAD;
+  text_segment.p_flags = PF_R | PF_X;
+  text_segment.p_offset = text_offset;
+  text_segment.p_vaddr = text_segment.p_paddr = 0;
+  text_segment.p_filesz = text_segment.p_memsz = text_size;
+  text_segment.p_align = kPageSize;
+
+  Elf64_Phdr &data_segment = layout.data_segment;
+  data_segment.p_type = PT_LOAD;
+  data_segment.p_flags = PF_R | PF_W;
+  data_segment.p_offset = layout.data_offset;
+  data_segment.p_vaddr = data_segment.p_paddr = data_start;
+  data_segment.p_filesz = data_segment.p_memsz = data_size;
+  data_segment.p_align = kPageSize;
+
+  std::vector<Elf64_Shdr> &sections = layout.sections;
+  sections.assign(kSectionCount, Elf64_Shdr{});
+  sections[kTextSection] = {text_name, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, 0, text_offset, text_size,
+                            0, 0, 4, 0};
+  sections[kDataSection] = {data_name, SHT_PROGBITS, SHF_ALLOC | SHF_WRITE, data_start, layout.data_offset,
+                            data_size, 0, 0, 8, 0};
+  sections[kSymtabSection] = {symtab_name, SHT_SYMTAB, 0, 0, layout.symtab_offset,
+                              layout.symbols.size()*sizeof(Elf64_Sym), kStrtabSection, layout.first_global, 8,
+                              sizeof(Elf64_Sym)};
+  sections[kStrtabSection] = {strtab_name, SHT_STRTAB, 0, 0, strtab_offset, layout.strtab.size(), 0, 0, 1, 0};
+  sections[kShstrtabSection] = {shstrtab_name, SHT_STRTAB, 0, 0, shstrtab_offset, shstrtab.size(), 0, 0, 1, 0};
+  return layout;
+}
+
+// The ELF header and program headers, which start the file
+void writeHeaders(BinaryWriter &writer, const ElfLayout &layout) {
+  writeStruct(writer, layout.header);
+  writeStruct(writer, layout.text_segment);
+  if (layout.header.e_phnum > 1) {
+    writeStruct(writer, layout.data_segment);
+  }
+}
+
+// Everything from the data to the end of the file; base is the file offset the writer starts at
+void writeTrailer(BinaryWriter &writer, uint64_t base, const ElfLayout &layout, std::string_view data) {
+  padTo(writer, base, layout.data_offset);
+  writer.writeRaw(data);
+  padTo(writer, base, layout.symtab_offset);
+  for (const Elf64_Sym &symbol : layout.symbols) {
+    writeStruct(writer, symbol);
+  }
+  writer.writeRaw(layout.strtab);
+  writer.writeRaw(layout.shstrtab);
+  padTo(writer, base, layout.section_header_offset);
+  for (const Elf64_Shdr &section : layout.sections) {
+    writeStruct(writer, section);
+  }
+}
+
+} // namespace
 
-  // ELF Header
-  ElfHeader elfHeader;
-  elfHeader.e_shoff = sizeof(ElfHeader);  // Section headers start after ELF header
-  elfHeader.e_shnum = 4;  // Now we have 4 sections: NULL, .text, .data, .shstrtab
-  elfHeader.e_shstrndx = 3;  // Index of .shstrtab
-
-  // Section Header String Table (stores section names)
-  std::string shstrtab = "\0.text\0.data\0.shstrtab\0";
-  uint32_t shstrtab_offset = sizeof(ElfHeader) + 3*sizeof(ElfSectionHeader)
-      + program.text_buffer.size()*sizeof(uint32_t)
-      + program.data_buffer.size();
-  uint32_t text_offset = sizeof(ElfHeader) + 3*sizeof(ElfSectionHeader);
-  uint32_t data_offset = text_offset + program.text_buffer.size()*sizeof(uint32_t);
-
-  // Section Headers
-  ElfSectionHeader nullSection = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}; // Empty first entry
-  ElfSectionHeader textSection = {1, 1, 6, 0x1000, text_offset,
-                                  static_cast<uint32_t>(program.text_buffer.size()*sizeof(uint32_t)), 0, 0, 4, 0};
-  ElfSectionHeader dataSection = {7, 1, 3, 0x2000, data_offset,
-                                  static_cast<uint32_t>(program.data_buffer.size()), 0, 0, 4, 0};
-  ElfSectionHeader shstrtabSection = {13, 3, 0, 0, shstrtab_offset,
-                                      static_cast<uint32_t>(shstrtab.size()), 0, 0, 1, 0};
-
-  // Write ELF Header
-  elfFile.write(reinterpret_cast<const char *>(&elfHeader), sizeof(elfHeader));
-
-  // Write Section Headers
-  elfFile.write(reinterpret_cast<const char *>(&nullSection), sizeof(nullSection));
-  elfFile.write(reinterpret_cast<const char *>(&textSection), sizeof(textSection));
-  elfFile.write(reinterpret_cast<const char *>(&dataSection), sizeof(dataSection));
-  elfFile.write(reinterpret_cast<const char *>(&shstrtabSection), sizeof(shstrtabSection));
-
-  // Write `.text` section (machine code)
-  for (const auto &instruction : program.text_buffer) {
-    elfFile.write(reinterpret_cast<const char *>(&instruction), sizeof(instruction));
-  }
-
-  // Write `.data` section (raw binary data)
-  for (const auto &data : program.data_buffer) {
-    if (std::holds_alternative<uint8_t>(data)) {
-      uint8_t value = std::get<uint8_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
-    } else if (std::holds_alternative<uint16_t>(data)) {
-      uint16_t value = std::get<uint16_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
-    } else if (std::holds_alternative<uint32_t>(data)) {
-      uint32_t value = std::get<uint32_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
-    } else if (std::holds_alternative<uint64_t>(data)) {
-      uint64_t value = std::get<uint64_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
+void generateElfFile(const AssembledProgram &program, const std::string &output_filename) {
+  std::string_view text(reinterpret_cast<const char *>(program.text_buffer.data()),
+                        program.text_buffer.size()*sizeof(uint32_t));
+  std::string_view data(reinterpret_cast<const char *>(program.data_image.data()), program.data_image.size());
+  ElfLayout layout = layoutElf(text.size(), data.size(), program.symbol_table, program.global_symbols,
+                               program.entry_point);
+
+  BinaryWriter writer;
+  writeHeaders(writer, layout);
+  padTo(writer, 0, layout.text_segment.p_offset);
+  writer.writeRaw(text);
+  writeTrailer(writer, 0, layout, data);
+  writer.writeFile(output_filename);
+}
+
+ElfFileWriter::ElfFileWriter(std::string filename) : filename_(std::move(filename)) {
+  fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd_ < 0) {
+    throw std::runtime_error("Failed to write file: " + filename_);
+  }
+  buffer_.reserve(kBufferWords);
+}
+
+ElfFileWriter::~ElfFileWriter() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    ::unlink(filename_.c_str());
+  }
+}
+
+void ElfFileWriter::writeAt(uint64_t offset, std::string_view bytes) {
+  while (!bytes.empty()) {
+    ssize_t written = ::pwrite(fd_, bytes.data(), bytes.size(), static_cast<off_t>(offset));
+    if (written <= 0) {
+      throw std::runtime_error("Failed to write file: " + filename_);
+    }
+    bytes.remove_prefix(static_cast<size_t>(written));
+    offset += static_cast<uint64_t>(written);
+  }
+}
+
+void ElfFileWriter::flush() {
+  writeAt(kTextOffset + flushed_words_*sizeof(uint32_t),
+          std::string_view(reinterpret_cast<const char *>(buffer_.data()), buffer_.size()*sizeof(uint32_t)));
+  flushed_words_ += buffer_.size();
+  buffer_.clear();
+}
+
+void ElfFileWriter::appendText(uint32_t word) {
+  buffer_.push_back(word);
+  if (buffer_.size()==kBufferWords) {
+    flush();
+  }
+}
+
+void ElfFileWriter::readText(size_t index, std::span<uint32_t> words) {
+  for (uint32_t &word : words) {
+    if (index >= flushed_words_) {
+      word = buffer_.at(index - flushed_words_);
+    } else if (::pread(fd_, &word, sizeof(word), static_cast<off_t>(kTextOffset + index*sizeof(uint32_t)))
+               !=sizeof(word)) {
+      throw std::runtime_error("Failed to read file: " + filename_);
     }
+    ++index;
   }
+}
 
-  // Write `.shstrtab` section
-  elfFile.write(shstrtab.c_str(), shstrtab.size());
+void ElfFileWriter::writeText(size_t index, std::span<const uint32_t> words) {
+  for (uint32_t word : words) {
+    if (index >= flushed_words_) {
+      buffer_.at(index - flushed_words_) = word;
+    } else {
+      writeAt(kTextOffset + index*sizeof(uint32_t), std::string_view(reinterpret_cast<const char *>(&word), sizeof(word)));
+    }
+    ++index;
+  }
+}
+
+void ElfFileWriter::finish(const std::vector<uint8_t> &data_image, const std::map<std::string, SymbolData> &symbol_table,
+                           const std::set<std::string> &global_symbols, uint64_t entry_point) {
+  flush();
+  std::string_view data(reinterpret_cast<const char *>(data_image.data()), data_image.size());
+  ElfLayout layout = layoutElf(flushed_words_*sizeof(uint32_t), data.size(), symbol_table, global_symbols, entry_point);
+
+  // The gaps between the headers, the text and the data are holes, which read as zeros
+  BinaryWriter trailer;
+  writeTrailer(trailer, layout.data_offset, layout, data);
+  writeAt(layout.data_offset, trailer.getBuffer());
+  BinaryWriter headers;
+  writeHeaders(headers, layout);
+  writeAt(0, headers.getBuffer());
+
+  if (::close(fd_)!=0) {
+    fd_ = -1;
+    ::unlink(filename_.c_str());
+    throw std::runtime_error("Failed to write file: " + filename_);
+  }
+  fd_ = -1;
+}
+
+AssembledProgram readElfFile(const std::filesystem::path &filename) {
+  std::string contents = readBinaryFile(filename);
+  std::string_view file(contents);
+
+  auto header = readStruct<Elf64_Ehdr>(file, 0, filename);
+  if (std::memcmp(header.e_ident, ELFMAG, SELFMAG)!=0) {
+    unsupported(filename, "not an ELF file");
+  }
+  if (header.e_ident[EI_CLASS]!=ELFCLASS64 || header.e_ident[EI_DATA]!=ELFDATA2LSB) {
+    unsupported(filename, "not a 64-bit little-endian file");
+  }
+  if (header.e_machine!=EM_RISCV) {
+    unsupported(filename, "not a RISC-V file");
+  }
+  if (header.e_type!=ET_EXEC) {
+    unsupported(filename, "not a statically linked executable");
+  }
+  if (header.e_phentsize!=sizeof(Elf64_Phdr)) {
+    unsupported(filename, "unexpected program header size");
+  }
+
+  AssembledProgram program;
+  program.filename = filename.string();
+  program.entry_point = header.e_entry;
+
+  for (uint16_t i = 0; i < header.e_phnum; ++i) {
+    auto segment = readStruct<Elf64_Phdr>(file, header.e_phoff + i*sizeof(Elf64_Phdr), filename);
+    if (segment.p_type==PT_INTERP || segment.p_type==PT_DYNAMIC) {
+      unsupported(filename, "dynamically linked executables are not supported");
+    }
+    if (segment.p_type!=PT_LOAD) {
+      continue;
+    }
+    if (segment.p_filesz > segment.p_memsz) {
+      unsupported(filename, "segment is larger in the file than in memory");
+    }
+    if (segment.p_offset > file.size() || file.size() - segment.p_offset < segment.p_filesz) {
+      throw std::runtime_error("Truncated ELF file: " + filename.string());
+    }
+    ProgramSegment loaded;
+    loaded.address = segment.p_vaddr;
+    loaded.memory_size = segment.p_memsz;
+    loaded.executable = (segment.p_flags & PF_X)!=0;
+    std::string_view bytes = file.substr(segment.p_offset, segment.p_filesz);
+    loaded.bytes.assign(bytes.begin(), bytes.end());
+    program.segments.push_back(std::move(loaded));
+  }
+  if (program.segments.empty()) {
+    unsupported(filename, "no loadable segments");
+  }
+
+  readSymbols(file, header, filename, program);
+  return program;
+}
 
-  std::cout << "ELF file generated: " << output_filename << std::endl;
+bool isElfFile(const std::filesystem::path &filename) {
+  std::ifstream in(filename, std::ios::binary);
+  char magic[SELFMAG] = {};
+  in.read(magic, SELFMAG);
+  return in && std::memcmp(magic, ELFMAG, SELFMAG)==0;
 }
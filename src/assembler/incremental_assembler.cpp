@@ -0,0 +1,313 @@
+/**
+ * @file incremental_assembler.cpp
+ * @brief Implementation of the IncrementalAssembler.
+ */
+
+#include "assembler/incremental_assembler.h"
+#include "assembler/assembler.h"
+#include "assembler/binary_stream.h"
+#include "assembler/elf_util.h"
+#include "assembler/linker.h"
+#include "config.h"
+#include "utils.h"
+#include "globals.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <string_view>
+
+namespace {
+
+// Drops a `#` or `;` comment and the whitespace around what is left
+std::string_view stripLine(std::string_view line) {
+  line = line.substr(0, line.find_first_of("#;"));
+  size_t start = line.find_first_not_of(" \t\r");
+  if (start==std::string_view::npos) {
+    return {};
+  }
+  return line.substr(start, line.find_last_not_of(" \t\r") + 1 - start);
+}
+
+// Whether a line holds nothing but an instruction. Labels, directives and strings change the
+// symbol table or the data section, and the parser finds sections by token value, so an operand
+// spelled like a section name could change how the rest of the file is read.
+bool isInstructionLine(std::string_view line) {
+  line = stripLine(line);
+  if (line.empty()) {
+    return true;
+  }
+  if (line.front()=='.' || line.find_first_of(":\"'")!=std::string_view::npos) {
+    return false;
+  }
+  size_t pos = 0;
+  while (pos < line.size()) {
+    size_t end = pos;
+    while (end < line.size() && (std::isalnum(static_cast<unsigned char>(line[end])) || line[end]=='_')) {
+      ++end;
+    }
+    std::string_view word = line.substr(pos, end - pos);
+    if (word=="text" || word=="data" || word=="bss" || word=="section") {
+      return false;
+    }
+    pos = end + 1;
+  }
+  return true;
+}
+
+// Whether a line is in the text section, going by the closest section directive before it
+bool isInTextSection(const SourceFile &source, unsigned int line_number) {
+  for (unsigned int line = line_number; line >= 1; --line) {
+    std::string_view text = stripLine(source.getLine(line));
+    if (text.starts_with(".section")) {
+      text = stripLine(text.substr(8));
+      return text.starts_with(".text");
+    }
+    if (text.starts_with(".text")) {
+      return true;
+    }
+    if (text.starts_with(".data") || text.starts_with(".bss")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+IncrementalAssembler::Settings IncrementalAssembler::currentSettings() {
+  Settings settings;
+  settings.data_section_start = vm_config::current().getDataSectionStart();
+  settings.text_section_start = vm_config::current().getTextSectionStart();
+  settings.m_extension = vm_config::current().getMExtensionEnabled();
+  settings.f_extension = vm_config::current().getFExtensionEnabled();
+  settings.d_extension = vm_config::current().getDExtensionEnabled();
+  return settings;
+}
+
+const AssembledProgram &IncrementalAssembler::assemble(const std::string &filename) {
+  incremental_ = false;
+  changed_words_.clear();
+
+  if (isElfFile(filename)) {
+    source_.reset();
+    program_ = ::assemble(filename);
+    return program_;
+  }
+
+  std::string text = readBinaryFile(filename);
+  if (source_ && filename==filename_ && currentSettings()==settings_) {
+    try {
+      incremental_ = assembleChanges(text);
+    } catch (const std::exception &) {
+      incremental_ = false;
+    }
+  }
+  if (!incremental_) {
+    changed_words_.clear();
+    assembleAll(filename, std::move(text));
+  }
+  return program_;
+}
+
+void IncrementalAssembler::assembleAll(const std::string &filename, std::string text) {
+  // Nothing is kept from a failed assembly, so the next call starts over
+  source_.reset();
+  filename_ = filename;
+  settings_ = currentSettings();
+
+  auto source = std::make_unique<SourceFile>(filename, text);
+  Lexer lexer(filename, std::move(text));
+  Parser parser(lexer.getSource(), lexer.getTokenList());
+  parser.parse();
+  if (parser.getErrorCount()!=0) {
+    reportParseErrors(parser, filename);
+  }
+
+  program_ = buildProgram(parser, filename);
+  DumpDisasssembly(globals::disassembly_file_path, program_);
+  DumpNoErrors(globals::errors_dump_file_path);
+
+  instruction_lines_.clear();
+  instruction_lines_.reserve(program_.intermediate_code.size());
+  for (const auto &[instruction, line] : program_.instruction_number_line_number_mapping) {
+    instruction_lines_.push_back(line);
+  }
+  data_references_ = parser.getRelocations();
+  source_ = std::move(source);
+}
+
+bool IncrementalAssembler::assembleChanges(std::string text) {
+  auto source = std::make_unique<SourceFile>(filename_, std::move(text));
+  const SourceFile &old_source = *source_;
+  const unsigned int old_count = old_source.getLineCount();
+  const unsigned int new_count = source->getLineCount();
+
+  // The edit replaces old lines (prefix, old_end] with new lines (prefix, new_end]
+  unsigned int prefix = 0;
+  while (prefix < old_count && prefix < new_count
+         && old_source.getLine(prefix + 1)==source->getLine(prefix + 1)) {
+    ++prefix;
+  }
+  unsigned int suffix = 0;
+  while (suffix < old_count - prefix && suffix < new_count - prefix
+         && old_source.getLine(old_count - suffix)==source->getLine(new_count - suffix)) {
+    ++suffix;
+  }
+  const unsigned int old_end = old_count - suffix;
+  const unsigned int new_end = new_count - suffix;
+
+  for (unsigned int line = prefix + 1; line <= old_end; ++line) {
+    if (!isInstructionLine(old_source.getLine(line))) {
+      return false;
+    }
+  }
+  for (unsigned int line = prefix + 1; line <= new_end; ++line) {
+    if (!isInstructionLine(source->getLine(line))) {
+      return false;
+    }
+  }
+  if ((old_end > prefix || new_end > prefix) && !isInTextSection(*source, prefix)) {
+    return false;
+  }
+
+  // Parse the new lines at their own line numbers; every label they use is left as a relocation
+  std::string snippet(prefix, '\n');
+  for (unsigned int line = prefix + 1; line <= new_end; ++line) {
+    snippet.append(source->getLine(line));
+    snippet.push_back('\n');
+  }
+  Lexer lexer(filename_, std::move(snippet));
+  Parser parser(lexer.getSource(), lexer.getTokenList());
+  parser.setRelocatable(true);
+  parser.parse();
+  if (parser.getErrorCount()!=0 || parser.getDataSize()!=0 || !parser.getSymbolTable().empty()) {
+    return false;
+  }
+  const std::vector<std::pair<ICUnit, bool>> &code = parser.getIntermediateCode();
+  std::vector<uint32_t> words = generateMachineCode(code);
+
+  const auto first = static_cast<size_t>(
+      std::lower_bound(instruction_lines_.begin(), instruction_lines_.end(), prefix + 1) - instruction_lines_.begin());
+  const auto removed = static_cast<size_t>(
+      std::lower_bound(instruction_lines_.begin() + first, instruction_lines_.end(), old_end + 1)
+      - (instruction_lines_.begin() + first));
+  const size_t added = code.size();
+  const size_t after = first + added; // first instruction after the edit, in the new program
+  const auto delta = static_cast<int64_t>(added) - static_cast<int64_t>(removed);
+  const auto line_delta = static_cast<int64_t>(new_end) - static_cast<int64_t>(old_end);
+
+  std::vector<uint32_t> old_text = program_.text_buffer;
+
+  // Splice the new instructions in; the ones after the edit move down by delta
+  program_.text_buffer.erase(program_.text_buffer.begin() + first, program_.text_buffer.begin() + first + removed);
+  program_.text_buffer.insert(program_.text_buffer.begin() + first, words.begin(), words.end());
+
+  std::vector<std::pair<ICUnit, bool>> &intermediate_code = program_.intermediate_code;
+  intermediate_code.erase(intermediate_code.begin() + first, intermediate_code.begin() + first + removed);
+  intermediate_code.insert(intermediate_code.begin() + first, code.begin(), code.end());
+  for (size_t index = first; index < after; ++index) {
+    intermediate_code[index].first.relabel(parser.getLabels(), program_.labels);
+  }
+
+  instruction_lines_.erase(instruction_lines_.begin() + first, instruction_lines_.begin() + first + removed);
+  instruction_lines_.insert(instruction_lines_.begin() + first, added, 0);
+  for (size_t index = first; index < intermediate_code.size(); ++index) {
+    ICUnit &block = intermediate_code[index].first;
+    block.setInstructionIndex(static_cast<unsigned int>(index));
+    if (index >= after) {
+      block.setLineNumber(static_cast<unsigned int>(block.getLineNumber() + line_delta));
+    }
+    instruction_lines_[index] = block.getLineNumber();
+  }
+
+  // Labels are never on the edited lines, so everything defined after them moves with the text
+  for (auto &[name, symbol] : program_.symbol_table) {
+    if (symbol.line_number > prefix) {
+      symbol.line_number += line_delta;
+      if (!symbol.isData) {
+        symbol.address += delta*4;
+      }
+    }
+  }
+
+  const uint64_t data_section_start = vm_config::current().getDataSectionStart();
+  auto resolve = [&](size_t index, RelocationType type, const std::string &name) {
+    auto symbol = program_.symbol_table.find(name);
+    if (symbol==program_.symbol_table.end()
+        || symbol->second.isData!=(type==RelocationType::kPcrelHiLo)) {
+      return false;
+    }
+    uint64_t target = symbol->second.address + (symbol->second.isData ? data_section_start : 0);
+    return applyRelocation(program_, index, type, static_cast<int64_t>(target - index*4));
+  };
+
+  std::vector<Relocation> data_references;
+  data_references.reserve(data_references_.size() + parser.getRelocations().size());
+  for (const Relocation &reference : data_references_) {
+    if (reference.instruction_index < first) {
+      data_references.push_back(reference);
+    }
+  }
+  for (Relocation relocation : parser.getRelocations()) {
+    relocation.instruction_index += static_cast<unsigned int>(first);
+    if (!resolve(relocation.instruction_index, relocation.type, relocation.symbol)) {
+      return false;
+    }
+    if (relocation.type==RelocationType::kPcrelHiLo) {
+      data_references.push_back(std::move(relocation));
+    }
+  }
+  for (const Relocation &reference : data_references_) {
+    if (reference.instruction_index >= first + removed) {
+      data_references.push_back(reference);
+      data_references.back().instruction_index += static_cast<unsigned int>(delta);
+      if (delta!=0 && !resolve(data_references.back().instruction_index, reference.type, reference.symbol)) {
+        return false;
+      }
+    }
+  }
+  data_references_ = std::move(data_references);
+
+  // A branch or jump outside the edit changes offset only if the edit lies between it and its target
+  if (delta!=0) {
+    for (size_t index = 0; index < intermediate_code.size(); ++index) {
+      const ICUnit &block = intermediate_code[index].first;
+      if ((index >= first && index < after) || !block.hasLabel()) {
+        continue;
+      }
+      auto symbol = program_.symbol_table.find(block.getLabel(program_.labels));
+      if (symbol==program_.symbol_table.end()) {
+        return false;
+      }
+      if ((index >= after)==(symbol->second.line_number > prefix)) {
+        continue;
+      }
+      RelocationType type = block.getInstructionInfo()->format==instruction_set::InstructionFormat::B
+                            ? RelocationType::kBranch : RelocationType::kJal;
+      if (!resolve(index, type, block.getLabel(program_.labels))) {
+        return false;
+      }
+    }
+  }
+
+  program_.instruction_number_line_number_mapping.clear();
+  for (size_t index = 0; index < instruction_lines_.size(); ++index) {
+    program_.instruction_number_line_number_mapping.emplace_hint(
+        program_.instruction_number_line_number_mapping.end(), static_cast<unsigned int>(index),
+        instruction_lines_[index]);
+  }
+  program_.line_number_instruction_number_mapping =
+      buildLineNumberInstructionNumberMapping(program_.instruction_number_line_number_mapping);
+
+  for (size_t index = 0; index < program_.text_buffer.size(); ++index) {
+    if (index >= old_text.size() || old_text[index]!=program_.text_buffer[index]) {
+      changed_words_.push_back(static_cast<unsigned int>(index));
+    }
+  }
+
+  DumpDisasssembly(globals::disassembly_file_path, program_);
+  DumpNoErrors(globals::errors_dump_file_path);
+  source_ = std::move(source);
+  return true;
+}
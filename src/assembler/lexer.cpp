@@ -11,28 +11,46 @@
 #include "vm/registers.h"
 #include"common/rounding_modes.h"
 
+#include <charconv>
+#include <cstring>
+#include <cstdint>
 #include <utility>
 #include <string>
 #include <stdexcept>
-#include <regex>
 #include <iostream>
-#include <fstream>
 
-Lexer::Lexer(std::string filename) : filename_(std::move(filename)), line_number_(0), column_number_(0), pos_(0) {
-  input_.open(filename_);
-  if (!input_) {
-    throw std::runtime_error("Failed to open file: " + filename_);
+namespace {
+
+// Value of a digit in bases up to 16, or 16 for anything else
+unsigned int digitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return static_cast<unsigned int>(c - '0');
+  }
+  char lower = static_cast<char>(c | 0x20);
+  if (lower >= 'a' && lower <= 'f') {
+    return static_cast<unsigned int>(lower - 'a' + 10);
   }
+  return 16;
+}
+
+// Characters the lexer treats as part of a numeric literal
+bool isNumberChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c=='.' || c=='-' || c=='+';
 }
 
+} // namespace
+
+Lexer::Lexer(std::string filename) : source_(std::move(filename)), line_number_(0), column_number_(0), pos_(0) {}
+
+Lexer::Lexer(std::string filename, std::string text)
+    : source_(std::move(filename), std::move(text)), line_number_(0), column_number_(0), pos_(0) {}
+
 std::string Lexer::getFilename() const {
-  return filename_;
+  return source_.getFilename();
 }
 
-Lexer::~Lexer() {
-  if (input_.is_open()) {
-    input_.close();
-  }
+const SourceFile &Lexer::getSource() const {
+  return source_;
 }
 
 void Lexer::skipWhitespace() {
@@ -83,12 +101,10 @@ Token Lexer::identifier() {
     ++pos_;
     ++column_number_;
   }
-  std::string value = current_line_.substr(start_pos, pos_ - start_pos);
-
-  std::regex label_regex("^[a-zA-Z][a-zA-Z0-9_]*:$");
+  std::string_view value = current_line_.substr(start_pos, pos_ - start_pos);
 
   if (pos_ < current_line_.size() && current_line_[pos_]==':') {
-    if (value.find('.')!=std::string::npos) {
+    if (value.find('.')!=std::string_view::npos) {
       ++pos_;
       ++column_number_;
       return {TokenType::INVALID, value, line_number_, start_column};
@@ -118,7 +134,7 @@ Token Lexer::identifier() {
   if (pos_ < current_line_.size() && current_line_[pos_]==':') {
     return {TokenType::LABEL, value, line_number_, start_column};
   }
-  if (!tokens_.empty() && tokens_.back().type==TokenType::COMMA) {
+  if (after_comma_) {
     return {TokenType::LABEL_REF, value, line_number_, start_column};
   }
 
@@ -129,145 +145,111 @@ Token Lexer::identifier() {
 }
 
 Token Lexer::number() {
-  unsigned int start_pos = pos_;
-  unsigned int start_column = column_number_;
+  const size_t start_pos = pos_;
+  const unsigned int start_column = column_number_;
+  const char *line = current_line_.data();
+  const size_t size = current_line_.size();
+  size_t p = pos_;
+
+  bool is_negative = line[p]=='-';
+  if (is_negative) {
+    ++p;
+  }
 
-  while (pos_ < current_line_.size()
-      && (std::isdigit(current_line_[pos_])
-          || std::isalpha(current_line_[pos_])
-          || current_line_[pos_]=='-'
-          || current_line_[pos_]=='x'
-          || current_line_[pos_]=='X'
-          || current_line_[pos_]=='o'
-          || current_line_[pos_]=='O'
-          || current_line_[pos_]=='0'
-          || current_line_[pos_]=='b'
-          || current_line_[pos_]=='B'
-          || current_line_[pos_]=='.'
-          || current_line_[pos_]=='e'
-          || current_line_[pos_]=='E'
-          || current_line_[pos_]=='+')) {
-    ++pos_;
-    ++column_number_;
+  unsigned int base = 10;
+  if (p + 1 < size && line[p]=='0') {
+    char prefix = static_cast<char>(line[p + 1] | 0x20);
+    if (prefix=='x') {
+      base = 16;
+    } else if (prefix=='b') {
+      base = 2;
+    } else if (prefix=='o') {
+      base = 8;
+    }
+    if (base!=10) {
+      p += 2;
+    }
   }
 
-  std::string value = current_line_.substr(start_pos, pos_ - start_pos);
-
-  std::regex hex_regex("^-?0[xX][0-9a-fA-F]+$");
-  std::regex binary_regex("^-?0[bB][01]+$");
-  std::regex octal_regex("^-?0[oO][0-7]+$");
-  std::regex decimal_regex("^-?[0-9]+$");
-  std::regex float_regex("^-?[0-9]*\\.[0-9]+([eE][-+]?[0-9]+)?$|^-?[0-9]+[eE][-+]?[0-9]+$");
-
-  if (std::regex_match(value, hex_regex)) {
-    bool is_negative = value[0]=='-';
-    value = (is_negative ? "-" : "") + value.substr(is_negative ? 3 : 2);
-    return {TokenType::NUM, std::to_string(std::stoll(value, nullptr, 16)), line_number_, start_column};
-  } else if (std::regex_match(value, binary_regex)) {
-    bool is_negative = value[0]=='-';
-    value = (is_negative ? "-" : "") + value.substr(is_negative ? 3 : 2);
-    return {TokenType::NUM, std::to_string(std::stoll(value, nullptr, 2)), line_number_, start_column};
-  } else if (std::regex_match(value, octal_regex)) {
-    bool is_negative = value[0]=='-';
-    value = (is_negative ? "-" : "") + value.substr(is_negative ? 3 : 2);
-    return {TokenType::NUM, std::to_string(std::stoll(value, nullptr, 8)), line_number_, start_column};
-  } else if (std::regex_match(value, decimal_regex)) {
-    return {TokenType::NUM, std::to_string(std::stoll(value, nullptr, 10)), line_number_, start_column};
-  } else if (std::regex_match(value, float_regex)) {
-
-    return {TokenType::FLOAT, std::to_string(std::stod(value)), line_number_, start_column};
-  }
-
-  return {TokenType::INVALID, "Invalid", line_number_, start_column};
-
-  /*
-      The below code is for character by character parsing of numbers.
-      The code is given for reference and is not used in the current implementation.
-      The regex based implementation, although slower, is more robust and easier to understand.
-      It is recommended to use character by character parsing in real world applications for better performance.
-  */
-  /*
-  {
-      size_t start_pos = pos_;
-      bool is_negative = false;
-
-      // Check for a leading minus sign
-      if (current_line_[pos_] == '-') {
-          is_negative = true;
-          ++start_pos;
-          ++pos_;
-          ++column_number_;
-
-          // Ensure there's a digit or a valid number after the minus sign
-          if (pos_ >= current_line_.size() ||
-              (!std::isdigit(current_line_[pos_]) && current_line_[pos_] != '0')) {
-              return Token(TokenType::INVALID, "-", line_number_, start_pos);
-          }
+  // Integer part, accumulated directly with overflow detection
+  const size_t digits_start = p;
+  uint64_t magnitude = 0;
+  bool overflow = false;
+  while (p < size) {
+    unsigned int digit = digitValue(line[p]);
+    if (digit >= base) {
+      break;
+    }
+    if (magnitude > (UINT64_MAX - digit)/base) {
+      overflow = true;
+    }
+    magnitude = magnitude*base + digit;
+    ++p;
+  }
+  const bool has_digits = p > digits_start;
+
+  // Decimal floats: [0-9]*.[0-9]+([eE][-+]?[0-9]+)? or [0-9]+[eE][-+]?[0-9]+
+  bool is_float = false;
+  if (base==10) {
+    size_t q = p;
+    bool has_fraction = false;
+    if (q < size && line[q]=='.') {
+      size_t r = q + 1;
+      while (r < size && std::isdigit(static_cast<unsigned char>(line[r]))) {
+        ++r;
       }
-
-      // Check for special number formats (hex, octal, binary)
-      if (current_line_[pos_] == '0' && pos_ + 1 < current_line_.size()) {
-          char next_char = current_line_[pos_ + 1];
-          if (next_char == 'x' || next_char == 'X') {  // Hexadecimal
-              pos_ += 2;  // Skip "0x"
-              column_number_ += 2;
-              while (pos_ < current_line_.size() &&
-                     (std::isdigit(current_line_[pos_]) ||
-                      (current_line_[pos_] >= 'a' && current_line_[pos_] <= 'f') ||
-                      (current_line_[pos_] >= 'A' && current_line_[pos_] <= 'F'))) {
-                  ++pos_;
-                  ++column_number_;
-              }
-              std::string value = current_line_.substr(start_pos, pos_ - start_pos);
-              if (is_negative) {
-                  value = "-" + value;
-              }
-              return Token(TokenType::HEX_NUM, value, line_number_, start_pos);
-          } else if (next_char == 'o' || next_char == 'O') {  // Octal
-              pos_ += 2;  // Skip "0o"
-              column_number_ += 2;
-              while (pos_ < current_line_.size() &&
-                     current_line_[pos_] >= '0' && current_line_[pos_] <= '7') {
-                  ++pos_;
-                  ++column_number_;
-              }
-              std::string value = current_line_.substr(start_pos, pos_ - start_pos);
-              if (is_negative) {
-                  value = "-" + value;
-              }
-              return Token(TokenType::OCTAL_NUM, value, line_number_, start_pos);
-          } else if (next_char == 'b' || next_char == 'B') {  // Binary
-              pos_ += 2;  // Skip "0b"
-              column_number_ += 2;
-              while (pos_ < current_line_.size() &&
-                     (current_line_[pos_] == '0' || current_line_[pos_] == '1')) {
-                  ++pos_;
-                  ++column_number_;
-              }
-              std::string value = current_line_.substr(start_pos, pos_ - start_pos);
-              if (is_negative) {
-                  value = "-" + value;
-              }
-              return Token(TokenType::BINARY_NUM, value, line_number_, start_pos);
-          }
+      if (r > q + 1) {
+        has_fraction = true;
+        q = r;
       }
-
-      // Parse decimal numbers
-      while (pos_ < current_line_.size() && std::isdigit(current_line_[pos_])) {
-          ++pos_;
-          ++column_number_;
+    }
+    bool has_exponent = false;
+    if ((has_digits || has_fraction) && q < size && (line[q] | 0x20)=='e') {
+      size_t r = q + 1;
+      if (r < size && (line[r]=='+' || line[r]=='-')) {
+        ++r;
       }
-
-      // Construct the value string, including the minus sign if necessary
-      std::string value = current_line_.substr(start_pos, pos_ - start_pos);
-      if (is_negative) {
-          value = "-" + value;
+      size_t exponent_start = r;
+      while (r < size && std::isdigit(static_cast<unsigned char>(line[r]))) {
+        ++r;
       }
+      if (r > exponent_start) {
+        has_exponent = true;
+        q = r;
+      }
+    }
+    if (has_fraction || (has_digits && has_exponent)) {
+      is_float = true;
+      p = q;
+    }
+  }
+
+  // Anything still number-like glued to the literal makes the whole token invalid
+  bool trailing = false;
+  while (p < size && isNumberChar(line[p])) {
+    trailing = true;
+    ++p;
+  }
 
-      return Token(TokenType::DECIMAL_NUM, value, line_number_, start_pos);
+  column_number_ += static_cast<unsigned int>(p - pos_);
+  pos_ = p;
+  Token token(TokenType::INVALID, current_line_.substr(start_pos, p - start_pos), line_number_, start_column);
+  if (trailing) {
+    return token;
   }
-  */
 
+  if (is_float) {
+    double value = 0.0;
+    auto result = std::from_chars(line + start_pos, line + p, value);
+    if (result.ec==std::errc() && result.ptr==line + p) {
+      token.type = TokenType::FLOAT;
+      token.float_value = value;
+    }
+  } else if (has_digits && !overflow) {
+    token.type = TokenType::NUM;
+    token.int_value = static_cast<int64_t>(is_negative ? 0 - magnitude : magnitude);
+  }
+  return token;
 }
 
 Token Lexer::directive() {
@@ -278,7 +260,7 @@ Token Lexer::directive() {
     ++pos_;
     ++column_number_;
   }
-  std::string value = current_line_.substr(start_pos, pos_ - start_pos);
+  std::string_view value = current_line_.substr(start_pos, pos_ - start_pos);
   return {TokenType::DIRECTIVE, value, line_number_, start_column};
 }
 
@@ -298,7 +280,7 @@ Token Lexer::stringLiteral() {
     return {TokenType::INVALID, "", line_number_, start_column};
   }
 
-  std::string value = current_line_.substr(start_pos, pos_ - start_pos);
+  std::string_view value = current_line_.substr(start_pos, pos_ - start_pos);
   ++pos_;
   ++column_number_;
   return {TokenType::STRING, value, line_number_, start_column};
@@ -343,21 +325,51 @@ Token Lexer::getNextToken() {
 
 }
 
-std::vector<Token> Lexer::getTokenList() {
-  while (std::getline(input_, current_line_)) {
-    pos_ = 0;
-    column_number_ = 1;
-    line_number_++;
-    while (pos_ < current_line_.size()) {
-      Token token = getNextToken();
-      if (token.type==TokenType::INVALID) {
-      }
-      if (/* token.type != TokenType::INVALID && */ token.type!=TokenType::EOF_) {
-        tokens_.push_back(token);
-      }
+bool Lexer::nextLine() {
+  // Same line split as SourceFile::getLine, without building the line index
+  const std::string_view text = source_.getText();
+  if (next_line_offset_ >= text.size()) {
+    return false;
+  }
+  const void *newline = std::memchr(text.data() + next_line_offset_, '\n', text.size() - next_line_offset_);
+  size_t end = newline ? static_cast<size_t>(static_cast<const char *>(newline) - text.data()) : text.size();
+  current_line_ = text.substr(next_line_offset_, end - next_line_offset_);
+  next_line_offset_ = end + 1;
+  pos_ = 0;
+  column_number_ = 1;
+  line_number_++;
+  return true;
+}
+
+template <typename Tokens>
+void Lexer::tokenizeLine(Tokens &tokens) {
+  while (pos_ < current_line_.size()) {
+    Token token = getNextToken();
+    if (/* token.type != TokenType::INVALID && */ token.type!=TokenType::EOF_) {
+      after_comma_ = token.type==TokenType::COMMA;
+      tokens.push_back(token);
     }
   }
+}
+
+std::vector<Token> Lexer::getTokenList() {
+  while (nextLine()) {
+    tokenizeLine(tokens_);
+  }
 
   tokens_.emplace_back(TokenType::EOF_, "", line_number_, column_number_);
-  return tokens_;
+  return std::move(tokens_);
+}
+
+bool Lexer::lexLine(std::deque<Token> &tokens) {
+  if (nextLine()) {
+    tokenizeLine(tokens);
+    return true;
+  }
+  if (at_end_) {
+    return false;
+  }
+  at_end_ = true;
+  tokens.emplace_back(TokenType::EOF_, "", line_number_, column_number_);
+  return true;
 }
@@ -0,0 +1,228 @@
+/**
+ * @file linker.cpp
+ * @brief Symbol resolution and relocation of assembled objects.
+ */
+
+#include "assembler/linker.h"
+#include "config.h"
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint64_t kDataUnitAlignment = 8;
+
+struct ExportedSymbol {
+  size_t object; ///< Index of the defining object.
+  SymbolData symbol; ///< The definition, relative to that object.
+};
+
+std::string location(const ObjectFile &object, unsigned int instruction_index) {
+  auto line = object.instruction_number_line_number_mapping.find(instruction_index);
+  if (line==object.instruction_number_line_number_mapping.end()) {
+    return object.filename;
+  }
+  return object.filename + ":" + std::to_string(line->second);
+}
+
+uint32_t encodeBTypeOffset(int64_t offset) {
+  auto imm = static_cast<uint32_t>(offset);
+  return ((imm >> 12) & 0x1) << 31
+      | ((imm >> 5) & 0x3F) << 25
+      | ((imm >> 1) & 0xF) << 8
+      | ((imm >> 11) & 0x1) << 7;
+}
+
+uint32_t encodeJTypeOffset(int64_t offset) {
+  auto imm = static_cast<uint32_t>(offset);
+  return ((imm >> 20) & 0x1) << 31
+      | ((imm >> 1) & 0x3FF) << 21
+      | ((imm >> 11) & 0x1) << 20
+      | ((imm >> 12) & 0xFF) << 12;
+}
+
+// Upper 20 bits of an auipc/I-type pair, rounded so that the signed low 12 bits make up the rest
+int32_t pcrelHi20(int64_t offset) {
+  return static_cast<int32_t>((offset + 0x800) >> 12);
+}
+
+} // namespace
+
+bool patchRelocation(std::span<uint32_t> words, RelocationType type, int64_t offset) {
+  switch (type) {
+    case RelocationType::kBranch: {
+      if (offset < -4096 || offset > 4095) {
+        return false;
+      }
+      words[0] = (words[0] & 0x01FFF07F) | encodeBTypeOffset(offset);
+      break;
+    }
+    case RelocationType::kJal: {
+      if (offset < -1048576 || offset > 1048575) {
+        return false;
+      }
+      words[0] = (words[0] & 0x00000FFF) | encodeJTypeOffset(offset);
+      break;
+    }
+    case RelocationType::kPcrelHiLo: {
+      if (offset < INT32_MIN || offset > INT32_MAX - 0x800) {
+        return false;
+      }
+      int32_t hi20 = pcrelHi20(offset);
+      auto lo12 = static_cast<int32_t>(offset - (static_cast<int64_t>(hi20) << 12));
+      words[0] = (words[0] & 0x00000FFF) | (static_cast<uint32_t>(hi20) << 12);
+      words[1] = (words[1] & 0x000FFFFF) | (static_cast<uint32_t>(lo12) << 20);
+      break;
+    }
+  }
+  return true;
+}
+
+bool applyRelocation(AssembledProgram &program, size_t index, RelocationType type, int64_t offset) {
+  if (!patchRelocation(std::span<uint32_t>(program.text_buffer).subspan(index), type, offset)) {
+    return false;
+  }
+  if (type==RelocationType::kPcrelHiLo) {
+    int32_t hi20 = pcrelHi20(offset);
+    program.intermediate_code[index].first.setImm(hi20);
+    program.intermediate_code[index + 1].first.setImm(offset - (static_cast<int64_t>(hi20) << 12));
+  } else {
+    program.intermediate_code[index].first.setImm(offset);
+  }
+  return true;
+}
+
+AssembledProgram linkObjects(const std::vector<ObjectFile> &objects) {
+  AssembledProgram program;
+  if (objects.empty()) {
+    return program;
+  }
+  program.filename = objects.front().filename;
+  program.source_files.reserve(objects.size());
+
+  // Layout
+  std::vector<uint64_t> text_base(objects.size());
+  std::vector<uint64_t> data_base(objects.size());
+  uint64_t text_size = 0;
+  uint64_t data_size = 0;
+  size_t data_entries = 0;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    data_size = (data_size + kDataUnitAlignment - 1) & ~(kDataUnitAlignment - 1);
+    text_base[i] = text_size;
+    data_base[i] = data_size;
+    text_size += objects[i].text_buffer.size()*4;
+    data_size += objects[i].data_size;
+    data_entries += objects[i].data_buffer.size() + kDataUnitAlignment;
+  }
+
+  std::unordered_map<std::string, ExportedSymbol> exports;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    for (const std::string &name : objects[i].global_symbols) {
+      auto local = objects[i].symbol_table.find(name);
+      if (local==objects[i].symbol_table.end()) {
+        continue; // .globl of a symbol defined elsewhere
+      }
+      auto [existing, inserted] = exports.try_emplace(name, ExportedSymbol{i, local->second});
+      if (!inserted) {
+        throw std::runtime_error("Multiple definition of '" + name + "' in " + objects[existing->second.object].filename
+                                 + " and " + objects[i].filename);
+      }
+    }
+  }
+
+  auto absolute = [&](size_t object, const SymbolData &symbol) {
+    return symbol.isData ? data_base[object] + symbol.address : text_base[object] + symbol.address;
+  };
+
+  // Concatenate sections
+  program.text_buffer.reserve(text_size/4);
+  program.intermediate_code.reserve(text_size/4);
+  program.data_buffer.reserve(data_entries);
+  uint64_t data_cursor = 0;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    const ObjectFile &object = objects[i];
+    const auto first_instruction = static_cast<unsigned int>(text_base[i]/4);
+    program.source_files.emplace_back(first_instruction, object.filename);
+    for (const auto &[instruction, line] : object.instruction_number_line_number_mapping) {
+      program.instruction_number_line_number_mapping.emplace_hint(program.instruction_number_line_number_mapping.end(),
+                                                                  first_instruction + instruction, line);
+    }
+    program.text_buffer.insert(program.text_buffer.end(), object.text_buffer.begin(), object.text_buffer.end());
+    for (const auto &[block, resolved] : object.intermediate_code) {
+      program.intermediate_code.emplace_back(block, resolved);
+      ICUnit &linked = program.intermediate_code.back().first;
+      linked.setInstructionIndex(block.getInstructionIndex() + first_instruction);
+      linked.relabel(object.labels, program.labels);
+    }
+    for (; data_cursor < data_base[i]; ++data_cursor) {
+      program.data_buffer.emplace_back(static_cast<uint8_t>(0));
+    }
+    program.data_buffer.insert(program.data_buffer.end(), object.data_buffer.begin(), object.data_buffer.end());
+    data_cursor += object.data_size;
+  }
+
+  for (const auto &[name, exported] : exports) {
+    SymbolData symbol = exported.symbol;
+    symbol.address = absolute(exported.object, symbol);
+    program.symbol_table.emplace(name, symbol);
+    program.global_symbols.insert(name);
+  }
+  // A local whose name is already taken, by an export or a local of an earlier object, is
+  // qualified with its object's file, so every object's labels stay in the symbol table
+  for (size_t i = 0; i < objects.size(); ++i) {
+    for (const auto &[name, local] : objects[i].symbol_table) {
+      if (exports.count(name) && exports.at(name).object==i) {
+        continue;
+      }
+      SymbolData symbol = local;
+      symbol.address = absolute(i, symbol);
+      if (program.symbol_table.try_emplace(name, symbol).second) {
+        continue;
+      }
+      std::string qualified = objects[i].filename + ":" + name;
+      if (program.symbol_table.count(qualified)) {
+        qualified += "#" + std::to_string(i);
+      }
+      program.symbol_table.emplace(std::move(qualified), symbol);
+    }
+  }
+
+  // Relocate
+  const uint64_t data_section_start = vm_config::current().getDataSectionStart();
+  for (size_t i = 0; i < objects.size(); ++i) {
+    const ObjectFile &object = objects[i];
+    for (const Relocation &relocation : object.relocations) {
+      size_t target_object = i;
+      const SymbolData *symbol = nullptr;
+      auto local = object.symbol_table.find(relocation.symbol);
+      if (local!=object.symbol_table.end()) {
+        symbol = &local->second;
+      } else if (auto exported = exports.find(relocation.symbol); exported!=exports.end()) {
+        target_object = exported->second.object;
+        symbol = &exported->second.symbol;
+      } else {
+        throw std::runtime_error("Undefined reference to '" + relocation.symbol + "' at "
+                                 + location(object, relocation.instruction_index));
+      }
+
+      uint64_t target = absolute(target_object, *symbol) + (symbol->isData ? data_section_start : 0);
+      size_t index = text_base[i]/4 + relocation.instruction_index;
+      auto offset = static_cast<int64_t>(target - index*4);
+
+      if (relocation.type==RelocationType::kBranch && symbol->isData) {
+        throw std::runtime_error("Branch to data symbol '" + relocation.symbol + "' at "
+                                 + location(object, relocation.instruction_index));
+      }
+      if (!applyRelocation(program, index, relocation.type, offset)) {
+        throw std::runtime_error("Relocation out of range for '" + relocation.symbol + "' at "
+                                 + location(object, relocation.instruction_index) + ": offset " + std::to_string(offset));
+      }
+    }
+  }
+
+  return program;
+}
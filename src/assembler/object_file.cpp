@@ -0,0 +1,87 @@
+/**
+ * @file object_file.cpp
+ * @brief Serialisation of relocatable objects.
+ *
+ * The format is a magic string followed by the fields of ObjectFile in declaration order,
+ * encoded with BinaryWriter.
+ */
+
+#include "assembler/object_file.h"
+#include "assembler/binary_stream.h"
+
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view kObjectMagic{"RVOBJ01\n"};
+
+} // namespace
+
+void writeObjectFile(const std::filesystem::path &filename, const ObjectFile &object) {
+  BinaryWriter writer;
+  writer.writeRaw(kObjectMagic);
+  writer.write(object.filename);
+  writer.write(object.text_buffer);
+  writer.write(object.intermediate_code, object.labels);
+  writer.write(object.instruction_number_line_number_mapping);
+  writer.write(object.data_size);
+  writer.write(object.data_buffer);
+  writer.write(object.symbol_table);
+
+  writer.write(static_cast<uint32_t>(object.global_symbols.size()));
+  for (const std::string &name : object.global_symbols) {
+    writer.write(name);
+  }
+
+  writer.write(static_cast<uint32_t>(object.relocations.size()));
+  for (const Relocation &relocation : object.relocations) {
+    writer.write(relocation.instruction_index);
+    writer.write(static_cast<uint8_t>(relocation.type));
+    writer.write(relocation.symbol);
+  }
+
+  writer.writeFile(filename);
+}
+
+ObjectFile readObjectFile(const std::filesystem::path &filename) {
+  std::string contents = readBinaryFile(filename);
+  if (!std::string_view(contents).starts_with(kObjectMagic)) {
+    throw std::runtime_error("Not an object file: " + filename.string());
+  }
+  BinaryReader reader(contents, filename.string());
+  reader.readRaw(kObjectMagic.size());
+
+  ObjectFile object;
+  object.filename = reader.readString();
+  reader.read(object.text_buffer);
+  reader.read(object.intermediate_code, object.labels);
+  reader.read(object.instruction_number_line_number_mapping);
+  object.data_size = reader.read<uint64_t>();
+  reader.read(object.data_buffer);
+  reader.read(object.symbol_table);
+
+  auto global_count = reader.read<uint32_t>();
+  for (uint32_t i = 0; i < global_count; ++i) {
+    object.global_symbols.push_back(reader.readString());
+  }
+
+  auto relocation_count = reader.read<uint32_t>();
+  for (uint32_t i = 0; i < relocation_count; ++i) {
+    Relocation relocation{};
+    relocation.instruction_index = reader.read<unsigned int>();
+    auto type = reader.read<uint8_t>();
+    if (type > static_cast<uint8_t>(RelocationType::kPcrelHiLo)) {
+      reader.fail();
+    }
+    relocation.type = static_cast<RelocationType>(type);
+    relocation.symbol = reader.readString();
+    object.relocations.push_back(std::move(relocation));
+  }
+
+  return object;
+}
+
+bool isObjectFile(const std::filesystem::path &filename) {
+  return filename.extension()==".o";
+}
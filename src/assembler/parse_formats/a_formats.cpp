@@ -0,0 +1,81 @@
+/**
+ * @file a_formats.cpp
+ * @brief Operand syntaxes of the A extension: lr, sc and the AMOs
+ */
+
+#include "assembler/parser.h"
+#include "common/instructions.h"
+#include "vm/registers.h"
+#include "utils.h"
+
+#include <string>
+
+// lr.w/lr.d rd, (rs1)
+bool Parser::parse_O_GPR_C_LP_GPR_RP() {
+  if (peekToken(1).line_number==currentToken().line_number
+      && peekToken(1).type==TokenType::GP_REGISTER
+      && peekToken(2).line_number==currentToken().line_number
+      && peekToken(2).type==TokenType::COMMA
+      && peekToken(3).line_number==currentToken().line_number
+      && peekToken(3).type==TokenType::LPAREN
+      && peekToken(4).line_number==currentToken().line_number
+      && peekToken(4).type==TokenType::GP_REGISTER
+      && peekToken(5).line_number==currentToken().line_number
+      && peekToken(5).type==TokenType::RPAREN
+      && (peekToken(6).type==TokenType::EOF_ || peekToken(6).line_number!=currentToken().line_number)
+      ) {
+    ICUnit block;
+    block.setOpcode(currentToken().value);
+    block.setLineNumber(currentToken().line_number);
+    block.setInstructionIndex(instruction_index_);
+    std::string reg;
+
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
+    block.setRd(reg);
+    reg = reg_alias_to_name.at(std::string(peekToken(4).value));
+    block.setRs1(reg);
+
+    skipCurrentLine();
+    emitInstruction(block, true);
+    return true;
+  }
+  return false;
+}
+
+// sc.w/sc.d and the AMOs: rd, rs2, (rs1)
+bool Parser::parse_O_GPR_C_GPR_C_LP_GPR_RP() {
+  if (peekToken(1).line_number==currentToken().line_number
+      && peekToken(1).type==TokenType::GP_REGISTER
+      && peekToken(2).line_number==currentToken().line_number
+      && peekToken(2).type==TokenType::COMMA
+      && peekToken(3).line_number==currentToken().line_number
+      && peekToken(3).type==TokenType::GP_REGISTER
+      && peekToken(4).line_number==currentToken().line_number
+      && peekToken(4).type==TokenType::COMMA
+      && peekToken(5).line_number==currentToken().line_number
+      && peekToken(5).type==TokenType::LPAREN
+      && peekToken(6).line_number==currentToken().line_number
+      && peekToken(6).type==TokenType::GP_REGISTER
+      && peekToken(7).line_number==currentToken().line_number
+      && peekToken(7).type==TokenType::RPAREN
+      && (peekToken(8).type==TokenType::EOF_ || peekToken(8).line_number!=currentToken().line_number)
+      ) {
+    ICUnit block;
+    block.setOpcode(currentToken().value);
+    block.setLineNumber(currentToken().line_number);
+    block.setInstructionIndex(instruction_index_);
+    std::string reg;
+
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
+    block.setRd(reg);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
+    block.setRs2(reg);
+    reg = reg_alias_to_name.at(std::string(peekToken(6).value));
+    block.setRs1(reg);
+
+    skipCurrentLine();
+    emitInstruction(block, true);
+    return true;
+  }
+  return false;
+}
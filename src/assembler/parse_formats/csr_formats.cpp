@@ -31,17 +31,15 @@ bool Parser::parse_O_GPR_C_CSR_C_GPR() {
     block.setInstructionIndex(instruction_index_);
     std::string reg;
 
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    uint32_t csr_value = csr_to_address.at(peekToken(3).value);
+    uint32_t csr_value = csr_to_address.at(std::string(peekToken(3).value));
     block.setCsr(csr_value);
-    reg = reg_alias_to_name.at(peekToken(5).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(5).value));
     block.setRs1(reg);
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -66,13 +64,13 @@ bool Parser::parse_O_GPR_C_CSR_C_I() {
     block.setInstructionIndex(instruction_index_);
     std::string reg;
 
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    uint32_t csr_value = csr_to_address.at(peekToken(3).value);
+    uint32_t csr_value = csr_to_address.at(std::string(peekToken(3).value));
     block.setCsr(csr_value);
-    int64_t imm = std::stoll(peekToken(5).value);
+    int64_t imm = peekToken(5).int_value;
     if (0 <= imm && imm <= 31) {
-      block.setImm(std::to_string(imm));
+      block.setImm(imm);
     } else {
       errors_.count++;
       recordError(ParseError(peekToken(5).line_number, "Immediate value out of range"));
@@ -81,16 +79,13 @@ bool Parser::parse_O_GPR_C_CSR_C_I() {
                                                                        filename_,
                                                                        peekToken(5).line_number,
                                                                        peekToken(5).column_number,
-                                                                       GetLineFromFile(filename_,
-                                                                                       peekToken(5).line_number)));
+                                                                       getSourceLine(peekToken(5).line_number)));
       skipCurrentLine();
       return true;
     }
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -34,19 +34,17 @@ bool Parser::parse_O_FPR_C_FPR_C_FPR_C_FPR() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
-    reg = reg_alias_to_name.at(peekToken(5).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(5).value));
     block.setRs2(reg);
-    reg = reg_alias_to_name.at(peekToken(7).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(7).value));
     block.setRs3(reg);
     block.setRm(0b111);
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -78,23 +76,21 @@ bool Parser::parse_O_FPR_C_FPR_C_FPR_C_FPR_C_RM() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
-    reg = reg_alias_to_name.at(peekToken(5).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(5).value));
     block.setRs2(reg);
-    reg = reg_alias_to_name.at(peekToken(7).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(7).value));
     block.setRs3(reg);
 
-    std::string rm = peekToken(9).value;
+    std::string rm(peekToken(9).value);
     uint8_t rmEncoding = getRoundingModeEncoding(rm);
     block.setRm(rmEncoding);
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -118,17 +114,15 @@ bool Parser::parse_O_FPR_C_FPR_C_FPR() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
-    reg = reg_alias_to_name.at(peekToken(5).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(5).value));
     block.setRs2(reg);
     block.setRm(0b111);
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -156,21 +150,19 @@ bool Parser::parse_O_FPR_C_FPR_C_FPR_C_RM() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
-    reg = reg_alias_to_name.at(peekToken(5).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(5).value));
     block.setRs2(reg);
 
-    std::string rm = peekToken(7).value;
+    std::string rm(peekToken(7).value);
     uint8_t rmEncoding = getRoundingModeEncoding(rm);
     block.setRm(rmEncoding);
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -190,15 +182,13 @@ bool Parser::parse_O_FPR_C_FPR() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
     block.setRm(0b111);
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -222,19 +212,17 @@ bool Parser::parse_O_FPR_C_FPR_C_RM() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
 
-    std::string rm = peekToken(5).value;
+    std::string rm(peekToken(5).value);
     uint8_t rmEncoding = getRoundingModeEncoding(rm);
     block.setRm(rmEncoding);
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -254,15 +242,13 @@ bool Parser::parse_O_FPR_C_GPR() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
     block.setRm(0b111);
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -286,19 +272,17 @@ bool Parser::parse_O_FPR_C_GPR_C_RM() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
 
-    std::string rm = peekToken(5).value;
+    std::string rm(peekToken(5).value);
     uint8_t rmEncoding = getRoundingModeEncoding(rm);
     block.setRm(rmEncoding);
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -318,15 +302,13 @@ bool Parser::parse_O_GPR_C_FPR() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
     block.setRm(0b111);
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -350,19 +332,17 @@ bool Parser::parse_O_GPR_C_FPR_C_RM() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
 
-    std::string rm = peekToken(5).value;
+    std::string rm(peekToken(5).value);
     uint8_t rmEncoding = getRoundingModeEncoding(rm);
     block.setRm(rmEncoding);
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -386,16 +366,14 @@ bool Parser::parse_O_GPR_C_FPR_C_FPR() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
-    reg = reg_alias_to_name.at(peekToken(5).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(5).value));
     block.setRs2(reg);
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -423,11 +401,11 @@ bool Parser::parse_O_FPR_C_I_LP_GPR_RP() {
     std::string reg;
 
     if (instruction_set::isValidFDITypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      int64_t imm = std::stoll(peekToken(3).value);
+      int64_t imm = peekToken(3).int_value;
       if (-2048 <= imm && imm <= 2047) {
-        block.setImm(std::to_string(imm));
+        block.setImm(imm);
       } else {
         errors_.count++;
         recordError(ParseError(peekToken(3).line_number, "Immediate value out of range"));
@@ -436,19 +414,18 @@ bool Parser::parse_O_FPR_C_I_LP_GPR_RP() {
                                                                          filename_,
                                                                          peekToken(3).line_number,
                                                                          peekToken(3).column_number,
-                                                                         GetLineFromFile(filename_,
-                                                                                         peekToken(3).line_number)));
+                                                                         getSourceLine(peekToken(3).line_number)));
         skipCurrentLine();
         return true;
       }
-      reg = reg_alias_to_name.at(peekToken(5).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(5).value));
       block.setRs1(reg);
     } else if (instruction_set::isValidFDSTypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRs2(reg);
-      int64_t imm = std::stoll(peekToken(3).value);
+      int64_t imm = peekToken(3).int_value;
       if (-2048 <= imm && imm <= 2047) {
-        block.setImm(std::to_string(imm));
+        block.setImm(imm);
       } else {
         errors_.count++;
         recordError(ParseError(peekToken(3).line_number, "Immediate value out of range"));
@@ -457,19 +434,16 @@ bool Parser::parse_O_FPR_C_I_LP_GPR_RP() {
                                                                          filename_,
                                                                          peekToken(3).line_number,
                                                                          peekToken(3).column_number,
-                                                                         GetLineFromFile(filename_,
-                                                                                         peekToken(3).line_number)));
+                                                                         getSourceLine(peekToken(3).line_number)));
         skipCurrentLine();
         return true;
       }
-      reg = reg_alias_to_name.at(peekToken(5).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(5).value));
       block.setRs1(reg);
     }
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
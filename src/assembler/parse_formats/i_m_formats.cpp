@@ -19,9 +19,7 @@ bool Parser::parse_O() {
     block.setLineNumber(currentToken().line_number);
     block.setInstructionIndex(instruction_index_);
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -46,17 +44,15 @@ bool Parser::parse_O_GPR_C_GPR_C_GPR() {
     block.setInstructionIndex(instruction_index_);
 
     std::string reg;
-    reg = reg_alias_to_name.at(peekToken(1).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(1).value));
     block.setRd(reg);
-    reg = reg_alias_to_name.at(peekToken(3).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(3).value));
     block.setRs1(reg);
-    reg = reg_alias_to_name.at(peekToken(5).value);
+    reg = reg_alias_to_name.at(std::string(peekToken(5).value));
     block.setRs2(reg);
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -82,15 +78,15 @@ bool Parser::parse_O_GPR_C_GPR_C_I() {
     std::string reg;
 
     if (instruction_set::isValidITypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      reg = reg_alias_to_name.at(peekToken(3).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(3).value));
       block.setRs1(reg);
-      int64_t imm = std::stoll(peekToken(5).value);
+      int64_t imm = peekToken(5).int_value;
 
       if (instruction_set::isValidI2TypeInstruction(block.getOpcode())) {
         if (0 <= imm && imm <= 31) {
-          block.setImm(std::to_string(imm));
+          block.setImm(imm);
         } else {
           errors_.count++;
           recordError(ParseError(peekToken(5).line_number, "Immediate value out of range"));
@@ -101,7 +97,7 @@ bool Parser::parse_O_GPR_C_GPR_C_I() {
               filename_,
               peekToken(5).line_number,
               peekToken(5).column_number,
-              GetLineFromFile(filename_, peekToken(5).line_number)
+              getSourceLine(peekToken(5).line_number)
             )
           );
           skipCurrentLine();
@@ -109,7 +105,7 @@ bool Parser::parse_O_GPR_C_GPR_C_I() {
         }
       } else {
         if (-2048 <= imm && imm <= 2047) {
-          block.setImm(std::to_string(imm));
+          block.setImm(imm);
         } else {
           errors_.count++;
           recordError(ParseError(peekToken(5).line_number, "Immediate value out of range"));
@@ -118,22 +114,21 @@ bool Parser::parse_O_GPR_C_GPR_C_I() {
                                                                            filename_,
                                                                            peekToken(5).line_number,
                                                                            peekToken(5).column_number,
-                                                                           GetLineFromFile(filename_,
-                                                                                           peekToken(5).line_number)));
+                                                                           getSourceLine(peekToken(5).line_number)));
           skipCurrentLine();
           return true;
         }
       }
 
     } else if (instruction_set::isValidBTypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRs1(reg);
-      reg = reg_alias_to_name.at(peekToken(3).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(3).value));
       block.setRs2(reg);
-      int64_t imm = std::stoll(peekToken(5).value);
+      int64_t imm = peekToken(5).int_value;
       if (-4096 <= imm && imm <= 4095) {
         if (imm%4==0) {
-          block.setImm(std::to_string(imm));
+          block.setImm(imm);
         } else {
           errors_.count++;
           recordError(ParseError(peekToken(5).line_number, "Misaligned immediate value"));
@@ -142,8 +137,7 @@ bool Parser::parse_O_GPR_C_GPR_C_I() {
                                                                            filename_,
                                                                            peekToken(5).line_number,
                                                                            peekToken(5).column_number,
-                                                                           GetLineFromFile(filename_,
-                                                                                           peekToken(5).line_number)));
+                                                                           getSourceLine(peekToken(5).line_number)));
           skipCurrentLine();
           return true;
         }
@@ -155,16 +149,13 @@ bool Parser::parse_O_GPR_C_GPR_C_I() {
                                                                          filename_,
                                                                          peekToken(5).line_number,
                                                                          peekToken(5).column_number,
-                                                                         GetLineFromFile(filename_,
-                                                                                         peekToken(5).line_number)));
+                                                                         getSourceLine(peekToken(5).line_number)));
         skipCurrentLine();
         return true;
       }
     }
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -186,11 +177,11 @@ bool Parser::parse_O_GPR_C_I() {
     std::string reg;
 
     if (instruction_set::isValidUTypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      int64_t imm = std::stoll(peekToken(3).value);
+      int64_t imm = peekToken(3).int_value;
       if (0 <= imm && imm <= 1048575) {
-        block.setImm(std::to_string(imm));
+        block.setImm(imm);
       } else {
         errors_.count++;
         recordError(ParseError(peekToken(3).line_number, "Immediate value out of range"));
@@ -199,18 +190,17 @@ bool Parser::parse_O_GPR_C_I() {
                                                                          filename_,
                                                                          peekToken(3).line_number,
                                                                          peekToken(3).column_number,
-                                                                         GetLineFromFile(filename_,
-                                                                                         peekToken(3).line_number)));
+                                                                         getSourceLine(peekToken(3).line_number)));
         skipCurrentLine();
         return true;
       }
     } else if (instruction_set::isValidJTypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      int64_t imm = std::stoll(peekToken(3).value);
+      int64_t imm = peekToken(3).int_value;
       if (-1048576 <= imm && imm <= 1048575) {
         if (imm%2==0) {
-          block.setImm(std::to_string(imm));
+          block.setImm(imm);
         } else {
           errors_.count++;
           recordError(ParseError(peekToken(3).line_number, "Misaligned immediate value"));
@@ -219,8 +209,7 @@ bool Parser::parse_O_GPR_C_I() {
                                                                            filename_,
                                                                            peekToken(3).line_number,
                                                                            peekToken(3).column_number,
-                                                                           GetLineFromFile(filename_,
-                                                                                           peekToken(3).line_number)));
+                                                                           getSourceLine(peekToken(3).line_number)));
           skipCurrentLine();
           return true;
         }
@@ -232,17 +221,14 @@ bool Parser::parse_O_GPR_C_I() {
                                                                          filename_,
                                                                          peekToken(3).line_number,
                                                                          peekToken(3).column_number,
-                                                                         GetLineFromFile(filename_,
-                                                                                         peekToken(3).line_number)));
+                                                                         getSourceLine(peekToken(3).line_number)));
         skipCurrentLine();
         return true;
       }
     }
 
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -268,17 +254,17 @@ bool Parser::parse_O_GPR_C_GPR_C_IL() {
     std::string reg;
 
     if (instruction_set::isValidBTypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRs1(reg);
-      reg = reg_alias_to_name.at(peekToken(3).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(3).value));
       block.setRs2(reg);
-      if (symbol_table_.find(peekToken(5).value)!=symbol_table_.end()
-          && !symbol_table_[peekToken(5).value].isData) {
-        uint64_t address = symbol_table_[peekToken(5).value].address;
+      if (symbol_table_.find(std::string(peekToken(5).value))!=symbol_table_.end()
+          && !symbol_table_[std::string(peekToken(5).value)].isData) {
+        uint64_t address = symbol_table_[std::string(peekToken(5).value)].address;
         auto offset = static_cast<int64_t>(address - instruction_index_*4);
         if (-4096 <= offset && offset <= 4095) {
-          block.setImm(std::to_string(offset));
-          block.setLabel(peekToken(5).value);
+          block.setImm(offset);
+          block.setLabel(labels_, peekToken(5).value);
         } else {
           errors_.count++;
           recordError(ParseError(peekToken(5).line_number, "Immediate value out of range"));
@@ -287,25 +273,19 @@ bool Parser::parse_O_GPR_C_GPR_C_IL() {
                                                                            filename_,
                                                                            peekToken(5).line_number,
                                                                            peekToken(5).column_number,
-                                                                           GetLineFromFile(filename_,
-                                                                                           peekToken(5).line_number)));
+                                                                           getSourceLine(peekToken(5).line_number)));
           skipCurrentLine();
           return true;
         }
       } else {
-        back_patch_.push_back(instruction_index_);
-        block.setLabel(peekToken(5).value);
-        intermediate_code_.emplace_back(block, false);
-        instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-        instruction_index_++;
+        block.setLabel(labels_, peekToken(5).value);
+        emitInstruction(block, false);
         skipCurrentLine();
         return true;
       }
     }
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -330,15 +310,15 @@ bool Parser::parse_O_GPR_C_IL() {
     block.setInstructionIndex(instruction_index_);
     if (instruction_set::isValidJTypeInstruction(block.getOpcode())) {
       std::string reg;
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      if (symbol_table_.find(peekToken(3).value)!=symbol_table_.end()
-          && !symbol_table_[peekToken(3).value].isData) {
-        uint64_t address = symbol_table_[peekToken(3).value].address;
+      if (symbol_table_.find(std::string(peekToken(3).value))!=symbol_table_.end()
+          && !symbol_table_[std::string(peekToken(3).value)].isData) {
+        uint64_t address = symbol_table_[std::string(peekToken(3).value)].address;
         auto offset = static_cast<int64_t>(address - instruction_index_*4);
         if (-1048576 <= offset && offset <= 1048575) {
-          block.setImm(std::to_string(offset));
-          block.setLabel(peekToken(3).value);
+          block.setImm(offset);
+          block.setLabel(labels_, peekToken(3).value);
         } else {
           errors_.count++;
           recordError(ParseError(peekToken(3).line_number, "Immediate value out of range"));
@@ -347,25 +327,19 @@ bool Parser::parse_O_GPR_C_IL() {
                                                                            filename_,
                                                                            peekToken(3).line_number,
                                                                            peekToken(3).column_number,
-                                                                           GetLineFromFile(filename_,
-                                                                                           peekToken(3).line_number)));
+                                                                           getSourceLine(peekToken(3).line_number)));
           skipCurrentLine();
           return true;
         }
       } else {
-        back_patch_.push_back(instruction_index_);
-        block.setLabel(peekToken(3).value);
-        intermediate_code_.emplace_back(block, false);
-        instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-        instruction_index_++;
+        block.setLabel(labels_, peekToken(3).value);
+        emitInstruction(block, false);
         skipCurrentLine();
         return true;
       }
     }
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -380,9 +354,9 @@ bool Parser::parse_O_GPR_C_DL() {
       peekToken(3).type == TokenType::LABEL_REF &&
       (peekToken(4).type == TokenType::EOF_ || peekToken(4).line_number != currentToken().line_number)) {
 
-    std::string reg = reg_alias_to_name.at(peekToken(1).value);
-    std::string label = peekToken(3).value;
-    std::string opcode = currentToken().value;
+    std::string reg = reg_alias_to_name.at(std::string(peekToken(1).value));
+    std::string label(peekToken(3).value);
+    std::string opcode(currentToken().value);
 
     // if (opcode != "ld" && opcode != "lw" && opcode != "lh" && opcode != "lb") {
     //   errors_.count++;
@@ -394,14 +368,16 @@ bool Parser::parse_O_GPR_C_DL() {
     //       filename_,
     //       peekToken(3).line_number,
     //       peekToken(3).column_number,
-    //       GetLineFromFile(filename_, peekToken(3).line_number)
+    //       getSourceLine(peekToken(3).line_number)
     //     )
     //   );
     //   skipCurrentLine();
     //   return true;
     // }
 
-    if (symbol_table_.find(label) == symbol_table_.end() || !symbol_table_[label].isData) {
+    auto symbol = symbol_table_.find(label);
+    bool external = defersUndefinedSymbols() && symbol == symbol_table_.end();
+    if (!external && (symbol == symbol_table_.end() || !symbol->second.isData)) {
       errors_.count++;
       recordError(ParseError(peekToken(3).line_number, "Invalid label reference"));
       errors_.all_errors.emplace_back(
@@ -411,48 +387,51 @@ bool Parser::parse_O_GPR_C_DL() {
           filename_,
           peekToken(3).line_number,
           peekToken(3).column_number,
-          GetLineFromFile(filename_, peekToken(3).line_number)
+          getSourceLine(peekToken(3).line_number)
         )
       );
       skipCurrentLine();
       return true;
     }
 
-    uint64_t address = symbol_table_[label].address;
-    uint64_t data_section_start = vm_config::config.getDataSectionStart();
-    uint64_t symbol_addr = data_section_start + address;
-    uint64_t pc = instruction_index_ * 4;
-
-    int64_t offset = static_cast<int64_t>(symbol_addr) - static_cast<int64_t>(pc);
-    int32_t hi20 = (offset + 0x800) >> 12;
-    int32_t lo12 = offset - (hi20 << 12);
+    int32_t hi20 = 0;
+    int32_t lo12 = 0;
+    if (external || !sink_) {
+      relocations_.push_back({instruction_index_, RelocationType::kPcrelHiLo, label, currentToken().line_number});
+    }
+    if (!external && !relocatable_) {
+      uint64_t address = symbol->second.address;
+      uint64_t data_section_start = vm_config::current().getDataSectionStart();
+      uint64_t symbol_addr = data_section_start + address;
+      uint64_t pc = instruction_index_ * 4;
+
+      int64_t offset = static_cast<int64_t>(symbol_addr) - static_cast<int64_t>(pc);
+      hi20 = (offset + 0x800) >> 12;
+      lo12 = offset - (hi20 << 12);
+    }
 
     ICUnit auipc_instr;
     auipc_instr.setOpcode("auipc");
     auipc_instr.setLineNumber(currentToken().line_number);
     auipc_instr.setInstructionIndex(instruction_index_);
     auipc_instr.setRd(reg);
-    auipc_instr.setImm(std::to_string(hi20));
+    auipc_instr.setImm(hi20);
 
     ICUnit load_instr;
     load_instr.setOpcode(opcode);
     load_instr.setLineNumber(currentToken().line_number);
-    auipc_instr.setInstructionIndex(instruction_index_+1);
+    load_instr.setInstructionIndex(instruction_index_+1);
     load_instr.setRd(reg);
     load_instr.setRs1(reg);
-    load_instr.setImm(std::to_string(lo12));
+    load_instr.setImm(lo12);
 
     std::cout << "auipc " << reg << ", 0x" << std::hex << hi20 << std::dec << std::endl;
 
     std::cout << load_instr.getOpcode() << " " << reg << ", " << lo12 << "(" << reg << ")" << std::endl;
 
-    intermediate_code_.emplace_back(auipc_instr, true);
-    instruction_number_line_number_mapping_[instruction_index_] = auipc_instr.getLineNumber();
-    instruction_index_++;
+    emitInstruction(auipc_instr, true);
 
-    intermediate_code_.emplace_back(load_instr, true);
-    instruction_number_line_number_mapping_[instruction_index_] = load_instr.getLineNumber();
-    instruction_index_++;
+    emitInstruction(load_instr, true);
 
     skipCurrentLine();
     return true;
@@ -482,11 +461,11 @@ bool Parser::parse_O_GPR_C_I_LP_GPR_RP() {
     block.setInstructionIndex(instruction_index_);
     std::string reg;
     if (instruction_set::isValidITypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      int64_t imm = std::stoll(peekToken(3).value);
+      int64_t imm = peekToken(3).int_value;
       if (-2048 <= imm && imm <= 2047) {
-        block.setImm(std::to_string(imm));
+        block.setImm(imm);
       } else {
         errors_.count++;
         recordError(ParseError(peekToken(3).line_number, "Immediate value out of range"));
@@ -495,19 +474,18 @@ bool Parser::parse_O_GPR_C_I_LP_GPR_RP() {
                                                                          filename_,
                                                                          peekToken(3).line_number,
                                                                          peekToken(3).column_number,
-                                                                         GetLineFromFile(filename_,
-                                                                                         peekToken(3).line_number)));
+                                                                         getSourceLine(peekToken(3).line_number)));
         skipCurrentLine();
         return true;
       }
-      reg = reg_alias_to_name.at(peekToken(5).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(5).value));
       block.setRs1(reg);
     } else if (instruction_set::isValidSTypeInstruction(block.getOpcode())) {
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRs2(reg);
-      int64_t imm = std::stoll(peekToken(3).value);
+      int64_t imm = peekToken(3).int_value;
       if (-2048 <= imm && imm <= 2047) {
-        block.setImm(std::to_string(imm));
+        block.setImm(imm);
       } else {
         errors_.count++;
         recordError(ParseError(peekToken(3).line_number, "Immediate value out of range"));
@@ -516,18 +494,15 @@ bool Parser::parse_O_GPR_C_I_LP_GPR_RP() {
                                                                          filename_,
                                                                          peekToken(3).line_number,
                                                                          peekToken(3).column_number,
-                                                                         GetLineFromFile(filename_,
-                                                                                         peekToken(3).line_number)));
+                                                                         getSourceLine(peekToken(3).line_number)));
         skipCurrentLine();
         return true;
       }
-      reg = reg_alias_to_name.at(peekToken(5).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(5).value));
       block.setRs1(reg);
     }
     skipCurrentLine();
-    intermediate_code_.emplace_back(block, true);
-    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-    instruction_index_++;
+    emitInstruction(block, true);
     return true;
   }
   return false;
@@ -22,24 +22,35 @@ bool Parser::parse_pseudo() {
         && peekToken(3).type==TokenType::LABEL_REF
         && (peekToken(4).type==TokenType::EOF_ || peekToken(4).line_number!=currentToken().line_number)
         ) {
-      std::string reg = reg_alias_to_name.at(peekToken(1).value);
-      std::string label = peekToken(3).value;
+      std::string reg = reg_alias_to_name.at(std::string(peekToken(1).value));
+      std::string label(peekToken(3).value);
 
-      if (symbol_table_.find(label)!=symbol_table_.end() && symbol_table_[label].isData) {
-        uint64_t address = symbol_table_[label].address; // relative to data section (e.g., 0,8,16,...)
-        uint64_t data_section_start = vm_config::config.getDataSectionStart();
-        uint64_t symbol_addr = data_section_start + address;
-        uint64_t pc = instruction_index_ * 4;
-        int64_t offset = static_cast<int64_t>(symbol_addr) - static_cast<int64_t>(pc);
-        int32_t hi20 = (offset + 0x800) >> 12;
-        int32_t lo12 = offset - (hi20 << 12);
+      auto symbol = symbol_table_.find(label);
+      bool external = defersUndefinedSymbols() && symbol==symbol_table_.end();
+      if ((symbol!=symbol_table_.end() && symbol->second.isData) || external) {
+        int32_t hi20 = 0;
+        int32_t lo12 = 0;
+        // In a relocatable unit the data and text placement is decided by the linker;
+        // a streamed file only comes back to the labels it has not seen yet
+        if (external || !sink_) {
+          relocations_.push_back({instruction_index_, RelocationType::kPcrelHiLo, label, currentToken().line_number});
+        }
+        if (!external && !relocatable_) {
+          uint64_t address = symbol->second.address; // relative to data section (e.g., 0,8,16,...)
+          uint64_t data_section_start = vm_config::current().getDataSectionStart();
+          uint64_t symbol_addr = data_section_start + address;
+          uint64_t pc = instruction_index_ * 4;
+          int64_t offset = static_cast<int64_t>(symbol_addr) - static_cast<int64_t>(pc);
+          hi20 = (offset + 0x800) >> 12;
+          lo12 = offset - (hi20 << 12);
+        }
 
         ICUnit auipc_instr;
         auipc_instr.setOpcode("auipc");
         auipc_instr.setRd(reg);
         auipc_instr.setRs1("");
         auipc_instr.setRs2("");
-        auipc_instr.setImm(std::to_string(hi20));
+        auipc_instr.setImm(hi20);
         auipc_instr.setLineNumber(currentToken().line_number);
 
         // std::cout << "auipc " << reg << ", " << "0x" << std::hex << hi20 << std::dec << std::endl;
@@ -49,20 +60,16 @@ bool Parser::parse_pseudo() {
         addi_instr.setRd(reg);
         addi_instr.setRs1(reg);
         addi_instr.setRs2("");
-        addi_instr.setImm(std::to_string(lo12));
+        addi_instr.setImm(lo12);
         addi_instr.setLineNumber(currentToken().line_number);
 
         // std::cout << "addi " << reg << ", " << reg << ", " << lo12 << std::dec << std::endl;
 
         auipc_instr.setInstructionIndex(instruction_index_);
-        intermediate_code_.emplace_back(auipc_instr, true);
-        instruction_number_line_number_mapping_[instruction_index_] = auipc_instr.getLineNumber();
-        instruction_index_++;
+        emitInstruction(auipc_instr, true);
 
         addi_instr.setInstructionIndex(instruction_index_);
-        intermediate_code_.emplace_back(addi_instr, true);
-        instruction_number_line_number_mapping_[instruction_index_] = addi_instr.getLineNumber();
-        instruction_index_++;
+        emitInstruction(addi_instr, true);
       } else {
         errors_.count++;
         recordError(ParseError(currentToken().line_number, "Invalid label reference"));
@@ -73,7 +80,7 @@ bool Parser::parse_pseudo() {
             filename_,
             currentToken().line_number,
             currentToken().column_number,
-            GetLineFromFile(filename_, currentToken().line_number)));
+            getSourceLine(currentToken().line_number)));
       }
       skipCurrentLine();
       // instruction_index_+=2;
@@ -94,10 +101,8 @@ bool Parser::parse_pseudo() {
       block.setRd("x0");
       block.setRs1("x0");
       // block.setRs2("x0");
-      block.setImm("0");
-      intermediate_code_.emplace_back(block, true);
-      instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-      instruction_index_++;
+      block.setImm(0);
+      emitInstruction(block, true);
       nextToken();
       return true;
     }
@@ -116,17 +121,16 @@ bool Parser::parse_pseudo() {
             (peekToken(4).type==TokenType::EOF_ || peekToken(4).line_number!=currentToken().line_number)) {
       ICUnit block;
       block.setOpcode(currentToken().value);
-      int64_t imm = std::stoll(peekToken(3).value);
-      std::string reg = reg_alias_to_name.at(peekToken(1).value);
+      int64_t imm = peekToken(3).int_value;
+      std::string reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       if (-2048 <= imm && imm <= 2047) {
         block.setLineNumber(currentToken().line_number);
         block.setInstructionIndex(instruction_index_);
         block.setOpcode("addi");
         block.setRd(reg);
         block.setRs1("x0");
-        block.setImm(peekToken(3).value);
-        intermediate_code_.emplace_back(block, true);
-        instruction_number_line_number_mapping_[instruction_index_++] = block.getLineNumber();
+        block.setImm(imm);
+        emitInstruction(block, true);
       } else if (-2147483648LL <= imm && imm <= 2147483647LL) {
         int64_t upper = (imm + (1 << 11)) >> 12;
         int64_t lower = imm - (upper << 12);
@@ -136,9 +140,8 @@ bool Parser::parse_pseudo() {
         luiBlock.setInstructionIndex(instruction_index_);
         luiBlock.setOpcode("lui");
         luiBlock.setRd(reg);
-        luiBlock.setImm(std::to_string(upper));
-        intermediate_code_.emplace_back(luiBlock, true);
-        instruction_number_line_number_mapping_[instruction_index_++] = luiBlock.getLineNumber();
+        luiBlock.setImm(upper);
+        emitInstruction(luiBlock, true);
 
         if (lower!=0) {
           ICUnit addiBlock;
@@ -147,9 +150,8 @@ bool Parser::parse_pseudo() {
           addiBlock.setOpcode("addi");
           addiBlock.setRd(reg);
           addiBlock.setRs1(reg);
-          addiBlock.setImm(std::to_string(lower));
-          intermediate_code_.emplace_back(addiBlock, true);
-          instruction_number_line_number_mapping_[instruction_index_++] = addiBlock.getLineNumber();
+          addiBlock.setImm(lower);
+          emitInstruction(addiBlock, true);
         }
       } 
       else if (INT64_MIN <= imm && imm <= INT64_MAX) {
@@ -162,7 +164,7 @@ bool Parser::parse_pseudo() {
             filename_,
             currentToken().line_number,
             currentToken().column_number,
-            GetLineFromFile(filename_, currentToken().line_number)
+            getSourceLine(currentToken().line_number)
           )
         );
       }
@@ -176,7 +178,7 @@ bool Parser::parse_pseudo() {
             filename_,
             currentToken().line_number,
             currentToken().column_number,
-            GetLineFromFile(filename_, currentToken().line_number)
+            getSourceLine(currentToken().line_number)
           )
         );
       }
@@ -201,14 +203,12 @@ bool Parser::parse_pseudo() {
       block.setLineNumber(currentToken().line_number);
       block.setInstructionIndex(instruction_index_);
       std::string reg;
-      reg = reg_alias_to_name.at(peekToken(1).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      reg = reg_alias_to_name.at(peekToken(3).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(3).value));
       block.setRs1(reg);
       block.setRs2("x0");
-      intermediate_code_.emplace_back(block, true);
-      instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-      instruction_index_++;
+      emitInstruction(block, true);
       skipCurrentLine();
       return true;
     }
@@ -229,14 +229,12 @@ bool Parser::parse_pseudo() {
       block.setOpcode("xori");
       block.setLineNumber(currentToken().line_number);
       block.setInstructionIndex(instruction_index_);
-      std::string reg = reg_alias_to_name.at(peekToken(1).value);
+      std::string reg = reg_alias_to_name.at(std::string(peekToken(1).value));
       block.setRd(reg);
-      reg = reg_alias_to_name.at(peekToken(3).value);
+      reg = reg_alias_to_name.at(std::string(peekToken(3).value));
       block.setRs1(reg);
-      block.setImm("-1");
-      intermediate_code_.emplace_back(block, true);
-      instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-      instruction_index_++;
+      block.setImm(-1);
+      emitInstruction(block, true);
       skipCurrentLine();
       return true;
     }
@@ -253,10 +251,8 @@ bool Parser::parse_pseudo() {
       block.setInstructionIndex(instruction_index_);
       block.setRd("x0");
       block.setRs1("x1");
-      block.setImm("0");
-      intermediate_code_.emplace_back(block, true);
-      instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
-      instruction_index_++;
+      block.setImm(0);
+      emitInstruction(block, true);
       nextToken();
       return true;
     }
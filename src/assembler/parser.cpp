@@ -5,6 +5,7 @@
  */
 
 #include "assembler/parser.h"
+#include "assembler/lexer.h"
 
 #include "common/instructions.h"
 #include "vm/registers.h"
@@ -13,34 +14,66 @@
 
 #include <cstdint>
 #include <iostream>
+#include <span>
 #include <vector>
 
-Token Parser::prevToken() {
-  if (pos_ > 0) {
-    return tokens_[pos_ - 1];
-  }
-  return {TokenType::EOF_, "", 1, 1};
+namespace {
+
+// Tokens a streaming parser consumes before dropping them; only the previous token is looked at again
+constexpr size_t kStreamWindow = 4096;
+
+} // namespace
+
+Parser::Parser(Lexer &lexer, ParserSink &sink)
+    : source_(lexer.getSource()), filename_(lexer.getFilename()), lexer_(&lexer), sink_(&sink) {
 }
 
-Token Parser::currentToken() {
-  if (pos_ < tokens_.size()) {
-    return tokens_[pos_];
+const Token &Parser::tokenAt(size_t index) {
+  if (lexer_) {
+    while (index >= window_.size() && lexer_->lexLine(window_)) {
+    }
+    if (index < window_.size()) {
+      return window_[index];
+    }
+    return eof_token_;
   }
-  return {TokenType::EOF_, "", 1, 1};
+  if (index < tokens_.size()) {
+    return tokens_[index];
+  }
+  return eof_token_;
 }
 
-Token Parser::nextToken() {
-  if (pos_ < tokens_.size()) {
-    return tokens_[pos_++];
+const Token &Parser::prevToken() {
+  if (pos_ > 0) {
+    return tokenAt(pos_ - 1);
   }
-  return {TokenType::EOF_, "", 1, 1};
+  return eof_token_;
+}
+
+const Token &Parser::currentToken() {
+  return tokenAt(pos_);
 }
 
-Token Parser::peekToken(int n) {
-  if (pos_ + n < tokens_.size()) {
-    return tokens_[pos_ + n];
+const Token &Parser::nextToken() {
+  const Token &token = tokenAt(pos_);
+  if (&token==&eof_token_) {
+    return eof_token_;
+  }
+  ++pos_;
+  if (lexer_ && pos_ > kStreamWindow) {
+    // Erasing from the front of a deque leaves references to the remaining tokens valid
+    window_.erase(window_.begin(), window_.begin() + static_cast<std::ptrdiff_t>(pos_ - 1));
+    pos_ = 1;
   }
-  return {TokenType::EOF_, "", 1, 1};
+  return token;
+}
+
+const Token &Parser::peekToken(int n) {
+  return tokenAt(pos_ + n);
+}
+
+std::string Parser::getSourceLine(unsigned int line_number) const {
+  return std::string(source_.getLine(line_number));
 }
 
 void Parser::skipCurrentLine() {
@@ -55,6 +88,34 @@ void Parser::recordError(const ParseError &error) {
   errors_.count++;
 }
 
+void Parser::emitInstruction(const ICUnit &block, bool resolved) {
+  if (!sink_) {
+    if (!resolved) {
+      back_patch_.push_back(instruction_index_);
+    }
+    intermediate_code_.emplace_back(block, resolved);
+    instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
+  } else if (resolved) {
+    sink_->instruction(block);
+  } else {
+    // Sent with a zero offset and patched once the label has been seen
+    RelocationType type = instruction_set::isValidBTypeInstruction(block.getOpcode())
+                          ? RelocationType::kBranch : RelocationType::kJal;
+    relocations_.push_back({instruction_index_, type, block.getLabel(labels_), block.getLineNumber()});
+    ICUnit unresolved = block;
+    unresolved.setImm(0);
+    sink_->instruction(unresolved);
+  }
+  instruction_index_++;
+}
+
+void Parser::flushData() {
+  if (sink_ && !data_buffer_.empty()) {
+    sink_->data(data_buffer_);
+    data_buffer_.clear();
+  }
+}
+
 
 
 //=================================================================================
@@ -70,8 +131,8 @@ void Parser::parseDataDirective() {
       && currentToken().value!="bss"
       && currentToken().value!="section"
       && currentToken().type!=TokenType::EOF_) {
-      
-        
+    flushData();
+
     if (currentToken().type==TokenType::LABEL) {
       if (peekToken(1).value=="word") {
         align(4);
@@ -102,15 +163,20 @@ void Parser::parseDataDirective() {
             "Invalid directive", "Expected .dword, .word, .halfword, .byte, .float, .double, .string, .zero",
             filename_, currentToken().line_number,
             currentToken().column_number,
-            GetLineFromFile(filename_, currentToken().line_number)
+            getSourceLine(currentToken().line_number)
           )
         );
       }
-      symbol_table_[currentToken().value] = {data_index_, currentToken().line_number, true};
+      symbol_table_[std::string(currentToken().value)] = {data_index_, currentToken().line_number, true};
       nextToken();
       continue;
     }
 
+    if (isSymbolDirective()) {
+      parseSymbolDirective();
+      continue;
+    }
+
     if (currentToken().value=="dword") {
       nextToken();
       while (currentToken().type!=TokenType::EOF_
@@ -118,7 +184,7 @@ void Parser::parseDataDirective() {
               || currentToken().type==TokenType::COMMA)) {
         if (currentToken().type==TokenType::NUM) {
           align(8);
-          data_buffer_.emplace_back(static_cast<uint64_t>(std::stoull(currentToken().value)));
+          data_buffer_.emplace_back(static_cast<uint64_t>(currentToken().int_value));
           data_index_ += 8;
         }
         nextToken();
@@ -130,7 +196,7 @@ void Parser::parseDataDirective() {
               || currentToken().type==TokenType::COMMA)) {
         if (currentToken().type==TokenType::NUM) {
           align(4);
-          data_buffer_.emplace_back(static_cast<uint32_t>(std::stoull(currentToken().value)));
+          data_buffer_.emplace_back(static_cast<uint32_t>(currentToken().int_value));
           data_index_ += 4;
         }
         nextToken();
@@ -143,7 +209,7 @@ void Parser::parseDataDirective() {
               || currentToken().type==TokenType::COMMA)) {
         if (currentToken().type==TokenType::NUM) {
           align(2);
-          data_buffer_.emplace_back(static_cast<uint16_t>(std::stoull(currentToken().value)));
+          data_buffer_.emplace_back(static_cast<uint16_t>(currentToken().int_value));
           data_index_ += 2;
         }
         nextToken();
@@ -155,7 +221,7 @@ void Parser::parseDataDirective() {
               || currentToken().type==TokenType::COMMA)) {
         if (currentToken().type==TokenType::NUM) {
           align(1);
-          data_buffer_.emplace_back(static_cast<uint8_t>(std::stoull(currentToken().value)));
+          data_buffer_.emplace_back(static_cast<uint8_t>(currentToken().int_value));
           data_index_ += 1;
         }
         nextToken();
@@ -167,7 +233,7 @@ void Parser::parseDataDirective() {
               || currentToken().type==TokenType::COMMA)) {
         if (currentToken().type==TokenType::FLOAT) {
           align(4);
-          data_buffer_.emplace_back(static_cast<float>(std::stof(currentToken().value)));
+          data_buffer_.emplace_back(static_cast<float>(currentToken().float_value));
           data_index_ += 4;
         }
         nextToken();
@@ -179,7 +245,7 @@ void Parser::parseDataDirective() {
               || currentToken().type==TokenType::COMMA)) {
         if (currentToken().type==TokenType::FLOAT) {
           align(8);
-          data_buffer_.emplace_back(static_cast<double>(std::stod(currentToken().value)));
+          data_buffer_.emplace_back(currentToken().float_value);
           data_index_ += 8;
         }
         nextToken();
@@ -190,10 +256,10 @@ void Parser::parseDataDirective() {
           && (currentToken().type==TokenType::NUM
               || currentToken().type==TokenType::COMMA)) {
         if (currentToken().type==TokenType::NUM) {
-          unsigned long long num = std::stoull(currentToken().value);
+          int64_t num = currentToken().int_value;
           if (num > 0) {
             align(1);
-            for (unsigned long long i = 0; i < num; ++i) {
+            for (int64_t i = 0; i < num; ++i) {
               data_buffer_.emplace_back(static_cast<uint8_t>(0));
               data_index_ += 1;
             }
@@ -209,7 +275,7 @@ void Parser::parseDataDirective() {
                 "Invalid zero directive", "Expected a positive number",
                 filename_, currentToken().line_number,
                 currentToken().column_number,
-                GetLineFromFile(filename_, currentToken().line_number)
+                getSourceLine(currentToken().line_number)
               )
             );
           }
@@ -223,7 +289,7 @@ void Parser::parseDataDirective() {
               || currentToken().type==TokenType::COMMA)) {
 
         if (currentToken().type==TokenType::STRING) {
-          std::string rawString = currentToken().value;
+          std::string rawString(currentToken().value);
           std::string processedString = ParseEscapedString(rawString);
           processedString.push_back('\0');
           align(1); 
@@ -245,7 +311,7 @@ void Parser::parseDataDirective() {
           "Invalid directive", "Expected .dword, .word, .halfword, .byte, .string, .float, .double, .zero",
           filename_, currentToken().line_number,
           currentToken().column_number,
-          GetLineFromFile(filename_, currentToken().line_number)
+          getSourceLine(currentToken().line_number)
         )
       );
       nextToken();
@@ -259,45 +325,43 @@ void Parser::parseTextDirective() {
       && currentToken().type!=TokenType::EOF_) {
 
     if (currentToken().type==TokenType::LABEL) {
-      if (symbol_table_.find(currentToken().value)!=symbol_table_.end()) {
+      if (symbol_table_.find(std::string(currentToken().value))!=symbol_table_.end()) {
         errors_.count++;
         recordError(ParseError(currentToken().line_number,
                                "Label redefinition: already defined at line " + std::to_string(
-                                   symbol_table_[currentToken().value].line_number)));
+                                   symbol_table_[std::string(currentToken().value)].line_number)));
         errors_.all_errors.emplace_back(errors::LabelRedefinitionError("Label redefinition",
                                                                        "Label already defined at line " +
                                                                            std::to_string(
-                                                                               symbol_table_[currentToken().value].line_number),
+                                                                               symbol_table_[std::string(currentToken().value)].line_number),
                                                                        filename_,
                                                                        currentToken().line_number,
                                                                        currentToken().column_number,
-                                                                       GetLineFromFile(filename_,
-                                                                                       currentToken().line_number)));
+                                                                       getSourceLine(currentToken().line_number)));
         nextToken();
         continue;
       }
-      symbol_table_[currentToken().value] = {instruction_index_*4, currentToken().line_number, false};
+      symbol_table_[std::string(currentToken().value)] = {instruction_index_*4, currentToken().line_number, false};
       nextToken();
     } else if (currentToken().type==TokenType::OPCODE) {
-      if (instruction_set::isValidMExtensionInstruction(currentToken().value) && vm_config::config.getMExtensionEnabled() == false) {
+      if (instruction_set::isValidMExtensionInstruction(currentToken().value) && vm_config::current().getMExtensionEnabled() == false) {
         errors_.count++;
-        recordError(ParseError(currentToken().line_number, "Unexpected opcode, M extension is disabled: " + currentToken().value));
+        recordError(ParseError(currentToken().line_number, "Unexpected opcode, M extension is disabled: " + std::string(currentToken().value)));
         errors_.all_errors.emplace_back(errors::UnexpectedTokenError("Unexpected opcode, M extension is disabled",
                                                                    filename_,
                                                                    currentToken().line_number,
                                                                    currentToken().column_number,
-                                                                   GetLineFromFile(filename_,
-                                                                                   currentToken().line_number)));
+                                                                   getSourceLine(currentToken().line_number)));
         skipCurrentLine();
         continue;
       }
 
-      std::vector<instruction_set::SyntaxType>
-          syntaxes = instruction_set::instruction_syntax_map[currentToken().value];
+      std::span<const instruction_set::SyntaxType>
+          syntaxes = instruction_set::findInstruction(currentToken().value)->syntaxes();
 
       bool valid_syntax = false;
 
-      for (instruction_set::SyntaxType &syntax : syntaxes) {
+      for (instruction_set::SyntaxType syntax : syntaxes) {
         switch (syntax) {
           case instruction_set::SyntaxType::O_GPR_C_GPR_C_GPR: {
             valid_syntax = parse_O_GPR_C_GPR_C_GPR();
@@ -417,6 +481,14 @@ void Parser::parseTextDirective() {
             valid_syntax = parse_O_FPR_C_I_LP_GPR_RP();
             break;
           }
+          case instruction_set::SyntaxType::O_GPR_C_LP_GPR_RP: {
+            valid_syntax = parse_O_GPR_C_LP_GPR_RP();
+            break;
+          }
+          case instruction_set::SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP: {
+            valid_syntax = parse_O_GPR_C_GPR_C_LP_GPR_RP();
+            break;
+          }
 
           default: {
             break;
@@ -437,20 +509,19 @@ void Parser::parseTextDirective() {
                                 filename_,
                                 currentToken().line_number,
                                 currentToken().column_number,
-                                GetLineFromFile(filename_, currentToken().line_number)));
+                                getSourceLine(currentToken().line_number)));
 
         skipCurrentLine();
       }
 
     } else {
       errors_.count++;
-      recordError(ParseError(currentToken().line_number, "Unexpected token: " + currentToken().value));
+      recordError(ParseError(currentToken().line_number, "Unexpected token: " + std::string(currentToken().value)));
       errors_.all_errors.emplace_back(errors::UnexpectedTokenError("Unexpected token",
                                                                    filename_,
                                                                    currentToken().line_number,
                                                                    currentToken().column_number,
-                                                                   GetLineFromFile(filename_,
-                                                                                   currentToken().line_number)));
+                                                                   getSourceLine(currentToken().line_number)));
 
       skipCurrentLine();
       continue;
@@ -483,7 +554,7 @@ void Parser::parseBSSDirective() {
     //           errors::SyntaxError("Invalid syntax", "Expected a number after .space",
     //                               filename_, currentToken().line_number,
     //                               currentToken().column_number,
-    //                               GetLineFromFile(filename_, currentToken().line_number)));
+    //                               getSourceLine(currentToken().line_number)));
     //       nextToken();
     //     }
     //   } else {
@@ -494,7 +565,7 @@ void Parser::parseBSSDirective() {
     //         errors::SyntaxError("Invalid label", "Expected: .space",
     //                             filename_, currentToken().line_number,
     //                             currentToken().column_number,
-    //                             GetLineFromFile(filename_, currentToken().line_number)));
+    //                             getSourceLine(currentToken().line_number)));
     //     nextToken();
     //   }
     // } else {
@@ -505,15 +576,49 @@ void Parser::parseBSSDirective() {
     //       errors::SyntaxError("Invalid directive", "Expected: .space",
     //                           filename_, currentToken().line_number,
     //                           currentToken().column_number,
-    //                           GetLineFromFile(filename_, currentToken().line_number)));
+    //                           getSourceLine(currentToken().line_number)));
     //   nextToken();
     // }
   }
 }
 
+bool Parser::isSymbolDirective() {
+  return currentToken().type==TokenType::DIRECTIVE
+      && (currentToken().value=="globl" || currentToken().value=="global" || currentToken().value=="extern");
+}
+
+void Parser::parseSymbolDirective() {
+  bool is_extern = currentToken().value=="extern";
+  unsigned int line = currentToken().line_number;
+  nextToken();
+
+  bool named = false;
+  while (currentToken().type!=TokenType::EOF_ && currentToken().line_number==line) {
+    if (currentToken().type!=TokenType::COMMA) {
+      if (!is_extern) {
+        global_symbols_.emplace(currentToken().value);
+      }
+      named = true;
+    }
+    nextToken();
+  }
+
+  if (!named) {
+    errors_.count++;
+    recordError(ParseError(line, "Invalid syntax: Expected a symbol name"));
+    errors_.all_errors.emplace_back(
+        errors::SyntaxError("Invalid syntax", "Expected a symbol name",
+                            filename_, line, 0, getSourceLine(line)));
+  }
+}
+
 // TODO: implement bss directive
 
 void Parser::parse() {
+  if (sink_) {
+    parseStream();
+    return;
+  }
   instruction_index_ = 0;
   data_index_ = 0;
 
@@ -521,6 +626,9 @@ void Parser::parse() {
   while (currentToken().type!=TokenType::EOF_) {
     if (currentToken().value == "section" && currentToken().type == TokenType::DIRECTIVE) {
       nextToken();
+    } else if (isSymbolDirective()) {
+      // recorded in the second pass
+      skipCurrentLine();
     } else if (currentToken().value=="data" && currentToken().type==TokenType::DIRECTIVE) {
       nextToken();
       parseDataDirective();
@@ -549,7 +657,7 @@ void Parser::parse() {
                               filename_,
                               currentToken().line_number,
                               currentToken().column_number,
-                              GetLineFromFile(filename_, currentToken().line_number)));
+                              getSourceLine(currentToken().line_number)));
       nextToken();
     }
   }
@@ -561,6 +669,8 @@ void Parser::parse() {
   while (currentToken().type!=TokenType::EOF_) {
     if (currentToken().value == "section" && currentToken().type == TokenType::DIRECTIVE) {
       nextToken();
+    } else if (isSymbolDirective()) {
+      parseSymbolDirective();
     } else if (currentToken().value=="data" && currentToken().type==TokenType::DIRECTIVE) {
       while (currentToken().type!=TokenType::EOF_ && currentToken().value!="text") {
         nextToken();
@@ -586,21 +696,21 @@ void Parser::parse() {
                               filename_,
                               currentToken().line_number,
                               currentToken().column_number,
-                              GetLineFromFile(filename_, currentToken().line_number)));
+                              getSourceLine(currentToken().line_number)));
       nextToken();
     }
   }
 
   for (unsigned int index : back_patch_) {
     ICUnit block = intermediate_code_[index].first;
-    if (symbol_table_.find(block.getLabel())!=symbol_table_.end()) {
+    if (symbol_table_.find(block.getLabel(labels_))!=symbol_table_.end()) {
 
       if (instruction_set::isValidBTypeInstruction(block.getOpcode())) {
-        if (!symbol_table_[block.getLabel()].isData) {
-          uint64_t address = symbol_table_[block.getLabel()].address;
+        if (!symbol_table_[block.getLabel(labels_)].isData) {
+          uint64_t address = symbol_table_[block.getLabel(labels_)].address;
           auto offset = static_cast<int64_t>(address - index*4);
           if (-4096 <= offset && offset <= 4095) {
-            block.setImm(std::to_string(offset));
+            block.setImm(offset);
           } else {
             errors_.count++;
             recordError(ParseError(block.getLineNumber(), "Immediate value out of range"));
@@ -609,8 +719,7 @@ void Parser::parse() {
                                                                              filename_,
                                                                              block.getLineNumber(),
                                                                              0,
-                                                                             GetLineFromFile(filename_,
-                                                                                             block.getLineNumber())));
+                                                                             getSourceLine(block.getLineNumber())));
             continue;
           }
         } else {
@@ -621,15 +730,15 @@ void Parser::parse() {
                                            filename_,
                                            block.getLineNumber(),
                                            0,
-                                           GetLineFromFile(filename_, block.getLineNumber())));
+                                           getSourceLine(block.getLineNumber())));
         }
       } else if (instruction_set::isValidJTypeInstruction(block.getOpcode())) {
-        if (!symbol_table_[block.getLabel()].isData) {
-          uint64_t address = symbol_table_[block.getLabel()].address;
+        if (!symbol_table_[block.getLabel(labels_)].isData) {
+          uint64_t address = symbol_table_[block.getLabel(labels_)].address;
           auto offset = static_cast<int64_t>(address - index*4);
           if (-1048576 <= offset && offset <= 1048575) {
-            block.setImm(std::to_string(offset));
-            // block.setLabel(block.getImm());
+            block.setImm(offset);
+            // block.setLabel(labels_, block.getImm());
           } else {
             errors_.count++;
             recordError(ParseError(block.getLineNumber(), "Immediate value out of range"));
@@ -638,16 +747,15 @@ void Parser::parse() {
                                                                              filename_,
                                                                              block.getLineNumber(),
                                                                              0,
-                                                                             GetLineFromFile(filename_,
-                                                                                             block.getLineNumber())));
+                                                                             getSourceLine(block.getLineNumber())));
             continue;
           }
         } else {
-          uint64_t address = symbol_table_[block.getLabel()].address;
+          uint64_t address = symbol_table_[block.getLabel(labels_)].address;
           auto offset = static_cast<int64_t>(address - index*4);
           if (-1048576 <= offset && offset <= 1048575) {
-            block.setImm(std::to_string(offset));
-            // block.setLabel(block.getImm());
+            block.setImm(offset);
+            // block.setLabel(labels_, block.getImm());
           } else {
             errors_.count++;
             recordError(ParseError(block.getLineNumber(), "Immediate value out of range"));
@@ -656,8 +764,7 @@ void Parser::parse() {
                                                                              filename_,
                                                                              block.getLineNumber(),
                                                                              0,
-                                                                             GetLineFromFile(filename_,
-                                                                                             block.getLineNumber())));
+                                                                             getSourceLine(block.getLineNumber())));
             continue;
           }
         }
@@ -668,23 +775,120 @@ void Parser::parse() {
         errors_.all_errors.emplace_back(
             errors::InvalidLabelRefError("Invalid label reference", "Label reference not found", filename_,
                                          block.getLineNumber(), 0,
-                                         GetLineFromFile(filename_, block.getLineNumber())));
+                                         getSourceLine(block.getLineNumber())));
         continue;
       }
       intermediate_code_[index].first = block;
       intermediate_code_[index].second = true;
+    } else if (relocatable_) {
+      // Defined in another unit, the linker fills in the offset
+      RelocationType type = instruction_set::isValidBTypeInstruction(block.getOpcode())
+                            ? RelocationType::kBranch : RelocationType::kJal;
+      relocations_.push_back({index, type, block.getLabel(labels_)});
+      intermediate_code_[index].first.setImm(0);
+      intermediate_code_[index].second = true;
     } else {
       errors_.count++;
       recordError(ParseError(block.getLineNumber(), "Invalid label reference: Label reference not found"));
       errors_.all_errors.emplace_back(
           errors::InvalidLabelRefError("Invalid label reference", "Label reference not found", filename_,
                                        block.getLineNumber(), 0,
-                                       GetLineFromFile(filename_, block.getLineNumber())));
+                                       getSourceLine(block.getLineNumber())));
     }
   }
 
 }
 
+void Parser::parseStream() {
+  instruction_index_ = 0;
+  data_index_ = 0;
+
+  // Data and text are handled in file order; references to labels further down are patched at the end
+  while (currentToken().type!=TokenType::EOF_) {
+    if (currentToken().value == "section" && currentToken().type == TokenType::DIRECTIVE) {
+      nextToken();
+    } else if (isSymbolDirective()) {
+      parseSymbolDirective();
+    } else if (currentToken().value=="data" && currentToken().type==TokenType::DIRECTIVE) {
+      nextToken();
+      parseDataDirective();
+      flushData();
+    } else if (currentToken().value=="bss" && currentToken().type==TokenType::DIRECTIVE) {
+      nextToken();
+      parseBSSDirective();
+    } else if (currentToken().value=="text" && currentToken().type==TokenType::DIRECTIVE) {
+      nextToken();
+      parseTextDirective();
+    } else if (currentToken().type==TokenType::LABEL || currentToken().type==TokenType::OPCODE) {
+      parseTextDirective();
+    } else {
+      errors_.count++;
+      recordError(ParseError(currentToken().line_number,
+                             "Invalid token: Expected .data, .text, .bss or <opcode> or <label>"));
+      errors_.all_errors.emplace_back(
+          errors::SyntaxError("Invalid token", "Expected: .data, .text, .bss or <opcode> or <label>",
+                              filename_,
+                              currentToken().line_number,
+                              currentToken().column_number,
+                              getSourceLine(currentToken().line_number)));
+      nextToken();
+    }
+  }
+
+  resolveReferences();
+}
+
+void Parser::resolveReferences() {
+  for (const Relocation &reference : relocations_) {
+    auto symbol = symbol_table_.find(reference.symbol);
+    const unsigned int line = reference.line_number;
+    const auto pc = static_cast<int64_t>(reference.instruction_index*4);
+
+    int64_t offset = 0;
+    std::string expected_range;
+    if (reference.type==RelocationType::kPcrelHiLo) {
+      if (symbol==symbol_table_.end() || !symbol->second.isData) {
+        errors_.count++;
+        recordError(ParseError(line, "Invalid label reference"));
+        errors_.all_errors.emplace_back(
+            errors::InvalidLabelRefError("Invalid label reference", "Expected: Label defined in .data section",
+                                         filename_, line, 0, getSourceLine(line)));
+        continue;
+      }
+      offset = static_cast<int64_t>(vm_config::current().getDataSectionStart() + symbol->second.address) - pc;
+      expected_range = "Expected: -2147483648 <= offset <= 2147481599";
+    } else {
+      if (symbol==symbol_table_.end()) {
+        errors_.count++;
+        recordError(ParseError(line, "Invalid label reference: Label reference not found"));
+        errors_.all_errors.emplace_back(
+            errors::InvalidLabelRefError("Invalid label reference", "Label reference not found", filename_,
+                                         line, 0, getSourceLine(line)));
+        continue;
+      }
+      if (reference.type==RelocationType::kBranch && symbol->second.isData) {
+        errors_.count++;
+        recordError(ParseError(line, "Invalid label reference: Label references data"));
+        errors_.all_errors.emplace_back(
+            errors::InvalidLabelRefError("Invalid label reference", "Label references data",
+                                         filename_, line, 0, getSourceLine(line)));
+        continue;
+      }
+      // As in the two-pass parse, a jump to a data label takes the label's offset into the data section
+      offset = static_cast<int64_t>(symbol->second.address) - pc;
+      expected_range = reference.type==RelocationType::kBranch ? "Expected: -4096 <= imm <= 4095"
+                                                                : "Expected: -1048576 <= imm <= 1048575";
+    }
+
+    if (!sink_->patch(reference, offset)) {
+      errors_.count++;
+      recordError(ParseError(line, "Immediate value out of range"));
+      errors_.all_errors.emplace_back(errors::ImmediateOutOfRangeError("Immediate value out of range", expected_range,
+                                                                       filename_, line, 0, getSourceLine(line)));
+    }
+  }
+}
+
 unsigned int Parser::getErrorCount() const {
   return errors_.count;
 }
@@ -759,7 +963,8 @@ void Parser::printIntermediateCode() const {
   }
 
   for (const auto &pair : intermediate_code_) {
-    std::cout << pair.first << " -> " << pair.second << '\n';
+    pair.first.print(std::cout, labels_);
+    std::cout << " -> " << pair.second << '\n';
   }
 }
 
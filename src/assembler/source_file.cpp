@@ -0,0 +1,91 @@
+/**
+ * @file source_file.cpp
+ * @brief Implementation of the memory-mapped SourceFile.
+ */
+
+#include "assembler/source_file.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceFile::SourceFile(std::string filename) : filename_(std::move(filename)) {
+  int fd = ::open(filename_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open file: " + filename_);
+  }
+
+  struct stat file_stat{};
+  if (::fstat(fd, &file_stat)!=0 || !S_ISREG(file_stat.st_mode)) {
+    ::close(fd);
+    throw std::runtime_error("Failed to open file: " + filename_);
+  }
+
+  size_ = static_cast<size_t>(file_stat.st_size);
+  if (size_ > 0) {
+    void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping==MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("Failed to map file: " + filename_);
+    }
+    // The lexer walks the file once from start to end
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(mapping);
+    mapped_ = true;
+  }
+  // The mapping stays valid after the descriptor is closed
+  ::close(fd);
+}
+
+SourceFile::SourceFile(std::string filename, std::string text)
+    : filename_(std::move(filename)), text_(std::move(text)) {
+  data_ = text_.data();
+  size_ = text_.size();
+}
+
+void SourceFile::indexLines() const {
+  if (indexed_) {
+    return;
+  }
+  indexed_ = true;
+  // Same line split as std::getline: a trailing newline does not start a new line
+  if (size_ > 0) {
+    line_offsets_.push_back(0);
+  }
+  const char *cursor = data_;
+  const char *end = data_ + size_;
+  while (cursor < end) {
+    const void *newline = std::memchr(cursor, '\n', static_cast<size_t>(end - cursor));
+    if (!newline) {
+      break;
+    }
+    cursor = static_cast<const char *>(newline) + 1;
+    if (cursor < end) {
+      line_offsets_.push_back(static_cast<size_t>(cursor - data_));
+    }
+  }
+}
+
+SourceFile::~SourceFile() {
+  if (mapped_) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+}
+
+std::string_view SourceFile::getLine(unsigned int line_number) const {
+  indexLines();
+  if (line_number==0 || line_number > line_offsets_.size()) {
+    throw std::out_of_range("Line number out of range.");
+  }
+  size_t start = line_offsets_[line_number - 1];
+  size_t end = (line_number < line_offsets_.size()) ? line_offsets_[line_number] - 1 : size_;
+  if (end > start && data_[end - 1]=='\n') {
+    --end;
+  }
+  return {data_ + start, end - start};
+}
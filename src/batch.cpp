@@ -0,0 +1,350 @@
+/**
+ * @file batch.cpp
+ * @brief Batch simulation driver
+ */
+#include "batch.h"
+#include "assembler/assembler.h"
+#include "vm/rvss/rvss_vm.h"
+#include "vm/rv5s/rv5s_vm.h"
+#include "vm_runner.h"
+#include "config.h"
+#include "globals.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+struct Job {
+    unsigned int line = 0;
+    std::vector<std::string> files;
+    std::string overrides;     ///< As written in the manifest
+    vm_config::VmConfig config;
+    std::string error;         ///< Why the job cannot run, if it cannot
+};
+
+struct JobResult {
+    std::string status = "error"; ///< end, exit, stopped (at the execution limit or a breakpoint) or error
+    uint64_t exit_code = 0;
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t stall_cycles = 0;
+    uint64_t branch_mispredictions = 0;
+    cache::CacheStats cache{};
+    double time_ms = 0.0;
+    std::string error;
+};
+
+/**
+ * Runs tasks on worker threads that each start with an equal share of them. A worker takes
+ * its own tasks from the back of its queue and, once that is empty, steals from the front of
+ * the others', so long jobs in one share do not leave the other workers idle.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned int threads) : queues_(threads) {}
+
+    // Calls task(i) for every i below count and returns once all calls have returned. Each
+    // worker calls setup once before its first task.
+    void Run(size_t count, const std::function<void()> &setup, const std::function<void(size_t)> &task) {
+        for (size_t i = 0; i < count; ++i) {
+            queues_[i % queues_.size()].tasks.push_back(i);
+        }
+        std::vector<std::thread> workers;
+        for (unsigned int self = 0; self < queues_.size(); ++self) {
+            workers.emplace_back([&, self]() {
+                setup();
+                while (std::optional<size_t> next = Take(self)) {
+                    task(*next);
+                }
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<Queue> queues_;
+
+    std::optional<size_t> Take(unsigned int self) {
+        {
+            Queue &own = queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                size_t task = own.tasks.back();
+                own.tasks.pop_back();
+                return task;
+            }
+        }
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            Queue &victim = queues_[(self + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                size_t task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        // No task is ever added while the pool runs, so empty queues stay empty
+        return std::nullopt;
+    }
+};
+
+std::vector<Job> ReadManifest(const std::filesystem::path &manifest_path) {
+    std::ifstream manifest(manifest_path);
+    if (!manifest) {
+        throw std::runtime_error("Unable to open batch manifest: " + manifest_path.string());
+    }
+    const std::filesystem::path base = manifest_path.parent_path();
+
+    std::vector<Job> jobs;
+    std::string line;
+    unsigned int line_number = 0;
+    while (std::getline(manifest, line)) {
+        ++line_number;
+        std::istringstream words(line);
+        std::string word;
+        if (!(words >> word) || word[0] == '#') {
+            continue;
+        }
+
+        Job job;
+        job.line = line_number;
+        job.config = vm_config::current();
+        do {
+            const size_t equals = word.find('=');
+            const size_t dot = word.find('.');
+            if (equals == std::string::npos || dot == std::string::npos || dot > equals) {
+                std::filesystem::path file(word);
+                job.files.push_back((file.is_relative() ? base / file : file).string());
+                continue;
+            }
+            if (!job.overrides.empty()) {
+                job.overrides += ' ';
+            }
+            job.overrides += word;
+            try {
+                job.config.modifyConfig(word.substr(0, dot), word.substr(dot + 1, equals - dot - 1),
+                                        word.substr(equals + 1), false);
+            } catch (const std::exception &e) {
+                job.error = "Invalid override " + word + ": " + e.what();
+            }
+        } while (words >> word);
+
+        if (job.files.empty() && job.error.empty()) {
+            job.error = "No program given";
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+// RV5SVM::Run() has no execution limit, and a pipeline run without hazard detection may never
+// leave a loop; in a batch that would hold a worker forever, so the job stops after limit cycles.
+void RunPipeline(RV5SVM &vm, uint64_t limit) {
+    vm.ClearStop();
+    while (!vm.stop_requested_ && vm.cycle_s_ < limit && !vm.IsDrained()) {
+        vm.PipelinedStep(false);
+    }
+    if (vm.IsDrained()) {
+        vm.output_status_ = "VM_PROGRAM_END";
+    }
+}
+
+// Runs on a worker thread with the job's configuration bound to it
+JobResult RunJob(const Job &job) {
+    JobResult result;
+    if (!job.error.empty()) {
+        result.error = job.error;
+        return result;
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    try {
+        AssembledProgram program = assemble(job.files);
+        std::unique_ptr<VmBase> vm = createVMInstance(job.config.getVmType());
+        // The exit syscall only ends the job, and programs that read stdin get empty lines
+        // instead of blocking a worker
+        vm->exit_ends_process_ = false;
+        vm->empty_input_when_idle_ = true;
+        vm->LoadProgram(program);
+        if (auto *pipeline = dynamic_cast<RV5SVM *>(vm.get())) {
+            RunPipeline(*pipeline, job.config.getInstructionExecutionLimit());
+        } else {
+            vm->Run();
+        }
+
+        if (vm->output_status_ == "VM_EXIT") {
+            result.status = "exit";
+        } else if (vm->output_status_ == "VM_PROGRAM_END") {
+            // Every Run() sets this only once the program has finished, never at the limit
+            result.status = "end";
+        } else {
+            result.status = "stopped";
+        }
+        result.exit_code = vm->exit_code_;
+        result.instructions = vm->instructions_retired_;
+        result.cycles = vm->cycle_s_;
+        result.stall_cycles = vm->stall_cycles_;
+        result.branch_mispredictions = vm->branch_mispredictions_;
+        result.cache = vm->memory_controller_.GetCacheStats();
+    } catch (const std::exception &e) {
+        result.status = "error";
+        result.error = e.what();
+    }
+    result.time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    return result;
+}
+
+std::string JoinFiles(const std::vector<std::string> &files) {
+    std::string joined;
+    for (const std::string &file : files) {
+        if (!joined.empty()) {
+            joined += ' ';
+        }
+        joined += file;
+    }
+    return joined;
+}
+
+double Cpi(const JobResult &result) {
+    return (result.instructions > 0) ? static_cast<double>(result.cycles) / static_cast<double>(result.instructions)
+                                     : 0.0;
+}
+
+std::string CsvField(const std::string &field) {
+    if (field.find_first_of(",\"\n") == std::string::npos) {
+        return field;
+    }
+    std::string quoted = "\"";
+    for (char c : field) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+void WriteCsvReport(std::ostream &out, const std::vector<Job> &jobs, const std::vector<JobResult> &results) {
+    out << "line,program,overrides,processor,status,exit_code,instructions,cycles,cpi,stall_cycles,"
+           "branch_mispredictions,cache_accesses,cache_misses,time_ms,error\n";
+    out << std::fixed;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const Job &job = jobs[i];
+        const JobResult &result = results[i];
+        out << job.line << ',' << CsvField(JoinFiles(job.files)) << ',' << CsvField(job.overrides) << ','
+            << job.config.getVmTypeString() << ',' << result.status << ',' << result.exit_code << ','
+            << result.instructions << ',' << result.cycles << ',' << std::setprecision(4) << Cpi(result) << ','
+            << result.stall_cycles << ',' << result.branch_mispredictions << ',' << result.cache.accesses << ','
+            << result.cache.misses << ',' << std::setprecision(3) << result.time_ms << ',' << CsvField(result.error)
+            << '\n';
+    }
+}
+
+void WriteJsonReport(std::ostream &out, const std::vector<Job> &jobs, const std::vector<JobResult> &results) {
+    out << "[\n";
+    out << std::fixed;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const Job &job = jobs[i];
+        const JobResult &result = results[i];
+        out << "    {\n";
+        out << "        \"line\": " << job.line << ",\n";
+        out << "        \"program\": " << JsonString(JoinFiles(job.files)) << ",\n";
+        out << "        \"overrides\": " << JsonString(job.overrides) << ",\n";
+        out << "        \"processor\": " << JsonString(job.config.getVmTypeString()) << ",\n";
+        out << "        \"status\": " << JsonString(result.status) << ",\n";
+        out << "        \"exit_code\": " << result.exit_code << ",\n";
+        out << "        \"instructions\": " << result.instructions << ",\n";
+        out << "        \"cycles\": " << result.cycles << ",\n";
+        out << "        \"cpi\": " << std::setprecision(4) << Cpi(result) << ",\n";
+        out << "        \"stall_cycles\": " << result.stall_cycles << ",\n";
+        out << "        \"branch_mispredictions\": " << result.branch_mispredictions << ",\n";
+        out << "        \"cache_accesses\": " << result.cache.accesses << ",\n";
+        out << "        \"cache_misses\": " << result.cache.misses << ",\n";
+        out << "        \"time_ms\": " << std::setprecision(3) << result.time_ms << ",\n";
+        out << "        \"error\": " << JsonString(result.error) << "\n";
+        out << "    }" << ((i + 1 < jobs.size()) ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+} // namespace
+
+int RunBatchSimulation(const std::string &manifest_path, const std::string &report_path) {
+    std::vector<Job> jobs;
+    try {
+        jobs = ReadManifest(manifest_path);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    if (jobs.empty()) {
+        std::cerr << "Error: The batch manifest has no jobs.\n";
+        return 1;
+    }
+
+    unsigned int threads = static_cast<unsigned int>(vm_config::current().getBatchThreads());
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned int>(std::min<size_t>(threads, jobs.size()));
+
+    std::vector<JobResult> results(jobs.size());
+    auto start_time = std::chrono::steady_clock::now();
+    {
+        ConsoleMute mute;
+        WorkStealingPool pool(threads);
+        pool.Run(jobs.size(),
+                 []() {
+                     // Jobs report through their results only; their dumps would overwrite each other
+                     globals::setStateDirectory({});
+                 },
+                 [&](size_t i) {
+                     vm_config::ScopedConfig bind(jobs[i].config);
+                     results[i] = RunJob(jobs[i]);
+                 });
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time);
+
+    std::ofstream report(report_path);
+    if (!report) {
+        std::cerr << "Error: Unable to write batch report: " << report_path << '\n';
+        return 1;
+    }
+    if (std::filesystem::path(report_path).extension() == ".json") {
+        WriteJsonReport(report, jobs, results);
+    } else {
+        WriteCsvReport(report, jobs, results);
+    }
+
+    unsigned int failed = 0;
+    double job_time = 0.0;
+    for (const JobResult &result : results) {
+        failed += (result.status == "error") ? 1 : 0;
+        job_time += result.time_ms;
+    }
+    std::cout << "--- Batch Simulation ---" << std::endl;
+    std::cout << "Jobs: " << jobs.size() << ", Failed: " << failed << ", Threads: " << threads << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "Wall Time: " << elapsed.count()
+              << " ms, Job Time: " << job_time << " ms" << std::defaultfloat << std::endl;
+    std::cout << "Report: " << report_path << std::endl;
+    return (failed == 0) ? 0 : 1;
+}
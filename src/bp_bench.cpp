@@ -0,0 +1,153 @@
+/**
+ * @file bp_bench.cpp
+ * @brief Branch predictor benchmark harness
+ */
+#include "bp_bench.h"
+#include "assembler/assembler.h"
+#include "vm/rvss/rvss_vm.h"
+#include "config.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+constexpr const char *kTraceExtension = ".bptrace";
+
+// Swallows the per-instruction logging of the VM while a trace is recorded
+class NullBuffer : public std::streambuf {
+  protected:
+    int overflow(int c) override {
+        return c;
+    }
+};
+
+// Expands directories into the assembly and trace files below them, in a stable order
+std::vector<std::filesystem::path> CollectInputs(const std::vector<std::string> &paths) {
+    std::vector<std::filesystem::path> inputs;
+    for (const std::string &path : paths) {
+        if (std::filesystem::is_directory(path)) {
+            std::vector<std::filesystem::path> found;
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(path)) {
+                std::string extension = entry.path().extension().string();
+                if (entry.is_regular_file() && (extension == ".s" || extension == kTraceExtension)) {
+                    found.push_back(entry.path());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            inputs.insert(inputs.end(), found.begin(), found.end());
+        } else {
+            inputs.emplace_back(path);
+        }
+    }
+    return inputs;
+}
+
+} // namespace
+
+branch_predictor::BranchTrace RecordBranchTrace(const std::string &filename, uint64_t max_instructions) {
+    AssembledProgram program = assemble(filename);
+
+    branch_predictor::BranchTrace trace;
+    trace.name = std::filesystem::path(filename).filename().string();
+
+    vm_config::VmConfig config = vm_config::current();
+    config.setInstructionExecutionLimit(max_instructions);
+
+    NullBuffer null_buffer;
+    std::streambuf *saved_buffer = std::cout.rdbuf(&null_buffer);
+    try {
+        RVSSVM vm(std::make_shared<const vm_config::VmConfig>(config));
+        vm.LoadProgram(program);
+        vm.branch_trace_ = &trace;
+        // Programs that read stdin get empty lines instead of blocking the benchmark
+        for (int i = 0; i < 1024; ++i) {
+            vm.PushInput("");
+        }
+        vm.Run();
+        trace.instructions = vm.instructions_retired_;
+        vm.branch_trace_ = nullptr;
+    } catch (...) {
+        std::cout.rdbuf(saved_buffer);
+        throw;
+    }
+    std::cout.rdbuf(saved_buffer);
+
+    return trace;
+}
+
+int RunBranchPredictorBenchmark(const std::vector<std::string> &paths) {
+    std::vector<std::filesystem::path> inputs = CollectInputs(paths);
+    if (inputs.empty()) {
+        std::cerr << "Error: No programs or traces found for the branch predictor benchmark.\n";
+        return 1;
+    }
+
+    branch_predictor::BranchPredictorConfig predictor_config = VmBase::PredictorConfigFromVmConfig(vm_config::current());
+
+    std::vector<uint64_t> total_mispredictions;
+    uint64_t total_instructions = 0;
+    uint64_t total_branches = 0;
+    std::chrono::nanoseconds total_replay_time{0};
+    bool header_printed = false;
+
+    for (const std::filesystem::path &input : inputs) {
+        branch_predictor::BranchTrace trace;
+        try {
+            if (input.extension() == kTraceExtension) {
+                trace = branch_predictor::ReadBranchTrace(input);
+            } else {
+                trace = RecordBranchTrace(input.string());
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Skipping " << input.string() << ": " << e.what() << '\n';
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<branch_predictor::ReplayResult> results = branch_predictor::ReplayBranchTrace(trace, predictor_config);
+        total_replay_time += std::chrono::steady_clock::now() - start;
+
+        if (!header_printed) {
+            std::cout << std::left << std::setw(28) << "Program" << std::right << std::setw(12) << "Instrs" << std::setw(10) << "Branches";
+            for (const auto &result : results) {
+                std::cout << std::setw(14) << result.predictor;
+            }
+            std::cout << "\n";
+            total_mispredictions.assign(results.size(), 0);
+            header_printed = true;
+        }
+
+        std::cout << std::left << std::setw(28) << trace.name << std::right << std::setw(12) << trace.instructions
+                  << std::setw(10) << trace.branches.size() << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::cout << std::setw(14) << results[i].mpki;
+            total_mispredictions[i] += results[i].mispredictions;
+        }
+        std::cout << std::defaultfloat << "\n";
+
+        total_instructions += trace.instructions;
+        total_branches += trace.branches.size();
+    }
+
+    if (!header_printed) {
+        std::cerr << "Error: None of the inputs produced a branch trace.\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(28) << "TOTAL" << std::right << std::setw(12) << total_instructions
+              << std::setw(10) << total_branches << std::fixed << std::setprecision(3);
+    for (uint64_t mispredictions : total_mispredictions) {
+        double mpki = (total_instructions > 0) ? static_cast<double>(mispredictions) * 1000.0 / static_cast<double>(total_instructions) : 0.0;
+        std::cout << std::setw(14) << mpki;
+    }
+    std::cout << std::defaultfloat << "\n";
+    std::cout << "MPKI = mispredictions per 1000 instructions. Replay time: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(total_replay_time).count() << " us\n";
+    return 0;
+}
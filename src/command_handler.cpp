@@ -34,6 +34,16 @@ Command ParseCommand(const std::string &input) {
     command_type = command_handler::CommandType::REDO;
   } else if (command_str=="reset") {
     command_type = command_handler::CommandType::RESET;
+  } else if (command_str=="snapshot" || command_str=="snap") {
+    command_type = command_handler::CommandType::SNAPSHOT;
+  } else if (command_str=="restore") {
+    command_type = command_handler::CommandType::RESTORE_SNAPSHOT;
+  } else if (command_str=="delete_snapshot") {
+    command_type = command_handler::CommandType::DELETE_SNAPSHOT;
+  } else if (command_str=="reverse_step" || command_str=="rs") {
+    command_type = command_handler::CommandType::REVERSE_STEP;
+  } else if (command_str=="reverse_continue" || command_str=="rc") {
+    command_type = command_handler::CommandType::REVERSE_CONTINUE;
   } else if (command_str=="modify_register" || command_str=="mreg") {
     command_type = command_handler::CommandType::MODIFY_REGISTER;
   } else if (command_str=="get_register" || command_str=="greg") {
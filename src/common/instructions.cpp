@@ -7,8 +7,8 @@
 /** @endcond */
 
 #include "common/instructions.h"
+#include "common/static_string_table.h"
 
-#include <unordered_set>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -178,738 +178,320 @@ std::unordered_map<std::string, Instruction> instruction_string_map = {
 };
 
 
-static const std::unordered_set<std::string> valid_instructions = {
-    "add", "sub", "and", "or", "xor", "sll", "srl", "sra", "slt", "sltu",
-    "addw", "subw", "sllw", "srlw", "sraw",
-    "addi", "xori", "ori", "andi", "slli", "srli", "srai", "slti", "sltiu",
-    "addiw", "slliw", "srliw", "sraiw",
-    "lb", "lh", "lw", "ld", "lbu", "lhu", "lwu",
-    "sb", "sh", "sw", "sd",
-    "beq", "bne", "blt", "bge", "bltu", "bgeu",
-    "lui", "auipc",
-    "jal", "jalr",
-    "ecall",
-
-    "csrrw", "csrrs", "csrrc", "csrrwi", "csrrsi", "csrrci",
-
-    "la", "nop", "li", "mv", "not", "neg", "negw",
-    "sext.w", "seqz", "snez", "sltz", "sgtz",
-    "beqz", "bnez", "blez", "bgez", "bltz", "bgtz",
-    "bgt", "ble", "bgtu", "bleu",
-    "j", "jr", "ret", "call", "tail", "fence", "fence_i",
-
-    "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu",
-    "mulw", "divw", "divuw", "remw", "remuw",
-
-    // RV64F
-    "flw", "fsw", "fmadd.s", "fmsub.s", "fnmsub.s", "fnmadd.s",
-    "fadd.s", "fsub.s", "fmul.s", "fdiv.s", "fsqrt.s",
-    "fsgnj.s", "fsgnjn.s", "fsgnjx.s",
-    "fmin.s", "fmax.s",
-    "fcvt.w.s", "fcvt.wu.s", "fmv.x.w",
-    "feq.s", "flt.s", "fle.s",
-    "fclass.s", "fcvt.s.w", "fcvt.s.wu", "fmv.w.x",
-    "fcvt.l.s", "fcvt.lu.s", "fcvt.s.l", "fcvt.s.lu",
-
-    // RV64D
-    "fld", "fsd", "fmadd.d", "fmsub.d", "fnmsub.d", "fnmadd.d",
-    "fadd.d", "fsub.d", "fmul.d", "fdiv.d", "fsqrt.d",
-    "fsgnj.d", "fsgnjn.d", "fsgnjx.d",
-    "fmin.d", "fmax.d",
-    "fcvt.s.d", "fcvt.d.s",
-    "feq.d", "flt.d", "fle.d",
-    "fclass.d", "fcvt.w.d", "fcvt.wu.d", "fcvt.d.w", "fcvt.d.wu",
-    "fcvt.l.d", "fcvt.lu.d", "fmv.x.d", "fcvt.d.l", "fcvt.d.lu", "fmv.d.x"
-
-};
-
-static const std::unordered_set<std::string> RTypeInstructions = {
-    // Base RV32I
-    "add", "sub", "and", "or", "xor", "sll", "srl", "sra", "slt", "sltu",
-
-    // RV64
-    "addw", "subw", "sllw", "srlw", "sraw",
-
-    // M Extension
-    "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu",
-
-    // M Extension RV64
-    "mulw", "divw", "divuw", "remw", "remuw",
-
-};
-
-static const std::unordered_set<std::string> ITypeInstructions = {
-    "addi", "xori", "ori", "andi", "slli", "srli", "srai", "slti", "sltiu",
-    "addiw", "slliw", "srliw", "sraiw",
-    "lb", "lh", "lw", "ld", "lbu", "lhu", "lwu",
-    "jalr"
-};
-
-static const std::unordered_set<std::string> I1TypeInstructions = {
-    "addi", "xori", "ori", "andi", "sltiu", "slti",
-    "addiw",
-    "lb", "lh", "lw", "ld", "lbu", "lhu", "lwu",
-    "jalr"
-};
-
-static const std::unordered_set<std::string> I2TypeInstructions = {
-    "slli", "srli", "srai",
-    "slliw", "srliw", "sraiw"
-};
-
-static const std::unordered_set<std::string> I3TypeInstructions = {
-    "ecall"
-};
-
-static const std::unordered_set<std::string> STypeInstructions = {
-    "sb", "sh", "sw", "sd"
-};
-
-static const std::unordered_set<std::string> BTypeInstructions = {
-    "beq", "bne", "blt", "bge", "bltu", "bgeu"
-};
-
-static const std::unordered_set<std::string> UTypeInstructions = {
-    "lui", "auipc"
-};
-
-static const std::unordered_set<std::string> JTypeInstructions = {
-    "jal"
-};
-
-static const std::unordered_set<std::string> PseudoInstructions = {
-    "la", "nop", "li", "mv", "not", "neg", "negw",
-    "sext.w", "seqz", "snez", "sltz", "sgtz",
-    "beqz", "bnez", "blez", "bgez", "bltz", "bgtz",
-    "bgt", "ble", "bgtu", "bleu",
-    "j", "jr", "ret", "call", "tail", "fence", "fence_i",
-};
-
-static const std::unordered_set<std::string> BaseExtensionInstructions = {
-    "add", "sub", "and", "or", "xor", "sll", "srl", "sra", "slt", "sltu",
-    "addw", "subw", "sllw", "srlw", "sraw",
-    "addi", "xori", "ori", "andi", "slli", "srli", "srai", "slti", "sltiu",
-    "addiw", "slliw", "srliw", "sraiw",
-    "lb", "lh", "lw", "ld", "lbu", "lhu", "lwu",
-    "sb", "sh", "sw", "sd",
-    "beq", "bne", "blt", "bge", "bltu", "bgeu",
-    "lui", "auipc",
-    "jal", "jalr",
-    "ecall",
-};
-
-static const std::unordered_set<std::string> CSRRInstructions = {
-    "csrrw", "csrrs", "csrrc",
-};
-
-static const std::unordered_set<std::string> CSRIInstructions = {
-    "csrrwi", "csrrsi", "csrrci",
-};
-
-static const std::unordered_set<std::string> CSRInstructions = {
-    "csrrw", "csrrs", "csrrc", "csrrwi", "csrrsi", "csrrci",
-};
-
-static const std::unordered_set<std::string> MExtensionInstructions = {
-    "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu",
-    "mulw", "divw", "divuw", "remw", "remuw",
-};
-
-//====================================================================================
-static const std::unordered_set<std::string> FDExtensionRTypeInstructions = {
-    "fsgnj.s", "fsgnjn.s", "fsgnjx.s", "fmin.s", "fmax.s",
-    "feq.s", "flt.s", "fle.s",
-    "fsgnj.d", "fsgnjn.d", "fsgnjx.d", "fmin.d", "fmax.d",
-    "feq.d", "flt.d", "fle.d",
-};
-
-static const std::unordered_set<std::string> FDExtensionR1TypeInstructions = {
-    "fadd.s", "fsub.s", "fmul.s", "fdiv.s",
-    "fadd.d", "fsub.d", "fmul.d", "fdiv.d",
-};
-
-static const std::unordered_set<std::string> FDExtensionR2TypeInstructions = {
-    "fsqrt.s",
-    "fcvt.w.s", "fcvt.wu.s",
-    "fcvt.s.w", "fcvt.s.wu",
-    "fcvt.l.s", "fcvt.lu.s",
-    "fcvt.s.l", "fcvt.s.lu",
-    "fsqrt.d",
-    "fcvt.s.d", "fcvt.d.s",
-    "fcvt.w.d", "fcvt.wu.d",
-    "fcvt.d.w", "fcvt.d.wu",
-
-    "fcvt.l.d", "fcvt.lu.d",
-    "fcvt.d.l", "fcvt.d.lu",
-};
-
-static const std::unordered_set<std::string> FDExtensionR3TypeInstructions = {
-    "fmv.x.w", "fmv.w.x",
-    "fclass.s",
-    "fclass.d",
-    "fmv.x.d", "fmv.d.x",
-};
-
-static const std::unordered_set<std::string> FDExtensionR4TypeInstructions = {
-    "fmadd.s", "fmsub.s", "fnmsub.s", "fnmadd.s",
-    "fmadd.d", "fmsub.d", "fnmsub.d", "fnmadd.d",
-};
-
-static const std::unordered_set<std::string> FDExtensionITypeInstructions = {
-    "flw", "fld",
-};
-
-static const std::unordered_set<std::string> FDExtensionSTypeInstructions = {
-    "fsw", "fsd",
-};
-
-static const std::unordered_set<std::string> FExtensionInstructions = {
-    "flw", "fsw", "fmadd.s", "fmsub.d", "fnmsub.s", "fnmadd.s",
-    "fadd.s", "fsub.s", "fmul.s", "fdiv.s", "fsqrt.s",
-    "fsgnj.s", "fsgnjn.s", "fsgnjx.s",
-    "fmin.s", "fmax.s",
-    "fcvt.w.s", "fcvt.wu.s", "fmv.x.w",
-    "feq.s", "flt.s", "fle.s",
-    "fclass.s", "fcvt.s.w", "fcvt.s.wu", "fmv.w.x",
-    "fcvt.l.s", "fcvt.lu.s", "fcvt.s.l", "fcvt.s.lu",
-};
-
-static const std::unordered_set<std::string> DExtensionInstructions = {};
-
-std::unordered_map<std::string, RTypeInstructionEncoding> R_type_instruction_encoding_map = {
-    {"add", {0b0110011, 0b000, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"sub", {0b0110011, 0b000, 0b0100000}}, // O_GPR_C_GPR_C_GPR
-    {"xor", {0b0110011, 0b100, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"or", {0b0110011, 0b110, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"and", {0b0110011, 0b111, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"sll", {0b0110011, 0b001, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"srl", {0b0110011, 0b101, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"sra", {0b0110011, 0b101, 0b0100000}}, // O_GPR_C_GPR_C_GPR
-    {"slt", {0b0110011, 0b010, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"sltu", {0b0110011, 0b011, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-
-    {"addw", {0b0111011, 0b000, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"subw", {0b0111011, 0b000, 0b0100000}}, // O_GPR_C_GPR_C_GPR
-    {"sllw", {0b0111011, 0b001, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"srlw", {0b0111011, 0b101, 0b0000000}}, // O_GPR_C_GPR_C_GPR
-    {"sraw", {0b0111011, 0b101, 0b0100000}}, // O_GPR_C_GPR_C_GPR
-
-//==RV64M======================================================================================
-    {"mul", {0b0110011, 0b000, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"mulh", {0b0110011, 0b001, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"mulhsu", {0b0110011, 0b010, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"mulhu", {0b0110011, 0b011, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"div", {0b0110011, 0b100, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"divu", {0b0110011, 0b101, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"rem", {0b0110011, 0b110, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"remu", {0b0110011, 0b111, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-
-    {"mulw", {0b0111011, 0b000, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"divw", {0b0111011, 0b100, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"divuw", {0b0111011, 0b101, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"remw", {0b0111011, 0b110, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-    {"remuw", {0b0111011, 0b111, 0b0000001}}, // O_GPR_C_GPR_C_GPR
-
-};
-
-std::unordered_map<std::string, I1TypeInstructionEncoding> I1_type_instruction_encoding_map = {
-    {"addi", {0b0010011, 0b000}}, // O_GPR_C_GPR_C_I
-    {"xori", {0b0010011, 0b100}}, // O_GPR_C_GPR_C_I
-    {"ori", {0b0010011, 0b110}}, // O_GPR_C_GPR_C_I
-    {"andi", {0b0010011, 0b111}}, // O_GPR_C_GPR_C_I
-    {"sltiu", {0b0010011, 0b011}}, // O_GPR_C_GPR_C_I
-    {"slti", {0b0010011, 0b010}}, // O_GPR_C_GPR_C_I
-
-    {"addiw", {0b0011011, 0b000}}, // O_GPR_C_GPR_C_I
-
-    {"lb", {0b0000011, 0b000}}, // O_GPR_C_I_LP_GPR_RP, O_GPR_C_DL
-    {"lh", {0b0000011, 0b001}}, // O_GPR_C_I_LP_GPR_RP, O_GPR_C_DL
-    {"lw", {0b0000011, 0b010}}, // O_GPR_C_I_LP_GPR_RP, O_GPR_C_DL
-    {"ld", {0b0000011, 0b011}}, // O_GPR_C_I_LP_GPR_RP, O_GPR_C_DL
-    {"lbu", {0b0000011, 0b100}}, // O_GPR_C_I_LP_GPR_RP,
-    {"lhu", {0b0000011, 0b101}}, // O_GPR_C_I_LP_GPR_RP,
-    {"lwu", {0b0000011, 0b110}}, // O_GPR_C_I_LP_GPR_RP,
-
-    {"jalr", {0b1100111, 0b000}}, // O_GR_C_I, O_GPR_C_IL
-};
-
-std::unordered_map<std::string, I3TypeInstructionEncoding> I3_type_instruction_encoding_map = {
-    {"ecall", {0b1110011, 0b000, 0b0000000}}, // O
-};
-
-std::unordered_map<std::string, I2TypeInstructionEncoding> I2_type_instruction_encoding_map = {
-    {"slli", {0b0010011, 0b001, 0b000000}}, // O_GPR_C_GPR_C_I
-    {"srli", {0b0010011, 0b101, 0b000000}}, // O_GPR_C_GPR_C_I
-    {"srai", {0b0010011, 0b101, 0b010000}}, // O_GPR_C_GPR_C_I
-
-    {"slliw", {0b0011011, 0b001, 0b000000}}, // O_GPR_C_GPR_C_I
-    {"srliw", {0b0011011, 0b101, 0b000000}}, // O_GPR_C_GPR_C_I
-    {"sraiw", {0b0011011, 0b101, 0b010000}}, // O_GPR_C_GPR_C_I
-};
-
-std::unordered_map<std::string, STypeInstructionEncoding> S_type_instruction_encoding_map = {
-    {"sb", {0b0100011, 0b000}}, // O_GPR_C_GPR_C_I
-    {"sh", {0b0100011, 0b001}}, // O_GPR_C_GPR_C_I
-    {"sw", {0b0100011, 0b010}}, // O_GPR_C_GPR_C_I
-    {"sd", {0b0100011, 0b011}}, // O_GPR_C_GPR_C_I
-};
-
-std::unordered_map<std::string, BTypeInstructionEncoding> B_type_instruction_encoding_map = {
-    {"beq", {0b1100011, 0b000}}, // O_GPR_C_GPR_C_I, O_GPR_C_GPR_C_IL
-    {"bne", {0b1100011, 0b001}}, // O_GPR_C_GPR_C_I, O_GPR_C_GPR_C_IL
-    {"blt", {0b1100011, 0b100}}, // O_GPR_C_GPR_C_I, O_GPR_C_GPR_C_IL
-    {"bge", {0b1100011, 0b101}}, // O_GPR_C_GPR_C_I, O_GPR_C_GPR_C_IL
-    {"bltu", {0b1100011, 0b110}}, // O_GPR_C_GPR_C_I, O_GPR_C_GPR_C_IL
-    {"bgeu", {0b1100011, 0b111}}, // O_GPR_C_GPR_C_I, O_GPR_C_GPR_C_IL
-};
-
-std::unordered_map<std::string, UTypeInstructionEncoding> U_type_instruction_encoding_map = {
-    {"lui", {0b0110111}}, // O_GR_C_I
-    {"auipc", {0b0010111}}, // O_GR_C_I
-};
-
-std::unordered_map<std::string, JTypeInstructionEncoding> J_type_instruction_encoding_map = {
-    {"jal", {0b1101111}}, // O_GPR_C_IL
-};
-
-std::unordered_map<std::string, CSR_RTypeInstructionEncoding> CSR_R_type_instruction_encoding_map{
-    {"csrrw", {0b1110011, 0b001}}, // O_GPR_C_CSR_C_GPR
-    {"csrrs", {0b1110011, 0b010}}, // O_GPR_C_CSR_C_GPR
-    {"csrrc", {0b1110011, 0b011}}, // O_GPR_C_CSR_C_GPR
-};
-
-std::unordered_map<std::string, CSR_ITypeInstructionEncoding> CSR_I_type_instruction_encoding_map{
-    {"csrrwi", {0b1110011, 0b101}}, // O_GPR_C_CSR_C_I
-    {"csrrsi", {0b1110011, 0b110}}, // O_GPR_C_CSR_C_I
-    {"csrrci", {0b1110011, 0b111}}, // O_GPR_C_CSR_C_I
-};
-
-std::unordered_map<std::string, FDRTypeInstructionEncoding> F_D_R_type_instruction_encoding_map = {
-    {"fsgnj.s", {0b1010011, 0b000, 0b0010000}}, // O_FPR_C_FPR_C_FPR
-    {"fsgnjn.s", {0b1010011, 0b001, 0b0010000}}, // O_FPR_C_FPR_C_FPR
-    {"fsgnjx.s", {0b1010011, 0b010, 0b0010000}}, // O_FPR_C_FPR_C_FPR
-
-    {"fmin.s", {0b1010011, 0b000, 0b0010100}}, // O_FPR_C_FPR_C_FPR
-    {"fmax.s", {0b1010011, 0b001, 0b0010100}}, // O_FPR_C_FPR_C_FPR
-
-    {"feq.s", {0b1010011, 0b010, 0b1010000}}, // O_GPR_C_FPR_C_FPR // affect all
-    {"flt.s", {0b1010011, 0b001, 0b1010000}}, // O_GPR_C_FPR_C_FPR // affect all
-    {"fle.s", {0b1010011, 0b000, 0b1010000}}, // O_GPR_C_FPR_C_FPR // affect all
-
-    {"feq.d", {0b1010011, 0b010, 0b1010001}}, // O_GPR_C_FPR_C_FPR
-    {"flt.d", {0b1010011, 0b001, 0b1010001}}, // O_GPR_C_FPR_C_FPR
-    {"fle.d", {0b1010011, 0b000, 0b1010001}}, // O_GPR_C_FPR_C_FPR
-
-    {"fsgnj.d", {0b1010011, 0b000, 0b0010001}}, // O_FPR_C_FPR_C_FPR
-    {"fsgnjn.d", {0b1010011, 0b001, 0b0010001}}, // O_FPR_C_FPR_C_FPR
-    {"fsgnjx.d", {0b1010011, 0b010, 0b0010001}}, // O_FPR_C_FPR_C_FPR
-
-    {"fmin.d", {0b1010011, 0b000, 0b0010101}}, // O_FPR_C_FPR_C_FPR
-    {"fmax.d", {0b1010011, 0b001, 0b0010101}}, // O_FPR_C_FPR_C_FPR
-};
-
-std::unordered_map<std::string, FDR1TypeInstructionEncoding> F_D_R1_type_instruction_encoding_map = {
-    {"fadd.s", {0b1010011, 0b0000000}}, // O_FPR_C_FPR_C_FPR
-    {"fsub.s", {0b1010011, 0b0000100}}, // O_FPR_C_FPR_C_FPR
-    {"fmul.s", {0b1010011, 0b0001000}}, // O_FPR_C_FPR_C_FPR
-    {"fdiv.s", {0b1010011, 0b0001100}}, // O_FPR_C_FPR_C_FPR
-
-    {"fadd.d", {0b1010011, 0b0000001}}, // O_FPR_C_FPR_C_FPR
-    {"fsub.d", {0b1010011, 0b0000101}}, // O_FPR_C_FPR_C_FPR
-    {"fmul.d", {0b1010011, 0b0001001}}, // O_FPR_C_FPR_C_FPR
-    {"fdiv.d", {0b1010011, 0b0001101}}, // O_FPR_C_FPR_C_FPR
-};
-
-std::unordered_map<std::string, FDR2TypeInstructionEncoding> F_D_R2_type_instruction_encoding_map = {
-    {"fsqrt.s", {0b1010011, 0b00000, 0b0101100}}, // O_FPR_C_FPR
-
-    {"fcvt.w.s", {0b1010011, 0b00000, 0b1100000}}, // O_GPR_C_FPR // affect all
-    {"fcvt.wu.s", {0b1010011, 0b00001, 0b1100000}}, // O_GPR_C_FPR // affect all
-    {"fcvt.l.s", {0b1010011, 0b00010, 0b1100000}}, // O_GPR_C_FPR // affect all
-    {"fcvt.lu.s", {0b1010011, 0b00011, 0b1100000}}, // O_GPR_C_FPR // affect all
-
-    {"fcvt.s.w", {0b1010011, 0b00000, 0b1101000}}, // O_FPR_C_GPR
-    {"fcvt.s.wu", {0b1010011, 0b00001, 0b1101000}}, // O_FPR_C_GPR
-    {"fcvt.s.l", {0b1010011, 0b00010, 0b1101000}}, // O_FPR_C_GPR
-    {"fcvt.s.lu", {0b1010011, 0b00011, 0b1101000}}, // O_FPR_C_GPR
-
-
-    {"fsqrt.d", {0b1010011, 0b00000, 0b0101101}}, // O_FPR_C_FPR
-
-    {"fcvt.w.d", {0b1010011, 0b00000, 0b1100001}}, // O_GPR_C_FPR
-    {"fcvt.wu.d", {0b1010011, 0b00001, 0b1100001}}, // O_GPR_C_FPR
-    {"fcvt.l.d", {0b1010011, 0b00010, 0b1100001}}, // O_GPR_C_FPR
-    {"fcvt.lu.d", {0b1010011, 0b00011, 0b1100001}}, // O_GPR_C_FPR
-
-    {"fcvt.d.w", {0b1010011, 0b00000, 0b1101001}}, // O_FPR_C_GPR
-    {"fcvt.d.wu", {0b1010011, 0b00001, 0b1101001}}, // O_FPR_C_GPR
-    {"fcvt.d.l", {0b1010011, 0b00010, 0b1101001}}, // O_FPR_C_GPR
-    {"fcvt.d.lu", {0b1010011, 0b00011, 0b1101001}}, // O_FPR_C_GPR
-
-
-    {"fcvt.s.d", {0b1010011, 0b00001, 0b0100000}}, // O_FPR_C_FPR
-    {"fcvt.d.s", {0b1010011, 0b00000, 0b0100001}}, // O_FPR_C_FPR
-
-};
-
-std::unordered_map<std::string, FDR3TypeInstructionEncoding> F_D_R3_type_instruction_encoding_map = {
-    {"fmv.w.x", {0b1010011, 0b000, 0b00000, 0b1111000}}, // O_FPR_C_GPR
-    {"fmv.x.w", {0b1010011, 0b000, 0b00000, 0b1110000}}, // O_GPR_C_FPR // affect all
-    {"fclass.s", {0b1010011, 0b001, 0b00000, 0b1110000}}, // O_GPR_C_FPR // affect all
-
-    {"fmv.d.x", {0b1010011, 0b000, 0b00000, 0b1111001}}, // O_FPR_C_GPR
-    {"fmv.x.d", {0b1010011, 0b000, 0b00000, 0b1110001}}, // O_GPR_C_FPR
-    {"fclass.d", {0b1010011, 0b001, 0b00000, 0b1110001}}, // O_GPR_C_FPR
-};
-
-std::unordered_map<std::string, FDR4TypeInstructionEncoding> F_D_R4_type_instruction_encoding_map = {
-    {"fmadd.s", {0b1000011, 0b00}}, // O_FPR_C_FPR_C_FPR_C_FPR
-    {"fmsub.s", {0b1000111, 0b00}}, // O_FPR_C_FPR_C_FPR_C_FPR
-    {"fnmsub.s", {0b1001011, 0b00}}, // O_FPR_C_FPR_C_FPR_C_FPR
-    {"fnmadd.s", {0b1001111, 0b00}}, // O_FPR_C_FPR_C_FPR_C_FPR
-
-    {"fmadd.d", {0b1000011, 0b01}}, // O_FPR_C_FPR_C_FPR_C_FPR
-    {"fmsub.d", {0b1000111, 0b01}}, // O_FPR_C_FPR_C_FPR_C_FPR
-    {"fnmsub.d", {0b1001011, 0b01}}, // O_FPR_C_FPR_C_FPR_C_FPR
-    {"fnmadd.d", {0b1001111, 0b01}}, // O_FPR_C_FPR_C_FPR_C_FPR
-};
-
-std::unordered_map<std::string, FDITypeInstructionEncoding> F_D_I_type_instruction_encoding_map = {
-    {"flw", {0b0000111, 0b010}}, // O_FPR_C_I_LP_GPR_RP, O_FPR_C_DL
-    {"fld", {0b0000111, 0b011}}, // O_FPR_C_I_LP_GPR_RP, O_FPR_C_DL
-};
+namespace {
+
+using Format = InstructionFormat;
+using Extension = InstructionExtension;
+
+// Columns: name, format, extension, opcode, funct2, funct3, funct5, funct6, funct7, syntaxes, syntax count.
+// The RV64 word instructions have no syntax yet, so the parser rejects them.
+constexpr auto kInstructions = std::to_array<InstructionInfo>({
+    {"add", Format::R, Extension::kBase, 0b0110011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"sub", Format::R, Extension::kBase, 0b0110011, 0b00, 0b000, 0b00000, 0b000000, 0b0100000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"xor", Format::R, Extension::kBase, 0b0110011, 0b00, 0b100, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"or", Format::R, Extension::kBase, 0b0110011, 0b00, 0b110, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"and", Format::R, Extension::kBase, 0b0110011, 0b00, 0b111, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"sll", Format::R, Extension::kBase, 0b0110011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"srl", Format::R, Extension::kBase, 0b0110011, 0b00, 0b101, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"sra", Format::R, Extension::kBase, 0b0110011, 0b00, 0b101, 0b00000, 0b000000, 0b0100000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"slt", Format::R, Extension::kBase, 0b0110011, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"sltu", Format::R, Extension::kBase, 0b0110011, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"addw", Format::R, Extension::kBase, 0b0111011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {}, 0},
+    {"subw", Format::R, Extension::kBase, 0b0111011, 0b00, 0b000, 0b00000, 0b000000, 0b0100000, {}, 0},
+    {"sllw", Format::R, Extension::kBase, 0b0111011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {}, 0},
+    {"srlw", Format::R, Extension::kBase, 0b0111011, 0b00, 0b101, 0b00000, 0b000000, 0b0000000, {}, 0},
+    {"sraw", Format::R, Extension::kBase, 0b0111011, 0b00, 0b101, 0b00000, 0b000000, 0b0100000, {}, 0},
+    {"mul", Format::R, Extension::kM, 0b0110011, 0b00, 0b000, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"mulh", Format::R, Extension::kM, 0b0110011, 0b00, 0b001, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"mulhsu", Format::R, Extension::kM, 0b0110011, 0b00, 0b010, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"mulhu", Format::R, Extension::kM, 0b0110011, 0b00, 0b011, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"div", Format::R, Extension::kM, 0b0110011, 0b00, 0b100, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"divu", Format::R, Extension::kM, 0b0110011, 0b00, 0b101, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"rem", Format::R, Extension::kM, 0b0110011, 0b00, 0b110, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"remu", Format::R, Extension::kM, 0b0110011, 0b00, 0b111, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"mulw", Format::R, Extension::kM, 0b0111011, 0b00, 0b000, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"divw", Format::R, Extension::kM, 0b0111011, 0b00, 0b100, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"divuw", Format::R, Extension::kM, 0b0111011, 0b00, 0b101, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"remw", Format::R, Extension::kM, 0b0111011, 0b00, 0b110, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"remuw", Format::R, Extension::kM, 0b0111011, 0b00, 0b111, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_GPR_C_GPR_C_GPR}, 1},
+    {"addi", Format::I1, Extension::kBase, 0b0010011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"xori", Format::I1, Extension::kBase, 0b0010011, 0b00, 0b100, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"ori", Format::I1, Extension::kBase, 0b0010011, 0b00, 0b110, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"andi", Format::I1, Extension::kBase, 0b0010011, 0b00, 0b111, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"sltiu", Format::I1, Extension::kBase, 0b0010011, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"slti", Format::I1, Extension::kBase, 0b0010011, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"addiw", Format::I1, Extension::kBase, 0b0011011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {}, 0},
+    {"lb", Format::I1, Extension::kBase, 0b0000011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}, 2},
+    {"lh", Format::I1, Extension::kBase, 0b0000011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}, 2},
+    {"lw", Format::I1, Extension::kBase, 0b0000011, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}, 2},
+    {"ld", Format::I1, Extension::kBase, 0b0000011, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}, 2},
+    {"lbu", Format::I1, Extension::kBase, 0b0000011, 0b00, 0b100, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"lhu", Format::I1, Extension::kBase, 0b0000011, 0b00, 0b101, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"lwu", Format::I1, Extension::kBase, 0b0000011, 0b00, 0b110, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"jalr", Format::I1, Extension::kBase, 0b1100111, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"slli", Format::I2, Extension::kBase, 0b0010011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"srli", Format::I2, Extension::kBase, 0b0010011, 0b00, 0b101, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"srai", Format::I2, Extension::kBase, 0b0010011, 0b00, 0b101, 0b00000, 0b010000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I}, 1},
+    {"slliw", Format::I2, Extension::kBase, 0b0011011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {}, 0},
+    {"srliw", Format::I2, Extension::kBase, 0b0011011, 0b00, 0b101, 0b00000, 0b000000, 0b0000000, {}, 0},
+    {"sraiw", Format::I2, Extension::kBase, 0b0011011, 0b00, 0b101, 0b00000, 0b010000, 0b0000000, {}, 0},
+    {"ecall", Format::I3, Extension::kBase, 0b1110011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O}, 1},
+    {"sb", Format::S, Extension::kBase, 0b0100011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"sh", Format::S, Extension::kBase, 0b0100011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"sw", Format::S, Extension::kBase, 0b0100011, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"sd", Format::S, Extension::kBase, 0b0100011, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I_LP_GPR_RP}, 1},
+    {"beq", Format::B, Extension::kBase, 0b1100011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}, 2},
+    {"bne", Format::B, Extension::kBase, 0b1100011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}, 2},
+    {"blt", Format::B, Extension::kBase, 0b1100011, 0b00, 0b100, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}, 2},
+    {"bge", Format::B, Extension::kBase, 0b1100011, 0b00, 0b101, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}, 2},
+    {"bltu", Format::B, Extension::kBase, 0b1100011, 0b00, 0b110, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}, 2},
+    {"bgeu", Format::B, Extension::kBase, 0b1100011, 0b00, 0b111, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}, 2},
+    {"lui", Format::U, Extension::kBase, 0b0110111, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I}, 1},
+    {"auipc", Format::U, Extension::kBase, 0b0010111, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I}, 1},
+    {"jal", Format::J, Extension::kBase, 0b1101111, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_I, SyntaxType::O_GPR_C_IL}, 2},
+    {"csrrw", Format::CsrR, Extension::kCsr, 0b1110011, 0b00, 0b001, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_CSR_C_GPR}, 1},
+    {"csrrs", Format::CsrR, Extension::kCsr, 0b1110011, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_CSR_C_GPR}, 1},
+    {"csrrc", Format::CsrR, Extension::kCsr, 0b1110011, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_CSR_C_GPR}, 1},
+    {"csrrwi", Format::CsrI, Extension::kCsr, 0b1110011, 0b00, 0b101, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_CSR_C_I}, 1},
+    {"csrrsi", Format::CsrI, Extension::kCsr, 0b1110011, 0b00, 0b110, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_CSR_C_I}, 1},
+    {"csrrci", Format::CsrI, Extension::kCsr, 0b1110011, 0b00, 0b111, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_CSR_C_I}, 1},
+    {"fsgnj.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0010000, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fsgnjn.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b0010000, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fsgnjx.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b010, 0b00000, 0b000000, 0b0010000, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fmin.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0010100, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fmax.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b0010100, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"feq.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b010, 0b00000, 0b000000, 0b1010000, {SyntaxType::O_GPR_C_FPR_C_FPR}, 1},
+    {"flt.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b1010000, {SyntaxType::O_GPR_C_FPR_C_FPR}, 1},
+    {"fle.s", Format::FdR, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1010000, {SyntaxType::O_GPR_C_FPR_C_FPR}, 1},
+    {"feq.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b010, 0b00000, 0b000000, 0b1010001, {SyntaxType::O_GPR_C_FPR_C_FPR}, 1},
+    {"flt.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b1010001, {SyntaxType::O_GPR_C_FPR_C_FPR}, 1},
+    {"fle.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1010001, {SyntaxType::O_GPR_C_FPR_C_FPR}, 1},
+    {"fsgnj.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0010001, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fsgnjn.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b0010001, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fsgnjx.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b010, 0b00000, 0b000000, 0b0010001, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fmin.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0010101, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fmax.d", Format::FdR, Extension::kD, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b0010101, {SyntaxType::O_FPR_C_FPR_C_FPR}, 1},
+    {"fadd.s", Format::FdR1, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fsub.s", Format::FdR1, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0000100, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fmul.s", Format::FdR1, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0001000, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fdiv.s", Format::FdR1, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0001100, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fadd.d", Format::FdR1, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0000001, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fsub.d", Format::FdR1, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0000101, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fmul.d", Format::FdR1, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0001001, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fdiv.d", Format::FdR1, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0001101, {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fsqrt.s", Format::FdR2, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0101100, {SyntaxType::O_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_RM}, 2},
+    {"fcvt.w.s", Format::FdR2, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1100000, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fcvt.wu.s", Format::FdR2, Extension::kF, 0b1010011, 0b00, 0b000, 0b00001, 0b000000, 0b1100000, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fcvt.l.s", Format::FdR2, Extension::kF, 0b1010011, 0b00, 0b000, 0b00010, 0b000000, 0b1100000, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fcvt.lu.s", Format::FdR2, Extension::kF, 0b1010011, 0b00, 0b000, 0b00011, 0b000000, 0b1100000, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fcvt.s.w", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1101000, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.s.wu", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00001, 0b000000, 0b1101000, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.s.l", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00010, 0b000000, 0b1101000, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.s.lu", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00011, 0b000000, 0b1101000, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fsqrt.d", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0101101, {SyntaxType::O_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_RM}, 2},
+    {"fcvt.w.d", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1100001, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.wu.d", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00001, 0b000000, 0b1100001, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.l.d", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00010, 0b000000, 0b1100001, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.lu.d", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00011, 0b000000, 0b1100001, {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.d.w", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1101001, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fcvt.d.wu", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00001, 0b000000, 0b1101001, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fcvt.d.l", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00010, 0b000000, 0b1101001, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.d.lu", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00011, 0b000000, 0b1101001, {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}, 2},
+    {"fcvt.s.d", Format::FdR2, Extension::kD, 0b1010011, 0b00, 0b000, 0b00001, 0b000000, 0b0100000, {SyntaxType::O_FPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fcvt.d.s", Format::FdR2, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b0100001, {SyntaxType::O_FPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}, 2},
+    {"fmv.w.x", Format::FdR3, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1111000, {SyntaxType::O_FPR_C_GPR}, 1},
+    {"fmv.x.w", Format::FdR3, Extension::kF, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1110000, {SyntaxType::O_GPR_C_FPR}, 1},
+    {"fclass.s", Format::FdR3, Extension::kF, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b1110000, {SyntaxType::O_GPR_C_FPR}, 1},
+    {"fmv.d.x", Format::FdR3, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1111001, {SyntaxType::O_FPR_C_GPR}, 1},
+    {"fmv.x.d", Format::FdR3, Extension::kD, 0b1010011, 0b00, 0b000, 0b00000, 0b000000, 0b1110001, {SyntaxType::O_GPR_C_FPR}, 1},
+    {"fclass.d", Format::FdR3, Extension::kD, 0b1010011, 0b00, 0b001, 0b00000, 0b000000, 0b1110001, {SyntaxType::O_GPR_C_FPR}, 1},
+    {"fmadd.s", Format::FdR4, Extension::kF, 0b1000011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fmsub.s", Format::FdR4, Extension::kF, 0b1000111, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fnmsub.s", Format::FdR4, Extension::kF, 0b1001011, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fnmadd.s", Format::FdR4, Extension::kF, 0b1001111, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fmadd.d", Format::FdR4, Extension::kD, 0b1000011, 0b01, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fmsub.d", Format::FdR4, Extension::kD, 0b1000111, 0b01, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fnmsub.d", Format::FdR4, Extension::kD, 0b1001011, 0b01, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"fnmadd.d", Format::FdR4, Extension::kD, 0b1001111, 0b01, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}, 2},
+    {"flw", Format::FdI, Extension::kF, 0b0000111, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_I_LP_GPR_RP}, 1},
+    {"fld", Format::FdI, Extension::kD, 0b0000111, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_I_LP_GPR_RP}, 1},
+    {"fsw", Format::FdS, Extension::kF, 0b0100111, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_I_LP_GPR_RP}, 1},
+    {"fsd", Format::FdS, Extension::kD, 0b0100111, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_FPR_C_I_LP_GPR_RP}, 1},
+    {"lr.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b00010, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_LP_GPR_RP}, 1},
+    {"sc.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b00011, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoswap.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b00001, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoadd.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoxor.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b00100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoand.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b01100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoor.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b01000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amomin.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b10000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amomax.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b10100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amominu.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b11000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amomaxu.w", Format::A, Extension::kA, 0b0101111, 0b00, 0b010, 0b11100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"lr.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b00010, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_LP_GPR_RP}, 1},
+    {"sc.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b00011, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoswap.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b00001, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoadd.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b00000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoxor.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b00100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoand.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b01100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amoor.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b01000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amomin.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b10000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amomax.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b10100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amominu.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b11000, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"amomaxu.d", Format::A, Extension::kA, 0b0101111, 0b00, 0b011, 0b11100, 0b000000, 0b0000000, {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}, 1},
+    {"la", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"nop", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"li", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"mv", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"not", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"neg", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"negw", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"sext.w", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"seqz", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"snez", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"sltz", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"sgtz", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"beqz", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"bnez", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"blez", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"bgez", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"bltz", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"bgtz", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"bgt", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"ble", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"bgtu", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"bleu", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"j", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"jr", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"ret", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"call", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"tail", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::PSEUDO}, 1},
+    {"fence", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O}, 1},
+    {"fence_i", Format::Pseudo, Extension::kPseudo, 0b0000000, 0b00, 0b000, 0b00000, 0b000000, 0b0000000, {SyntaxType::O}, 1},
+});
+
+constexpr StaticStringTable<InstructionInfo, kInstructions.size(), 4096> kInstructionTable(kInstructions);
+static_assert(!kInstructionTable.hasDuplicates(), "Duplicate mnemonic in the instruction table");
+static_assert(kInstructionTable.maxProbeLength() <= 3, "Instruction table needs more slots or a different hash");
+
+bool hasFormat(std::string_view instruction, Format format) {
+  const InstructionInfo *info = kInstructionTable.find(instruction);
+  return info && info->format==format;
+}
 
-std::unordered_map<std::string, FDSTypeInstructionEncoding> F_D_S_type_instruction_encoding_map = {
-    {"fsw", {0b0100111, 0b010}}, // O_FPR_C_I_LP_GPR_RP
-    {"fsd", {0b0100111, 0b011}}, // O_FPR_C_I_LP_GPR_RP
-};
+} // namespace
 
-/*
-   O_GPR_C_GPR_C_GPR,       ///< Opcode general-register , general-register , register
-    O_GPR_C_GPR_C_I,        ///< Opcode general-register , general-register , immediate
-    O_GPR_C_I,            ///< Opcode general-register , immediate
-    O_GPR_C_GPR_C_IL,       ///< Opcode general-register , general-register , immediate , instruction_label
-    O_GPR_C_GPR_C_DL,       ///< Opcode register , register , immediate , data_label
-    O_GPR_C_IL,           ///< Opcode register , instruction_label
-    O_GPR_C_DL,           ///< Opcode register , data_label
-    O_GPR_C_I_LP_GPR_RP,    ///< Opcode register , immediate , lparen ( register )rparen
-    O,                  ///< Opcode
-    PSEUDO,              ///< Pseudo instruction
-
-    O_GPR_C_CSR_C_GPR,       ///< Opcode general-register , csr , general-register
-    O_GPR_C_CSR_C_I,        ///< Opcode general-register , csr , immediate
-
-    O_FPR_C_FPR_C_FPR_C_FPR,    ///< Opcode floating-point-register , floating-point-register , floating-point-register , floating-point-register
-    O_FPR_C_FPR_C_FPR_C_FPR_C_RM,    ///< Opcode floating-point-register , floating-point-register , floating-point-register , rounding_mode
-    O_FPR_C_FPR_C_FPR,        ///< Opcode floating-point-register , floating-point-register , floating-point-register
-    O_FPR_C_FPR_C_FPR_C_RM,    ///< Opcode floating-point-register , floating-point-register , floating-point-register , rounding_mode
-    O_FPR_C_FPR,            ///< Opcode floating-point-register , floating-point-register
-    O_FPR_C_FPR_C_RM,           ///< Opcode floating-point-register , floating-point-register , rounding_mode
-
-    O_FPR_C_GPR,            ///< Opcode floating-point-register , general-register
-    O_FPR_C_GPR_C_RM,           ///< Opcode floating-point-register , general-register , rounding_mode
-    O_GPR_C_FPR,           ///< Opcode general-register , floating-point-register
-    O_GPR_C_FPR_C_RM,       ///< Opcode general-register , floating-point-register , rounding_mode
-    O_GPR_C_FPR_C_FPR,       ///< Opcode general-register , floating-point-register , floating-point-register
-    O_FPR_C_I_LP_GPR_RP,    ///< Opcode floating-point-register , immediate , lparen ( general-register ) rparen
-
-    DL -> Data Label
-    IL -> Instruction Label
-*/
-std::unordered_map<std::string, std::vector<SyntaxType>> instruction_syntax_map = {
-    {"add", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"sub", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"xor", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"or", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"and", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"sll", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"srl", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"sra", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"slt", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"sltu", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-
-    {"addi", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"xori", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"ori", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"andi", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"slli", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"srli", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"srai", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"slti", {SyntaxType::O_GPR_C_GPR_C_I}},
-    {"sltiu", {SyntaxType::O_GPR_C_GPR_C_I}},
-
-    {"lb", {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}},
-    {"lh", {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}},
-    {"lw", {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}},
-    {"ld", {SyntaxType::O_GPR_C_I_LP_GPR_RP, SyntaxType::O_GPR_C_DL}},
-    {"lbu", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-    {"lhu", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-    {"lwu", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-
-    {"sb", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-    {"sh", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-    {"sw", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-    {"sd", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-
-    {"beq", {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}},
-    {"bne", {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}},
-    {"blt", {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}},
-    {"bge", {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}},
-    {"bltu", {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}},
-    {"bgeu", {SyntaxType::O_GPR_C_GPR_C_I, SyntaxType::O_GPR_C_GPR_C_IL}},
-
-    {"lui", {SyntaxType::O_GPR_C_I}},
-    {"auipc", {SyntaxType::O_GPR_C_I}},
-
-    {"jal", {SyntaxType::O_GPR_C_I, SyntaxType::O_GPR_C_IL}},
-
-    {"jalr", {SyntaxType::O_GPR_C_I_LP_GPR_RP}},
-
-    {"ecall", {SyntaxType::O}},
-
-///////////////////////////////////////////////////////////////////////////////////
-
-    {"csrrw", {SyntaxType::O_GPR_C_CSR_C_GPR}},
-    {"csrrs", {SyntaxType::O_GPR_C_CSR_C_GPR}},
-    {"csrrc", {SyntaxType::O_GPR_C_CSR_C_GPR}},
-    {"csrrwi", {SyntaxType::O_GPR_C_CSR_C_I}},
-    {"csrrsi", {SyntaxType::O_GPR_C_CSR_C_I}},
-    {"csrrci", {SyntaxType::O_GPR_C_CSR_C_I}},
-
-    {"fence", {SyntaxType::O}},
-    {"fence_i", {SyntaxType::O}},
-
-///////////////////////////////////////////////////////////////////////////////////
-
-    {"nop", {SyntaxType::PSEUDO}},
-    {"li", {SyntaxType::PSEUDO}},
-    {"la", {SyntaxType::PSEUDO}},
-    {"mv", {SyntaxType::PSEUDO}},
-    {"not", {SyntaxType::PSEUDO}},
-    {"neg", {SyntaxType::PSEUDO}},
-    {"negw", {SyntaxType::PSEUDO}},
-    {"sext.w", {SyntaxType::PSEUDO}},
-    {"seqz", {SyntaxType::PSEUDO}},
-    {"snez", {SyntaxType::PSEUDO}},
-    {"sltz", {SyntaxType::PSEUDO}},
-    {"sgtz", {SyntaxType::PSEUDO}},
-    {"beqz", {SyntaxType::PSEUDO}},
-    {"bnez", {SyntaxType::PSEUDO}},
-    {"blez", {SyntaxType::PSEUDO}},
-    {"bgez", {SyntaxType::PSEUDO}},
-    {"bltz", {SyntaxType::PSEUDO}},
-    {"bgtz", {SyntaxType::PSEUDO}},
-    {"bgt", {SyntaxType::PSEUDO}},
-    {"ble", {SyntaxType::PSEUDO}},
-    {"bgtu", {SyntaxType::PSEUDO}},
-    {"bleu", {SyntaxType::PSEUDO}},
-    {"j", {SyntaxType::PSEUDO}},
-    {"jr", {SyntaxType::PSEUDO}},
-    {"ret", {SyntaxType::PSEUDO}},
-    {"call", {SyntaxType::PSEUDO}},
-    {"tail", {SyntaxType::PSEUDO}},
-    {"fence", {SyntaxType::PSEUDO}},
-    {"fence_i", {SyntaxType::PSEUDO}},
-
-///////////////////////////////////////////////////////////////////////////////////
-    {"mul", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"mulh", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"mulhsu", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"mulhu", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"div", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"divu", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"rem", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"remu", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-
-    {"mulw", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"divw", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"divuw", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"remw", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-    {"remuw", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-
-///////////////////////////////////////////////////////////////////////////////////
-
-    {"flw", {SyntaxType::O_FPR_C_I_LP_GPR_RP}},
-    {"fsw", {SyntaxType::O_FPR_C_I_LP_GPR_RP}},
-
-    {"fmadd.s", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-    {"fmsub.s", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-    {"fnmsub.s", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-    {"fnmadd.s", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-
-    {"fadd.s", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-    {"fsub.s", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-    {"fmul.s", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-    {"fdiv.s", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-
-    {"fsqrt.s", {SyntaxType::O_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_RM}},
-
-    {"fsgnj.s", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fsgnjn.s", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fsgnjx.s", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fmin.s", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fmax.s", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-
-    {"feq.s", {SyntaxType::O_GPR_C_FPR_C_FPR}},
-    {"flt.s", {SyntaxType::O_GPR_C_FPR_C_FPR}},
-    {"fle.s", {SyntaxType::O_GPR_C_FPR_C_FPR}},
-
-    {"fclass.s", {SyntaxType::O_GPR_C_FPR}},
-
-    {"fmv.x.w", {SyntaxType::O_GPR_C_FPR}}, // x[n][0:31] to f[m][0:31], 32-bit floating-point value from an f (floating-point) register into an x (integer) register without conversion
-    {"fmv.w.x", {SyntaxType::O_FPR_C_GPR}}, // f[n][0:31] to x[m][0:31],
-
-    {"fcvt.w.s", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // f32->int32
-    {"fcvt.wu.s", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // f32->uint32
-    {"fcvt.l.s", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // f32->int64
-    {"fcvt.lu.s", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // f32->uint64
-
-    {"fcvt.s.w", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // int32->f32
-    {"fcvt.s.wu", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // uint32->f32
-    {"fcvt.s.l", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // int64->f32
-    {"fcvt.s.lu", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // uint64->f32
-
-
-///////////////////////////////////////////////////////////////////////////////////
-
-    {"fld", {SyntaxType::O_FPR_C_I_LP_GPR_RP}},
-    {"fsd", {SyntaxType::O_FPR_C_I_LP_GPR_RP}},
-
-    {"fmadd.d", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-    {"fmsub.d", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-    {"fnmsub.d", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-    {"fnmadd.d", {SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_FPR_C_RM}},
-
-    {"fadd.d", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-    {"fsub.d", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-    {"fmul.d", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-    {"fdiv.d", {SyntaxType::O_FPR_C_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_FPR_C_RM}},
-
-    {"fsqrt.d", {SyntaxType::O_FPR_C_FPR, SyntaxType::O_FPR_C_FPR_C_RM}},
-
-    {"fsgnj.d", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fsgnjn.d", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fsgnjx.d", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fmin.d", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-    {"fmax.d", {SyntaxType::O_FPR_C_FPR_C_FPR}},
-
-    {"feq.d", {SyntaxType::O_GPR_C_FPR_C_FPR}},
-    {"flt.d", {SyntaxType::O_GPR_C_FPR_C_FPR}},
-    {"fle.d", {SyntaxType::O_GPR_C_FPR_C_FPR}},
-
-    {"fclass.d", {SyntaxType::O_GPR_C_FPR}},
-
-    {"fcvt.w.d", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // f64->int32, sign extends
-    {"fcvt.wu.d", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // f64->uint32, sign extends
-    {"fcvt.l.d", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // f64->int64
-    {"fcvt.lu.d", {SyntaxType::O_GPR_C_FPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // f64->uint64
-
-    {"fcvt.d.w", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // int32->f64
-    {"fcvt.d.wu", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // uint32->f64
-    {"fcvt.d.l", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // int64->f64
-    {"fcvt.d.lu", {SyntaxType::O_FPR_C_GPR, SyntaxType::O_FPR_C_GPR_C_RM}}, // uint64->f64
+const InstructionInfo *findInstruction(std::string_view name) {
+  return kInstructionTable.find(name);
+}
 
-    {"fcvt.s.d", {SyntaxType::O_FPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // f64->f32
-    {"fcvt.d.s", {SyntaxType::O_FPR_C_FPR, SyntaxType::O_GPR_C_FPR_C_RM}}, // f32->f64
+InstructionId findInstructionId(std::string_view name) {
+  const InstructionInfo *info = kInstructionTable.find(name);
+  return info ? static_cast<InstructionId>(info - kInstructionTable.entries().data()) : kNoInstruction;
+}
 
-    {"fmv.x.d", {SyntaxType::O_GPR_C_FPR}}, // x[n][0:63] to f[m][0:63], 64-bit floating-point value from an f (floating-point) register into an x (integer) register without conversion
-    {"fmv.d.x", {SyntaxType::O_FPR_C_GPR}}, // f[n][0:63] to x[m][0:63], 64-bit floating-point value from an x (integer) register into an f (floating-point) register without conversion
+const InstructionInfo &getInstructionInfo(InstructionId id) {
+  return kInstructionTable.entries()[id];
+}
 
-};
+bool isValidInstruction(std::string_view instruction) {
+  return kInstructionTable.find(instruction)!=nullptr;
+}
 
-bool isValidInstruction(const std::string &instruction) {
-  return valid_instructions.find(instruction)!=valid_instructions.end();
+bool isValidRTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::R);
 }
 
-bool isValidRTypeInstruction(const std::string &instruction) {
-  return RTypeInstructions.find(instruction)!=RTypeInstructions.end();
+bool isValidITypeInstruction(std::string_view instruction) {
+  const InstructionInfo *info = kInstructionTable.find(instruction);
+  return info && (info->format==Format::I1 || info->format==Format::I2 || info->format==Format::I3);
 }
 
-bool isValidITypeInstruction(const std::string &instruction) {
-  return (I1TypeInstructions.find(instruction)!=I1TypeInstructions.end()) ||
-      (I2TypeInstructions.find(instruction)!=I2TypeInstructions.end()) ||
-      (I3TypeInstructions.find(instruction)!=I3TypeInstructions.end());
+bool isValidI1TypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::I1);
 }
 
-bool isValidI1TypeInstruction(const std::string &instruction) {
-  return I1TypeInstructions.find(instruction)!=I1TypeInstructions.end();
+bool isValidI2TypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::I2);
 }
 
-bool isValidI2TypeInstruction(const std::string &instruction) {
-  return I2TypeInstructions.find(instruction)!=I2TypeInstructions.end();
+bool isValidI3TypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::I3);
 }
 
-bool isValidI3TypeInstruction(const std::string &instruction) {
-  return I3TypeInstructions.find(instruction)!=I3TypeInstructions.end();
+bool isValidSTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::S);
 }
 
-bool isValidSTypeInstruction(const std::string &instruction) {
-  return STypeInstructions.find(instruction)!=STypeInstructions.end();
+bool isValidBTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::B);
 }
 
-bool isValidBTypeInstruction(const std::string &instruction) {
-  return BTypeInstructions.find(instruction)!=BTypeInstructions.end();
+bool isValidUTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::U);
 }
 
-bool isValidUTypeInstruction(const std::string &instruction) {
-  return UTypeInstructions.find(instruction)!=UTypeInstructions.end();
+bool isValidJTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::J);
 }
 
-bool isValidJTypeInstruction(const std::string &instruction) {
-  return JTypeInstructions.find(instruction)!=JTypeInstructions.end();
+bool isValidPseudoInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::Pseudo);
 }
 
-bool isValidPseudoInstruction(const std::string &instruction) {
-  return PseudoInstructions.find(instruction)!=PseudoInstructions.end();
+bool isValidBaseExtensionInstruction(std::string_view instruction) {
+  const InstructionInfo *info = kInstructionTable.find(instruction);
+  return info && info->extension==Extension::kBase;
 }
 
-bool isValidBaseExtensionInstruction(const std::string &instruction) {
-  return BaseExtensionInstructions.find(instruction)!=BaseExtensionInstructions.end();
+bool isValidMExtensionInstruction(std::string_view instruction) {
+  const InstructionInfo *info = kInstructionTable.find(instruction);
+  return info && info->extension==Extension::kM;
 }
 
-bool isValidMExtensionInstruction(const std::string &instruction) {
-  return MExtensionInstructions.find(instruction)!=MExtensionInstructions.end();
+bool isValidCSRRTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::CsrR);
 }
 
-bool isValidCSRRTypeInstruction(const std::string &instruction) {
-  return CSRRInstructions.find(instruction)!=CSRRInstructions.end();
+bool isValidCSRITypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::CsrI);
 }
 
-bool isValidCSRITypeInstruction(const std::string &instruction) {
-  return CSRIInstructions.find(instruction)!=CSRIInstructions.end();
+bool isValidCSRInstruction(std::string_view instruction) {
+  const InstructionInfo *info = kInstructionTable.find(instruction);
+  return info && (info->format==Format::CsrR || info->format==Format::CsrI);
 }
 
-bool isValidCSRInstruction(const std::string &instruction) {
-  return (CSRRInstructions.find(instruction)!=CSRRInstructions.end()) ||
-      (CSRIInstructions.find(instruction)!=CSRIInstructions.end());
+bool isValidFDRTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::FdR);
 }
 
-bool isValidFDRTypeInstruction(const std::string &instruction) {
-  return (FDExtensionRTypeInstructions.find(instruction)!=FDExtensionRTypeInstructions.end());
+bool isValidFDR1TypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::FdR1);
 }
 
-bool isValidFDR1TypeInstruction(const std::string &instruction) {
-  return (FDExtensionR1TypeInstructions.find(instruction)!=FDExtensionR1TypeInstructions.end());
+bool isValidFDR2TypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::FdR2);
 }
 
-bool isValidFDR2TypeInstruction(const std::string &instruction) {
-  return (FDExtensionR2TypeInstructions.find(instruction)!=FDExtensionR2TypeInstructions.end());
+bool isValidFDR3TypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::FdR3);
 }
 
-bool isValidFDR3TypeInstruction(const std::string &instruction) {
-  return (FDExtensionR3TypeInstructions.find(instruction)!=FDExtensionR3TypeInstructions.end());
+bool isValidFDR4TypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::FdR4);
 }
 
-bool isValidFDR4TypeInstruction(const std::string &instruction) {
-  return (FDExtensionR4TypeInstructions.find(instruction)!=FDExtensionR4TypeInstructions.end());
+bool isValidFDITypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::FdI);
 }
 
-bool isValidFDITypeInstruction(const std::string &instruction) {
-  return (FDExtensionITypeInstructions.find(instruction)!=FDExtensionITypeInstructions.end());
+bool isValidFDSTypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::FdS);
 }
 
-bool isValidFDSTypeInstruction(const std::string &instruction) {
-  return (FDExtensionSTypeInstructions.find(instruction)!=FDExtensionSTypeInstructions.end());
+bool isValidATypeInstruction(std::string_view instruction) {
+  return hasFormat(instruction, Format::A);
 }
 
 bool isFInstruction(const uint32_t &instruction) {
@@ -965,8 +547,8 @@ bool isDInstruction(const uint32_t &instruction) {
   return false;
 }
 
-std::string getExpectedSyntaxes(const std::string &opcode) {
-  static const std::unordered_map<std::string, std::string> opcodeSyntaxMap = {
+std::string getExpectedSyntaxes(std::string_view opcode) {
+  static const std::unordered_map<std::string_view, std::string> opcodeSyntaxMap = {
       {"nop", "nop"},
       {"li", "li <reg>, <imm>"},
       {"mv", "mv <reg>, <reg>"},
@@ -1019,17 +601,23 @@ std::string getExpectedSyntaxes(const std::string &opcode) {
       {SyntaxType::O_GPR_C_FPR_C_RM, "<gp-reg>, <fp-reg>, <rm>"},
       {SyntaxType::O_GPR_C_FPR_C_FPR, "<gp-reg>, <fp-reg>, <fp-reg>"},
       {SyntaxType::O_FPR_C_I_LP_GPR_RP, "<fp-reg>, <imm>(<gp-reg>)"},
+      {SyntaxType::O_GPR_C_LP_GPR_RP, "<gp-reg>, (<gp-reg>)"},
+      {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP, "<gp-reg>, <gp-reg>, (<gp-reg>)"},
   };
 
   std::string syntaxes;
-  const auto &syntaxList = instruction_syntax_map[opcode];
+  const InstructionInfo *info = findInstruction(opcode);
+  if (!info) {
+    return syntaxes;
+  }
+  std::span<const SyntaxType> syntaxList = info->syntaxes();
   for (size_t i = 0; i < syntaxList.size(); ++i) {
     if (i > 0) {
       syntaxes += " or ";
     }
     auto syntaxIt = syntaxTypeToString.find(syntaxList[i]);
     if (syntaxIt!=syntaxTypeToString.end()) {
-      syntaxes += opcode + " " + syntaxIt->second;
+      syntaxes += std::string(opcode) + " " + syntaxIt->second;
     }
   }
 
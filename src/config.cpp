@@ -29,6 +29,14 @@ namespace vm_config
                 {
                     setVmType(VmTypes::MULTI_STAGE);
                 }
+                else if (value == "in_order")
+                {
+                    setVmType(VmTypes::IN_ORDER);
+                }
+                else if (value == "out_of_order")
+                {
+                    setVmType(VmTypes::OUT_OF_ORDER);
+                }
                 else
                 {
                     throw std::invalid_argument("Unknown VM type: " + value);
@@ -42,6 +50,22 @@ namespace vm_config
             {
                 setInstructionExecutionLimit(std::stoull(value));
             }
+            else if (key == "checkpoint_interval")
+            {
+                uint64_t interval = std::stoull(value);
+                if (interval == 0) {
+                    throw std::invalid_argument("checkpoint_interval must be at least 1: " + value);
+                }
+                setCheckpointInterval(interval);
+            }
+            else if (key == "max_checkpoints")
+            {
+                uint64_t count = std::stoull(value);
+                if (count < 2) {
+                    throw std::invalid_argument("max_checkpoints must be at least 2: " + value);
+                }
+                setMaxCheckpoints(count);
+            }
             else if (key == "hazard_detection") {
                 if (value == "true") {
                     setHazardDetectionEnabled(true);
@@ -68,6 +92,12 @@ namespace vm_config
                     branch_prediction_type = BranchPredictionType::DYNAMIC1BIT;
                 } else if (value == "dynamic_2bit") {
                     branch_prediction_type = BranchPredictionType::DYNAMIC2BIT;
+                } else if (value == "gshare") {
+                    branch_prediction_type = BranchPredictionType::GSHARE;
+                } else if (value == "tournament") {
+                    branch_prediction_type = BranchPredictionType::TOURNAMENT;
+                } else if (value == "tage") {
+                    branch_prediction_type = BranchPredictionType::TAGE;
                 } else {
                     std::cerr << "Unknown branch prediction type: '" << value << "'. Defaulting to 'none'." << std::endl;
                     branch_prediction_type = BranchPredictionType::NONE;
@@ -160,6 +190,21 @@ namespace vm_config
                     throw std::invalid_argument("Unknown value: " + value);
                 }
             }
+            else if (key == "assembly_cache")
+            {
+                if (value == "true")
+                {
+                    setAssemblyCacheEnabled(true);
+                }
+                else if (value == "false")
+                {
+                    setAssemblyCacheEnabled(false);
+                }
+                else
+                {
+                    throw std::invalid_argument("Unknown value: " + value);
+                }
+            }
         }
 
         else if (section == "General") {
@@ -188,8 +233,229 @@ namespace vm_config
             } else if (key == "cache_write_miss_policy") {
                 setCacheWriteMissPolicy(value);
             }
+        } else if (section == "Pipeline") {
+            uint64_t count = std::stoull(value);
+            if (key == "issue_width") {
+                if (count == 0 || count > 8) {
+                    throw std::invalid_argument("issue_width must be between 1 and 8: " + value);
+                }
+                setIssueWidth(count);
+            } else if (key == "frontend_stages" || key == "execute_stages" || key == "memory_stages") {
+                if (count == 0 || count > 16) {
+                    throw std::invalid_argument(key + " must be between 1 and 16: " + value);
+                }
+                if (key == "frontend_stages") {
+                    setFrontendStages(count);
+                } else if (key == "execute_stages") {
+                    setExecuteStages(count);
+                } else {
+                    setMemoryStages(count);
+                }
+            }
+        } else if (section == "OutOfOrder") {
+            uint64_t count = std::stoull(value);
+            if (key == "width") {
+                if (count == 0 || count > 8) {
+                    throw std::invalid_argument("width must be between 1 and 8: " + value);
+                }
+                setOooWidth(count);
+            } else if (key == "rob_size" || key == "issue_queue_size" || key == "lsq_size") {
+                if (count == 0 || count > 1024) {
+                    throw std::invalid_argument(key + " must be between 1 and 1024: " + value);
+                }
+                if (key == "rob_size") {
+                    setRobSize(count);
+                } else if (key == "issue_queue_size") {
+                    setIssueQueueSize(count);
+                } else {
+                    setLsqSize(count);
+                }
+            } else if (key == "physical_registers") {
+                // Every architectural GPR and FPR needs a physical register, plus at least one to rename into
+                if (count <= 64 || count > 4096) {
+                    throw std::invalid_argument("physical_registers must be between 65 and 4096: " + value);
+                }
+                setPhysicalRegisters(count);
+            }
+        } else if (section == "Sampling") {
+            if (key == "mode") {
+                if (value == "window") {
+                    setSamplingMode(SamplingMode::WINDOW);
+                } else if (value == "periodic") {
+                    setSamplingMode(SamplingMode::PERIODIC);
+                } else {
+                    throw std::invalid_argument("Unknown value for mode: " + value);
+                }
+            } else if (key == "confidence") {
+                double confidence = std::stod(value);
+                if (!(confidence > 0.0 && confidence < 1.0)) {
+                    throw std::invalid_argument("confidence must be between 0 and 1: " + value);
+                }
+                setSamplingConfidence(confidence);
+            } else if (key == "fast_forward") {
+                setSamplingFastForward(std::stoull(value));
+            } else if (key == "warmup") {
+                setSamplingWarmup(std::stoull(value));
+            } else if (key == "window" || key == "period") {
+                uint64_t count = std::stoull(value);
+                if (count == 0) {
+                    throw std::invalid_argument(key + " must be at least 1: " + value);
+                }
+                if (key == "window") {
+                    setSamplingWindow(count);
+                } else {
+                    setSamplingPeriod(count);
+                }
+            }
+        } else if (section == "SimPoint") {
+            uint64_t count = std::stoull(value);
+            if (key == "interval") {
+                if (count == 0) {
+                    throw std::invalid_argument("interval must be at least 1: " + value);
+                }
+                setSimPointInterval(count);
+            } else if (key == "max_clusters" || key == "dimensions") {
+                if (count == 0 || count > 100) {
+                    throw std::invalid_argument(key + " must be between 1 and 100: " + value);
+                }
+                if (key == "max_clusters") {
+                    setSimPointMaxClusters(count);
+                } else {
+                    setSimPointDimensions(count);
+                }
+            }
+        } else if (section == "Multicore") {
+            if (key == "core") {
+                if (value == "single_stage") {
+                    setMulticoreCore(VmTypes::SINGLE_STAGE);
+                } else if (value == "multi_stage") {
+                    setMulticoreCore(VmTypes::MULTI_STAGE);
+                } else {
+                    throw std::invalid_argument("Unknown value for core: " + value);
+                }
+            } else if (key == "harts") {
+                uint64_t harts = std::stoull(value);
+                if (harts == 0 || harts > 64) {
+                    throw std::invalid_argument("harts must be between 1 and 64: " + value);
+                }
+                setMulticoreHarts(harts);
+            } else if (key == "l1_lines" || key == "l1_block_size" || key == "l1_associativity") {
+                uint64_t count = std::stoull(value);
+                if (count == 0) {
+                    throw std::invalid_argument(key + " must be at least 1: " + value);
+                }
+                if (key == "l1_lines") {
+                    setMulticoreL1Lines(count);
+                } else if (key == "l1_block_size") {
+                    setMulticoreL1BlockSize(count);
+                } else {
+                    setMulticoreL1Associativity(count);
+                }
+            } else if (key == "stack_spacing") {
+                setMulticoreStackSpacing(std::stoull(value, nullptr, 0));
+            } else if (key == "quantum") {
+                setMulticoreQuantum(std::stoull(value));
+            } else if (key == "threads") {
+                uint64_t threads = std::stoull(value);
+                if (threads > 64) {
+                    throw std::invalid_argument("threads must be between 0 and 64: " + value);
+                }
+                setMulticoreThreads(threads);
+            } else if (key == "deterministic") {
+                if (value != "true" && value != "false") {
+                    throw std::invalid_argument("Unknown value for deterministic: " + value);
+                }
+                setMulticoreDeterministic(value == "true");
+            }
+        } else if (section == "Batch") {
+            if (key == "threads") {
+                uint64_t threads = std::stoull(value);
+                if (threads > 256) {
+                    throw std::invalid_argument("threads must be between 0 and 256: " + value);
+                }
+                setBatchThreads(threads);
+            }
+        } else if (section == "Syscalls") {
+            if (key == "sandbox_directory") {
+                setSyscallSandboxDirectory(value);
+            }
         } else if (section == "BranchPrediction") {
-            // Do nothing for now
+            // Table sizes must be powers of two so they can be indexed with a mask
+            auto parse_table_size = [&]() {
+                uint64_t size = std::stoull(value);
+                if (size == 0 || (size & (size - 1)) != 0) {
+                    throw std::invalid_argument(key + " must be a power of two: " + value);
+                }
+                return size;
+            };
+
+            if (key == "one_bit_table_size") {
+                setOneBitTableSize(parse_table_size());
+            } else if (key == "bimodal_table_size") {
+                setBimodalTableSize(parse_table_size());
+            } else if (key == "gshare_table_size") {
+                setGshareTableSize(parse_table_size());
+            } else if (key == "gshare_history_bits") {
+                uint64_t bits = std::stoull(value);
+                if (bits == 0 || bits > 64) {
+                    throw std::invalid_argument("gshare_history_bits must be between 1 and 64: " + value);
+                }
+                setGshareHistoryBits(bits);
+            } else if (key == "chooser_table_size") {
+                setChooserTableSize(parse_table_size());
+            } else if (key == "tage_table_size") {
+                setTageTableSize(parse_table_size());
+            } else if (key == "tage_num_tables") {
+                uint64_t tables = std::stoull(value);
+                if (tables == 0 || tables > 16) {
+                    throw std::invalid_argument("tage_num_tables must be between 1 and 16: " + value);
+                }
+                setTageNumTables(tables);
+            } else if (key == "tage_min_history" || key == "tage_max_history") {
+                uint64_t length = std::stoull(value);
+                if (length == 0 || length > 64) {
+                    throw std::invalid_argument(key + " must be between 1 and 64: " + value);
+                }
+                if (key == "tage_min_history") {
+                    if (length > getTageMaxHistory()) {
+                        throw std::invalid_argument("tage_min_history cannot exceed tage_max_history: " + value);
+                    }
+                    setTageMinHistory(length);
+                } else {
+                    if (length < getTageMinHistory()) {
+                        throw std::invalid_argument("tage_max_history cannot be below tage_min_history: " + value);
+                    }
+                    setTageMaxHistory(length);
+                }
+            } else if (key == "btb_enabled" || key == "ras_enabled") {
+                if (value != "true" && value != "false") {
+                    throw std::invalid_argument("Unknown value for " + key + ": " + value);
+                }
+                if (key == "btb_enabled") {
+                    setBtbEnabled(value == "true");
+                } else {
+                    setRasEnabled(value == "true");
+                }
+            } else if (key == "btb_entries") {
+                uint64_t entries = parse_table_size();
+                if (entries < getBtbAssociativity()) {
+                    throw std::invalid_argument("btb_entries cannot be smaller than btb_associativity: " + value);
+                }
+                setBtbEntries(entries);
+            } else if (key == "btb_associativity") {
+                uint64_t ways = parse_table_size();
+                if (ways > getBtbEntries()) {
+                    throw std::invalid_argument("btb_associativity cannot exceed btb_entries: " + value);
+                }
+                setBtbAssociativity(ways);
+            } else if (key == "ras_size") {
+                uint64_t depth = std::stoull(value);
+                if (depth == 0) {
+                    throw std::invalid_argument("ras_size must be at least 1: " + value);
+                }
+                setRasSize(depth);
+            }
+            // Older config files carry branch_prediction_table_size and friends; they are ignored
         }
         else
         {
@@ -295,7 +561,9 @@ namespace vm_config
         config_file << "hazard_detection=" << (isHazardDetectionEnabled() ? "true" : "false") << "\n";
         config_file << "forwarding=" << (isForwardingEnabled() ? "true" : "false") << "\n";
         config_file << "branch_prediction=" << getBranchPredictionTypeString() << "\n";
-        config_file << "instruction_execution_limit=" << instruction_execution_limit << "\n\n";
+        config_file << "instruction_execution_limit=" << instruction_execution_limit << "\n";
+        config_file << "checkpoint_interval=" << getCheckpointInterval() << "\n";
+        config_file << "max_checkpoints=" << getMaxCheckpoints() << "\n\n";
 
         config_file << "[Memory]\n";
         config_file << "memory_size=0x" << std::hex << getMemorySize() << std::dec << "\n";
@@ -315,10 +583,70 @@ namespace vm_config
         config_file << "cache_write_hit_policy=" << getCacheWriteHitPolicy() << "\n";
         config_file << "cache_write_miss_policy=" << getCacheWriteMissPolicy() << "\n\n";
 
+        config_file << "[Pipeline]\n";
+        config_file << "issue_width=" << getIssueWidth() << "\n";
+        config_file << "frontend_stages=" << getFrontendStages() << "\n";
+        config_file << "execute_stages=" << getExecuteStages() << "\n";
+        config_file << "memory_stages=" << getMemoryStages() << "\n\n";
+
+        config_file << "[OutOfOrder]\n";
+        config_file << "width=" << getOooWidth() << "\n";
+        config_file << "rob_size=" << getRobSize() << "\n";
+        config_file << "issue_queue_size=" << getIssueQueueSize() << "\n";
+        config_file << "lsq_size=" << getLsqSize() << "\n";
+        config_file << "physical_registers=" << getPhysicalRegisters() << "\n\n";
+
+        config_file << "[Sampling]\n";
+        config_file << "mode=" << getSamplingModeString() << "\n";
+        config_file << "fast_forward=" << getSamplingFastForward() << "\n";
+        config_file << "warmup=" << getSamplingWarmup() << "\n";
+        config_file << "window=" << getSamplingWindow() << "\n";
+        config_file << "period=" << getSamplingPeriod() << "\n";
+        config_file << "confidence=" << getSamplingConfidence() << "\n\n";
+
+        config_file << "[SimPoint]\n";
+        config_file << "interval=" << getSimPointInterval() << "\n";
+        config_file << "max_clusters=" << getSimPointMaxClusters() << "\n";
+        config_file << "dimensions=" << getSimPointDimensions() << "\n\n";
+
+        config_file << "[Multicore]\n";
+        config_file << "harts=" << getMulticoreHarts() << "\n";
+        config_file << "core=" << getMulticoreCoreString() << "\n";
+        config_file << "l1_lines=" << getMulticoreL1Lines() << "\n";
+        config_file << "l1_block_size=" << getMulticoreL1BlockSize() << "\n";
+        config_file << "l1_associativity=" << getMulticoreL1Associativity() << "\n";
+        config_file << "stack_spacing=" << getMulticoreStackSpacing() << "\n";
+        config_file << "quantum=" << getMulticoreQuantum() << "\n";
+        config_file << "threads=" << getMulticoreThreads() << "\n";
+        config_file << "deterministic=" << (getMulticoreDeterministic() ? "true" : "false") << "\n\n";
+
+        config_file << "[Batch]\n";
+        config_file << "threads=" << getBatchThreads() << "\n\n";
+
+        config_file << "[Syscalls]\n";
+        config_file << "sandbox_directory=" << getSyscallSandboxDirectory() << "\n\n";
+
+        config_file << "[BranchPrediction]\n";
+        config_file << "one_bit_table_size=" << getOneBitTableSize() << "\n";
+        config_file << "bimodal_table_size=" << getBimodalTableSize() << "\n";
+        config_file << "gshare_table_size=" << getGshareTableSize() << "\n";
+        config_file << "gshare_history_bits=" << getGshareHistoryBits() << "\n";
+        config_file << "chooser_table_size=" << getChooserTableSize() << "\n";
+        config_file << "tage_table_size=" << getTageTableSize() << "\n";
+        config_file << "tage_num_tables=" << getTageNumTables() << "\n";
+        config_file << "tage_min_history=" << getTageMinHistory() << "\n";
+        config_file << "tage_max_history=" << getTageMaxHistory() << "\n";
+        config_file << "btb_enabled=" << (getBtbEnabled() ? "true" : "false") << "\n";
+        config_file << "btb_entries=" << getBtbEntries() << "\n";
+        config_file << "btb_associativity=" << getBtbAssociativity() << "\n";
+        config_file << "ras_enabled=" << (getRasEnabled() ? "true" : "false") << "\n";
+        config_file << "ras_size=" << getRasSize() << "\n\n";
+
         config_file << "[Assembler]\n";
         config_file << "m_extension_enabled=" << (getMExtensionEnabled() ? "true" : "false") << "\n";
         config_file << "f_extension_enabled=" << (getFExtensionEnabled() ? "true" : "false") << "\n";
-        config_file << "d_extension_enabled=" << (getDExtensionEnabled() ? "true" : "false") << "\n\n";
+        config_file << "d_extension_enabled=" << (getDExtensionEnabled() ? "true" : "false") << "\n";
+        config_file << "assembly_cache=" << (getAssemblyCacheEnabled() ? "true" : "false") << "\n\n";
         config_file.close();
 
     }
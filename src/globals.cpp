@@ -3,18 +3,39 @@
 
 std::filesystem::path globals::invokation_path = std::filesystem::current_path();
 
-std::filesystem::path globals::vm_state_directory = globals::invokation_path / "vm_state";
+thread_local std::filesystem::path globals::vm_state_directory = globals::invokation_path / "vm_state";
 std::filesystem::path globals::config_file_path = (globals::invokation_path / "vm_state" / "config.ini");
-std::filesystem::path globals::disassembly_file_path = (globals::invokation_path / "vm_state" / "disassembly.txt");
-std::filesystem::path globals::errors_dump_file_path = (globals::invokation_path / "vm_state" / "errors_dump.json");
-std::filesystem::path globals::registers_dump_file_path = (globals::invokation_path / "vm_state" / "registers_dump.json");
-std::filesystem::path globals::memory_dump_file_path = (globals::invokation_path / "vm_state" / "memory_dump.json");
-std::filesystem::path globals::cache_dump_file_path = (globals::invokation_path / "vm_state" / "cache_dump.json");
-std::filesystem::path globals::vm_state_dump_file_path = (globals::invokation_path / "vm_state" / "vm_state_dump.json");
-std::filesystem::path globals::pipeline_registers_dump_file_path = (globals::invokation_path / "vm_state" / "pipeline_registers_dump.json");
+thread_local std::filesystem::path globals::disassembly_file_path = (globals::invokation_path / "vm_state" / "disassembly.txt");
+thread_local std::filesystem::path globals::errors_dump_file_path = (globals::invokation_path / "vm_state" / "errors_dump.json");
+thread_local std::filesystem::path globals::registers_dump_file_path = (globals::invokation_path / "vm_state" / "registers_dump.json");
+thread_local std::filesystem::path globals::memory_dump_file_path = (globals::invokation_path / "vm_state" / "memory_dump.json");
+thread_local std::filesystem::path globals::cache_dump_file_path = (globals::invokation_path / "vm_state" / "cache_dump.json");
+thread_local std::filesystem::path globals::vm_state_dump_file_path = (globals::invokation_path / "vm_state" / "vm_state_dump.json");
+std::filesystem::path globals::assembly_cache_directory = (globals::invokation_path / "vm_state" / "assembly_cache");
+thread_local std::filesystem::path globals::pipeline_registers_dump_file_path = (globals::invokation_path / "vm_state" / "pipeline_registers_dump.json");
+thread_local std::filesystem::path globals::simpoint_bbv_file_path = (globals::invokation_path / "vm_state" / "simpoint.bb");
+thread_local std::filesystem::path globals::simpoint_file_path = (globals::invokation_path / "vm_state" / "simpoint.simpoints");
+thread_local std::filesystem::path globals::simpoint_weights_file_path = (globals::invokation_path / "vm_state" / "simpoint.weights");
 
 bool globals::verbose_errors_print = false;
 bool globals::verbose_warnings = false;
 bool globals::vm_as_backend = false;
 
 unsigned int globals::text_section_start = 0x00000000;
+
+void globals::setStateDirectory(const std::filesystem::path &directory) {
+  auto in_directory = [&](const char *name) {
+    return directory.empty() ? std::filesystem::path() : directory / name;
+  };
+  vm_state_directory = directory;
+  disassembly_file_path = in_directory("disassembly.txt");
+  errors_dump_file_path = in_directory("errors_dump.json");
+  registers_dump_file_path = in_directory("registers_dump.json");
+  memory_dump_file_path = in_directory("memory_dump.json");
+  cache_dump_file_path = in_directory("cache_dump.json");
+  vm_state_dump_file_path = in_directory("vm_state_dump.json");
+  pipeline_registers_dump_file_path = in_directory("pipeline_registers_dump.json");
+  simpoint_bbv_file_path = in_directory("simpoint.bb");
+  simpoint_file_path = in_directory("simpoint.simpoints");
+  simpoint_weights_file_path = in_directory("simpoint.weights");
+}
@@ -1,29 +1,37 @@
 #include "main.h"
 #include "assembler/assembler.h"
+#include "assembler/elf_util.h"
+#include "assembler/incremental_assembler.h"
 #include "utils.h"
 #include "globals.h"
 #include "vm/rvss/rvss_vm.h"
 #include "vm/rv5s/rv5s_vm.h" // 5 Stage Pipiline VM
+#include "vm/rvio/rvio_vm.h" // In-order N-wide pipeline model
+#include "vm/rvooo/rvooo_vm.h" // Out-of-order core model
 #include "vm_runner.h"
 #include "command_handler.h"
 #include "config.h"
+#include "bp_bench.h"
+#include "sampling.h"
+#include "multicore.h"
+#include "batch.h"
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <map>
 #include <memory> // For std::unique_ptr
 #include <thread>
 #include <bitset>
 #include <regex>
 
-std::unique_ptr<VmBase> createVMInstance(vm_config::VmTypes vmType) {
-
-  if (vmType == vm_config::VmTypes::SINGLE_STAGE) {
-    std::cout << "Initializing Single-Stage VM..." << std::endl;
-    return std::make_unique<RVSSVM>();
-  } else {
-    std::cout << "Initializing 5-Stage VM..." << std::endl;
-    return std::make_unique<RV5SVM>();
+// Takes argv[i] and the file arguments after it, leaving i on the last one
+std::vector<std::string> collectFileArguments(int argc, char *argv[], int &i) {
+  std::vector<std::string> files{argv[i]};
+  while (i + 1 < argc && argv[i + 1][0] != '-') {
+    files.emplace_back(argv[++i]);
   }
-
+  return files;
 }
 
 int main(int argc, char *argv[]) {
@@ -47,9 +55,19 @@ int main(int argc, char *argv[]) {
         std::cout << "Usage: " << argv[0] << " [options]\n"
                   << "Options:\n"
                   << "  --help, -h           Show this help message\n"
-                  << "  --assemble <file>    Assemble the specified file\n"
-                  << "  --run <file>         Run the specified file\n"
+                  << "  --assemble <file> [files...]  Assemble the specified file, linking any further sources or objects\n"
+                  << "  --assemble-object <file> <object>  Assemble a file into a relocatable object\n"
+                  << "  --assemble-elf <file> <elf>  Assemble a file into an RV64 ELF executable\n"
+                  << "  --run <file> [files...]       Run the specified file, linking any further sources or objects,\n"
+                  << "                                or a statically linked RV64 ELF executable\n"
+                  << "  --sample <file> [files...]    Fast-forward a program and simulate [Sampling] windows on the 5-stage pipeline\n"
+                  << "  --simpoint <file> [files...]  Estimate CPI from representative [SimPoint] intervals simulated on the 5-stage pipeline\n"
+                  << "  --multicore <file> [files...] Run a program on the [Multicore] harts with coherent L1 caches\n"
+                  << "  --batch <manifest> [report]   Run the manifest's jobs concurrently into one CSV or JSON report\n"
+                  << "                                (default: vm_state/batch_report.csv)\n"
                   << "  --verbose-errors     Enable verbose error printing\n"
+                  << "  --record-branch-trace <file> <trace>  Record the conditional branches of a program\n"
+                  << "  --bp-bench [paths]   Compare branch predictor MPKI over programs/traces (default: examples verification)\n"
                   << "  --start-vm           Start the VM with the default program\n"
                   << "  --start-vm --vm-as-backend  Start the VM with the default program in backend mode\n";
         return 0;
@@ -60,7 +78,7 @@ int main(int argc, char *argv[]) {
             return 1;
         }
         try {
-            AssembledProgram program = assemble(argv[i]);
+            AssembledProgram program = assemble(collectFileArguments(argc, argv, i));
             std::cout << "Assembled program: " << program.filename << '\n';
             return 0;
         } catch (const std::runtime_error& e) {
@@ -68,13 +86,42 @@ int main(int argc, char *argv[]) {
             return 1;
         }
 
+    } else if (arg == "--assemble-object") {
+        if (i + 2 >= argc) {
+            std::cerr << "Error: --assemble-object needs a source file and an output object file.\n";
+            return 1;
+        }
+        try {
+            ObjectFile object = assembleObject(argv[i + 1]);
+            writeObjectFile(argv[i + 2], object);
+            std::cout << "Assembled object: " << argv[i + 2] << '\n';
+            return 0;
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--assemble-elf") {
+        if (i + 2 >= argc) {
+            std::cerr << "Error: --assemble-elf needs a source file and an output ELF file.\n";
+            return 1;
+        }
+        try {
+            assembleElfFile(argv[i + 1], argv[i + 2]);
+            std::cout << "Assembled ELF executable: " << argv[i + 2] << '\n';
+            return 0;
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
     } else if (arg == "--run") {
         if (++i >= argc) {
             std::cerr << "Error: No file specified to run.\n";
             return 1;
         }
         try {
-            AssembledProgram program = assemble(argv[i]);
+            AssembledProgram program = assemble(collectFileArguments(argc, argv, i));
             std::unique_ptr<VmBase> vm = createVMInstance(vm_config::config.getVmType());
             vm->LoadProgram(program);
             vm->Run();
@@ -85,6 +132,62 @@ int main(int argc, char *argv[]) {
             return 1;
         }
 
+    } else if (arg == "--sample") {
+        if (++i >= argc) {
+            std::cerr << "Error: No file specified to sample.\n";
+            return 1;
+        }
+        return RunSampledSimulation(collectFileArguments(argc, argv, i));
+
+    } else if (arg == "--simpoint") {
+        if (++i >= argc) {
+            std::cerr << "Error: No file specified for SimPoint simulation.\n";
+            return 1;
+        }
+        return RunSimPointSimulation(collectFileArguments(argc, argv, i));
+
+    } else if (arg == "--multicore") {
+        if (++i >= argc) {
+            std::cerr << "Error: No file specified for multicore simulation.\n";
+            return 1;
+        }
+        return RunMulticoreSimulation(collectFileArguments(argc, argv, i));
+
+    } else if (arg == "--batch") {
+        if (++i >= argc) {
+            std::cerr << "Error: No manifest specified for batch simulation.\n";
+            return 1;
+        }
+        std::string manifest = argv[i];
+        std::string report = (globals::vm_state_directory / "batch_report.csv").string();
+        if (i + 1 < argc && argv[i + 1][0] != '-') {
+            report = argv[++i];
+        }
+        return RunBatchSimulation(manifest, report);
+
+    } else if (arg == "--record-branch-trace") {
+        if (i + 2 >= argc) {
+            std::cerr << "Error: --record-branch-trace needs a program and an output trace file.\n";
+            return 1;
+        }
+        try {
+            branch_predictor::BranchTrace trace = RecordBranchTrace(argv[i + 1]);
+            branch_predictor::WriteBranchTrace(argv[i + 2], trace);
+            std::cout << "Recorded " << trace.branches.size() << " branches over " << trace.instructions
+                      << " instructions to " << argv[i + 2] << '\n';
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--bp-bench") {
+        std::vector<std::string> paths(argv + i + 1, argv + argc);
+        if (paths.empty()) {
+            paths = {"examples", "verification"};
+        }
+        return RunBranchPredictorBenchmark(paths);
+
     } else if (arg == "--verbose-errors") {
         globals::verbose_errors_print = true;
         std::cout << "Verbose error printing enabled.\n";
@@ -166,6 +269,14 @@ int main(int argc, char *argv[]) {
 
   AssembledProgram program;
   std::unique_ptr<VmBase> vm;
+  // Reloads of an edited file only re-encode the changed lines, and only the changed words are
+  // copied into memory while it still holds the previous version of the program
+  IncrementalAssembler incremental_assembler;
+  bool program_in_memory = false;
+  // Saved points of the current run by id; they share memory blocks with the VM copy-on-write
+  // and are dropped whenever the program or the VM is replaced
+  std::map<unsigned int, VmSnapshot> snapshots;
+  unsigned int next_snapshot_id = 1;
 
   // Loading VM Instance based on configuration
 
@@ -227,12 +338,13 @@ int main(int argc, char *argv[]) {
         if (section == "Execution" && key == "processor_type") {
           
           vm_config::VmTypes oldType = vm_config::config.getVmType();
+          std::string oldTypeName = vm_config::config.getVmTypeString();
           vm_config::config.modifyConfig(command.args[0], command.args[1], command.args[2]);
           vm_config::VmTypes newType = vm_config::config.getVmType();
 
           if (oldType != newType) {
 
-            std::cout << "Processor type changed from " << (oldType == vm_config::VmTypes::SINGLE_STAGE ? "single_stage" : "multi_stage") << " to " << (newType == vm_config::VmTypes::SINGLE_STAGE ? "single_stage" : "multi_stage") << std::endl;
+            std::cout << "Processor type changed from " << oldTypeName << " to " << vm_config::config.getVmTypeString() << std::endl;
 
             if (vm_running) {
               if (vm) vm->RequestStop();
@@ -241,6 +353,7 @@ int main(int argc, char *argv[]) {
             }
             vm.reset();
             vm = createVMInstance(newType);
+            snapshots.clear();
             
             if (!program.filename.empty()) {
               std::cout << "Reloading program after VM type change: " << program.filename << std::endl;
@@ -255,6 +368,12 @@ int main(int argc, char *argv[]) {
         } else {
 
           vm_config::config.modifyConfig(command.args[0], command.args[1], command.args[2]);
+          // A running VM takes the new settings up where its next step or run begins
+          vm->Reconfigure(vm_config::snapshot());
+          // Steps re-executed under the new settings could differ from the recorded ones
+          if (!vm_running) {
+            vm->ClearHistory();
+          }
 
         }
 
@@ -271,7 +390,7 @@ int main(int argc, char *argv[]) {
 
     if (command.type==command_handler::CommandType::LOAD) {
       try {
-        program = assemble(command.args[0]);
+        program = incremental_assembler.assemble(command.args[0]);
         std::cout << "VM_PARSE_SUCCESS" << std::endl;
         vm->output_status_ = "VM_PARSE_SUCCESS";
         vm->DumpState(globals::vm_state_dump_file_path);
@@ -282,7 +401,13 @@ int main(int argc, char *argv[]) {
         std::cerr << e.what() << '\n';
         continue;
       }
-      vm->LoadProgram(program);
+      if (incremental_assembler.wasIncremental() && program_in_memory) {
+        vm->UpdateProgram(program, incremental_assembler.getChangedWords());
+      } else {
+        vm->LoadProgram(program);
+      }
+      program_in_memory = true;
+      snapshots.clear();
       std::cout << "Program loaded: " << command.args[0] << std::endl;
     } else if (command.type==command_handler::CommandType::RUN) {
       launch_vm_thread([&]() { vm->Run(); });
@@ -305,6 +430,55 @@ int main(int argc, char *argv[]) {
       vm->Redo();
     } else if (command.type==command_handler::CommandType::RESET) {
       vm->Reset();
+      program_in_memory = false;
+      snapshots.clear();
+    } else if (command.type==command_handler::CommandType::SNAPSHOT) {
+      if (vm_running) continue;
+      snapshots.emplace(next_snapshot_id, vm->TakeSnapshot());
+      std::cout << "VM_SNAPSHOT_TAKEN " << next_snapshot_id++ << std::endl;
+    } else if (command.type==command_handler::CommandType::RESTORE_SNAPSHOT
+               || command.type==command_handler::CommandType::DELETE_SNAPSHOT) {
+      if (vm_running) continue;
+      auto snapshot = snapshots.end();
+      if (command.args.size()==1 && !command.args[0].empty()
+          && std::all_of(command.args[0].begin(), command.args[0].end(),
+                         [](unsigned char c) { return std::isdigit(c); })) {
+        snapshot = snapshots.find(static_cast<unsigned int>(std::stoul(command.args[0])));
+      }
+      if (snapshot==snapshots.end()) {
+        std::cout << "VM_NO_SUCH_SNAPSHOT" << std::endl;
+        continue;
+      }
+      if (command.type==command_handler::CommandType::DELETE_SNAPSHOT) {
+        snapshots.erase(snapshot);
+        std::cout << "VM_SNAPSHOT_DELETED" << std::endl;
+        continue;
+      }
+      vm->RestoreSnapshot(snapshot->second);
+      std::cout << "VM_SNAPSHOT_RESTORED" << std::endl;
+      DumpRegisters(globals::registers_dump_file_path, vm->registers_);
+      vm->DumpState(globals::vm_state_dump_file_path);
+    } else if (command.type==command_handler::CommandType::REVERSE_STEP) {
+      if (vm_running) continue;
+      uint64_t count = 1;
+      try {
+        if (!command.args.empty()) {
+          if (command.args[0].empty()
+              || !std::all_of(command.args[0].begin(), command.args[0].end(),
+                              [](unsigned char c) { return std::isdigit(c); })) {
+            std::cout << "VM_REVERSE_STEP_ERROR" << std::endl;
+            continue;
+          }
+          count = std::stoull(command.args[0]);
+        }
+      } catch (const std::out_of_range &e) {
+        std::cout << "VM_REVERSE_STEP_ERROR" << std::endl;
+        continue;
+      }
+      vm->ReverseStep(count);
+    } else if (command.type==command_handler::CommandType::REVERSE_CONTINUE) {
+      if (vm_running) continue;
+      vm->ReverseContinue();
     } else if (command.type==command_handler::CommandType::EXIT) {
       vm->RequestStop();
       if (vm_thread.joinable()) vm_thread.join(); // ensure clean exit
@@ -312,9 +486,17 @@ int main(int argc, char *argv[]) {
       vm->DumpState(globals::vm_state_dump_file_path);
       break;
     } else if (command.type==command_handler::CommandType::ADD_BREAKPOINT) {
-      vm->AddBreakpoint(std::stoul(command.args[0], nullptr, 10));
+      if (std::isdigit(static_cast<unsigned char>(command.args[0].front()))) {
+        vm->AddBreakpoint(std::stoul(command.args[0], nullptr, 10));
+      } else {
+        vm->AddBreakpoint(command.args[0]);
+      }
     } else if (command.type==command_handler::CommandType::REMOVE_BREAKPOINT) {
-      vm->RemoveBreakpoint(std::stoul(command.args[0], nullptr, 10));
+      if (std::isdigit(static_cast<unsigned char>(command.args[0].front()))) {
+        vm->RemoveBreakpoint(std::stoul(command.args[0], nullptr, 10));
+      } else {
+        vm->RemoveBreakpoint(command.args[0]);
+      }
     } else if (command.type==command_handler::CommandType::MODIFY_REGISTER) {
       try {
         if (command.args.size() != 2) {
@@ -368,6 +550,7 @@ int main(int argc, char *argv[]) {
           std::cout << "VM_MODIFY_MEMORY_ERROR" << std::endl;
           continue;
         }
+        vm->TruncateHistory();
         std::cout << "VM_MODIFY_MEMORY_SUCCESS" << std::endl;
       } catch (const std::out_of_range &e) {
         std::cout << "VM_MODIFY_MEMORY_ERROR" << std::endl;
@@ -0,0 +1,513 @@
+/**
+ * @file multicore.cpp
+ * @brief Multicore simulation driver
+ */
+#include "multicore.h"
+#include "assembler/assembler.h"
+#include "vm/cache/mesi.h"
+#include "vm/rvss/rvss_vm.h"
+#include "vm/rv5s/rv5s_vm.h"
+#include "config.h"
+#include "globals.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr unsigned int kMhartid = 0xF14;
+
+struct Hart {
+    std::unique_ptr<VmBase> vm;
+    RVSSVM *single_stage = nullptr; ///< Set when the hart is a single-cycle core
+    RV5SVM *multi_stage = nullptr;  ///< Set when the hart is a 5-stage core
+    uint64_t steps = 0;
+    bool done = false;
+    // Threaded mode only
+    std::vector<MemoryAccess> log;        ///< Accesses of the current quantum
+    std::vector<size_t> marks;            ///< Size of log after each step of the current quantum
+    std::unique_ptr<AtomicPort> port;
+};
+
+cache::CacheConfig L1ConfigFromVmConfig() {
+    const vm_config::VmConfig &config = vm_config::current();
+    cache::CacheConfig l1;
+    l1.cache_enabled = true;
+    l1.lines = config.getMulticoreL1Lines();
+    l1.block_size = config.getMulticoreL1BlockSize();
+    l1.associativity = config.getMulticoreL1Associativity();
+    l1.replacement_policy = cache::ReplacementPolicy::LRU;
+    l1.write_miss_policy = cache::WriteMissPolicy::WriteAllocate;
+    l1.size = l1.lines * l1.block_size;
+    return l1;
+}
+
+// A single-cycle hart also stops at the exit syscall
+bool Finished(const Hart &hart) {
+    if (hart.single_stage) {
+        const RVSSVM &vm = *hart.single_stage;
+        return vm.program_counter_ >= vm.program_size_ || vm.IsStopRequested();
+    }
+    return hart.multi_stage->IsDrained();
+}
+
+// Advances a hart by one instruction or one clock
+void StepHart(Hart &hart) {
+    if (hart.single_stage) {
+        hart.single_stage->WarmStep();
+    } else {
+        hart.multi_stage->PipelinedStep(false);
+    }
+    hart.steps++;
+}
+
+// Marks the hart done once it has reached the end or the step limit, and says whether it is
+bool CheckDone(Hart &hart, uint64_t step_limit) {
+    if (!hart.done && (Finished(hart) || hart.steps >= step_limit)) {
+        hart.done = true;
+    }
+    return hart.done;
+}
+
+// Loads the program into the hart's memory and gives it its id and stack
+void SetUpHart(VmBase &vm, unsigned int id, const AssembledProgram &program) {
+    vm.LoadProgram(program);
+    vm.ResetBranchPredictors();
+    // The exit syscall only stops the hart, and programs that read stdin get empty lines
+    // instead of blocking the run
+    vm.exit_ends_process_ = false;
+    vm.empty_input_when_idle_ = true;
+    vm.registers_.WriteGpr(10, id);
+    vm.registers_.WriteCsr(kMhartid, id);
+    vm.registers_.WriteGpr(2, vm.registers_.ReadGpr(2) - id * vm_config::current().getMulticoreStackSpacing());
+}
+
+double Ratio(unsigned long part, unsigned long whole) {
+    return (whole > 0) ? static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+void PrintHartStats(const std::vector<Hart> &harts, const cache::MesiSystem &coherence, uint64_t step_limit) {
+    const vm_config::VmConfig &config = vm_config::current();
+    const cache::CacheConfig &l1 = coherence.GetConfig();
+    std::cout << "Harts: " << harts.size() << " x " << config.getMulticoreCoreString() << ", L1: " << l1.lines
+              << " lines of " << l1.block_size << " bytes, " << l1.associativity << "-way, MESI" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    for (unsigned int id = 0; id < harts.size(); ++id) {
+        const VmBase &vm = *harts[id].vm;
+        const cache::L1Stats &stats = coherence.GetL1Stats(id);
+        std::cout << "Hart " << id << ": Instructions: " << vm.instructions_retired_ << ", Cycles: " << vm.cycle_s_
+                  << ", CPI: " << Ratio(vm.cycle_s_, vm.instructions_retired_);
+        if (harts[id].steps >= step_limit) {
+            std::cout << " (stopped at instruction_execution_limit)";
+        }
+        std::cout << std::endl;
+        std::cout << "  L1: Accesses: " << stats.accesses << ", Hits: " << stats.hits << ", Misses: " << stats.misses
+                  << " (" << Ratio(stats.misses, stats.accesses) * 100.0 << "%), Coherence Misses: "
+                  << stats.coherence_misses << std::endl;
+        std::cout << "      Upgrades: " << stats.upgrades << ", Invalidations Received: " << stats.invalidations
+                  << ", Evictions: " << stats.evictions << ", Writebacks: " << stats.writebacks << std::endl;
+    }
+    const cache::BusStats &bus = coherence.GetBusStats();
+    std::cout << "Bus: BusRd: " << bus.bus_reads << ", BusRdX: " << bus.bus_read_exclusives << ", BusUpgr: "
+              << bus.bus_upgrades << ", Invalidations: " << bus.invalidations << std::endl;
+    std::cout << "     Cache-to-Cache Transfers: " << bus.cache_to_cache << ", Memory Fetches: " << bus.memory_fetches
+              << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+void DumpHartRegisters(const std::vector<Hart> &harts) {
+    for (unsigned int id = 0; id < harts.size(); ++id) {
+        DumpRegisters(globals::vm_state_directory / ("registers_dump_hart" + std::to_string(id) + ".json"),
+                      harts[id].vm->registers_);
+    }
+}
+
+// Every hart steps one instruction or clock in turn, on one thread, over a single shared memory
+int RunLockstep(const AssembledProgram &program) {
+    const vm_config::VmConfig &config = vm_config::current();
+    const unsigned int hart_count = static_cast<unsigned int>(config.getMulticoreHarts());
+    const bool pipelined = config.getMulticoreCore() == vm_config::VmTypes::MULTI_STAGE;
+    const uint64_t step_limit = config.getInstructionExecutionLimit();
+
+    cache::MesiSystem coherence(hart_count, L1ConfigFromVmConfig());
+    std::vector<Hart> harts(hart_count);
+    uint64_t rounds = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    {
+        ConsoleMute mute;
+        for (unsigned int id = 0; id < hart_count; ++id) {
+            Hart &hart = harts[id];
+            if (pipelined) {
+                auto vm = std::make_unique<RV5SVM>();
+                hart.multi_stage = vm.get();
+                hart.vm = std::move(vm);
+            } else {
+                auto vm = std::make_unique<RVSSVM>();
+                hart.single_stage = vm.get();
+                hart.vm = std::move(vm);
+            }
+            hart.vm->memory_controller_.ShareMemory(harts[0].vm->memory_controller_);
+            hart.vm->memory_controller_.AttachCoherence(&coherence, id);
+        }
+        // Every hart loads the same image into the shared memory before any of them runs
+        for (unsigned int id = 0; id < hart_count; ++id) {
+            SetUpHart(*harts[id].vm, id, program);
+        }
+
+        bool running = true;
+        while (running) {
+            running = false;
+            for (Hart &hart : harts) {
+                if (CheckDone(hart, step_limit)) {
+                    continue;
+                }
+                StepHart(hart);
+                running = true;
+            }
+            ++rounds;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+
+    DumpHartRegisters(harts);
+    std::cout << "--- Multicore Simulation ---" << std::endl;
+    PrintHartStats(harts, coherence, step_limit);
+    std::cout << "Rounds: " << rounds << ", Simulation Time: " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
+
+// Shared memory and lr reservations the atomics of the non-deterministic threaded mode work on
+struct AtomicDomain {
+    std::mutex mutex;
+    MemoryController &memory;
+    uint64_t granule;                                  ///< Bytes a reservation covers, the L1 block size
+    std::vector<std::optional<uint64_t>> reservations; ///< Block reserved by each hart's lr
+
+    AtomicDomain(MemoryController &shared, uint64_t block_size, unsigned int harts)
+        : memory(shared), granule(block_size), reservations(harts) {}
+
+    // A write by hart to address breaks the reservations the other harts hold on its block
+    void BreakOthers(unsigned int hart, uint64_t address) {
+        for (unsigned int other = 0; other < reservations.size(); ++other) {
+            if (other != hart && reservations[other] == address / granule) {
+                reservations[other].reset();
+            }
+        }
+    }
+};
+
+bool IsLoadReserved(uint32_t instruction) {
+    return ((instruction >> 27) & 0b11111) == 0b00010;
+}
+
+bool IsStoreConditional(uint32_t instruction) {
+    return ((instruction >> 27) & 0b11111) == 0b00011;
+}
+
+// Deterministic mode: atomics run on the hart's private memory like any other access, and the
+// barrier redoes each AMO on the shared memory so that concurrent AMOs on one location compose
+class DeferredAtomics : public AtomicPort {
+public:
+    explicit DeferredAtomics(std::vector<MemoryAccess> &log) : log_(log) {}
+
+    uint64_t Execute(VmBase &hart, uint32_t instruction, uint64_t address, uint64_t value) override {
+        const size_t logged = log_.size();
+        const uint64_t result = hart.ExecuteAtomicLocally(instruction, address, value);
+        if (!IsLoadReserved(instruction) && !IsStoreConditional(instruction) && log_.size() > logged) {
+            log_.back().atomic = instruction;
+            log_.back().value = value;
+        }
+        return result;
+    }
+
+private:
+    std::vector<MemoryAccess> &log_;
+};
+
+// Non-deterministic mode: atomics go straight to the shared memory under one lock, so they are
+// seen by every hart at once, and are copied into the hart's private memory as well
+class LockedAtomics : public AtomicPort {
+public:
+    LockedAtomics(AtomicDomain &domain, unsigned int hart, std::vector<MemoryAccess> &log)
+        : domain_(domain), hart_(hart), log_(log) {}
+
+    uint64_t Execute(VmBase &hart, uint32_t instruction, uint64_t address, uint64_t value) override {
+        const bool word = ((instruction >> 12) & 0b111) == 0b010;
+        std::lock_guard<std::mutex> lock(domain_.mutex);
+        MemoryController &shared = domain_.memory;
+        std::optional<uint64_t> &reservation = domain_.reservations[hart_];
+
+        if (IsLoadReserved(instruction)) {
+            reservation = address / domain_.granule;
+            log_.push_back({address, 0, 0, false, 0, false});
+            return word ? static_cast<uint64_t>(static_cast<int32_t>(shared.ReadWord_d(address)))
+                        : shared.ReadDoubleWord_d(address);
+        }
+
+        uint64_t rd = 0;
+        uint64_t stored = value;
+        if (IsStoreConditional(instruction)) {
+            const bool held = reservation == address / domain_.granule;
+            reservation.reset();
+            if (!held) {
+                return 1;
+            }
+        } else {
+            rd = word ? static_cast<uint64_t>(static_cast<int32_t>(shared.ReadWord_d(address)))
+                      : shared.ReadDoubleWord_d(address);
+            stored = VmBase::AtomicOperation(instruction, rd, value);
+        }
+        if (word) {
+            shared.WriteWord_d(address, static_cast<uint32_t>(stored));
+            hart.memory_controller_.WriteWord_d(address, static_cast<uint32_t>(stored));
+        } else {
+            shared.WriteDoubleWord_d(address, stored);
+            hart.memory_controller_.WriteDoubleWord_d(address, stored);
+        }
+        domain_.BreakOthers(hart_, address);
+        log_.push_back({address, stored, static_cast<uint8_t>(word ? 4 : 8), true, 0, true});
+        return rd;
+    }
+
+private:
+    AtomicDomain &domain_;
+    unsigned int hart_;
+    std::vector<MemoryAccess> &log_;
+};
+
+/**
+ * Harts on host threads, each on a private copy of memory, meeting at a barrier every quantum
+ * steps. At the barrier the accesses each hart logged are replayed in a fixed order, step by
+ * step and hart by hart, through the coherence model, and its stores into the shared memory,
+ * which every hart then takes a fresh copy of.
+ */
+class QuantumSimulation {
+public:
+    QuantumSimulation(const AssembledProgram &program, unsigned int hart_count)
+        : coherence_(hart_count, L1ConfigFromVmConfig()), harts_(hart_count),
+          domain_(shared_, coherence_.GetConfig().block_size, hart_count) {
+        const bool deterministic = vm_config::current().getMulticoreDeterministic();
+        ConsoleMute mute;
+        for (unsigned int id = 0; id < hart_count; ++id) {
+            Hart &hart = harts_[id];
+            auto vm = std::make_unique<RVSSVM>();
+            hart.single_stage = vm.get();
+            hart.vm = std::move(vm);
+            SetUpHart(*hart.vm, id, program);
+            hart.vm->memory_controller_.LogAccesses(&hart.log);
+            if (deterministic) {
+                hart.port = std::make_unique<DeferredAtomics>(hart.log);
+            } else {
+                hart.port = std::make_unique<LockedAtomics>(domain_, id, hart.log);
+            }
+            hart.vm->atomic_port_ = hart.port.get();
+        }
+        shared_.CopyMemoryFrom(harts_[0].vm->memory_controller_);
+        for (Hart &hart : harts_) {
+            hart.vm->memory_controller_.CopyMemoryFrom(shared_);
+        }
+    }
+
+    // Runs every hart to the end on threads host threads and returns the wall time taken
+    std::chrono::milliseconds Run(unsigned int threads) {
+        const vm_config::VmConfig &config = vm_config::current();
+        const uint64_t quantum = config.getMulticoreQuantum();
+        const uint64_t step_limit = config.getInstructionExecutionLimit();
+        auto merge = [this]() noexcept { Merge(); };
+        std::barrier<decltype(merge)> barrier(threads, merge);
+
+        auto worker = [&](unsigned int thread) {
+            vm_config::ScopedConfig bind(config);
+            while (!finished_) {
+                for (size_t id = thread; id < harts_.size(); id += threads) {
+                    Hart &hart = harts_[id];
+                    for (uint64_t step = 0; step < quantum && !CheckDone(hart, step_limit); ++step) {
+                        StepHart(hart);
+                        hart.marks.push_back(hart.log.size());
+                    }
+                    CheckDone(hart, step_limit);
+                }
+                barrier.arrive_and_wait();
+            }
+        };
+
+        auto start_time = std::chrono::steady_clock::now();
+        {
+            ConsoleMute mute;
+            std::vector<std::thread> pool;
+            for (unsigned int thread = 1; thread < threads; ++thread) {
+                pool.emplace_back(worker, thread);
+            }
+            worker(0);
+            for (std::thread &thread : pool) {
+                thread.join();
+            }
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+    }
+
+    [[nodiscard]] const std::vector<Hart> &GetHarts() const {
+        return harts_;
+    }
+
+    [[nodiscard]] const cache::MesiSystem &GetCoherence() const {
+        return coherence_;
+    }
+
+    [[nodiscard]] uint64_t GetQuanta() const {
+        return quanta_;
+    }
+
+private:
+    cache::MesiSystem coherence_;
+    std::vector<Hart> harts_;
+    MemoryController shared_;
+    AtomicDomain domain_;
+    uint64_t quanta_ = 0;
+    bool finished_ = false;
+
+    // Runs on one thread while all the others wait at the barrier
+    void Merge() {
+        const uint64_t granule = coherence_.GetConfig().block_size;
+        size_t longest = 0;
+        for (const Hart &hart : harts_) {
+            longest = std::max(longest, hart.marks.size());
+        }
+        for (size_t step = 0; step < longest; ++step) {
+            for (unsigned int id = 0; id < harts_.size(); ++id) {
+                Hart &hart = harts_[id];
+                if (step >= hart.marks.size()) {
+                    continue;
+                }
+                const size_t first = (step == 0) ? 0 : hart.marks[step - 1];
+                for (size_t i = first; i < hart.marks[step]; ++i) {
+                    Apply(id, hart.log[i], granule);
+                }
+            }
+        }
+
+        bool all_done = true;
+        for (Hart &hart : harts_) {
+            hart.log.clear();
+            hart.marks.clear();
+            hart.vm->memory_controller_.CopyMemoryFrom(shared_);
+            all_done = all_done && hart.done;
+        }
+        quanta_++;
+        finished_ = all_done;
+    }
+
+    void Apply(unsigned int id, const MemoryAccess &access, uint64_t granule) {
+        coherence_.Access(id, access.address, access.is_write);
+        if (!access.is_write) {
+            return;
+        }
+        for (unsigned int other = 0; other < harts_.size(); ++other) {
+            if (other != id) {
+                harts_[other].vm->memory_controller_.BreakReservation(access.address, granule);
+            }
+        }
+        domain_.BreakOthers(id, access.address);
+        if (access.merged) {
+            return;
+        }
+
+        uint64_t value = access.value;
+        if (access.atomic) {
+            const uint64_t old_value = (access.size == 4)
+                ? static_cast<uint64_t>(static_cast<int32_t>(shared_.ReadWord_d(access.address)))
+                : shared_.ReadDoubleWord_d(access.address);
+            value = VmBase::AtomicOperation(access.atomic, old_value, access.value);
+        }
+        switch (access.size) {
+            case 1: shared_.WriteByte_d(access.address, static_cast<uint8_t>(value)); break;
+            case 2: shared_.WriteHalfWord_d(access.address, static_cast<uint16_t>(value)); break;
+            case 4: shared_.WriteWord_d(access.address, static_cast<uint32_t>(value)); break;
+            default: shared_.WriteDoubleWord_d(access.address, value); break;
+        }
+    }
+};
+
+bool SameFinalState(const std::vector<Hart> &a, const std::vector<Hart> &b) {
+    for (size_t id = 0; id < a.size(); ++id) {
+        const VmBase &x = *a[id].vm;
+        const VmBase &y = *b[id].vm;
+        if (x.program_counter_ != y.program_counter_ || x.instructions_retired_ != y.instructions_retired_
+            || x.registers_.GetGprValues() != y.registers_.GetGprValues()
+            || x.registers_.GetFprValues() != y.registers_.GetFprValues()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the harts on host threads synchronised every quantum, once on one thread for reference
+int RunThreaded(const AssembledProgram &program) {
+    const vm_config::VmConfig &config = vm_config::current();
+    const unsigned int hart_count = static_cast<unsigned int>(config.getMulticoreHarts());
+    if (config.getMulticoreCore() != vm_config::VmTypes::SINGLE_STAGE) {
+        std::cerr << "[Multicore] quantum needs core=single_stage; use quantum=0 for multi_stage harts" << std::endl;
+        return 1;
+    }
+    unsigned int threads = static_cast<unsigned int>(config.getMulticoreThreads());
+    if (threads == 0 || threads > hart_count) {
+        threads = hart_count;
+    }
+
+    QuantumSimulation reference(program, hart_count);
+    const std::chrono::milliseconds serial_time = reference.Run(1);
+    std::unique_ptr<QuantumSimulation> parallel;
+    std::chrono::milliseconds parallel_time = serial_time;
+    if (threads > 1) {
+        parallel = std::make_unique<QuantumSimulation>(program, hart_count);
+        parallel_time = parallel->Run(threads);
+    }
+    const QuantumSimulation &result = parallel ? *parallel : reference;
+    const uint64_t step_limit = config.getInstructionExecutionLimit();
+
+    DumpHartRegisters(result.GetHarts());
+    std::cout << "--- Multicore Simulation ---" << std::endl;
+    PrintHartStats(result.GetHarts(), result.GetCoherence(), step_limit);
+    std::cout << "Quantum: " << config.getMulticoreQuantum() << " cycles, Quanta: " << result.GetQuanta()
+              << ", Threads: " << threads << ", "
+              << (config.getMulticoreDeterministic() ? "deterministic" : "non-deterministic") << std::endl;
+    std::cout << "Simulation Time: 1 thread: " << serial_time.count() << " ms, " << threads << " threads: "
+              << parallel_time.count() << " ms, Speedup: " << std::fixed << std::setprecision(2)
+              << ((parallel_time.count() > 0) ? static_cast<double>(serial_time.count()) / parallel_time.count() : 1.0)
+              << std::defaultfloat << std::endl;
+    if (parallel) {
+        const bool same = SameFinalState(reference.GetHarts(), parallel->GetHarts());
+        std::cout << "Final state " << (same ? "matches" : "differs from") << " the single-threaded run";
+        if (!same && config.getMulticoreDeterministic()) {
+            std::cout << " (deterministic mode should not differ)";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+} // namespace
+
+int RunMulticoreSimulation(const std::vector<std::string> &filenames) {
+    AssembledProgram program;
+    try {
+        program = assemble(filenames);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    if (vm_config::current().getMulticoreQuantum() > 0) {
+        return RunThreaded(program);
+    }
+    return RunLockstep(program);
+}
@@ -0,0 +1,358 @@
+/**
+ * @file sampling.cpp
+ * @brief Sampled simulation driver
+ */
+#include "sampling.h"
+#include "simpoint.h"
+#include "assembler/assembler.h"
+#include "vm/rvss/rvss_vm.h"
+#include "vm/rv5s/rv5s_vm.h"
+#include "config.h"
+#include "globals.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Seeds k-means, so a program always gets the same simulation points
+constexpr uint64_t kClusteringSeed = 42;
+
+// What one detailed window measured, after its warmup
+struct Sample {
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t cache_accesses = 0;
+    uint64_t cache_misses = 0;
+};
+
+// Sample mean and the half-width of its confidence interval
+struct Estimate {
+    double mean = 0;
+    double half_width = 0;
+};
+
+// Two-sided standard normal quantile for a confidence level, e.g. 1.96 for 0.95
+double NormalQuantile(double confidence) {
+    double low = 0.0;
+    double high = 10.0;
+    for (int i = 0; i < 100; ++i) {
+        double mid = (low + high) / 2.0;
+        if (std::erf(mid / std::sqrt(2.0)) < confidence) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (low + high) / 2.0;
+}
+
+Estimate EstimateMean(const std::vector<double> &values, double z) {
+    Estimate estimate;
+    if (values.empty()) {
+        return estimate;
+    }
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    estimate.mean = sum / static_cast<double>(values.size());
+    if (values.size() > 1) {
+        double squares = 0.0;
+        for (double value : values) {
+            squares += (value - estimate.mean) * (value - estimate.mean);
+        }
+        double deviation = std::sqrt(squares / static_cast<double>(values.size() - 1));
+        estimate.half_width = z * deviation / std::sqrt(static_cast<double>(values.size()));
+    }
+    return estimate;
+}
+
+// Clocks the pipeline until it has retired this many more instructions or the program ends
+void RetireDetailed(RV5SVM &vm, uint64_t instructions) {
+    uint64_t retired = 0;
+    while (retired < instructions && !vm.IsDrained()) {
+        unsigned int before = vm.instructions_retired_;
+        vm.PipelinedStep(false);
+        retired += vm.instructions_retired_ - before;
+    }
+}
+
+void PrepareFunctional(RVSSVM &vm, const AssembledProgram &program) {
+    vm.LoadProgram(program);
+    // The single-cycle VM has no cache or predictors of its own; give it the pipeline's
+    vm.memory_controller_.Init(VmBase::CacheConfigFromVmConfig(vm.GetConfig()));
+    vm.ResetBranchPredictors();
+    // The exit syscall only stops the run, and programs that read stdin get empty lines
+    // instead of blocking it
+    vm.exit_ends_process_ = false;
+    vm.empty_input_when_idle_ = true;
+}
+
+// Executes the next instruction functionally; false once the program has ended or exited
+bool FunctionalStep(RVSSVM &vm) {
+    if (vm.program_counter_ >= vm.program_size_ || vm.IsStopRequested()) {
+        return false;
+    }
+    vm.WarmStep();
+    return true;
+}
+
+// A checkpoint of the functional VM that RV5SVM continues from with an empty pipeline
+VmSnapshot HandOver(const RVSSVM &functional) {
+    VmSnapshot snapshot = functional.TakeSnapshot();
+    snapshot.core.reset();
+    return snapshot;
+}
+
+// Starts the pipeline from a checkpoint and measures a window after the warmup
+Sample MeasureWindow(const VmSnapshot &start, RV5SVM &detailed, uint64_t warmup, uint64_t window) {
+    detailed.RestoreSnapshot(start);
+
+    RetireDetailed(detailed, warmup);
+    unsigned int cycles = detailed.cycle_s_;
+    unsigned int instructions = detailed.instructions_retired_;
+    cache::CacheStats cache = detailed.memory_controller_.GetCacheStats();
+
+    RetireDetailed(detailed, window);
+    cache::CacheStats cache_end = detailed.memory_controller_.GetCacheStats();
+    Sample sample;
+    sample.instructions = detailed.instructions_retired_ - instructions;
+    sample.cycles = detailed.cycle_s_ - cycles;
+    sample.cache_accesses = cache_end.accesses - cache.accesses;
+    sample.cache_misses = cache_end.misses - cache.misses;
+    return sample;
+}
+
+double Cpi(const Sample &sample) {
+    return (sample.instructions > 0) ? static_cast<double>(sample.cycles) / static_cast<double>(sample.instructions) : 0.0;
+}
+
+} // namespace
+
+int RunSampledSimulation(const std::vector<std::string> &filenames) {
+    const vm_config::VmConfig &config = vm_config::current();
+    const bool periodic = config.getSamplingMode() == vm_config::SamplingMode::PERIODIC;
+    const uint64_t warmup = config.getSamplingWarmup();
+    const uint64_t window = config.getSamplingWindow();
+    const uint64_t period = config.getSamplingPeriod();
+    if (periodic && period < warmup + window) {
+        std::cerr << "Error: [Sampling] period must be at least warmup + window.\n";
+        return 1;
+    }
+
+    AssembledProgram program;
+    try {
+        program = assemble(filenames);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    std::vector<Sample> samples;
+    uint64_t executed = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    {
+        ConsoleMute mute;
+        RVSSVM functional;
+        RV5SVM detailed;
+        PrepareFunctional(functional, program);
+        detailed.LoadProgram(program);
+
+        uint64_t next_sample = config.getSamplingFastForward();
+        while (true) {
+            if (executed == next_sample) {
+                samples.push_back(MeasureWindow(HandOver(functional), detailed, warmup, window));
+                if (!periodic) {
+                    break;
+                }
+                next_sample += period;
+            }
+            if (!FunctionalStep(functional)) {
+                break;
+            }
+            ++executed;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+
+    std::vector<double> cpis;
+    std::vector<double> miss_rates;
+    uint64_t measured = 0;
+    for (const Sample &sample : samples) {
+        if (sample.instructions == 0) {
+            continue;
+        }
+        measured += sample.instructions;
+        cpis.push_back(Cpi(sample));
+        if (sample.cache_accesses > 0) {
+            miss_rates.push_back(static_cast<double>(sample.cache_misses) / static_cast<double>(sample.cache_accesses));
+        }
+    }
+    if (cpis.empty()) {
+        std::cerr << "Error: The program ended after " << executed << " instructions, before a window was measured.\n";
+        return 1;
+    }
+
+    const double confidence = config.getSamplingConfidence();
+    const double z = NormalQuantile(confidence);
+    Estimate cpi = EstimateMean(cpis, z);
+    Estimate miss_rate = EstimateMean(miss_rates, z);
+    bool interval = cpis.size() > 1;
+
+    std::cout << "--- Sampled Simulation ---" << std::endl;
+    std::cout << "Mode: " << config.getSamplingModeString() << " (fast_forward=" << config.getSamplingFastForward()
+              << ", warmup=" << warmup << ", window=" << window;
+    if (periodic) {
+        std::cout << ", period=" << period;
+    }
+    std::cout << ")" << std::endl;
+    std::cout << "Instructions Executed: " << executed << (periodic ? "" : " (stopped after the window)") << std::endl;
+    std::cout << "Samples: " << cpis.size() << ", Instructions Measured: " << measured << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Cycles Per Instruction (CPI): " << cpi.mean;
+    if (interval) {
+        std::cout << " +/- " << cpi.half_width << " (" << std::setprecision(1) << confidence * 100.0 << "% confidence, +/- "
+                  << (cpi.mean > 0 ? cpi.half_width / cpi.mean * 100.0 : 0.0) << "%)" << std::setprecision(4);
+    }
+    std::cout << std::endl;
+    if (periodic) {
+        std::cout << std::setprecision(0) << "Estimated Total Cycles: " << cpi.mean * static_cast<double>(executed);
+        if (interval) {
+            std::cout << " +/- " << cpi.half_width * static_cast<double>(executed);
+        }
+        std::cout << std::setprecision(4) << std::endl;
+    }
+    if (!miss_rates.empty()) {
+        std::cout << "Cache Miss Rate: " << miss_rate.mean * 100.0 << "%";
+        if (miss_rates.size() > 1) {
+            std::cout << " +/- " << miss_rate.half_width * 100.0 << "%";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::defaultfloat;
+    std::cout << "Simulation Time: " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
+
+int RunSimPointSimulation(const std::vector<std::string> &filenames) {
+    const vm_config::VmConfig &config = vm_config::current();
+    const uint64_t interval = config.getSimPointInterval();
+
+    AssembledProgram program;
+    try {
+        program = assemble(filenames);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    std::ofstream bbv_file(globals::simpoint_bbv_file_path);
+    if (!bbv_file) {
+        std::cerr << "Error: Unable to write " << globals::simpoint_bbv_file_path.string() << '\n';
+        return 1;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    uint64_t executed = 0;
+    simpoint::BbvProfiler profiler(interval, static_cast<unsigned int>(config.getSimPointDimensions()), bbv_file);
+    {
+        ConsoleMute mute;
+        RVSSVM functional;
+        PrepareFunctional(functional, program);
+        uint64_t pc = functional.program_counter_;
+        while (FunctionalStep(functional)) {
+            uint8_t opcode = functional.current_instruction_ & 0b1111111;
+            profiler.Retire(pc, opcode == 0b1100011 || opcode == 0b1101111 || opcode == 0b1100111);
+            pc = functional.program_counter_;
+            ++executed;
+        }
+        profiler.Finish();
+    }
+    bbv_file.close();
+
+    const std::vector<uint64_t> &sizes = profiler.GetIntervalSizes();
+    if (sizes.empty()) {
+        std::cerr << "Error: The program ended before executing an instruction.\n";
+        return 1;
+    }
+    simpoint::Selection selection = simpoint::SelectSimPoints(profiler.GetProjections(), sizes,
+                                                              config.getSimPointMaxClusters(), kClusteringSeed);
+    const size_t clusters = selection.simpoints.size();
+
+    std::ofstream simpoint_file(globals::simpoint_file_path);
+    std::ofstream weights_file(globals::simpoint_weights_file_path);
+    for (size_t cluster = 0; cluster < clusters; ++cluster) {
+        simpoint_file << selection.simpoints[cluster] << ' ' << cluster << '\n';
+        weights_file << selection.weights[cluster] << ' ' << cluster << '\n';
+    }
+
+    // Run again to take a checkpoint at the start of each chosen interval, then simulate each
+    // interval in detail from its checkpoint
+    std::vector<Sample> samples(clusters);
+    {
+        ConsoleMute mute;
+        std::vector<std::pair<size_t, size_t>> order; // interval, cluster
+        for (size_t cluster = 0; cluster < clusters; ++cluster) {
+            order.emplace_back(selection.simpoints[cluster], cluster);
+        }
+        std::sort(order.begin(), order.end());
+
+        std::vector<VmSnapshot> checkpoints(clusters);
+        RVSSVM functional;
+        PrepareFunctional(functional, program);
+        uint64_t position = 0;
+        for (const auto &[index, cluster] : order) {
+            while (position < index * interval && FunctionalStep(functional)) {
+                ++position;
+            }
+            checkpoints[cluster] = HandOver(functional);
+        }
+
+        RV5SVM detailed;
+        detailed.LoadProgram(program);
+        for (size_t cluster = 0; cluster < clusters; ++cluster) {
+            samples[cluster] = MeasureWindow(checkpoints[cluster], detailed, 0, sizes[selection.simpoints[cluster]]);
+            checkpoints[cluster] = VmSnapshot();
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+
+    double cpi = 0.0;
+    double miss_rate = 0.0;
+    double miss_weight = 0.0;
+    uint64_t measured = 0;
+    std::cout << "--- SimPoint Simulation ---" << std::endl;
+    std::cout << "Instructions Executed: " << executed << " in " << sizes.size() << " intervals of " << interval << std::endl;
+    std::cout << "Clusters: " << clusters << " (BBVs in " << globals::simpoint_bbv_file_path.string() << ")" << std::endl;
+    std::cout << std::fixed;
+    for (size_t cluster = 0; cluster < clusters; ++cluster) {
+        const Sample &sample = samples[cluster];
+        std::cout << "SimPoint " << cluster << ": interval " << selection.simpoints[cluster] << std::setprecision(4)
+                  << ", weight " << selection.weights[cluster] << ", CPI " << Cpi(sample);
+        if (sample.cache_accesses > 0) {
+            double rate = static_cast<double>(sample.cache_misses) / static_cast<double>(sample.cache_accesses);
+            std::cout << ", miss rate " << std::setprecision(2) << rate * 100.0 << "%";
+            miss_rate += selection.weights[cluster] * rate;
+            miss_weight += selection.weights[cluster];
+        }
+        std::cout << std::endl;
+        cpi += selection.weights[cluster] * Cpi(sample);
+        measured += sample.instructions;
+    }
+    std::cout << std::setprecision(4) << "Cycles Per Instruction (CPI): " << cpi << std::endl;
+    std::cout << std::setprecision(0) << "Estimated Total Cycles: " << cpi * static_cast<double>(executed) << std::endl;
+    if (miss_weight > 0.0) {
+        std::cout << std::setprecision(4) << "Cache Miss Rate: " << miss_rate / miss_weight * 100.0 << "%" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+    std::cout << "Instructions Simulated in Detail: " << measured << std::endl;
+    std::cout << "Simulation Time: " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
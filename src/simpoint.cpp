@@ -0,0 +1,265 @@
+/**
+ * @file simpoint.cpp
+ * @brief Basic block vector profiling and k-means selection of simulation points
+ */
+#include "simpoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace simpoint {
+
+namespace {
+
+// Restarts of k-means per k, keeping the one with the lowest distortion
+constexpr int kRestarts = 5;
+constexpr int kMaxIterations = 100;
+// Seeds the projection rows, so a program always gets the same projection
+constexpr uint64_t kProjectionSeed = 0x5eed5eed;
+
+double SquaredDistance(const std::vector<double> &a, const std::vector<double> &b) {
+    double distance = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        distance += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return distance;
+}
+
+struct Clustering {
+    std::vector<std::vector<double>> centroids;
+    std::vector<size_t> labels;
+    double distortion = 0.0; ///< Sum of squared distances to the assigned centroids
+};
+
+// k-means++ seeding followed by Lloyd iterations
+Clustering KMeans(const std::vector<std::vector<double>> &points, size_t k, std::mt19937_64 &random) {
+    const size_t n = points.size();
+    Clustering clustering;
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    clustering.centroids.push_back(points[pick(random)]);
+    std::vector<double> nearest(n, std::numeric_limits<double>::max());
+    while (clustering.centroids.size() < k) {
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            nearest[i] = std::min(nearest[i], SquaredDistance(points[i], clustering.centroids.back()));
+            total += nearest[i];
+        }
+        if (total <= 0.0) {
+            clustering.centroids.push_back(points[pick(random)]);
+            continue;
+        }
+        double target = std::uniform_real_distribution<double>(0.0, total)(random);
+        size_t chosen = 0;
+        for (; chosen + 1 < n && target >= nearest[chosen]; ++chosen) {
+            target -= nearest[chosen];
+        }
+        clustering.centroids.push_back(points[chosen]);
+    }
+
+    clustering.labels.assign(n, k);
+    for (int iteration = 0; iteration < kMaxIterations; ++iteration) {
+        bool changed = false;
+        for (size_t i = 0; i < n; ++i) {
+            size_t best = 0;
+            double best_distance = std::numeric_limits<double>::max();
+            for (size_t c = 0; c < k; ++c) {
+                double distance = SquaredDistance(points[i], clustering.centroids[c]);
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = c;
+                }
+            }
+            if (clustering.labels[i] != best) {
+                clustering.labels[i] = best;
+                changed = true;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+        std::vector<size_t> members(k, 0);
+        for (auto &centroid : clustering.centroids) {
+            std::fill(centroid.begin(), centroid.end(), 0.0);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            members[clustering.labels[i]]++;
+            for (size_t d = 0; d < points[i].size(); ++d) {
+                clustering.centroids[clustering.labels[i]][d] += points[i][d];
+            }
+        }
+        for (size_t c = 0; c < k; ++c) {
+            if (members[c] == 0) {
+                // An emptied cluster restarts at a random point
+                clustering.centroids[c] = points[pick(random)];
+                continue;
+            }
+            for (double &value : clustering.centroids[c]) {
+                value /= static_cast<double>(members[c]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        clustering.distortion += SquaredDistance(points[i], clustering.centroids[clustering.labels[i]]);
+    }
+    return clustering;
+}
+
+// Bayesian Information Criterion of a clustering under a spherical Gaussian model (X-means)
+double Bic(const Clustering &clustering, size_t n, size_t dimensions) {
+    const auto r = static_cast<double>(n);
+    const auto m = static_cast<double>(dimensions);
+    const auto k = static_cast<double>(clustering.centroids.size());
+    double variance = (n > clustering.centroids.size()) ? clustering.distortion / (r - k) : 0.0;
+    variance = std::max(variance, 1e-12);
+
+    std::vector<size_t> members(clustering.centroids.size(), 0);
+    for (size_t label : clustering.labels) {
+        members[label]++;
+    }
+    double likelihood = 0.0;
+    for (size_t count : members) {
+        if (count == 0) {
+            continue;
+        }
+        const auto rn = static_cast<double>(count);
+        likelihood += -rn / 2.0 * std::log(2.0 * std::numbers::pi) - rn * m / 2.0 * std::log(variance)
+                      - (rn - k) / 2.0 + rn * std::log(rn) - rn * std::log(r);
+    }
+    const double parameters = (k - 1.0) + m * k + 1.0;
+    return likelihood - parameters / 2.0 * std::log(r);
+}
+
+} // namespace
+
+BbvProfiler::BbvProfiler(uint64_t interval, unsigned int dimensions, std::ostream &output)
+    : interval_(interval), dimensions_(dimensions), output_(output), random_(kProjectionSeed) {}
+
+void BbvProfiler::Retire(uint64_t pc, bool ends_block) {
+    if (!in_block_) {
+        block_start_ = pc;
+        in_block_ = true;
+    }
+    block_instructions_++;
+    interval_instructions_++;
+    if (ends_block) {
+        EndBlock();
+        in_block_ = false;
+    }
+    if (interval_instructions_ == interval_) {
+        // A block cut by the interval boundary keeps its entry pc in the next interval
+        EndBlock();
+        EndInterval();
+    }
+}
+
+void BbvProfiler::Finish() {
+    EndBlock();
+    EndInterval();
+}
+
+void BbvProfiler::EndBlock() {
+    if (block_instructions_ == 0) {
+        return;
+    }
+    auto [entry, inserted] = block_ids_.try_emplace(block_start_, static_cast<uint32_t>(block_ids_.size() + 1));
+    if (inserted) {
+        std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+        std::vector<double> row(dimensions_);
+        for (double &value : row) {
+            value = uniform(random_);
+        }
+        block_projections_.push_back(std::move(row));
+    }
+    counts_[entry->second] += block_instructions_;
+    block_instructions_ = 0;
+}
+
+void BbvProfiler::EndInterval() {
+    if (interval_instructions_ == 0) {
+        return;
+    }
+    std::vector<std::pair<uint32_t, uint64_t>> counts(counts_.begin(), counts_.end());
+    std::sort(counts.begin(), counts.end());
+
+    std::vector<double> projection(dimensions_, 0.0);
+    output_ << 'T';
+    for (const auto &[block, count] : counts) {
+        output_ << ':' << block << ':' << count << ' ';
+        double share = static_cast<double>(count) / static_cast<double>(interval_instructions_);
+        const std::vector<double> &row = block_projections_[block - 1];
+        for (unsigned int d = 0; d < dimensions_; ++d) {
+            projection[d] += share * row[d];
+        }
+    }
+    output_ << '\n';
+
+    projections_.push_back(std::move(projection));
+    interval_sizes_.push_back(interval_instructions_);
+    counts_.clear();
+    interval_instructions_ = 0;
+}
+
+Selection SelectSimPoints(const std::vector<std::vector<double>> &points, const std::vector<uint64_t> &sizes,
+                          size_t max_clusters, uint64_t seed) {
+    Selection selection;
+    const size_t n = points.size();
+    if (n == 0) {
+        return selection;
+    }
+    const size_t dimensions = points.front().size();
+    std::mt19937_64 random(seed);
+
+    std::vector<Clustering> clusterings;
+    std::vector<double> scores;
+    for (size_t k = 1; k <= std::min(max_clusters, n); ++k) {
+        Clustering best;
+        for (int restart = 0; restart < kRestarts; ++restart) {
+            Clustering clustering = KMeans(points, k, random);
+            if (restart == 0 || clustering.distortion < best.distortion) {
+                best = std::move(clustering);
+            }
+        }
+        scores.push_back(Bic(best, n, dimensions));
+        clusterings.push_back(std::move(best));
+    }
+
+    auto [lowest, highest] = std::minmax_element(scores.begin(), scores.end());
+    const double threshold = *lowest + 0.9 * (*highest - *lowest);
+    size_t chosen = 0;
+    while (scores[chosen] < threshold) {
+        ++chosen;
+    }
+    const Clustering &clustering = clusterings[chosen];
+
+    // Clusters left empty are dropped and the rest numbered in order
+    const size_t k = clustering.centroids.size();
+    std::vector<size_t> renumbered(k, k);
+    std::vector<double> closest;
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t &cluster = renumbered[clustering.labels[i]];
+        if (cluster == k) {
+            cluster = selection.simpoints.size();
+            selection.simpoints.push_back(i);
+            selection.weights.push_back(0.0);
+            closest.push_back(std::numeric_limits<double>::max());
+        }
+        double distance = SquaredDistance(points[i], clustering.centroids[clustering.labels[i]]);
+        if (distance < closest[cluster]) {
+            closest[cluster] = distance;
+            selection.simpoints[cluster] = i;
+        }
+        selection.weights[cluster] += static_cast<double>(sizes[i]);
+        total += static_cast<double>(sizes[i]);
+        selection.labels.push_back(cluster);
+    }
+    for (double &weight : selection.weights) {
+        weight /= total;
+    }
+    return selection;
+}
+
+} // namespace simpoint
@@ -14,6 +14,8 @@
 #include <vector>
 #include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <iomanip>
 #include <fstream>
 
 void setupVmStateDirectory() {
@@ -116,7 +118,32 @@ std::string ParseEscapedString(const std::string &input) {
   return oss.str();
 }
 
+std::string JsonString(const std::string &text) {
+  std::ostringstream out;
+  out << '"';
+  for (char c : text) {
+    switch (c) {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec
+              << std::setfill(' ');
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+  return out.str();
+}
+
 void DumpErrors(const std::filesystem::path &filename, const std::vector<ParseError> &errors) {
+  if (filename.empty()) {
+    return;
+  }
   std::ofstream file(filename);
   if (!file.is_open()) {
     throw std::runtime_error("Unable to open file: " + filename.string());
@@ -145,6 +172,9 @@ void DumpErrors(const std::filesystem::path &filename, const std::vector<ParseEr
 }
 
 void DumpNoErrors(const std::filesystem::path &filename) {
+  if (filename.empty()) {
+    return;
+  }
   std::ofstream file(filename);
   if (!file.is_open()) {
     throw std::runtime_error("Unable to open file: " + filename.string());
@@ -159,6 +189,9 @@ void DumpNoErrors(const std::filesystem::path &filename) {
 }
 
 void DumpRegisters(const std::filesystem::path &filename, RegisterFile &register_file) {
+  if (filename.empty()) {
+    return;
+  }
 
   std::vector<uint64_t> gp_registers = register_file.GetGprValues();
   std::vector<uint64_t> fp_registers = register_file.GetFprValues();
@@ -310,12 +343,32 @@ void DumpRegisters(const std::filesystem::path &filename, RegisterFile &register
 // }
 
 void DumpDisasssembly(const std::filesystem::path &filename, AssembledProgram &program) {
+  if (filename.empty()) {
+    return;
+  }
   std::ofstream out(filename);
   if (!out) {
     std::cerr << "Failed to open disassembly output file: " << filename << std::endl;
     return;
   }
+  WriteDisassembly(out, program);
+}
 
+namespace {
+
+// Writes a value in hex, right-aligned in a field of the given width
+void writeHex(std::ostream &out, uint64_t value, int width, char fill) {
+  char digits[16];
+  auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value, 16);
+  for (auto padding = width - (end - digits); padding > 0; --padding) {
+    out.put(fill);
+  }
+  out.write(digits, end - digits);
+}
+
+} // namespace
+
+void WriteDisassembly(std::ostream &out, AssembledProgram &program) {
   const std::map<std::string, SymbolData>& symbol_table = program.symbol_table;
   const std::vector<std::pair<ICUnit, bool>>& intermediate_code = program.intermediate_code;
   const std::vector<uint32_t>& text_buffer = program.text_buffer;
@@ -347,33 +400,32 @@ void DumpDisasssembly(const std::filesystem::path &filename, AssembledProgram &p
     auto it = label_for_address.find(current_address);
     if (it != label_for_address.end()) {
       if (line_number > 1) {
-        out << std::endl;
+        out << '\n';
         ++line_number;
       }
       out << std::setw(16) << std::setfill('0') << std::hex
           << current_address
           << std::dec << std::setfill(' ')
-          << " <" << it->second << ">:" << std::endl;
+          << " <" << it->second << ">:\n";
       ++line_number;
     }
 
-    out << "  "
-        << std::setw(hex_digits) << std::setfill(' ') << std::right << std::hex
-        << current_address
-        << std::dec << std::left << std::setw(0)
-        << ": ";
+    // Formatting with stream manipulators dominates the time spent on large programs
+    out << "  ";
+    writeHex(out, current_address, hex_digits, ' ');
+    out << ": ";
 
     if (instruction_index < text_buffer.size()) {
-      uint32_t raw = text_buffer[instruction_index];
-      out << std::setfill('0') << std::setw(8) << std::right << std::hex
-          << raw
-          << std::dec << std::setfill(' ') << "             ";
+      writeHex(out, text_buffer[instruction_index], 8, '0');
+      out << "             ";
     } else {
       out << " ????????             ";
     }
 
-    out << ICBlock << std::endl; 
-    instruction_number_disassembly_mapping[instruction_index] = line_number;
+    ICBlock.print(out, program.labels);
+    out << '\n';
+    instruction_number_disassembly_mapping.emplace_hint(instruction_number_disassembly_mapping.end(),
+                                                        instruction_index, line_number);
 
     ++line_number;
     ++instruction_index;
@@ -398,7 +450,9 @@ void SetupConfigFile() {
   config_file << "processor_type=single_stage\n";
   config_file << "hazard_detection=false\n";
   config_file << "forwarding=false\n";
-  config_file << "branch_prediction=none\n\n";
+  config_file << "branch_prediction=none\n";
+  config_file << "checkpoint_interval=100000\n";
+  config_file << "max_checkpoints=64\n\n";
 
   config_file << "[Memory]\n";
   config_file << "memory_size=0xffffffffffffffff\n";
@@ -408,7 +462,8 @@ void SetupConfigFile() {
   config_file << "[Assembler]\n";
   config_file << "m_extension_enabled=true\n";
   config_file << "f_extension_enabled=true\n";
-  config_file << "d_extension_enabled=true\n\n";
+  config_file << "d_extension_enabled=true\n";
+  config_file << "assembly_cache=false\n\n";
   // -----------------------------------------
 
   config_file << "[Cache]\n";
@@ -421,8 +476,63 @@ void SetupConfigFile() {
   config_file << "cache_write_hit_policy=write_back\n";
   config_file << "cache_write_miss_policy=write_allocate\n\n";
 
+  config_file << "[Pipeline]\n";
+  config_file << "issue_width=1\n";
+  config_file << "frontend_stages=2\n";
+  config_file << "execute_stages=1\n";
+  config_file << "memory_stages=1\n\n";
+
+  config_file << "[OutOfOrder]\n";
+  config_file << "width=4\n";
+  config_file << "rob_size=64\n";
+  config_file << "issue_queue_size=32\n";
+  config_file << "lsq_size=16\n";
+  config_file << "physical_registers=128\n\n";
+
+  config_file << "[Sampling]\n";
+  config_file << "mode=periodic\n";
+  config_file << "fast_forward=0\n";
+  config_file << "warmup=2000\n";
+  config_file << "window=1000\n";
+  config_file << "period=100000\n";
+  config_file << "confidence=0.95\n\n";
+
+  config_file << "[SimPoint]\n";
+  config_file << "interval=100000\n";
+  config_file << "max_clusters=10\n";
+  config_file << "dimensions=15\n\n";
+
+  config_file << "[Multicore]\n";
+  config_file << "harts=2\n";
+  config_file << "core=single_stage\n";
+  config_file << "l1_lines=64\n";
+  config_file << "l1_block_size=64\n";
+  config_file << "l1_associativity=4\n";
+  config_file << "stack_spacing=65536\n";
+  config_file << "quantum=0\n";
+  config_file << "threads=0\n";
+  config_file << "deterministic=true\n\n";
+
+  config_file << "[Batch]\n";
+  config_file << "threads=0\n\n";
+
+  config_file << "[Syscalls]\n";
+  config_file << "sandbox_directory=\n\n";
+
   config_file << "[BranchPrediction]\n";
-  config_file << "branch_prediction_table_size=0\n";
-  config_file << "branch_prediction_table_associativity=0\n";
+  config_file << "one_bit_table_size=1024\n";
+  config_file << "bimodal_table_size=1024\n";
+  config_file << "gshare_table_size=4096\n";
+  config_file << "gshare_history_bits=12\n";
+  config_file << "chooser_table_size=1024\n";
+  config_file << "tage_table_size=1024\n";
+  config_file << "tage_num_tables=4\n";
+  config_file << "tage_min_history=4\n";
+  config_file << "tage_max_history=64\n";
+  config_file << "btb_enabled=true\n";
+  config_file << "btb_entries=64\n";
+  config_file << "btb_associativity=4\n";
+  config_file << "ras_enabled=true\n";
+  config_file << "ras_size=16\n";
   config_file.close();
 }
\ No newline at end of file
@@ -0,0 +1,493 @@
+/**
+ * @file branch_predictor.cpp
+ * @brief Implementation of the dynamic branch direction predictors
+ */
+#include "vm/branch_predictor/branch_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace branch_predictor {
+
+namespace {
+
+// 2-bit saturating counter: 0,1 predict not taken; 2,3 predict taken
+constexpr uint16_t kWeaklyNotTaken = 1;
+constexpr uint16_t kWeaklyTaken = 2;
+constexpr uint16_t kCounterMax = 3;
+
+uint16_t Saturate(uint16_t counter, bool taken) {
+    if (taken) {
+        return counter < kCounterMax ? counter + 1 : counter;
+    }
+    return counter > 0 ? counter - 1 : counter;
+}
+
+uint64_t PcIndex(uint64_t pc) {
+    return pc >> 2; // instructions are word aligned
+}
+
+// TAGE tagged entry layout: [15] valid, [13:5] tag, [4:3] useful, [2:0] counter
+constexpr uint16_t kTageValid = 1u << 15;
+constexpr uint64_t kTageTagBits = 9;
+constexpr uint16_t kTageTagMask = (1u << kTageTagBits) - 1;
+constexpr uint16_t kTageCounterMax = 7;
+constexpr uint16_t kTageUsefulMax = 3;
+
+uint16_t TageCounter(uint16_t entry) {
+    return entry & 0x7;
+}
+
+uint16_t TageUseful(uint16_t entry) {
+    return (entry >> 3) & 0x3;
+}
+
+uint16_t TageTag(uint16_t entry) {
+    return (entry >> 5) & kTageTagMask;
+}
+
+uint16_t TageEntry(uint16_t tag, uint16_t useful, uint16_t counter) {
+    return kTageValid | static_cast<uint16_t>(tag << 5) | static_cast<uint16_t>(useful << 3) | counter;
+}
+
+// XORs the newest `length` history bits down to `bits` bits
+uint64_t FoldHistory(uint64_t history, uint64_t length, uint64_t bits) {
+    uint64_t h = length >= 64 ? history : history & ((1ULL << length) - 1);
+    uint64_t chunk_mask = (1ULL << bits) - 1;
+    uint64_t folded = 0;
+    while (h != 0) {
+        folded ^= h & chunk_mask;
+        h >>= bits;
+    }
+    return folded;
+}
+
+void CheckTableSize(uint64_t size, const char *what) {
+    if (!IsPowerOfTwo(size) || size > UINT32_MAX) {
+        throw std::invalid_argument(std::string(what) + " must be a power of two");
+    }
+}
+
+} // namespace
+
+    BranchPredictor::BranchPredictor(PredictorKind kind) : kind_(kind), name_(PredictorKindToString(kind)) {}
+
+    void BranchPredictor::Reset() {
+        for (size_t i = 0; i < tables_.size(); ++i) {
+            std::fill(tables_[i].begin(), tables_[i].end(), initial_values_[i]);
+        }
+        history_ = 0;
+        stats_ = PredictorStats();
+    }
+
+    BranchPredictor::State BranchPredictor::SaveState() const {
+        return {tables_, history_, stats_};
+    }
+
+    void BranchPredictor::RestoreState(const State &state) {
+        tables_ = state.tables;
+        history_ = state.history;
+        stats_ = state.stats;
+    }
+
+    void BranchPredictor::AddTable(uint64_t size, uint16_t initial_value) {
+        tables_.emplace_back(size, initial_value);
+        initial_values_.push_back(initial_value);
+    }
+
+    void BranchPredictor::Write(uint8_t table, uint64_t index, uint16_t value) {
+        uint16_t &slot = tables_[table][index];
+        if (slot == value) {
+            return;
+        }
+        if (journal_) {
+            journal_->push_back({id_, table, static_cast<uint32_t>(index), slot, value});
+        }
+        slot = value;
+    }
+
+    void BranchPredictor::WriteHistory(uint64_t value) {
+        if (history_ == value) {
+            return;
+        }
+        if (journal_) {
+            journal_->push_back({id_, kHistoryTable, 0, history_, value});
+        }
+        history_ = value;
+    }
+
+    void BranchPredictor::ApplyWrite(const StateWrite &write, bool undo) {
+        uint64_t value = undo ? write.old_value : write.new_value;
+        if (write.table == kHistoryTable) {
+            history_ = value;
+        } else {
+            tables_[write.table][write.index] = static_cast<uint16_t>(value);
+        }
+    }
+
+    // --- 1-bit ---
+    // Entry values: 0 = never seen, 1 = last not taken, 2 = last taken
+
+    OneBitPredictor::OneBitPredictor(uint64_t table_size)
+        : BranchPredictor(PredictorKind::OneBit), mask_(table_size - 1) {
+        CheckTableSize(table_size, "one_bit_table_size");
+        AddTable(table_size, 0);
+    }
+
+    bool OneBitPredictor::Predict(uint64_t pc, uint64_t target) const {
+        uint16_t entry = tables_[0][PcIndex(pc) & mask_];
+        if (entry == 0) {
+            // Cold entry: backward branches taken, forward branches not taken
+            return target < pc;
+        }
+        return entry == 2;
+    }
+
+    void OneBitPredictor::Update(uint64_t pc, uint64_t, bool taken) {
+        Write(0, PcIndex(pc) & mask_, taken ? 2 : 1);
+    }
+
+    // --- Bimodal ---
+
+    BimodalPredictor::BimodalPredictor(uint64_t table_size)
+        : BranchPredictor(PredictorKind::Bimodal), mask_(table_size - 1) {
+        CheckTableSize(table_size, "bimodal_table_size");
+        AddTable(table_size, kWeaklyNotTaken);
+    }
+
+    bool BimodalPredictor::Predict(uint64_t pc, uint64_t) const {
+        return tables_[0][PcIndex(pc) & mask_] >= kWeaklyTaken;
+    }
+
+    void BimodalPredictor::Update(uint64_t pc, uint64_t, bool taken) {
+        uint64_t index = PcIndex(pc) & mask_;
+        Write(0, index, Saturate(tables_[0][index], taken));
+    }
+
+    // --- Gshare ---
+
+    GsharePredictor::GsharePredictor(uint64_t table_size, uint64_t history_bits)
+        : BranchPredictor(PredictorKind::Gshare),
+          mask_(table_size - 1),
+          history_mask_(history_bits >= 64 ? ~0ULL : (1ULL << history_bits) - 1) {
+        CheckTableSize(table_size, "gshare_table_size");
+        AddTable(table_size, kWeaklyNotTaken);
+    }
+
+    bool GsharePredictor::Predict(uint64_t pc, uint64_t) const {
+        return tables_[0][(PcIndex(pc) ^ history_) & mask_] >= kWeaklyTaken;
+    }
+
+    void GsharePredictor::Update(uint64_t pc, uint64_t, bool taken) {
+        uint64_t index = (PcIndex(pc) ^ history_) & mask_;
+        Write(0, index, Saturate(tables_[0][index], taken));
+        WriteHistory(((history_ << 1) | (taken ? 1 : 0)) & history_mask_);
+    }
+
+    // --- Tournament ---
+    // Chooser counters >= 2 select the gshare component, < 2 the bimodal one.
+
+    TournamentPredictor::TournamentPredictor(uint64_t bimodal_size, uint64_t gshare_size,
+                                             uint64_t history_bits, uint64_t chooser_size)
+        : BranchPredictor(PredictorKind::Tournament),
+          bimodal_mask_(bimodal_size - 1),
+          gshare_mask_(gshare_size - 1),
+          history_mask_(history_bits >= 64 ? ~0ULL : (1ULL << history_bits) - 1),
+          chooser_mask_(chooser_size - 1) {
+        CheckTableSize(bimodal_size, "bimodal_table_size");
+        CheckTableSize(gshare_size, "gshare_table_size");
+        CheckTableSize(chooser_size, "chooser_table_size");
+        AddTable(bimodal_size, kWeaklyNotTaken);
+        AddTable(gshare_size, kWeaklyNotTaken);
+        AddTable(chooser_size, kWeaklyTaken);
+    }
+
+    bool TournamentPredictor::PredictBimodal(uint64_t pc) const {
+        return tables_[kBimodal][PcIndex(pc) & bimodal_mask_] >= kWeaklyTaken;
+    }
+
+    bool TournamentPredictor::PredictGshare(uint64_t pc) const {
+        return tables_[kGshare][(PcIndex(pc) ^ history_) & gshare_mask_] >= kWeaklyTaken;
+    }
+
+    bool TournamentPredictor::Predict(uint64_t pc, uint64_t) const {
+        bool use_gshare = tables_[kChooser][PcIndex(pc) & chooser_mask_] >= kWeaklyTaken;
+        return use_gshare ? PredictGshare(pc) : PredictBimodal(pc);
+    }
+
+    void TournamentPredictor::Update(uint64_t pc, uint64_t, bool taken) {
+        bool bimodal_taken = PredictBimodal(pc);
+        bool gshare_taken = PredictGshare(pc);
+
+        // Train the chooser only when the components disagree
+        if (bimodal_taken != gshare_taken) {
+            uint64_t chooser_index = PcIndex(pc) & chooser_mask_;
+            Write(kChooser, chooser_index, Saturate(tables_[kChooser][chooser_index], gshare_taken == taken));
+        }
+
+        uint64_t bimodal_index = PcIndex(pc) & bimodal_mask_;
+        Write(kBimodal, bimodal_index, Saturate(tables_[kBimodal][bimodal_index], taken));
+
+        uint64_t gshare_index = (PcIndex(pc) ^ history_) & gshare_mask_;
+        Write(kGshare, gshare_index, Saturate(tables_[kGshare][gshare_index], taken));
+
+        WriteHistory(((history_ << 1) | (taken ? 1 : 0)) & history_mask_);
+    }
+
+    // --- TAGE ---
+    // Table 0 is the bimodal base, tables 1..n are tagged, shortest history first.
+
+    TagePredictor::TagePredictor(uint64_t base_size, uint64_t table_size, uint64_t num_tables,
+                                 uint64_t min_history, uint64_t max_history)
+        : BranchPredictor(PredictorKind::Tage),
+          base_mask_(base_size - 1),
+          index_bits_(0),
+          index_mask_(table_size - 1),
+          history_mask_(max_history >= 64 ? ~0ULL : (1ULL << max_history) - 1) {
+        CheckTableSize(base_size, "bimodal_table_size");
+        CheckTableSize(table_size, "tage_table_size");
+        if (num_tables == 0 || num_tables > 16) {
+            throw std::invalid_argument("tage_num_tables must be between 1 and 16");
+        }
+        if (min_history == 0 || min_history > max_history || max_history > 64) {
+            throw std::invalid_argument("TAGE history lengths must satisfy 1 <= tage_min_history <= tage_max_history <= 64");
+        }
+        while ((1ULL << index_bits_) < table_size) {
+            index_bits_++;
+        }
+
+        AddTable(base_size, kWeaklyNotTaken);
+        for (uint64_t i = 0; i < num_tables; ++i) {
+            double ratio = (num_tables == 1) ? 0.0 : static_cast<double>(i) / static_cast<double>(num_tables - 1);
+            double length = static_cast<double>(min_history) *
+                            std::pow(static_cast<double>(max_history) / static_cast<double>(min_history), ratio);
+            history_lengths_.push_back(static_cast<uint64_t>(std::lround(length)));
+            AddTable(table_size, 0);
+        }
+    }
+
+    uint64_t TagePredictor::Index(size_t table, uint64_t pc) const {
+        uint64_t pc_index = PcIndex(pc);
+        uint64_t history = FoldHistory(history_, history_lengths_[table - 1], std::max<uint64_t>(index_bits_, 1));
+        return (pc_index ^ (pc_index >> index_bits_) ^ history) & index_mask_;
+    }
+
+    uint16_t TagePredictor::Tag(size_t table, uint64_t pc) const {
+        uint64_t length = history_lengths_[table - 1];
+        uint64_t tag = PcIndex(pc) ^ FoldHistory(history_, length, kTageTagBits) ^ (FoldHistory(history_, length, kTageTagBits - 1) << 1);
+        return static_cast<uint16_t>(tag & kTageTagMask);
+    }
+
+    TagePredictor::Lookup TagePredictor::Find(uint64_t pc) const {
+        Lookup lookup;
+        for (size_t table = tables_.size() - 1; table >= 1; --table) {
+            uint16_t entry = tables_[table][Index(table, pc)];
+            if ((entry & kTageValid) && TageTag(entry) == Tag(table, pc)) {
+                if (lookup.provider < 0) {
+                    lookup.provider = static_cast<int>(table);
+                } else {
+                    lookup.alternate = static_cast<int>(table);
+                    break;
+                }
+            }
+        }
+
+        bool base_prediction = tables_[0][PcIndex(pc) & base_mask_] >= kWeaklyTaken;
+        lookup.alternate_prediction = base_prediction;
+        if (lookup.alternate >= 0) {
+            lookup.alternate_prediction = TageCounter(tables_[lookup.alternate][Index(lookup.alternate, pc)]) >= 4;
+        }
+        lookup.prediction = base_prediction;
+        if (lookup.provider >= 0) {
+            lookup.prediction = TageCounter(tables_[lookup.provider][Index(lookup.provider, pc)]) >= 4;
+        }
+        return lookup;
+    }
+
+    bool TagePredictor::Predict(uint64_t pc, uint64_t) const {
+        return Find(pc).prediction;
+    }
+
+    void TagePredictor::Update(uint64_t pc, uint64_t, bool taken) {
+        Lookup lookup = Find(pc);
+
+        if (lookup.provider >= 0) {
+            uint8_t table = static_cast<uint8_t>(lookup.provider);
+            uint64_t index = Index(table, pc);
+            uint16_t entry = tables_[table][index];
+            uint16_t counter = TageCounter(entry);
+            uint16_t useful = TageUseful(entry);
+
+            if (taken) {
+                counter = counter < kTageCounterMax ? counter + 1 : counter;
+            } else {
+                counter = counter > 0 ? counter - 1 : counter;
+            }
+            // The useful bits track whether the provider beats the alternate prediction
+            if (lookup.prediction != lookup.alternate_prediction) {
+                if (lookup.prediction == taken) {
+                    useful = useful < kTageUsefulMax ? useful + 1 : useful;
+                } else {
+                    useful = useful > 0 ? useful - 1 : useful;
+                }
+            }
+            Write(table, index, TageEntry(TageTag(entry), useful, counter));
+        } else {
+            uint64_t index = PcIndex(pc) & base_mask_;
+            Write(0, index, Saturate(tables_[0][index], taken));
+        }
+
+        // On a misprediction, allocate in a longer table whose entry is not useful
+        size_t first_longer = (lookup.provider < 0) ? 1 : static_cast<size_t>(lookup.provider) + 1;
+        if (lookup.prediction != taken && first_longer < tables_.size()) {
+            bool allocated = false;
+            for (size_t table = first_longer; table < tables_.size(); ++table) {
+                uint64_t index = Index(table, pc);
+                if (TageUseful(tables_[table][index]) == 0) {
+                    Write(static_cast<uint8_t>(table), index, TageEntry(Tag(table, pc), 0, taken ? 4 : 3));
+                    allocated = true;
+                    break;
+                }
+            }
+            if (!allocated) {
+                for (size_t table = first_longer; table < tables_.size(); ++table) {
+                    uint64_t index = Index(table, pc);
+                    uint16_t entry = tables_[table][index];
+                    Write(static_cast<uint8_t>(table), index,
+                          TageEntry(TageTag(entry), TageUseful(entry) - 1, TageCounter(entry)));
+                }
+            }
+        }
+
+        WriteHistory(((history_ << 1) | (taken ? 1 : 0)) & history_mask_);
+    }
+
+    // --- Unit ---
+
+    void BranchPredictorUnit::Initialize(const BranchPredictorConfig &config) {
+        config_ = config;
+        predictors_.clear();
+
+        predictors_.push_back(std::make_unique<OneBitPredictor>(config.one_bit_table_size));
+        predictors_.push_back(std::make_unique<BimodalPredictor>(config.bimodal_table_size));
+        predictors_.push_back(std::make_unique<GsharePredictor>(config.gshare_table_size, config.gshare_history_bits));
+        predictors_.push_back(std::make_unique<TournamentPredictor>(config.bimodal_table_size, config.gshare_table_size,
+                                                                    config.gshare_history_bits, config.chooser_table_size));
+        predictors_.push_back(std::make_unique<TagePredictor>(config.bimodal_table_size, config.tage_table_size,
+                                                              config.tage_num_tables, config.tage_min_history,
+                                                              config.tage_max_history));
+    }
+
+    void BranchPredictorUnit::Reset() {
+        for (auto &predictor : predictors_) {
+            predictor->Reset();
+        }
+    }
+
+    bool BranchPredictorUnit::Predict(PredictorKind kind, uint64_t pc, uint64_t target) const {
+        for (const auto &predictor : predictors_) {
+            if (predictor->GetKind() == kind) {
+                return predictor->Predict(pc, target);
+            }
+        }
+        return false;
+    }
+
+    ResolveRecord BranchPredictorUnit::Resolve(uint64_t pc, uint64_t target, bool taken) {
+        ResolveRecord record;
+        record.occurred = true;
+
+        for (size_t i = 0; i < predictors_.size(); ++i) {
+            BranchPredictor &predictor = *predictors_[i];
+            bool predicted = predictor.Predict(pc, target);
+
+            PredictorStats &stats = predictor.GetStats();
+            stats.predictions++;
+            if (predicted == taken) {
+                stats.correct++;
+                record.correct_mask |= (1ULL << i);
+            }
+
+            predictor.SetJournal(&record.writes, static_cast<uint8_t>(i));
+            predictor.Update(pc, target, taken);
+            predictor.SetJournal(nullptr, 0);
+        }
+
+        return record;
+    }
+
+    void BranchPredictorUnit::Train(uint64_t pc, uint64_t target, bool taken) {
+        for (auto &predictor : predictors_) {
+            PredictorStats &stats = predictor->GetStats();
+            stats.predictions++;
+            if (predictor->Predict(pc, target) == taken) {
+                stats.correct++;
+            }
+            predictor->Update(pc, target, taken);
+        }
+    }
+
+    BranchPredictorUnit::State BranchPredictorUnit::SaveState() const {
+        State state;
+        state.config = config_;
+        state.predictors.reserve(predictors_.size());
+        for (const auto &predictor : predictors_) {
+            state.predictors.push_back(predictor->SaveState());
+        }
+        return state;
+    }
+
+    void BranchPredictorUnit::RestoreState(const State &state) {
+        if (predictors_.size() != state.predictors.size() || config_ != state.config) {
+            Initialize(state.config);
+        }
+        for (size_t i = 0; i < predictors_.size(); ++i) {
+            predictors_[i]->RestoreState(state.predictors[i]);
+        }
+    }
+
+    void BranchPredictorUnit::Rollback(const ResolveRecord &record) {
+        if (!record.occurred) {
+            return;
+        }
+        for (auto it = record.writes.rbegin(); it != record.writes.rend(); ++it) {
+            predictors_[it->predictor]->ApplyWrite(*it, true);
+        }
+        for (size_t i = 0; i < predictors_.size(); ++i) {
+            PredictorStats &stats = predictors_[i]->GetStats();
+            stats.predictions--;
+            if (record.correct_mask & (1ULL << i)) {
+                stats.correct--;
+            }
+        }
+    }
+
+    void BranchPredictorUnit::Replay(const ResolveRecord &record) {
+        if (!record.occurred) {
+            return;
+        }
+        for (const auto &write : record.writes) {
+            predictors_[write.predictor]->ApplyWrite(write, false);
+        }
+        for (size_t i = 0; i < predictors_.size(); ++i) {
+            PredictorStats &stats = predictors_[i]->GetStats();
+            stats.predictions++;
+            if (record.correct_mask & (1ULL << i)) {
+                stats.correct++;
+            }
+        }
+    }
+
+    std::string PredictorKindToString(PredictorKind kind) {
+        switch (kind) {
+            case PredictorKind::OneBit: return "dynamic_1bit";
+            case PredictorKind::Bimodal: return "dynamic_2bit";
+            case PredictorKind::Gshare: return "gshare";
+            case PredictorKind::Tournament: return "tournament";
+            case PredictorKind::Tage: return "tage";
+            default: return "unknown";
+        }
+    }
+
+} // namespace branch_predictor
@@ -0,0 +1,90 @@
+/**
+ * @file branch_trace.cpp
+ * @brief Branch trace file format and trace replay
+ */
+#include "vm/branch_predictor/branch_trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace branch_predictor {
+
+namespace {
+
+constexpr const char *kTraceMagic = "branch_trace";
+
+} // namespace
+
+    void WriteBranchTrace(const std::filesystem::path &path, const BranchTrace &trace) {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Unable to open branch trace for writing: " + path.string());
+        }
+        file << kTraceMagic << " " << trace.instructions << " " << trace.branches.size() << " " << trace.name << "\n";
+        file << std::hex;
+        for (const BranchRecord &record : trace.branches) {
+            file << record.pc << " " << (record.taken ? 1 : 0) << " " << record.target << "\n";
+        }
+    }
+
+    BranchTrace ReadBranchTrace(const std::filesystem::path &path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Unable to open branch trace: " + path.string());
+        }
+
+        BranchTrace trace;
+        std::string header;
+        std::getline(file, header);
+        std::istringstream header_stream(header);
+        std::string magic;
+        uint64_t count = 0;
+        header_stream >> magic >> trace.instructions >> count;
+        if (magic != kTraceMagic || header_stream.fail()) {
+            throw std::runtime_error("Not a branch trace: " + path.string());
+        }
+        std::getline(header_stream >> std::ws, trace.name);
+
+        // The count is only a hint until the records are read, so a corrupt header cannot
+        // reserve unbounded memory
+        trace.branches.reserve(std::min<uint64_t>(count, 1 << 20));
+        BranchRecord record;
+        int taken = 0;
+        file >> std::hex;
+        while (file >> record.pc >> taken >> record.target) {
+            record.taken = (taken != 0);
+            trace.branches.push_back(record);
+        }
+        if (trace.branches.size() != count) {
+            throw std::runtime_error("Truncated branch trace: " + path.string());
+        }
+        return trace;
+    }
+
+    std::vector<ReplayResult> ReplayBranchTrace(const BranchTrace &trace, const BranchPredictorConfig &config) {
+        BranchPredictorUnit unit;
+        unit.Initialize(config);
+        unit.Reset();
+
+        for (const BranchRecord &record : trace.branches) {
+            unit.Train(record.pc, record.target, record.taken);
+        }
+
+        std::vector<ReplayResult> results;
+        for (const auto &predictor : unit.GetPredictors()) {
+            const PredictorStats &stats = predictor->GetStats();
+            ReplayResult result;
+            result.predictor = predictor->GetName();
+            result.branches = stats.predictions;
+            result.mispredictions = stats.predictions - stats.correct;
+            result.mpki = (trace.instructions > 0)
+                              ? static_cast<double>(result.mispredictions) * 1000.0 / static_cast<double>(trace.instructions)
+                              : 0.0;
+            results.push_back(result);
+        }
+        return results;
+    }
+
+} // namespace branch_predictor
@@ -0,0 +1,251 @@
+/**
+ * @file target_predictor.cpp
+ * @brief Implementation of the branch target buffer and return address stack
+ */
+#include "vm/branch_predictor/target_predictor.h"
+#include "vm/branch_predictor/branch_predictor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace branch_predictor {
+
+    // --- BTB ---
+
+    void BranchTargetBuffer::Initialize(uint64_t entries, uint64_t associativity) {
+        if (!IsPowerOfTwo(entries) || entries > UINT32_MAX) {
+            throw std::invalid_argument("btb_entries must be a power of two");
+        }
+        if (!IsPowerOfTwo(associativity) || associativity > entries) {
+            throw std::invalid_argument("btb_associativity must be a power of two no larger than btb_entries");
+        }
+        ways_ = associativity;
+        sets_ = entries / associativity;
+        entries_.assign(entries, BtbEntry());
+        clock_ = 0;
+    }
+
+    void BranchTargetBuffer::Reset() {
+        std::fill(entries_.begin(), entries_.end(), BtbEntry());
+        clock_ = 0;
+    }
+
+    bool BranchTargetBuffer::Lookup(uint64_t pc, uint64_t &target) const {
+        if (entries_.empty()) {
+            return false;
+        }
+        uint64_t set = (pc >> 2) & (sets_ - 1);
+        for (uint64_t way = 0; way < ways_; ++way) {
+            const BtbEntry &entry = entries_[set * ways_ + way];
+            if (entry.valid && entry.tag == pc) {
+                target = entry.target;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void BranchTargetBuffer::Update(uint64_t pc, uint64_t target, TargetUpdateRecord &record) {
+        if (entries_.empty()) {
+            return;
+        }
+        uint64_t set = (pc >> 2) & (sets_ - 1);
+        uint64_t base = set * ways_;
+
+        // Reuse the matching way, otherwise the first invalid one, otherwise the LRU one
+        uint64_t victim = base;
+        bool found = false;
+        for (uint64_t way = 0; way < ways_; ++way) {
+            const BtbEntry &entry = entries_[base + way];
+            if (entry.valid && entry.tag == pc) {
+                victim = base + way;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            for (uint64_t way = 0; way < ways_; ++way) {
+                const BtbEntry &entry = entries_[base + way];
+                if (!entry.valid) {
+                    victim = base + way;
+                    break;
+                }
+                if (entry.last_used < entries_[victim].last_used) {
+                    victim = base + way;
+                }
+            }
+        }
+
+        record.btb_written = true;
+        record.btb_slot = static_cast<uint32_t>(victim);
+        record.old_btb_entry = entries_[victim];
+        record.old_btb_clock = clock_;
+
+        BtbEntry &entry = entries_[victim];
+        entry.valid = true;
+        entry.tag = pc;
+        entry.target = target;
+        entry.last_used = ++clock_;
+
+        record.new_btb_entry = entry;
+        record.new_btb_clock = clock_;
+    }
+
+    void BranchTargetBuffer::RestoreSlot(uint32_t slot, const BtbEntry &entry, uint64_t clock) {
+        entries_[slot] = entry;
+        clock_ = clock;
+    }
+
+    // --- RAS ---
+
+    void ReturnAddressStack::Initialize(uint64_t size) {
+        if (size == 0 || size > UINT32_MAX) {
+            throw std::invalid_argument("ras_size must be at least 1");
+        }
+        entries_.assign(size, 0);
+        top_ = 0;
+        count_ = 0;
+    }
+
+    void ReturnAddressStack::Reset() {
+        std::fill(entries_.begin(), entries_.end(), 0);
+        top_ = 0;
+        count_ = 0;
+    }
+
+    bool ReturnAddressStack::Peek(uint64_t &address) const {
+        if (count_ == 0) {
+            return false;
+        }
+        address = entries_[(top_ + entries_.size() - 1) % entries_.size()];
+        return true;
+    }
+
+    void ReturnAddressStack::Push(uint64_t address, TargetUpdateRecord &record) {
+        record.ras_slot_written = true;
+        record.ras_slot = top_;
+        record.old_ras_value = entries_[top_];
+        record.new_ras_value = address;
+
+        entries_[top_] = address;
+        top_ = static_cast<uint32_t>((top_ + 1) % entries_.size());
+        if (count_ < entries_.size()) {
+            count_++;
+        }
+    }
+
+    void ReturnAddressStack::Pop() {
+        if (count_ == 0) {
+            return;
+        }
+        top_ = static_cast<uint32_t>((top_ + entries_.size() - 1) % entries_.size());
+        count_--;
+    }
+
+    void ReturnAddressStack::Restore(uint32_t top, uint32_t count) {
+        top_ = top;
+        count_ = count;
+    }
+
+    void ReturnAddressStack::RestoreSlot(uint32_t slot, uint64_t value) {
+        entries_[slot] = value;
+    }
+
+    // --- Unit ---
+
+    void TargetPredictor::Initialize(const TargetPredictorConfig &config) {
+        config_ = config;
+        btb_.Initialize(config.btb_entries, config.btb_associativity);
+        ras_.Initialize(config.ras_size);
+    }
+
+    void TargetPredictor::Reset() {
+        btb_.Reset();
+        ras_.Reset();
+        stats_ = TargetPredictorStats();
+    }
+
+    TargetSource TargetPredictor::Predict(uint64_t pc, bool is_return, uint64_t &target) const {
+        if (is_return && config_.ras_enabled && ras_.Peek(target)) {
+            return TargetSource::Ras;
+        }
+        if (config_.btb_enabled && btb_.Lookup(pc, target)) {
+            return TargetSource::Btb;
+        }
+        return TargetSource::None;
+    }
+
+    TargetUpdateRecord TargetPredictor::Resolve(uint64_t pc, uint64_t target, bool is_jalr, uint8_t rd, uint8_t rs1,
+                                                TargetSource source, uint64_t predicted_target, uint64_t flush_penalty) {
+        TargetUpdateRecord record;
+        record.occurred = true;
+        record.old_stats = stats_;
+        record.old_ras_top = ras_.GetTop();
+        record.old_ras_count = ras_.GetCount();
+
+        if (is_jalr) {
+            bool hit = (source != TargetSource::None) && (predicted_target == target);
+            if (source == TargetSource::Ras) {
+                stats_.ras_lookups++;
+                if (hit) {
+                    stats_.ras_hits++;
+                }
+            } else if (config_.btb_enabled) {
+                stats_.btb_lookups++;
+                if (hit) {
+                    stats_.btb_hits++;
+                }
+            }
+            if (hit) {
+                stats_.cycles_saved += flush_penalty;
+            }
+
+            if (config_.btb_enabled) {
+                btb_.Update(pc, target, record);
+            }
+        }
+
+        if (config_.ras_enabled) {
+            if (IsReturn(is_jalr, rd, rs1)) {
+                ras_.Pop();
+            }
+            if (IsCall(rd)) {
+                ras_.Push(pc + 4, record);
+            }
+        }
+
+        record.new_stats = stats_;
+        record.new_ras_top = ras_.GetTop();
+        record.new_ras_count = ras_.GetCount();
+        return record;
+    }
+
+    void TargetPredictor::Rollback(const TargetUpdateRecord &record) {
+        if (!record.occurred) {
+            return;
+        }
+        if (record.btb_written) {
+            btb_.RestoreSlot(record.btb_slot, record.old_btb_entry, record.old_btb_clock);
+        }
+        if (record.ras_slot_written) {
+            ras_.RestoreSlot(record.ras_slot, record.old_ras_value);
+        }
+        ras_.Restore(record.old_ras_top, record.old_ras_count);
+        stats_ = record.old_stats;
+    }
+
+    void TargetPredictor::Replay(const TargetUpdateRecord &record) {
+        if (!record.occurred) {
+            return;
+        }
+        if (record.btb_written) {
+            btb_.RestoreSlot(record.btb_slot, record.new_btb_entry, record.new_btb_clock);
+        }
+        if (record.ras_slot_written) {
+            ras_.RestoreSlot(record.ras_slot, record.new_ras_value);
+        }
+        ras_.Restore(record.new_ras_top, record.new_ras_count);
+        stats_ = record.new_stats;
+    }
+
+} // namespace branch_predictor
@@ -0,0 +1,165 @@
+/**
+ * @file mesi.cpp
+ * @brief MESI coherence between the private L1 caches of several harts
+ */
+#include "vm/cache/mesi.h"
+
+#include <algorithm>
+
+namespace cache {
+
+    MesiSystem::MesiSystem(unsigned int harts, const CacheConfig &config) : config_(config), caches_(harts) {
+        config_.associativity = std::max(config_.associativity, 1UL);
+        config_.block_size = std::max(config_.block_size, 1UL);
+        config_.lines = std::max(config_.lines, config_.associativity);
+        num_sets_ = config_.lines / config_.associativity;
+        for (L1 &l1 : caches_) {
+            l1.lines.resize(num_sets_ * config_.associativity);
+        }
+    }
+
+    MesiSystem::Line *MesiSystem::Find(unsigned int hart, uint64_t block) {
+        return const_cast<Line *>(static_cast<const MesiSystem *>(this)->Find(hart, block));
+    }
+
+    const MesiSystem::Line *MesiSystem::Find(unsigned int hart, uint64_t block) const {
+        const std::vector<Line> &lines = caches_[hart].lines;
+        const size_t first = (block % num_sets_) * config_.associativity;
+        for (size_t i = first; i < first + config_.associativity; ++i) {
+            if (lines[i].state != MesiState::Invalid && lines[i].block == block) {
+                return &lines[i];
+            }
+        }
+        return nullptr;
+    }
+
+    MesiSystem::Line &MesiSystem::Victim(unsigned int hart, uint64_t block) {
+        std::vector<Line> &lines = caches_[hart].lines;
+        const size_t first = (block % num_sets_) * config_.associativity;
+        Line *victim = &lines[first];
+        for (size_t i = first; i < first + config_.associativity; ++i) {
+            if (lines[i].state == MesiState::Invalid) {
+                return lines[i];
+            }
+            if (lines[i].last_use < victim->last_use) {
+                victim = &lines[i];
+            }
+        }
+        return *victim;
+    }
+
+    void MesiSystem::InvalidateOthers(unsigned int hart, uint64_t block) {
+        for (unsigned int other = 0; other < caches_.size(); ++other) {
+            if (other == hart) {
+                continue;
+            }
+            L1 &l1 = caches_[other];
+            if (l1.reservation == block) {
+                l1.reservation.reset();
+            }
+            Line *line = Find(other, block);
+            if (!line) {
+                continue;
+            }
+            if (line->state == MesiState::Modified) {
+                l1.stats.writebacks++;
+            }
+            line->state = MesiState::Invalid;
+            line->invalidated = true;
+            l1.stats.invalidations++;
+            bus_stats_.invalidations++;
+        }
+    }
+
+    void MesiSystem::Access(unsigned int hart, uint64_t address, bool is_write) {
+        const uint64_t block = address / config_.block_size;
+        L1 &l1 = caches_[hart];
+        l1.stats.accesses++;
+        clock_++;
+
+        if (Line *line = Find(hart, block)) {
+            l1.stats.hits++;
+            line->last_use = clock_;
+            if (is_write) {
+                if (line->state == MesiState::Shared) {
+                    l1.stats.upgrades++;
+                    bus_stats_.bus_upgrades++;
+                }
+                // Exclusive becomes Modified silently; nobody else can hold the line
+                line->state = MesiState::Modified;
+                InvalidateOthers(hart, block);
+            }
+            return;
+        }
+
+        l1.stats.misses++;
+        const size_t first = (block % num_sets_) * config_.associativity;
+        for (size_t i = first; i < first + config_.associativity; ++i) {
+            if (l1.lines[i].invalidated && l1.lines[i].block == block) {
+                l1.stats.coherence_misses++;
+                break;
+            }
+        }
+
+        bool held_elsewhere = false;
+        for (unsigned int other = 0; other < caches_.size(); ++other) {
+            if (other != hart && Find(other, block)) {
+                held_elsewhere = true;
+                break;
+            }
+        }
+        if (held_elsewhere) {
+            bus_stats_.cache_to_cache++;
+        } else {
+            bus_stats_.memory_fetches++;
+        }
+
+        MesiState state = MesiState::Modified;
+        if (is_write) {
+            bus_stats_.bus_read_exclusives++;
+            InvalidateOthers(hart, block);
+        } else {
+            bus_stats_.bus_reads++;
+            for (unsigned int other = 0; other < caches_.size(); ++other) {
+                Line *copy = (other == hart) ? nullptr : Find(other, block);
+                if (!copy) {
+                    continue;
+                }
+                if (copy->state == MesiState::Modified) {
+                    caches_[other].stats.writebacks++;
+                }
+                copy->state = MesiState::Shared;
+            }
+            state = held_elsewhere ? MesiState::Shared : MesiState::Exclusive;
+        }
+
+        Line &victim = Victim(hart, block);
+        if (victim.state != MesiState::Invalid) {
+            l1.stats.evictions++;
+            if (victim.state == MesiState::Modified) {
+                l1.stats.writebacks++;
+            }
+        }
+        victim.block = block;
+        victim.state = state;
+        victim.invalidated = false;
+        victim.last_use = clock_;
+    }
+
+    void MesiSystem::Reserve(unsigned int hart, uint64_t address) {
+        caches_[hart].reservation = address / config_.block_size;
+    }
+
+    bool MesiSystem::ConsumeReservation(unsigned int hart, uint64_t address) {
+        std::optional<uint64_t> &reservation = caches_[hart].reservation;
+        const bool held = reservation == address / config_.block_size;
+        reservation.reset();
+        return held;
+    }
+
+    MesiState MesiSystem::GetState(unsigned int hart, uint64_t address) const {
+        const Line *line = Find(hart, address / config_.block_size);
+        return line ? line->state : MesiState::Invalid;
+    }
+
+} // namespace cache
@@ -22,22 +22,18 @@ uint8_t Memory::Read(uint64_t address) {
   if (address >= memory_size_) {
     throw std::out_of_range("Memory address out of range: " + std::to_string(address));
   }
-  uint64_t block_index = GetBlockIndex(address);
-  uint64_t offset = GetBlockOffset(address);
-  if (!IsBlockPresent(block_index)) {
+  auto block = blocks_.find(GetBlockIndex(address));
+  if (block==blocks_.end()) {
     return 0;
   }
-  return blocks_[block_index].data[offset];
+  return block->second->data[GetBlockOffset(address)];
 }
 
 void Memory::Write(uint64_t address, uint8_t value) {
   if (address >= memory_size_) {
     throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
   }
-  uint64_t block_index = GetBlockIndex(address);
-  uint64_t offset = GetBlockOffset(address);
-  EnsureBlockExists(block_index);
-  blocks_[block_index].data[offset] = value;
+  EnsureBlockExists(GetBlockIndex(address)).data[GetBlockOffset(address)] = value;
 }
 
 uint64_t Memory::GetBlockIndex(uint64_t address) const {
@@ -52,10 +48,14 @@ bool Memory::IsBlockPresent(uint64_t block_index) const {
   return blocks_.find(block_index)!=blocks_.end();
 }
 
-void Memory::EnsureBlockExists(uint64_t block_index) {
-  if (blocks_.find(block_index)==blocks_.end()) {
-    blocks_.emplace(block_index, MemoryBlock());
+MemoryBlock &Memory::EnsureBlockExists(uint64_t block_index) {
+  std::shared_ptr<MemoryBlock> &block = blocks_[block_index];
+  if (!block) {
+    block = std::make_shared<MemoryBlock>(block_size_);
+  } else if (block.use_count() > 1) {
+    block = std::make_shared<MemoryBlock>(*block);
   }
+  return *block;
 }
 
 template<typename T>
@@ -178,6 +178,78 @@ void Memory::WriteDouble(uint64_t address, double value) {
   }
 }
 
+void Memory::LoadSegment(uint64_t address, const uint8_t *bytes, size_t size) {
+  if (size==0) {
+    return;
+  }
+  if (address >= memory_size_ || size > memory_size_ - address) {
+    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address + size - 1));
+  }
+  while (size > 0) {
+    uint64_t block_index = GetBlockIndex(address);
+    uint64_t offset = GetBlockOffset(address);
+    size_t chunk = std::min<size_t>(size, block_size_ - offset);
+
+    if (IsBlockPresent(block_index) || std::any_of(bytes, bytes + chunk, [](uint8_t byte) { return byte!=0; })) {
+      std::memcpy(EnsureBlockExists(block_index).data.data() + offset, bytes, chunk);
+    }
+
+    address += chunk;
+    bytes += chunk;
+    size -= chunk;
+  }
+}
+
+void Memory::ClearSegment(uint64_t address, uint64_t size) {
+  if (size==0) {
+    return;
+  }
+  if (address >= memory_size_ || size > memory_size_ - address) {
+    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address + size - 1));
+  }
+  while (size > 0) {
+    uint64_t block_index = GetBlockIndex(address);
+    uint64_t offset = GetBlockOffset(address);
+    uint64_t chunk = std::min<uint64_t>(size, block_size_ - offset);
+
+    if (chunk==block_size_) {
+      blocks_.erase(block_index);
+    } else if (IsBlockPresent(block_index)) {
+      std::memset(EnsureBlockExists(block_index).data.data() + offset, 0, chunk);
+    }
+
+    address += chunk;
+    size -= chunk;
+  }
+}
+
+void Memory::ReadSegment(uint64_t address, uint8_t *bytes, size_t size) const {
+  VisitSegment(address, size, [&bytes](const uint8_t *data, size_t chunk) {
+    std::memcpy(bytes, data, chunk);
+    bytes += chunk;
+  });
+}
+
+uint64_t Memory::StringLength(uint64_t address) const {
+  uint64_t length = 0;
+  while (true) {
+    if (address >= memory_size_) {
+      throw std::out_of_range("Memory address out of range: " + std::to_string(address));
+    }
+    size_t chunk = std::min<uint64_t>(block_size_ - GetBlockOffset(address), memory_size_ - address);
+    auto block = blocks_.find(GetBlockIndex(address));
+    if (block==blocks_.end()) {
+      return length; // an absent block reads as zeros
+    }
+    const uint8_t *start = block->second->data.data() + GetBlockOffset(address);
+    if (const void *nul = std::memchr(start, 0, chunk)) {
+      return length + (static_cast<const uint8_t *>(nul) - start);
+    }
+    length += chunk;
+    address += chunk;
+  }
+}
+
 void Memory::PrintMemory(const uint64_t address, unsigned int rows) {
   constexpr size_t bytes_per_row = 8; // One row equals 64 bytes
   std::cout << "Memory Dump at Address: 0x" << std::hex << address << std::dec << "\n";
@@ -274,7 +346,7 @@ void Memory::printMemoryUsage() const {
   std::cout << "---------------------\n";
   std::cout << "Block Count: " << blocks_.size() << "\n";
   for (const auto &[block_index, block] : blocks_) {
-    size_t used_bytes = std::count_if(block.data.begin(), block.data.end(),
+    size_t used_bytes = std::count_if(block->data.begin(), block->data.end(),
                                       [](uint8_t byte) { return byte!=0; });
     if (used_bytes > 0) {
       std::cout << "Block " << block_index << ": " << used_bytes
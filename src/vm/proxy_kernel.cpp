@@ -0,0 +1,530 @@
+/**
+ * @file proxy_kernel.cpp
+ * @brief Host side of the Linux syscalls a guest program makes: its files, heap and mappings
+ */
+#include "vm/proxy_kernel.h"
+#include "globals.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __has_include(<linux/openat2.h>)
+#include <linux/openat2.h>
+#endif
+
+namespace proxy_kernel {
+
+namespace {
+
+// open(2) flags as the Linux generic ABI, and so the guest, passes them
+constexpr uint64_t kGuestAccessMode = 03;
+constexpr uint64_t kGuestCreate = 0100;
+constexpr uint64_t kGuestExclusive = 0200;
+constexpr uint64_t kGuestTruncate = 01000;
+constexpr uint64_t kGuestAppend = 02000;
+constexpr uint64_t kGuestDirectory = 0200000;
+
+constexpr uint64_t kMapFixed = 0x10;
+constexpr uint64_t kMapAnonymous = 0x20;
+
+constexpr uint64_t kClockRealtime = 0;
+
+constexpr uint32_t kGuestCharDevice = 0020000;
+
+int HostOpenFlags(uint64_t flags) {
+    int host = O_CLOEXEC;
+    switch (flags & kGuestAccessMode) {
+        case 0: host |= O_RDONLY; break;
+        case 1: host |= O_WRONLY; break;
+        case 2: host |= O_RDWR; break;
+        default: return -1;
+    }
+    if (flags & kGuestCreate) host |= O_CREAT;
+    if (flags & kGuestExclusive) host |= O_EXCL;
+    if (flags & kGuestTruncate) host |= O_TRUNC;
+    if (flags & kGuestAppend) host |= O_APPEND;
+    if (flags & kGuestDirectory) host |= O_DIRECTORY;
+    return host;
+}
+
+#if defined(SYS_openat2) && defined(RESOLVE_BENEATH)
+// openat2(2) resolving path below the directory root, refusing symlinks and anything that
+// leads out of it; -1 with errno ENOSYS on kernels before 5.6
+int OpenBeneathKernel(int root, const std::string &path, int flags, mode_t mode) {
+    open_how how {};
+    how.flags = static_cast<uint64_t>(flags);
+    how.mode = (flags & O_CREAT) ? mode : 0;
+    how.resolve = RESOLVE_BENEATH | RESOLVE_NO_SYMLINKS | RESOLVE_NO_MAGICLINKS;
+    return static_cast<int>(::syscall(SYS_openat2, root, path.c_str(), &how, sizeof(how)));
+}
+#else
+int OpenBeneathKernel(int, const std::string &, int, mode_t) {
+    errno = ENOSYS;
+    return -1;
+}
+#endif
+
+// The same resolution done one component at a time, for kernels without openat2(2): every
+// directory on the way is opened with O_NOFOLLOW relative to the one before, so no symlink
+// is followed and ".." can only go back down the chain already walked
+int OpenBeneathWalk(int root, const std::string &path, int flags, mode_t mode) {
+    std::vector<std::string> components;
+    for (size_t begin = 0; begin <= path.size();) {
+        size_t end = std::min(path.find('/', begin), path.size());
+        std::string component = path.substr(begin, end - begin);
+        if (!component.empty() && component != ".") {
+            components.push_back(std::move(component));
+        }
+        begin = end + 1;
+    }
+    std::string last = ".";
+    if (!components.empty() && components.back() != "..") {
+        last = std::move(components.back());
+        components.pop_back();
+    }
+
+    std::vector<int> chain;
+    auto release = [&chain]() {
+        for (int fd : chain) {
+            ::close(fd);
+        }
+    };
+    for (const std::string &component : components) {
+        if (component == "..") {
+            if (chain.empty()) {
+                errno = EXDEV;
+                return -1;
+            }
+            ::close(chain.back());
+            chain.pop_back();
+            continue;
+        }
+        // With O_PATH a symlink is opened as itself, so what it is can be checked on the descriptor
+        int fd = ::openat(chain.empty() ? root : chain.back(), component.c_str(), O_PATH | O_NOFOLLOW | O_CLOEXEC);
+        struct stat status {};
+        int error = 0;
+        if (fd < 0 || ::fstat(fd, &status) < 0) {
+            error = errno;
+        } else if (S_ISLNK(status.st_mode)) {
+            error = ELOOP;
+        } else if (!S_ISDIR(status.st_mode)) {
+            error = ENOTDIR;
+        }
+        if (fd >= 0) {
+            chain.push_back(fd);
+        }
+        if (error) {
+            release();
+            errno = error;
+            return -1;
+        }
+    }
+    int fd = ::openat(chain.empty() ? root : chain.back(), last.c_str(), flags | O_NOFOLLOW, mode);
+    int error = errno;
+    release();
+    errno = error;
+    return fd;
+}
+
+// Opens path relative to the directory root without ever leaving it
+int OpenBeneath(int root, const std::string &path, int flags, mode_t mode) {
+    int fd = OpenBeneathKernel(root, path, flags, mode);
+    if (fd < 0 && errno == ENOSYS) {
+        fd = OpenBeneathWalk(root, path, flags, mode);
+    }
+    return fd;
+}
+
+template<size_t N>
+void Put(std::array<uint8_t, N> &out, size_t offset, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        out[offset + i] = static_cast<uint8_t>(value >> (8*i));
+    }
+}
+
+// struct stat of the riscv64 Linux ABI from the host's
+void FillStat(GuestStat &stat, const struct stat &host_stat) {
+    Put(stat, 0, host_stat.st_dev, 8);
+    Put(stat, 8, host_stat.st_ino, 8);
+    Put(stat, 16, host_stat.st_mode, 4);
+    Put(stat, 20, host_stat.st_nlink, 4);
+    Put(stat, 24, host_stat.st_uid, 4);
+    Put(stat, 28, host_stat.st_gid, 4);
+    Put(stat, 32, host_stat.st_rdev, 8);
+    Put(stat, 48, host_stat.st_size, 8);
+    Put(stat, 56, host_stat.st_blksize, 4);
+    Put(stat, 64, host_stat.st_blocks, 8);
+    Put(stat, 72, host_stat.st_atim.tv_sec, 8);
+    Put(stat, 80, host_stat.st_atim.tv_nsec, 8);
+    Put(stat, 88, host_stat.st_mtim.tv_sec, 8);
+    Put(stat, 96, host_stat.st_mtim.tv_nsec, 8);
+    Put(stat, 104, host_stat.st_ctim.tv_sec, 8);
+    Put(stat, 112, host_stat.st_ctim.tv_nsec, 8);
+}
+
+} // namespace
+
+HostFile::~HostFile() {
+    ::close(fd_);
+}
+
+ProxyKernel::~ProxyKernel() {
+    CloseAll();
+}
+
+ProxyKernel::State ProxyKernel::SaveState() const {
+    return {files_, break_start_, break_, mappings_, mmap_bottom_};
+}
+
+void ProxyKernel::RestoreState(const State &state) {
+    files_ = state.files;
+    break_start_ = state.break_start;
+    break_ = state.program_break;
+    mappings_ = state.mappings;
+    mmap_bottom_ = state.mmap_bottom;
+}
+
+void ProxyKernel::TruncateReplies() {
+    replies_.resize(reply_position_);
+}
+
+void ProxyKernel::ClearReplies() {
+    replies_.clear();
+    reply_position_ = 0;
+}
+
+template<typename Ask>
+const HostReply &ProxyKernel::Reply(Ask ask) {
+    if (reply_position_ == replies_.size()) {
+        HostReply reply;
+        ask(reply);
+        replies_.push_back(std::move(reply));
+    }
+    return replies_[reply_position_++];
+}
+
+void ProxyKernel::CloseSandbox() {
+    if (sandbox_root_ >= 0) {
+        ::close(sandbox_root_);
+    }
+    sandbox_root_ = -1;
+    sandbox_path_.clear();
+}
+
+int ProxyKernel::SandboxRoot(const std::filesystem::path &sandbox) {
+    if (sandbox_root_ >= 0 && sandbox_path_ == sandbox) {
+        return sandbox_root_;
+    }
+    CloseSandbox();
+    const std::filesystem::path root = globals::invokation_path / sandbox;
+    sandbox_root_ = ::open(root.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (sandbox_root_ >= 0) {
+        sandbox_path_ = sandbox;
+    }
+    return sandbox_root_;
+}
+
+void ProxyKernel::CloseAll() {
+    // Host descriptors a snapshot or a recorded reply still holds stay open until it goes
+    files_.clear();
+    CloseSandbox();
+}
+
+void ProxyKernel::Reset(uint64_t program_break) {
+    CloseAll();
+    break_start_ = RoundUpToPage(program_break);
+    break_ = break_start_;
+    mappings_.clear();
+    mmap_bottom_ = kMmapTop;
+}
+
+GuestFile *ProxyKernel::FindFile(int64_t fd) {
+    auto file = files_.find(fd);
+    return file == files_.end() ? nullptr : &file->second;
+}
+
+int64_t ProxyKernel::OpenAt(const std::filesystem::path &sandbox, int64_t dirfd, const std::string &path,
+                            uint64_t flags, uint64_t mode) {
+    if (sandbox.empty()) {
+        return -EACCES;
+    }
+    if (path.empty()) {
+        return -ENOENT;
+    }
+    // Paths are relative to the guest's root, which is also its working directory
+    if (dirfd != kAtFdcwd && path.front() != '/') {
+        return -EBADF;
+    }
+    const int host_flags = HostOpenFlags(flags);
+    if (host_flags < 0) {
+        return -EINVAL;
+    }
+
+    const HostReply &reply = Reply([&](HostReply &reply) {
+        int root = SandboxRoot(sandbox);
+        if (root < 0) {
+            reply.result = -ENOENT;
+            return;
+        }
+        // The guest's root is the sandbox, so an absolute path is one relative to it
+        const size_t first = path.find_first_not_of('/');
+        const std::string relative = first == std::string::npos ? "." : path.substr(first);
+        int host = OpenBeneath(root, relative, host_flags, static_cast<mode_t>(mode & 07777));
+        if (host < 0) {
+            // EXDEV: the path leads out of the sandbox; ELOOP: it goes through a symlink
+            reply.result = (errno == EXDEV || errno == ELOOP) ? -EACCES : -errno;
+            return;
+        }
+        reply.file = std::make_shared<const HostFile>(host);
+    });
+    if (!reply.file) {
+        return reply.result;
+    }
+    int64_t fd = 3;
+    while (files_.count(fd)) {
+        ++fd;
+    }
+    files_[fd] = {reply.file, 0, (flags & kGuestAppend) != 0};
+    return fd;
+}
+
+int64_t ProxyKernel::Close(int64_t fd) {
+    // The host descriptor itself is closed once nothing holds it any more
+    return files_.erase(fd) ? 0 : -EBADF;
+}
+
+int64_t ProxyKernel::Read(int64_t fd, uint8_t *buffer, uint64_t length) {
+    GuestFile *file = FindFile(fd);
+    if (!file) {
+        return -EBADF;
+    }
+    const HostReply &reply = Reply([&](HostReply &reply) {
+        reply.bytes.resize(length);
+        ssize_t result = ::pread(file->host->Descriptor(), reply.bytes.data(), length, file->offset);
+        reply.result = result < 0 ? -errno : result;
+        reply.bytes.resize(result < 0 ? 0 : result);
+    });
+    std::copy(reply.bytes.begin(), reply.bytes.end(), buffer);
+    if (reply.result > 0) {
+        file->offset += reply.result;
+    }
+    return reply.result;
+}
+
+int64_t ProxyKernel::Write(int64_t fd, const MemoryController &memory, uint64_t address, uint64_t length) {
+    GuestFile *file = FindFile(fd);
+    if (!file) {
+        return -EBADF;
+    }
+    std::vector<iovec> spans;
+    try {
+        memory.VisitSegment_d(address, length, [&spans](const uint8_t *data, size_t size) {
+            spans.push_back({const_cast<uint8_t *>(data), size});
+        });
+    } catch (const std::out_of_range &) {
+        return -EFAULT;
+    }
+
+    const HostReply &reply = Reply([&](HostReply &reply) {
+        const int host = file->host->Descriptor();
+        int64_t written = 0;
+        for (size_t first = 0; first < spans.size(); first += IOV_MAX) {
+            const int count = static_cast<int>(std::min<size_t>(IOV_MAX, spans.size() - first));
+            size_t wanted = 0;
+            for (int i = 0; i < count; ++i) {
+                wanted += spans[first + i].iov_len;
+            }
+            // An appending write goes wherever the host finds the end of the file
+            ssize_t result = file->append ? ::writev(host, spans.data() + first, count)
+                                          : ::pwritev(host, spans.data() + first, count, file->offset + written);
+            if (result < 0) {
+                reply.result = written > 0 ? written : -errno;
+                break;
+            }
+            written += result;
+            reply.result = written;
+            if (static_cast<size_t>(result) < wanted) {
+                break;
+            }
+        }
+        if (file->append) {
+            reply.offset = ::lseek(host, 0, SEEK_CUR);
+        }
+    });
+    if (reply.result > 0) {
+        file->offset = file->append ? reply.offset : file->offset + reply.result;
+    }
+    return reply.result;
+}
+
+int64_t ProxyKernel::Seek(int64_t fd, int64_t offset, uint64_t whence) {
+    GuestFile *file = FindFile(fd);
+    if (!file) {
+        return -EBADF;
+    }
+    int64_t base = 0;
+    if (whence == SEEK_CUR) {
+        base = file->offset;
+    } else if (whence == SEEK_END) {
+        base = Reply([&](HostReply &reply) {
+            struct stat host_stat {};
+            reply.result = ::fstat(file->host->Descriptor(), &host_stat) < 0 ? -errno : host_stat.st_size;
+        }).result;
+        if (base < 0) {
+            return base;
+        }
+    } else if (whence != SEEK_SET) {
+        return -EINVAL;
+    }
+    if (offset > 0 && base > INT64_MAX - offset) {
+        return -EOVERFLOW;
+    }
+    if (base + offset < 0) {
+        return -EINVAL;
+    }
+    file->offset = base + offset;
+    return file->offset;
+}
+
+int64_t ProxyKernel::Stat(int64_t fd, GuestStat &stat) {
+    stat.fill(0);
+    if (fd >= 0 && fd <= 2) {
+        // The VM's console
+        Put(stat, 16, kGuestCharDevice | 0620, 4); // st_mode
+        Put(stat, 20, 1, 4);                       // st_nlink
+        Put(stat, 56, 1024, 4);                    // st_blksize
+        return 0;
+    }
+    GuestFile *file = FindFile(fd);
+    if (!file) {
+        return -EBADF;
+    }
+    const HostReply &reply = Reply([&](HostReply &reply) {
+        struct stat host_stat {};
+        if (::fstat(file->host->Descriptor(), &host_stat) < 0) {
+            reply.result = -errno;
+            return;
+        }
+        GuestStat guest {};
+        FillStat(guest, host_stat);
+        reply.bytes.assign(guest.begin(), guest.end());
+    });
+    std::copy(reply.bytes.begin(), reply.bytes.end(), stat.begin());
+    return reply.result;
+}
+
+uint64_t ProxyKernel::Brk(uint64_t address) {
+    if (address >= break_start_ && address <= mmap_bottom_) {
+        break_ = address;
+    }
+    return break_;
+}
+
+void ProxyKernel::Unmap(uint64_t start, uint64_t end) {
+    // The first mapping that could overlap is the last one starting before start
+    auto mapping = mappings_.upper_bound(start);
+    if (mapping != mappings_.begin()) {
+        --mapping;
+    }
+    while (mapping != mappings_.end() && mapping->first < end) {
+        const uint64_t first = mapping->first;
+        const uint64_t last = mapping->second;
+        if (last <= start) {
+            ++mapping;
+            continue;
+        }
+        mapping = mappings_.erase(mapping);
+        if (first < start) {
+            mappings_[first] = start;
+        }
+        if (last > end) {
+            mappings_[end] = last;
+        }
+    }
+    mmap_bottom_ = mappings_.empty() ? kMmapTop : mappings_.begin()->first;
+}
+
+int64_t ProxyKernel::Mmap(uint64_t address, uint64_t length, uint64_t, uint64_t flags, int64_t, uint64_t) {
+    if (!(flags & kMapAnonymous)) {
+        return -ENODEV;
+    }
+    if (length == 0) {
+        return -EINVAL;
+    }
+    const uint64_t size = RoundUpToPage(length);
+    if (size < length) {
+        return -ENOMEM;
+    }
+
+    uint64_t start = 0;
+    if (flags & kMapFixed) {
+        // Replaces earlier mappings it overlaps, but never the program, its heap or the stack
+        if (address % kPageSize != 0 || address < break_ || address > kMmapTop || size > kMmapTop - address) {
+            return -EINVAL;
+        }
+        start = address;
+        Unmap(start, start + size);
+    } else {
+        // The highest gap that fits, between the mappings or between them and the break
+        uint64_t end = kMmapTop;
+        bool found = false;
+        for (auto mapping = mappings_.rbegin(); mapping != mappings_.rend() && !found; ++mapping) {
+            found = end - mapping->second >= size;
+            if (!found) {
+                end = mapping->first;
+            }
+        }
+        if (!found && end - break_ < size) {
+            return -ENOMEM;
+        }
+        start = end - size;
+    }
+    mappings_[start] = start + size;
+    mmap_bottom_ = std::min(mmap_bottom_, start);
+    return static_cast<int64_t>(start);
+}
+
+int64_t ProxyKernel::Munmap(uint64_t address, uint64_t length) {
+    if (address % kPageSize != 0 || length == 0) {
+        return -EINVAL;
+    }
+    const uint64_t size = RoundUpToPage(length);
+    if (size < length || size > UINT64_MAX - address) {
+        return -EINVAL;
+    }
+    Unmap(address, address + size);
+    return 0;
+}
+
+int64_t ProxyKernel::ClockGettime(uint64_t clock_id, GuestTimespec &time) {
+    if (clock_id > 7) {
+        return -EINVAL;
+    }
+    const HostReply &reply = Reply([&](HostReply &reply) {
+        std::chrono::nanoseconds now;
+        if (clock_id == kClockRealtime) {
+            now = std::chrono::system_clock::now().time_since_epoch();
+        } else {
+            // Monotonic, CPU time and boot time clocks all come from the host's monotonic clock
+            now = std::chrono::steady_clock::now().time_since_epoch();
+        }
+        GuestTimespec guest {};
+        Put(guest, 0, static_cast<uint64_t>(now.count() / 1000000000), 8);
+        Put(guest, 8, static_cast<uint64_t>(now.count() % 1000000000), 8);
+        reply.bytes.assign(guest.begin(), guest.end());
+    });
+    std::copy(reply.bytes.begin(), reply.bytes.end(), time.begin());
+    return reply.result;
+}
+
+} // namespace proxy_kernel
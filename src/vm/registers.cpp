@@ -5,9 +5,10 @@
  */
 
 #include "vm/registers.h"
+#include "common/static_string_table.h"
 
 #include <stdexcept>
-#include <unordered_set>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <array>
@@ -76,25 +77,34 @@ void RegisterFile::ModifyRegister(const std::string &reg_name, uint64_t value) {
 
 
 
-const std::unordered_set<std::string> valid_general_purpose_registers = {
+namespace {
+
+enum class RegisterClass : uint8_t {
+  kGeneralPurpose,
+  kFloatingPoint,
+  kCsr,
+};
+
+struct RegisterName {
+  std::string_view name;
+  RegisterClass register_class;
+};
+
+constexpr std::array<std::string_view, 64> kGeneralPurposeRegisterNames = {
     "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9",
     "x10", "x11", "x12", "x13", "x14", "x15", "x16", "x17", "x18", "x19",
     "x20", "x21", "x22", "x23", "x24", "x25", "x26", "x27", "x28", "x29",
-    "x30", "x31",
-
-    "zero",
-    "ra", "sp", "gp", "tp", "t0", "t1", "t2", "s0", "s1",
-    "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", "s2",
-    "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11",
+    "x30", "x31", "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7",
+    "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11",
     "t3", "t4", "t5", "t6",
 };
 
-const std::unordered_set<std::string> valid_floating_point_registers = {
-    "f0", "f1", "f2", "f3", "f4", "f5", "f6", "f7", "f8", "f9",
-    "f10", "f11", "f12", "f13", "f14", "f15", "f16", "f17", "f18", "f19",
-    "f20", "f21", "f22", "f23", "f24", "f25", "f26", "f27", "f28", "f29",
-    "f30", "f31",
-
+constexpr std::array<std::string_view, 84> kFloatingPointRegisterNames = {
+    "f0", "f1", "f2", "f3", "f4", "f5", "f6", "f7",
+    "f8", "f9", "f10", "f11", "f12", "f13", "f14", "f15",
+    "f16", "f17", "f18", "f19", "f20", "f21", "f22", "f23",
+    "f24", "f25", "f26", "f27", "f28", "f29", "f30", "f31",
     "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
     "fs0", "fs1", "fa0", "fa1", "fa2", "fa3", "fa4", "fa5",
     "fa6", "fa7", "fs2", "fs3", "fs4", "fs5", "fs6", "fs7",
@@ -104,14 +114,41 @@ const std::unordered_set<std::string> valid_floating_point_registers = {
     "ft28", "ft29", "ft30", "ft31",
 };
 
-const std::unordered_set<std::string> valid_csr_registers = {
-    "fflags", "frm", "fcsr"
+constexpr std::array<std::string_view, 4> kCsrNames = {
+    "fflags", "frm", "fcsr", "mhartid",
 };
 
+constexpr std::array<RegisterName, 152> kRegisterNames = [] {
+  std::array<RegisterName, 152> names{};
+  size_t i = 0;
+  for (std::string_view name : kGeneralPurposeRegisterNames) {
+    names[i++] = {name, RegisterClass::kGeneralPurpose};
+  }
+  for (std::string_view name : kFloatingPointRegisterNames) {
+    names[i++] = {name, RegisterClass::kFloatingPoint};
+  }
+  for (std::string_view name : kCsrNames) {
+    names[i++] = {name, RegisterClass::kCsr};
+  }
+  return names;
+}();
+
+constexpr StaticStringTable<RegisterName, kRegisterNames.size(), 1024> kRegisterTable(kRegisterNames);
+static_assert(!kRegisterTable.hasDuplicates(), "Duplicate register name");
+static_assert(kRegisterTable.maxProbeLength() <= 3, "Register table needs more slots or a different hash");
+
+bool HasRegisterClass(std::string_view reg, RegisterClass register_class) {
+  const RegisterName *entry = kRegisterTable.find(reg);
+  return entry && entry->register_class==register_class;
+}
+
+} // namespace
+
 const std::unordered_map<std::string, int> csr_to_address{
     {"fflags", 0x001},
     {"frm", 0x002},
     {"fcsr", 0x003},
+    {"mhartid", 0xF14},
 };
 
 const std::unordered_map<std::string, std::string> reg_alias_to_name = {
@@ -254,14 +291,14 @@ const std::unordered_map<std::string, std::string> reg_alias_to_name = {
 
 };
 
-bool IsValidGeneralPurposeRegister(const std::string &reg) {
-  return valid_general_purpose_registers.find(reg)!=valid_general_purpose_registers.end();
+bool IsValidGeneralPurposeRegister(std::string_view reg) {
+  return HasRegisterClass(reg, RegisterClass::kGeneralPurpose);
 }
 
-bool IsValidFloatingPointRegister(const std::string &reg) {
-  return valid_floating_point_registers.find(reg)!=valid_floating_point_registers.end();
+bool IsValidFloatingPointRegister(std::string_view reg) {
+  return HasRegisterClass(reg, RegisterClass::kFloatingPoint);
 }
 
-bool IsValidCsr(const std::string &reg) {
-  return valid_csr_registers.find(reg)!=valid_csr_registers.end();
-}
\ No newline at end of file
+bool IsValidCsr(std::string_view reg) {
+  return HasRegisterClass(reg, RegisterClass::kCsr);
+}
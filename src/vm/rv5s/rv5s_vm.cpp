@@ -20,7 +20,7 @@
 
 
 // initializes the 5-stage virtual machine
-RV5SVM::RV5SVM() : VmBase() {
+RV5SVM::RV5SVM(vm_config::ConfigSnapshot config) : VmBase(std::move(config)) {
 
     Reset();
     try {
@@ -44,6 +44,7 @@ RV5SVM::~RV5SVM() = default;
 // It sets all counters(program counters and cycle_s_ to 0)
 // creates new empty pipeline registers and clears the undo/redo stack
 void RV5SVM::Reset() {
+    ApplyPendingConfig();
 
     program_counter_ = 0;
     instructions_retired_ = 0;
@@ -53,34 +54,7 @@ void RV5SVM::Reset() {
     registers_.Reset();
     memory_controller_.Reset();
 
-    // Build Cache Config from vm_config
-    cache::CacheConfig cache_config;
-
-    cache_config.cache_enabled = vm_config::config.getCacheEnabled();
-    cache_config.lines = vm_config::config.getNumberOfLines();
-    cache_config.block_size = vm_config::config.getCacheBlockSize();
-    cache_config.associativity = vm_config::config.getCacheAssociativity();
-
-    std::string rep_str = vm_config::config.getCacheReplacementPolicy();
-    if (rep_str == "LRU") {
-        cache_config.replacement_policy = cache::ReplacementPolicy::LRU;
-    } else if (rep_str == "FIFO") {
-        cache_config.replacement_policy = cache::ReplacementPolicy::FIFO;
-    } else if (rep_str == "Random") {
-        cache_config.replacement_policy = cache::ReplacementPolicy::Random;
-    } else {
-        // Default fallback
-        cache_config.replacement_policy = cache::ReplacementPolicy::LRU;
-    }
-
-    std::string miss_str = vm_config::config.getCacheWriteMissPolicy();
-    if (miss_str == "write_allocate") {
-        cache_config.write_miss_policy = cache::WriteMissPolicy::WriteAllocate;
-    } else {
-        cache_config.write_miss_policy = cache::WriteMissPolicy::NoWriteAllocate;
-    }
-
-    memory_controller_.Init(cache_config);
+    memory_controller_.Init(CacheConfigFromVmConfig(GetConfig()));
     
     if_id_reg_ = IF_ID_Register();
     id_ex_reg_ = ID_EX_Register();
@@ -95,8 +69,10 @@ void RV5SVM::Reset() {
         redo_stack_.pop();
     }
 
-    // Reset Branch Prediction Table
-    branch_history_table_.clear();
+    // Rebuild the Branch Predictor, BTB and RAS from vm_config
+    ResetBranchPredictors();
+    pending_predictor_update_ = branch_predictor::ResolveRecord();
+    pending_target_update_ = branch_predictor::TargetUpdateRecord();
 
     // Reset Forwarding Signals
     forward_a_ = ForwardSource::kNone;
@@ -108,6 +84,7 @@ void RV5SVM::Reset() {
     last_retired_sequence_id_ = 0;
 
     control_unit_.Reset();
+    ClearHistory();
 
     DumpState(globals::vm_state_dump_file_path);
     DumpCacheState(globals::cache_dump_file_path);
@@ -125,7 +102,9 @@ void RV5SVM::Reset() {
 //In C++ only one line runs at a time
 //If you run it in the right order , everything will happen one after the other like in a single cycle
 // but here since you're  updating the main register in the end everything is updated simultaneously.
-void RV5SVM::PipelinedStep() {
+void RV5SVM::PipelinedStep(bool record_undo) {
+
+    CheckpointIfDue();
 
     //to snapshot the current stage 
     // this is pushed to the undo/redo stack
@@ -177,7 +156,7 @@ void RV5SVM::PipelinedStep() {
     bool ID_flushSignal = id_ex_reg_.isMisPredicted;
     uint64_t ID_newPCTarget = id_ex_reg_.actualTargetPC;
 
-    bool isHazardDetectionEnabled = vm_config::config.isHazardDetectionEnabled();
+    bool isHazardDetectionEnabled = GetConfig().isHazardDetectionEnabled();
 
     //Run the Execute Stage
     EX_MEM_Register next_ex_mem_reg;
@@ -226,7 +205,11 @@ void RV5SVM::PipelinedStep() {
     
     // Save all the calculated values into the pipeline registers
     delta.wb_write = WBInfo;
-    delta.mem_write = mem_info;    
+    delta.mem_write = mem_info;
+    delta.predictor_update = std::move(pending_predictor_update_);
+    pending_predictor_update_ = branch_predictor::ResolveRecord();
+    delta.target_update = pending_target_update_;
+    pending_target_update_ = branch_predictor::TargetUpdateRecord();
     if_id_reg_ = next_if_id_reg;
     id_ex_reg_ = next_id_ex_reg;
     ex_mem_reg_ = next_ex_mem_reg;
@@ -267,6 +250,9 @@ void RV5SVM::PipelinedStep() {
     delta.new_num_branches = num_branches_;
     delta.new_branch_mispredictions = branch_mispredictions_;
     
+    if (!record_undo) {
+        return;
+    }
     // Push the new cycle's delta onto the undo stack.
     undo_stack_.push(delta);
     // By executing a new step (PipelinedStep), we are creating a new,
@@ -278,6 +264,15 @@ void RV5SVM::PipelinedStep() {
     
 }
 
+void RV5SVM::ReplayStep() {
+    PipelinedStep(false);
+}
+
+void RV5SVM::DumpCoreState() {
+    DumpCacheState(globals::cache_dump_file_path);
+    DumpPipelineRegisters(globals::pipeline_registers_dump_file_path);
+}
+
 IF_ID_Register RV5SVM::pipelineFetch() {
     
     IF_ID_Register result;
@@ -310,9 +305,10 @@ IF_ID_Register RV5SVM::pipelineFetch() {
     // Branch Prediction Logic
     bool predictedTaken = false;
     uint64_t predictedTarget = 0;
+    branch_predictor::TargetSource targetSource = branch_predictor::TargetSource::None;
 
     // Get the branch prediction type from config
-    vm_config::BranchPredictionType bp_type = vm_config::config.getBranchPredictionType();
+    vm_config::BranchPredictionType bp_type = GetConfig().getBranchPredictionType();
 
     if (bp_type != vm_config::BranchPredictionType::NONE) {
 
@@ -330,7 +326,12 @@ IF_ID_Register RV5SVM::pipelineFetch() {
                 int32_t imm = ImmGenerator(result.instruction);
                 predictedTarget = program_counter_ + imm;
             } else {
-                predictedTaken = false; // For JALR, we cannot predict the target
+                // For JALR, the target comes from the return address stack or the BTB
+                uint8_t rd = (result.instruction >> 7) & 0b11111;
+                uint8_t rs1 = (result.instruction >> 15) & 0b11111;
+                bool isReturn = branch_predictor::IsReturn(true, rd, rs1);
+                targetSource = target_predictor_.Predict(program_counter_, isReturn, predictedTarget);
+                predictedTaken = (targetSource != branch_predictor::TargetSource::None);
             }
 
         } else if (isBranch) {
@@ -346,21 +347,16 @@ IF_ID_Register RV5SVM::pipelineFetch() {
                     predictedTaken = false;
                 }
 
-            } else if (bp_type == vm_config::BranchPredictionType::DYNAMIC1BIT) {
+            } else {
 
-                if (branch_history_table_.count(program_counter_) && branch_history_table_[program_counter_] == true) {
-                    // Predict taken
-                    predictedTaken = true;
+                // Dynamic Prediction: ask the configured predictor in the branch predictor unit
+                branch_predictor::PredictorKind kind;
+                if (GetSteeringPredictor(kind)) {
                     int32_t imm = ImmGenerator(result.instruction);
-                    predictedTarget = program_counter_ + static_cast<int64_t>(imm);
-                } else {
-                    // Follow Static Prediction: Backward branches taken, forward branches not taken
-                    int32_t imm = ImmGenerator(result.instruction);
-                    if (static_cast<int64_t>(imm) < 0) {
+                    uint64_t target = program_counter_ + static_cast<int64_t>(imm);
+                    if (branch_predictor_.Predict(kind, program_counter_, target)) {
                         predictedTaken = true;
-                        predictedTarget = program_counter_ + static_cast<int64_t>(imm);
-                    } else {
-                        predictedTaken = false;
+                        predictedTarget = target;
                     }
                 }
 
@@ -379,6 +375,8 @@ IF_ID_Register RV5SVM::pipelineFetch() {
 
     // Store prediction info in IF/ID register for use in Decode stage
     result.predictedTaken = predictedTaken;
+    result.predictedTarget = predictedTaken ? predictedTarget : 0;
+    result.targetSource = targetSource;
 
     result.sequence_id = ++instruction_sequence_counter_;
 
@@ -410,10 +408,11 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
 
     bool usesRS1 = (opcode != 0b0110111) && (opcode != 0b0010111) && (opcode != 0b1101111); 
     bool usesRS2 = (opcode == 0b0100011) || (opcode == 0b0110011) || (opcode == 0b1100011) 
-                   || (opcode == 0b0100111) || (opcode == 0b1010011); // Added Store-FP & Op-FP
+                   || (opcode == 0b0100111) || (opcode == 0b1010011) // Added Store-FP & Op-FP
+                   || (opcode == 0b0101111); // SC and AMOs
 
     // --- 2. Hazard Detection ---
-    if(vm_config::config.isHazardDetectionEnabled() && (vm_config::config.branch_prediction_type == vm_config::BranchPredictionType::NONE || (opcode != 0b1101111 && opcode != 0b1100111 && opcode != 0b1100011))) {
+    if(GetConfig().isHazardDetectionEnabled() && (GetConfig().branch_prediction_type == vm_config::BranchPredictionType::NONE || (opcode != 0b1101111 && opcode != 0b1100111 && opcode != 0b1100011))) {
         
         // Generic Hazard Check (Works for both Int and Float because we check Register Index AND Type)
         // Check ID/EX (1 cycle ahead)
@@ -427,7 +426,7 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
                 return ID_EX_Register(); // Stall for Load-Use
             }
 
-            if (!vm_config::config.isForwardingEnabled()) {
+            if (!GetConfig().isForwardingEnabled()) {
                 if (id_ex_reg_.RegWrite && (hazard1 || hazard2)) {
                     id_stall_ = true;
                     stall_cycles_++;
@@ -437,7 +436,7 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
         }
         
         // Check EX/MEM (2 cycles ahead) - Only needed if forwarding is disabled
-        if (!vm_config::config.isForwardingEnabled() && ex_mem_reg_.valid && ex_mem_reg_.RegWrite && ex_mem_reg_.rd != 0) {
+        if (!GetConfig().isForwardingEnabled() && ex_mem_reg_.valid && ex_mem_reg_.RegWrite && ex_mem_reg_.rd != 0) {
             bool hazard1 = usesRS1 && (ex_mem_reg_.rd == rs1) && (ex_mem_reg_.RdIsFPR == Rs1IsFPR);
             bool hazard2 = usesRS2 && (ex_mem_reg_.rd == rs2) && (ex_mem_reg_.RdIsFPR == Rs2IsFPR);
             if (hazard1 || hazard2) {
@@ -453,7 +452,7 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
     forward_b_ = ForwardSource::kNone;
 
     // --- 3. Forwarding Logic [UPDATED] ---
-    if(vm_config::config.isForwardingEnabled()) {
+    if(GetConfig().isForwardingEnabled()) {
         // EX/MEM Hazard (2 cycles ago)
         if (ex_mem_reg_.valid && ex_mem_reg_.RegWrite && ex_mem_reg_.rd != 0) {
             // Forward only if types match (Int->Int or Float->Float)
@@ -521,14 +520,14 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
     forward_branch_b_ = ForwardSource::kNone;
 
     // Branch Prediction Handling
-    if (vm_config::config.getBranchPredictionType() != vm_config::BranchPredictionType::NONE) {
+    if (GetConfig().getBranchPredictionType() != vm_config::BranchPredictionType::NONE) {
         
         uint64_t reg1_value = result.reg1_value;
         uint64_t reg2_value = result.reg2_value;
 
         if (result.isBranch || result.isJump) {
 
-            if (vm_config::config.isHazardDetectionEnabled()) {
+            if (GetConfig().isHazardDetectionEnabled()) {
 
                 bool hazardFromEX = false;
                 // Check for hazards from EX stage
@@ -559,7 +558,7 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
                     return ID_EX_Register(); // Return bubble
                 }
 
-                if (!vm_config::config.isForwardingEnabled()) {
+                if (!GetConfig().isForwardingEnabled()) {
 
                     bool ALUHazardFromMem = false;
                     if (ex_mem_reg_.valid && ex_mem_reg_.RegWrite && !ex_mem_reg_.MemRead && ex_mem_reg_.rd != 0) {
@@ -579,7 +578,7 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
 
             }
 
-            if (vm_config::config.isForwardingEnabled()) {
+            if (GetConfig().isForwardingEnabled()) {
 
                 // Forwarded values for branch resolution
                 if (ex_mem_reg_.valid && ex_mem_reg_.RegWrite && !ex_mem_reg_.MemRead && ex_mem_reg_.rd != 0) {
@@ -666,19 +665,26 @@ ID_EX_Register RV5SVM::pipelineDecode(const IF_ID_Register& if_id_reg) {
         }
 
         bool predictedTaken = if_id_reg.predictedTaken;
+        bool wrongTarget = actualTaken && predictedTaken && (actualTargetPC != if_id_reg.predictedTarget);
 
-        if (actualTaken != predictedTaken) {
+        if (actualTaken != predictedTaken || wrongTarget) {
             // Misprediction
             result.isMisPredicted = true;
             result.actualTargetPC = actualTargetPC;
             branch_mispredictions_++;
         }
 
-        if (vm_config::config.getBranchPredictionType() == vm_config::BranchPredictionType::DYNAMIC1BIT) {
-            // Update the Branch History Table
-            if (result.isBranch) {
-                branch_history_table_[result.currentPC] = actualTaken;
-            }
+        // Train every predictor on the resolved direction (shadow predictors included)
+        // GetBranch() is also set for JAL/JALR, so check the opcode for conditional branches
+        if (opcode == 0b1100011) {
+            uint64_t takenTargetPC = result.currentPC + static_cast<int64_t>(result.immediate);
+            pending_predictor_update_ = branch_predictor_.Resolve(result.currentPC, takenTargetPC, actualTaken);
+        }
+
+        // Train the BTB/RAS; a correctly predicted jump target saves the one-cycle ID flush
+        if (result.isJump) {
+            pending_target_update_ = target_predictor_.Resolve(result.currentPC, actualTargetPC, !result.isJAL, rd, rs1,
+                                                               if_id_reg.targetSource, if_id_reg.predictedTarget, 1);
         }
 
     }
@@ -820,7 +826,7 @@ EX_MEM_Register RV5SVM::pipelineExecute(const ID_EX_Register& id_ex_reg) {
 
     // Branch Handling
 
-    if (vm_config::config.getBranchPredictionType() == vm_config::BranchPredictionType::NONE) {
+    if (GetConfig().getBranchPredictionType() == vm_config::BranchPredictionType::NONE) {
 
         if (id_ex_reg.isJump) {
 
@@ -905,6 +911,23 @@ std::pair<MEM_WB_Register, MemWriteInfo> RV5SVM::pipelineMemory(const EX_MEM_Reg
 
     uint64_t memoryAddress = ex_mem_reg.alu_result;
 
+    // --- ATOMICS: read, modify and write in this one stage ---
+    if ((ex_mem_reg.instruction & 0b1111111) == 0b0101111) {
+        size_t size = (ex_mem_reg.funct3 == 0b010) ? 4 : 8;
+        writeInfo.old_bytes.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            writeInfo.old_bytes[i] = memory_controller_.ReadByte_d(memoryAddress + i);
+        }
+        result.data_from_memory = ExecuteAtomic(ex_mem_reg.instruction, memoryAddress, ex_mem_reg.reg2_value);
+        writeInfo.new_bytes.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            writeInfo.new_bytes[i] = memory_controller_.ReadByte_d(memoryAddress + i);
+        }
+        writeInfo.occurred = true;
+        writeInfo.address = memoryAddress;
+        return {result, writeInfo};
+    }
+
     // --- READ LOGIC ---
     if (ex_mem_reg.MemRead) {
         try {
@@ -1062,9 +1085,16 @@ WbWriteInfo RV5SVM::pipelineWriteBack(const MEM_WB_Register& mem_wb_reg) {
 void RV5SVM::Run() {
 
     ClearStop();
+    ApplyPendingConfig();
+
+    // A full run is not recorded cycle by cycle, so memory stays flat however long it is;
+    // reverse_step goes back through the checkpoints instead. Older undo records no longer
+    // lead to the current state.
+    undo_stack_ = std::stack<CycleDelta>();
+    redo_stack_ = std::stack<CycleDelta>();
     
-    while(!stop_requested_ && (program_counter_ < program_size_ || if_id_reg_.valid || id_ex_reg_.valid || ex_mem_reg_.valid || mem_wb_reg_.valid)) {
-        PipelinedStep();
+    while(!stop_requested_ && !IsDrained()) {
+        PipelinedStep(false);
         std::cout << "Program Counter: " << program_counter_ << std::endl;
     }
 
@@ -1082,6 +1112,20 @@ void RV5SVM::Run() {
     std::cout << "Number of Forwarding Events: " << forwarding_events_ << std::endl;
     std::cout << "Branch Mispredictions: " << branch_mispredictions_ << std::endl;
     std::cout << "Branch Misprediction Rate: " << ((num_branches_ > 0) ? ((static_cast<double>(branch_mispredictions_) / static_cast<double>(num_branches_)) * 100.0) : 0.0) << "%" << std::endl;
+    for (const auto &predictor : branch_predictor_.GetPredictors()) {
+        const branch_predictor::PredictorStats &stats = predictor->GetStats();
+        std::cout << "Predictor Accuracy [" << predictor->GetName() << "]: "
+                  << ((stats.predictions > 0) ? ((static_cast<double>(stats.correct) / static_cast<double>(stats.predictions)) * 100.0) : 0.0)
+                  << "% (" << stats.correct << "/" << stats.predictions << ")" << std::endl;
+    }
+    const branch_predictor::TargetPredictorStats &target_stats = target_predictor_.GetStats();
+    std::cout << "BTB Hit Rate: "
+              << ((target_stats.btb_lookups > 0) ? ((static_cast<double>(target_stats.btb_hits) / static_cast<double>(target_stats.btb_lookups)) * 100.0) : 0.0)
+              << "% (" << target_stats.btb_hits << "/" << target_stats.btb_lookups << ")" << std::endl;
+    std::cout << "RAS Hit Rate: "
+              << ((target_stats.ras_lookups > 0) ? ((static_cast<double>(target_stats.ras_hits) / static_cast<double>(target_stats.ras_lookups)) * 100.0) : 0.0)
+              << "% (" << target_stats.ras_hits << "/" << target_stats.ras_lookups << ")" << std::endl;
+    std::cout << "Cycles Saved by Target Prediction: " << target_stats.cycles_saved << std::endl;
 
     memory_controller_.PrintCacheStatus();
 
@@ -1093,6 +1137,7 @@ void RV5SVM::Run() {
 }
 
 void RV5SVM::Step() {
+    ApplyPendingConfig();
  
     if (program_counter_ >= program_size_ && !if_id_reg_.valid && !id_ex_reg_.valid && !ex_mem_reg_.valid && !mem_wb_reg_.valid){
         std::cout << "VM_PROGRAM_END" << std::endl;
@@ -1120,11 +1165,12 @@ void RV5SVM::Step() {
 void RV5SVM::DebugRun() {
 
     ClearStop();
+    ApplyPendingConfig();
     output_status_ = "VM_DEBUG_RUN_STARTED";
     
     // Main debug run loop
     // This condition is the same as Run(), it stops when the pipeline is empty.
-    while(!stop_requested_ && (program_counter_ < program_size_ || if_id_reg_.valid || id_ex_reg_.valid || ex_mem_reg_.valid || mem_wb_reg_.valid)) {
+    while(!stop_requested_ && !IsDrained()) {
         
         // PipelinedStep() automatically saves the undo/redo history
         PipelinedStep(); 
@@ -1204,6 +1250,10 @@ void RV5SVM::Undo() {
     }
 
 
+    // rewind the branch predictor tables trained in that cycle
+    branch_predictor_.Rollback(last.predictor_update);
+    target_predictor_.Rollback(last.target_update);
+
     // checks if the last cycle resulted in mem write
     //reverse that change
     if (last.mem_write.occurred) {
@@ -1240,6 +1290,9 @@ void RV5SVM::Undo() {
 }
 
 void RV5SVM::DumpPipelineRegisters(const std::filesystem::path &filename) {
+    if (filename.empty()) {
+        return;
+    }
 
     std::ofstream file(filename);
     if (!file.is_open()) {
@@ -1447,6 +1500,10 @@ void RV5SVM::Redo() {
         }
 
     }
+    // re-apply the branch predictor training from this cycle
+    branch_predictor_.Replay(next.predictor_update);
+    target_predictor_.Replay(next.target_update);
+
     //if mem write occured then update the memory 
     if (next.mem_write.occurred) {
         for (size_t i = 0; i < next.mem_write.new_bytes.size(); ++i) {
@@ -1478,4 +1535,32 @@ void RV5SVM::Redo() {
     DumpRegisters(globals::registers_dump_file_path, registers_);
     DumpPipelineRegisters(globals::pipeline_registers_dump_file_path);
 
-}
\ No newline at end of file
+}
+
+std::any RV5SVM::SaveCoreState() const {
+    return CoreState{if_id_reg_, id_ex_reg_, ex_mem_reg_, mem_wb_reg_, control_unit_, id_stall_,
+                     forward_a_, forward_b_, forward_branch_a_, forward_branch_b_,
+                     instruction_sequence_counter_, last_retired_sequence_id_};
+}
+
+void RV5SVM::RestoreCoreState(const std::any &state) {
+    // A snapshot without pipeline state, such as one handed over by the single-cycle VM,
+    // starts with the pipeline empty at its pc
+    const CoreState core = state.has_value() ? std::any_cast<const CoreState &>(state) : CoreState{};
+    if_id_reg_ = core.if_id_reg;
+    id_ex_reg_ = core.id_ex_reg;
+    ex_mem_reg_ = core.ex_mem_reg;
+    mem_wb_reg_ = core.mem_wb_reg;
+    control_unit_ = core.control_unit;
+    id_stall_ = core.id_stall;
+    forward_a_ = core.forward_a;
+    forward_b_ = core.forward_b;
+    forward_branch_a_ = core.forward_branch_a;
+    forward_branch_b_ = core.forward_branch_b;
+    instruction_sequence_counter_ = core.instruction_sequence_counter;
+    last_retired_sequence_id_ = core.last_retired_sequence_id;
+    pending_predictor_update_ = branch_predictor::ResolveRecord();
+    pending_target_update_ = branch_predictor::TargetUpdateRecord();
+    undo_stack_ = std::stack<CycleDelta>();
+    redo_stack_ = std::stack<CycleDelta>();
+}
@@ -0,0 +1,203 @@
+/**
+ * @file pipeline_model.cpp
+ * @brief Implementation of the in-order, N-wide pipeline timing model
+ */
+#include "vm/rvio/pipeline_model.h"
+#include "vm/rv5s/rv5s_control_unit.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr uint8_t kFprBase = 32;
+
+// Unified scoreboard id of a register field, x0 never creates a dependency
+uint8_t RegisterId(uint8_t index, bool is_fpr) {
+    if (is_fpr) {
+        return kFprBase + index;
+    }
+    return (index == 0) ? pipeline_model::kNoRegister : index;
+}
+
+bool IsFusedMultiplyAdd(uint8_t opcode) {
+    return opcode == 0b1000011 || opcode == 0b1000111 || opcode == 0b1001011 || opcode == 0b1001111;
+}
+
+pipeline_model::OpClass ClassifyUnit(uint32_t instruction, bool is_load, bool is_store) {
+    uint8_t opcode = instruction & 0b1111111;
+    uint8_t funct3 = (instruction >> 12) & 0b111;
+    uint8_t funct7 = (instruction >> 25) & 0b1111111;
+
+    if (is_load) {
+        return pipeline_model::OpClass::Load;
+    }
+    if (is_store) {
+        return pipeline_model::OpClass::Store;
+    }
+    if (opcode == 0b1110011) {
+        return pipeline_model::OpClass::System;
+    }
+    if ((opcode == 0b0110011 || opcode == 0b0111011) && funct7 == 0b0000001) {
+        return (funct3 < 0b100) ? pipeline_model::OpClass::Multiply : pipeline_model::OpClass::Divide;
+    }
+    if (opcode == 0b1010011) {
+        // FDIV and FSQRT use the iterative divider
+        uint8_t operation = funct7 >> 2;
+        if (operation == 0b00011 || operation == 0b01011) {
+            return pipeline_model::OpClass::FloatDivide;
+        }
+        return pipeline_model::OpClass::Float;
+    }
+    if (IsFusedMultiplyAdd(opcode)) {
+        return pipeline_model::OpClass::Float;
+    }
+    return pipeline_model::OpClass::Alu;
+}
+
+} // namespace
+
+namespace pipeline_model {
+
+    MicroOp DecodeMicroOp(uint32_t instruction) {
+        RV5SControlUnit decoder;
+        decoder.GenerateSignalForInstruction(instruction);
+
+        uint8_t opcode = instruction & 0b1111111;
+        uint8_t rd = (instruction >> 7) & 0b11111;
+        uint8_t funct3 = (instruction >> 12) & 0b111;
+        uint8_t rs1 = (instruction >> 15) & 0b11111;
+        uint8_t rs2 = (instruction >> 20) & 0b11111;
+        uint8_t rs3 = (instruction >> 27) & 0b11111;
+        bool fused = IsFusedMultiplyAdd(opcode);
+
+        // Same operand rules as the hazard unit of the 5-stage pipeline
+        bool uses_rs1 = (opcode != 0b0110111) && (opcode != 0b0010111) && (opcode != 0b1101111);
+        bool uses_rs2 = (opcode == 0b0100011) || (opcode == 0b0110011) || (opcode == 0b1100011)
+                        || (opcode == 0b0100111) || (opcode == 0b1010011) || fused;
+        bool writes_rd = (opcode != 0b0100011) && (opcode != 0b0100111) && (opcode != 0b1100011)
+                         && !(opcode == 0b1110011 && funct3 == 0);
+
+        MicroOp op;
+        if (uses_rs1) {
+            op.sources[0] = RegisterId(rs1, decoder.IsRs1FPR(instruction));
+        }
+        if (uses_rs2) {
+            op.sources[1] = RegisterId(rs2, decoder.IsRs2FPR(instruction) || fused);
+        }
+        if (fused) {
+            op.sources[2] = RegisterId(rs3, true);
+        }
+        if (writes_rd) {
+            op.dest = RegisterId(rd, decoder.IsRdFPR(instruction) || fused);
+        }
+        op.is_load = decoder.GetMemRead();
+        op.is_store = decoder.GetMemWrite();
+        op.op_class = ClassifyUnit(instruction, op.is_load, op.is_store);
+        if (op.is_load || op.is_store) {
+            op.access_size = static_cast<uint8_t>(1u << (funct3 & 0b11));
+        }
+        op.is_control = (opcode == 0b1100011) || (opcode == 0b1101111) || (opcode == 0b1100111);
+        op.serializing = (opcode == 0b1110011);
+        return op;
+    }
+
+    void PipelineModel::Initialize(const PipelineModelConfig &config) {
+        if (config.issue_width == 0 || config.issue_width > kMaxIssueWidth) {
+            throw std::invalid_argument("issue_width must be between 1 and " + std::to_string(kMaxIssueWidth));
+        }
+        if (config.frontend_stages == 0 || config.execute_stages == 0 || config.memory_stages == 0) {
+            throw std::invalid_argument("Every pipeline section needs at least one stage");
+        }
+        config_ = config;
+        Reset();
+    }
+
+    void PipelineModel::Reset() {
+        stats_ = PipelineModelStats();
+        stats_.issue_histogram.assign(config_.issue_width + 1, 0);
+        ready_.fill(0);
+
+        // The first instruction reaches execute once it has crossed the front end
+        fetch_ready_ = config_.frontend_stages;
+        group_cycle_ = config_.frontend_stages;
+        group_size_ = 0;
+        group_memory_ops_ = 0;
+        group_closed_ = false;
+        last_writeback_ = 0;
+    }
+
+    void PipelineModel::Issue(const MicroOp &op) {
+        bool is_memory = op.is_load || op.is_store;
+
+        // Without any hazard the instruction joins the current group, or opens the next one
+        bool group_full = group_closed_ || group_size_ >= config_.issue_width;
+        uint64_t ideal = group_full ? group_cycle_ + 1 : group_cycle_;
+
+        uint64_t front = std::max(ideal, fetch_ready_);
+        stats_.control_stall_cycles += front - ideal;
+
+        uint64_t operands = 0;
+        for (uint8_t source : op.sources) {
+            if (source != kNoRegister) {
+                operands = std::max(operands, ready_[source]);
+            }
+        }
+        uint64_t cycle = std::max(front, operands);
+        stats_.data_stall_cycles += cycle - front;
+
+        // Pairing rules: one memory port, serializing instructions issue alone
+        if (cycle == group_cycle_ && group_size_ > 0) {
+            if ((is_memory && group_memory_ops_ > 0) || op.serializing) {
+                cycle++;
+                stats_.structural_stall_cycles++;
+            }
+        }
+
+        if (cycle != group_cycle_) {
+            if (group_size_ > 0) {
+                stats_.issue_histogram[group_size_]++;
+                stats_.issue_histogram[0] += cycle - group_cycle_ - 1;
+            }
+            group_cycle_ = cycle;
+            group_size_ = 0;
+            group_memory_ops_ = 0;
+            group_closed_ = false;
+        }
+
+        group_size_++;
+        if (is_memory) {
+            group_memory_ops_++;
+        }
+        if (op.taken || op.serializing) {
+            group_closed_ = true;
+        }
+
+        // A misprediction resolves at the end of the first execute stage and refetches next cycle
+        if (op.mispredicted) {
+            fetch_ready_ = cycle + 1 + config_.frontend_stages;
+        }
+
+        uint64_t writeback = cycle + config_.execute_stages + config_.memory_stages;
+        if (op.dest != kNoRegister) {
+            uint64_t produced = cycle + config_.execute_stages + (op.is_load ? config_.memory_stages : 0);
+            ready_[op.dest] = config_.forwarding ? produced : writeback + 1;
+        }
+        last_writeback_ = std::max(last_writeback_, writeback);
+        stats_.instructions++;
+    }
+
+    uint64_t PipelineModel::GetCycles() const {
+        return (stats_.instructions > 0) ? last_writeback_ + 1 : 0;
+    }
+
+    PipelineModelStats PipelineModel::GetStats() const {
+        PipelineModelStats stats = stats_;
+        if (group_size_ > 0) {
+            stats.issue_histogram[group_size_]++;
+        }
+        return stats;
+    }
+
+} // namespace pipeline_model
@@ -0,0 +1,299 @@
+/**
+ * @file rvio_vm.cpp
+ * @brief In-order superscalar VM implementation
+ */
+
+#include "vm/rvio/rvio_vm.h"
+
+#include "utils.h"
+#include "globals.h"
+#include "config.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+RVIOVM::RVIOVM(vm_config::ConfigSnapshot config) : RVSSVM(std::move(config)) {
+    Reset();
+    DumpState(globals::vm_state_dump_file_path);
+    std::cout << "RVIOVM initialized: " << model_.GetConfig().issue_width << "-wide, "
+              << model_.GetStageCount() << " stages" << std::endl;
+}
+
+RVIOVM::~RVIOVM() = default;
+
+void RVIOVM::ExecuteTimed(TimingDelta *delta) {
+    CheckpointIfDue();
+    if (delta) {
+        delta->old_model = model_;
+        delta->old_num_branches = num_branches_;
+        delta->old_branch_mispredictions = branch_mispredictions_;
+    }
+
+    uint64_t pc = program_counter_;
+    Fetch();
+    Decode();
+    Execute();
+    WriteMemory();
+    WriteBack();
+    instructions_retired_++;
+
+    pipeline_model::MicroOp op = pipeline_model::DecodeMicroOp(current_instruction_);
+    if (op.is_control) {
+        op.taken = (program_counter_ != pc + 4);
+        branch_predictor::ResolveRecord predictor_update;
+        branch_predictor::TargetUpdateRecord target_update;
+        op.mispredicted = ResolveControlTransfer(pc, current_instruction_, program_counter_,
+                                                 model_.GetConfig().frontend_stages, predictor_update, target_update);
+        if (delta) {
+            delta->predictor_update = predictor_update;
+            delta->target_update = target_update;
+        }
+    }
+
+    model_.Issue(op);
+    UpdateMetrics();
+
+    if (delta) {
+        delta->new_model = model_;
+        delta->new_num_branches = num_branches_;
+        delta->new_branch_mispredictions = branch_mispredictions_;
+    }
+}
+
+void RVIOVM::UpdateMetrics() {
+    pipeline_model::PipelineModelStats stats = model_.GetStats();
+    cycle_s_ = static_cast<unsigned int>(model_.GetCycles());
+    stall_cycles_ = static_cast<unsigned int>(stats.data_stall_cycles + stats.control_stall_cycles + stats.structural_stall_cycles);
+    if (instructions_retired_ > 0 && cycle_s_ > 0) {
+        cpi_ = static_cast<float>(cycle_s_) / static_cast<float>(instructions_retired_);
+        ipc_ = static_cast<float>(instructions_retired_) / static_cast<float>(cycle_s_);
+    } else {
+        cpi_ = 0.0f;
+        ipc_ = 0.0f;
+    }
+}
+
+void RVIOVM::RecordedStep() {
+    current_delta_.old_pc = program_counter_;
+    TimingDelta timing;
+    ExecuteTimed(&timing);
+    current_delta_.new_pc = program_counter_;
+
+    undo_stack_.push(current_delta_);
+    timing_undo_stack_.push(timing);
+    while (!redo_stack_.empty()) {
+        redo_stack_.pop();
+    }
+    while (!timing_redo_stack_.empty()) {
+        timing_redo_stack_.pop();
+    }
+    current_delta_ = StepDelta();
+}
+
+void RVIOVM::ReplayStep() {
+    ExecuteTimed(nullptr);
+    current_delta_ = StepDelta();
+}
+
+void RVIOVM::PrintStats() {
+    pipeline_model::PipelineModelConfig config = model_.GetConfig();
+    pipeline_model::PipelineModelStats stats = model_.GetStats();
+
+    std::cout << "--- Simulation Stats ---" << std::endl;
+    std::cout << "Pipeline: " << config.issue_width << "-wide, " << model_.GetStageCount() << " stages ("
+              << config.frontend_stages << " front end, " << config.execute_stages << " execute, "
+              << config.memory_stages << " memory, 1 writeback), forwarding "
+              << (config.forwarding ? "on" : "off") << std::endl;
+    std::cout << "Total Cycles: " << cycle_s_ << std::endl;
+    std::cout << "Instructions Retired: " << instructions_retired_ << std::endl;
+    std::cout << "Stall Cycles: " << stall_cycles_ << std::endl;
+    std::cout << "  Data Hazards: " << stats.data_stall_cycles << std::endl;
+    std::cout << "  Control Hazards: " << stats.control_stall_cycles << std::endl;
+    std::cout << "  Structural Hazards: " << stats.structural_stall_cycles << std::endl;
+    std::cout << "Cycles Per Instruction (CPI): " << cpi_ << std::endl;
+    std::cout << "Instructions Per Cycle (IPC): " << ipc_ << std::endl;
+    std::cout << "Branch Mispredictions: " << branch_mispredictions_ << std::endl;
+    std::cout << "Branch Misprediction Rate: " << ((num_branches_ > 0) ? ((static_cast<double>(branch_mispredictions_) / static_cast<double>(num_branches_)) * 100.0) : 0.0) << "%" << std::endl;
+
+    uint64_t issue_cycles = 0;
+    for (uint64_t count : stats.issue_histogram) {
+        issue_cycles += count;
+    }
+    double utilisation = (issue_cycles > 0)
+        ? static_cast<double>(stats.instructions) / static_cast<double>(issue_cycles * config.issue_width) * 100.0
+        : 0.0;
+    std::cout << "Issue Slot Utilisation: " << utilisation << "%" << std::endl;
+    for (size_t width = 0; width < stats.issue_histogram.size(); ++width) {
+        std::cout << "  Cycles issuing " << width << ": " << stats.issue_histogram[width] << std::endl;
+    }
+
+    memory_controller_.PrintCacheStatus();
+}
+
+void RVIOVM::Run() {
+    ClearStop();
+    ApplyPendingConfig();
+    if (instructions_retired_ == 0) {
+        ConfigureModel();
+    }
+    uint64_t instruction_executed = 0;
+
+    while (!stop_requested_ && program_counter_ < program_size_) {
+        if (instruction_executed > GetConfig().getInstructionExecutionLimit())
+            break;
+
+        ExecuteTimed(nullptr);
+        current_delta_ = StepDelta();
+        instruction_executed++;
+        std::cout << "Program Counter: " << program_counter_ << std::endl;
+    }
+    if (program_counter_ >= program_size_) {
+        std::cout << "VM_PROGRAM_END" << std::endl;
+        output_status_ = "VM_PROGRAM_END";
+    }
+    PrintStats();
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVIOVM::DebugRun() {
+    ClearStop();
+    ApplyPendingConfig();
+    if (instructions_retired_ == 0) {
+        ConfigureModel();
+    }
+    uint64_t instruction_executed = 0;
+    while (!stop_requested_ && program_counter_ < program_size_) {
+        if (instruction_executed > GetConfig().getInstructionExecutionLimit())
+            break;
+        if (std::find(breakpoints_.begin(), breakpoints_.end(), program_counter_) != breakpoints_.end()) {
+            std::cout << "VM_BREAKPOINT_HIT " << program_counter_ << std::endl;
+            output_status_ = "VM_BREAKPOINT_HIT";
+            break;
+        }
+
+        RecordedStep();
+        instruction_executed++;
+        std::cout << "Program Counter: " << program_counter_ << std::endl;
+
+        if (program_counter_ < program_size_) {
+            std::cout << "VM_STEP_COMPLETED" << std::endl;
+            output_status_ = "VM_STEP_COMPLETED";
+        } else {
+            std::cout << "VM_LAST_INSTRUCTION_STEPPED" << std::endl;
+            output_status_ = "VM_LAST_INSTRUCTION_STEPPED";
+        }
+        DumpRegisters(globals::registers_dump_file_path, registers_);
+        DumpState(globals::vm_state_dump_file_path);
+
+        unsigned int delay_ms = GetConfig().getRunStepDelay();
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    }
+    if (program_counter_ >= program_size_) {
+        std::cout << "VM_PROGRAM_END" << std::endl;
+        output_status_ = "VM_PROGRAM_END";
+        PrintStats();
+    }
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVIOVM::Step() {
+    ApplyPendingConfig();
+    if (program_counter_ < program_size_) {
+        if (instructions_retired_ == 0) {
+            ConfigureModel();
+        }
+        RecordedStep();
+        std::cout << "Program Counter: " << std::hex << program_counter_ << std::dec << std::endl;
+
+        if (program_counter_ < program_size_) {
+            std::cout << "VM_STEP_COMPLETED" << std::endl;
+            output_status_ = "VM_STEP_COMPLETED";
+        } else {
+            std::cout << "VM_LAST_INSTRUCTION_STEPPED" << std::endl;
+            output_status_ = "VM_LAST_INSTRUCTION_STEPPED";
+        }
+    } else {
+        std::cout << "VM_PROGRAM_END" << std::endl;
+        output_status_ = "VM_PROGRAM_END";
+    }
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVIOVM::Undo() {
+    if (!timing_undo_stack_.empty()) {
+        TimingDelta last = timing_undo_stack_.top();
+        timing_undo_stack_.pop();
+
+        model_ = last.old_model;
+        branch_predictor_.Rollback(last.predictor_update);
+        target_predictor_.Rollback(last.target_update);
+        num_branches_ = last.old_num_branches;
+        branch_mispredictions_ = last.old_branch_mispredictions;
+        timing_redo_stack_.push(last);
+    }
+
+    RVSSVM::Undo();
+    UpdateMetrics();
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVIOVM::Redo() {
+    if (!timing_redo_stack_.empty()) {
+        TimingDelta next = timing_redo_stack_.top();
+        timing_redo_stack_.pop();
+
+        model_ = next.new_model;
+        branch_predictor_.Replay(next.predictor_update);
+        target_predictor_.Replay(next.target_update);
+        num_branches_ = next.new_num_branches;
+        branch_mispredictions_ = next.new_branch_mispredictions;
+        timing_undo_stack_.push(next);
+    }
+
+    RVSSVM::Redo();
+    UpdateMetrics();
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVIOVM::ConfigureModel() {
+    ResetBranchPredictors();
+
+    pipeline_model::PipelineModelConfig config;
+    config.issue_width = GetConfig().getIssueWidth();
+    config.frontend_stages = GetConfig().getFrontendStages();
+    config.execute_stages = GetConfig().getExecuteStages();
+    config.memory_stages = GetConfig().getMemoryStages();
+    config.forwarding = GetConfig().isForwardingEnabled();
+    model_.Initialize(config);
+}
+
+void RVIOVM::Reset() {
+    RVSSVM::Reset();
+    ConfigureModel();
+
+    timing_undo_stack_ = std::stack<TimingDelta>();
+    timing_redo_stack_ = std::stack<TimingDelta>();
+    num_branches_ = 0;
+    branch_mispredictions_ = 0;
+    stall_cycles_ = 0;
+    cpi_ = 0.0f;
+    ipc_ = 0.0f;
+}
+
+std::any RVIOVM::SaveCoreState() const {
+    return TimedState{RVSSVM::SaveCoreState(), model_};
+}
+
+void RVIOVM::RestoreCoreState(const std::any &state) {
+    const auto &timed = std::any_cast<const TimedState &>(state);
+    RVSSVM::RestoreCoreState(timed.functional);
+    model_ = timed.model;
+    timing_undo_stack_ = std::stack<TimingDelta>();
+    timing_redo_stack_ = std::stack<TimingDelta>();
+}
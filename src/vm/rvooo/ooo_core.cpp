@@ -0,0 +1,301 @@
+/**
+ * @file ooo_core.cpp
+ * @brief Implementation of the out-of-order core timing model
+ */
+#include "vm/rvooo/ooo_core.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ooo_core {
+
+    void OooCore::Initialize(const OooCoreConfig &config) {
+        if (config.width == 0 || config.width > kMaxWidth) {
+            throw std::invalid_argument("Out-of-order width must be between 1 and " + std::to_string(kMaxWidth));
+        }
+        if (config.rob_size == 0 || config.issue_queue_size == 0 || config.lsq_size == 0 || config.frontend_stages == 0) {
+            throw std::invalid_argument("ROB, issue queue, LSQ and front end must not be empty");
+        }
+        if (config.physical_registers <= pipeline_model::kNumTrackedRegisters
+            || config.physical_registers >= kNoPhysicalRegister) {
+            throw std::invalid_argument("physical_registers must exceed the " + std::to_string(pipeline_model::kNumTrackedRegisters)
+                                        + " architectural registers");
+        }
+        config_ = config;
+        Reset();
+    }
+
+    void OooCore::Reset() {
+        stats_ = OooCoreStats();
+        cycle_ = 0;
+        next_sequence_ = 0;
+
+        fetch_queue_.clear();
+        rob_.clear();
+        issue_queue_.clear();
+        load_store_queue_.clear();
+
+        // Architectural register i starts out in physical register i, the rest are free
+        for (unsigned int i = 0; i < pipeline_model::kNumTrackedRegisters; ++i) {
+            rename_table_[i] = static_cast<uint16_t>(i);
+        }
+        register_ready_.assign(config_.physical_registers, 0);
+        free_list_.clear();
+        for (uint64_t i = pipeline_model::kNumTrackedRegisters; i < config_.physical_registers; ++i) {
+            free_list_.push_back(static_cast<uint16_t>(i));
+        }
+
+        awaiting_redirect_ = false;
+        fetch_resume_cycle_ = 0;
+        serializing_in_flight_ = false;
+    }
+
+    void OooCore::Cycle(const FetchSupplier &fetch) {
+        Commit();
+        Issue();
+        Dispatch();
+        Fetch(fetch);
+
+        stats_.rob_occupancy_sum += rob_.size();
+        stats_.rob_occupancy_max = std::max<uint64_t>(stats_.rob_occupancy_max, rob_.size());
+        stats_.issue_queue_occupancy_sum += issue_queue_.size();
+        stats_.cycles++;
+        cycle_++;
+    }
+
+    RobEntry &OooCore::Entry(uint64_t sequence) {
+        // Sequence numbers are handed out at dispatch, so the ROB is contiguous
+        return rob_[sequence - rob_.front().sequence];
+    }
+
+    uint64_t OooCore::Latency(const RobEntry &entry) const {
+        switch (entry.op.op_class) {
+            case pipeline_model::OpClass::Multiply:
+                return config_.multiply_latency;
+            case pipeline_model::OpClass::Divide:
+                return config_.divide_latency;
+            case pipeline_model::OpClass::Float:
+                return config_.float_latency;
+            case pipeline_model::OpClass::FloatDivide:
+                return config_.float_divide_latency;
+            case pipeline_model::OpClass::Load:
+                return config_.load_latency;
+            default:
+                return config_.alu_latency;
+        }
+    }
+
+    void OooCore::Commit() {
+        for (uint64_t committed = 0; committed < config_.width && !rob_.empty(); ++committed) {
+            RobEntry &head = rob_.front();
+            if (!head.issued || head.complete_cycle > cycle_) {
+                break;
+            }
+
+            if (head.previous_dest != kNoPhysicalRegister) {
+                free_list_.push_back(head.previous_dest);
+            }
+            // Stores write the data cache here; both kinds leave the LSQ in order
+            if (head.op.is_load || head.op.is_store) {
+                load_store_queue_.pop_front();
+            }
+            if (head.op.serializing) {
+                serializing_in_flight_ = false;
+            }
+            stats_.committed++;
+            rob_.pop_front();
+        }
+    }
+
+    bool OooCore::ResolveLoad(const RobEntry &load, uint64_t &complete_cycle, bool &forwarded) {
+        forwarded = false;
+        uint64_t load_end = load.op.address + load.op.access_size;
+
+        // Walk older stores from youngest to oldest; the first overlapping one decides
+        for (auto it = load_store_queue_.rbegin(); it != load_store_queue_.rend(); ++it) {
+            if (*it >= load.sequence) {
+                continue;
+            }
+            const RobEntry &store = Entry(*it);
+            if (!store.op.is_store) {
+                continue;
+            }
+            if (!store.issued) {
+                // Address still unknown: no memory dependence speculation
+                return false;
+            }
+            uint64_t store_end = store.op.address + store.op.access_size;
+            if (store_end <= load.op.address || load_end <= store.op.address) {
+                continue;
+            }
+            if (store.op.address <= load.op.address && load_end <= store_end) {
+                complete_cycle = cycle_ + config_.forward_latency;
+                forwarded = true;
+                return true;
+            }
+            // Partial overlap waits for the store to reach the cache
+            return false;
+        }
+
+        complete_cycle = cycle_ + config_.load_latency;
+        return true;
+    }
+
+    void OooCore::Issue() {
+        uint64_t issued = 0;
+        for (auto it = issue_queue_.begin(); it != issue_queue_.end() && issued < config_.width;) {
+            RobEntry &entry = Entry(*it);
+
+            bool ready = true;
+            for (uint16_t source : entry.sources) {
+                if (source != kNoPhysicalRegister && register_ready_[source] > cycle_) {
+                    ready = false;
+                    break;
+                }
+            }
+            if (!ready) {
+                ++it;
+                continue;
+            }
+
+            uint64_t complete_cycle = cycle_ + Latency(entry);
+            if (entry.op.is_load) {
+                bool forwarded = false;
+                if (!ResolveLoad(entry, complete_cycle, forwarded)) {
+                    stats_.memory_order_stalls++;
+                    ++it;
+                    continue;
+                }
+                if (forwarded) {
+                    stats_.forwarded_loads++;
+                }
+            }
+
+            entry.issued = true;
+            entry.complete_cycle = complete_cycle;
+            if (entry.dest != kNoPhysicalRegister) {
+                register_ready_[entry.dest] = complete_cycle;
+            }
+            // The branch resolves when it executes and fetch restarts down the right path
+            if (entry.op.mispredicted) {
+                awaiting_redirect_ = false;
+                fetch_resume_cycle_ = complete_cycle;
+            }
+
+            it = issue_queue_.erase(it);
+            issued++;
+        }
+    }
+
+    void OooCore::Dispatch() {
+        uint64_t dispatched = 0;
+        StallReason blocked = StallReason::FrontEnd;
+
+        while (dispatched < config_.width) {
+            if (fetch_queue_.empty() || fetch_queue_.front().ready_cycle > cycle_) {
+                blocked = StallReason::FrontEnd;
+                break;
+            }
+            const pipeline_model::MicroOp &op = fetch_queue_.front().op;
+            bool is_memory = op.is_load || op.is_store;
+
+            if (serializing_in_flight_ || (op.serializing && !rob_.empty())) {
+                blocked = StallReason::Serialize;
+                break;
+            }
+            if (rob_.size() >= config_.rob_size) {
+                blocked = StallReason::RobFull;
+                break;
+            }
+            if (issue_queue_.size() >= config_.issue_queue_size) {
+                blocked = StallReason::IssueQueueFull;
+                break;
+            }
+            if (is_memory && load_store_queue_.size() >= config_.lsq_size) {
+                blocked = StallReason::LsqFull;
+                break;
+            }
+            if (op.dest != pipeline_model::kNoRegister && free_list_.empty()) {
+                blocked = StallReason::NoFreeRegister;
+                break;
+            }
+
+            RobEntry entry;
+            entry.sequence = next_sequence_++;
+            entry.op = op;
+            for (size_t i = 0; i < op.sources.size(); ++i) {
+                if (op.sources[i] != pipeline_model::kNoRegister) {
+                    entry.sources[i] = rename_table_[op.sources[i]];
+                }
+            }
+            if (op.dest != pipeline_model::kNoRegister) {
+                entry.previous_dest = rename_table_[op.dest];
+                entry.dest = free_list_.front();
+                free_list_.pop_front();
+                rename_table_[op.dest] = entry.dest;
+                register_ready_[entry.dest] = kNotReady;
+            }
+            if (op.serializing) {
+                serializing_in_flight_ = true;
+            }
+
+            issue_queue_.push_back(entry.sequence);
+            if (is_memory) {
+                load_store_queue_.push_back(entry.sequence);
+            }
+            rob_.push_back(entry);
+            fetch_queue_.pop_front();
+            dispatched++;
+        }
+
+        if (dispatched == 0) {
+            stats_.stall_cycles[static_cast<size_t>(blocked)]++;
+        }
+    }
+
+    void OooCore::Fetch(const FetchSupplier &fetch) {
+        if (awaiting_redirect_ || cycle_ < fetch_resume_cycle_) {
+            return;
+        }
+
+        uint64_t capacity = config_.width * (config_.frontend_stages + 1);
+        for (uint64_t fetched = 0; fetched < config_.width && fetch_queue_.size() < capacity; ++fetched) {
+            FetchedOp entry;
+            if (!fetch(entry.op)) {
+                break;
+            }
+            entry.ready_cycle = cycle_ + config_.frontend_stages;
+            fetch_queue_.push_back(entry);
+            stats_.fetched++;
+
+            if (entry.op.mispredicted) {
+                awaiting_redirect_ = true;
+                break;
+            }
+            // One taken transfer per fetch block
+            if (entry.op.taken) {
+                break;
+            }
+        }
+    }
+
+    std::string StallReasonToString(StallReason reason) {
+        switch (reason) {
+            case StallReason::FrontEnd:
+                return "front_end";
+            case StallReason::RobFull:
+                return "rob_full";
+            case StallReason::IssueQueueFull:
+                return "issue_queue_full";
+            case StallReason::LsqFull:
+                return "lsq_full";
+            case StallReason::NoFreeRegister:
+                return "no_free_register";
+            case StallReason::Serialize:
+                return "serialize";
+            default:
+                return "unknown";
+        }
+    }
+
+} // namespace ooo_core
@@ -0,0 +1,354 @@
+/**
+ * @file rvooo_vm.cpp
+ * @brief Out-of-order VM implementation
+ */
+
+#include "vm/rvooo/rvooo_vm.h"
+
+#include "utils.h"
+#include "globals.h"
+#include "config.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+RVOOOVM::RVOOOVM(vm_config::ConfigSnapshot config) : RVSSVM(std::move(config)) {
+    Reset();
+    DumpState(globals::vm_state_dump_file_path);
+    std::cout << "RVOOOVM initialized: " << core_.GetConfig().width << "-wide, ROB "
+              << core_.GetConfig().rob_size << std::endl;
+}
+
+RVOOOVM::~RVOOOVM() = default;
+
+void RVOOOVM::ConfigureCore() {
+    ResetBranchPredictors();
+
+    ooo_core::OooCoreConfig config;
+    config.width = GetConfig().getOooWidth();
+    config.rob_size = GetConfig().getRobSize();
+    config.issue_queue_size = GetConfig().getIssueQueueSize();
+    config.lsq_size = GetConfig().getLsqSize();
+    config.physical_registers = GetConfig().getPhysicalRegisters();
+    core_.Initialize(config);
+}
+
+bool RVOOOVM::FetchInstruction(pipeline_model::MicroOp &op, OooCycleDelta *delta) {
+    if (program_counter_ >= program_size_ || instructions_fetched_ > GetConfig().getInstructionExecutionLimit()) {
+        return false;
+    }
+
+    uint64_t pc = program_counter_;
+    current_delta_.old_pc = pc;
+    Fetch();
+    Decode();
+    Execute();
+    WriteMemory();
+    WriteBack();
+    current_delta_.new_pc = program_counter_;
+    instructions_fetched_++;
+
+    op = pipeline_model::DecodeMicroOp(current_instruction_);
+    if (op.is_load || op.is_store) {
+        op.address = static_cast<uint64_t>(execution_result_);
+    }
+    if (op.is_control) {
+        op.taken = (program_counter_ != pc + 4);
+        branch_predictor::ResolveRecord predictor_update;
+        branch_predictor::TargetUpdateRecord target_update;
+        op.mispredicted = ResolveControlTransfer(pc, current_instruction_, program_counter_,
+                                                 core_.GetConfig().frontend_stages, predictor_update, target_update);
+        if (delta) {
+            delta->predictor_updates.push_back(predictor_update);
+            delta->target_updates.push_back(target_update);
+        }
+    }
+
+    if (delta) {
+        delta->fetched_steps.push_back(current_delta_);
+    }
+    current_delta_ = StepDelta();
+    return true;
+}
+
+void RVOOOVM::CoreCycle(OooCycleDelta *delta) {
+    CheckpointIfDue();
+    if (delta) {
+        delta->old_core = core_;
+        delta->old_num_branches = num_branches_;
+        delta->old_branch_mispredictions = branch_mispredictions_;
+    }
+
+    core_.Cycle([this, delta](pipeline_model::MicroOp &op) {
+        return FetchInstruction(op, delta);
+    });
+    UpdateMetrics();
+
+    if (delta) {
+        delta->new_core = core_;
+        delta->new_num_branches = num_branches_;
+        delta->new_branch_mispredictions = branch_mispredictions_;
+    }
+}
+
+void RVOOOVM::RestartExecutionLimit() {
+    instructions_fetched_ = 0;
+    while (!limit_restarts_.empty() && limit_restarts_.back() >= cycle_s_) {
+        limit_restarts_.pop_back();
+    }
+    limit_restarts_.push_back(cycle_s_);
+}
+
+void RVOOOVM::ReplayStep() {
+    // Fetch stops where the execution limit stopped it the first time
+    if (std::binary_search(limit_restarts_.begin(), limit_restarts_.end(), cycle_s_)) {
+        instructions_fetched_ = 0;
+    }
+    CoreCycle(nullptr);
+}
+
+bool RVOOOVM::Finished() const {
+    bool fetch_done = program_counter_ >= program_size_
+                      || instructions_fetched_ > GetConfig().getInstructionExecutionLimit();
+    return fetch_done && core_.Drained();
+}
+
+void RVOOOVM::UpdateMetrics() {
+    const ooo_core::OooCoreStats &stats = core_.GetStats();
+    cycle_s_ = static_cast<unsigned int>(stats.cycles);
+    instructions_retired_ = static_cast<unsigned int>(stats.committed);
+
+    uint64_t stalls = 0;
+    for (uint64_t cycles : stats.stall_cycles) {
+        stalls += cycles;
+    }
+    stall_cycles_ = static_cast<unsigned int>(stalls);
+
+    if (instructions_retired_ > 0 && cycle_s_ > 0) {
+        cpi_ = static_cast<float>(cycle_s_) / static_cast<float>(instructions_retired_);
+        ipc_ = static_cast<float>(instructions_retired_) / static_cast<float>(cycle_s_);
+    } else {
+        cpi_ = 0.0f;
+        ipc_ = 0.0f;
+    }
+}
+
+void RVOOOVM::PrintStats() {
+    ooo_core::OooCoreConfig config = core_.GetConfig();
+    const ooo_core::OooCoreStats &stats = core_.GetStats();
+    double cycles = (stats.cycles > 0) ? static_cast<double>(stats.cycles) : 1.0;
+
+    std::cout << "--- Simulation Stats ---" << std::endl;
+    std::cout << "Core: " << config.width << "-wide, ROB " << config.rob_size << ", issue queue "
+              << config.issue_queue_size << ", LSQ " << config.lsq_size << ", "
+              << config.physical_registers << " physical registers" << std::endl;
+    std::cout << "Total Cycles: " << cycle_s_ << std::endl;
+    std::cout << "Instructions Retired: " << instructions_retired_ << std::endl;
+    std::cout << "Stall Cycles: " << stall_cycles_ << std::endl;
+    for (size_t i = 0; i < stats.stall_cycles.size(); ++i) {
+        std::cout << "  " << ooo_core::StallReasonToString(static_cast<ooo_core::StallReason>(i)) << ": "
+                  << stats.stall_cycles[i] << std::endl;
+    }
+    std::cout << "Cycles Per Instruction (CPI): " << cpi_ << std::endl;
+    std::cout << "Instructions Per Cycle (IPC): " << ipc_ << std::endl;
+    std::cout << "Average ROB Occupancy: " << static_cast<double>(stats.rob_occupancy_sum) / cycles
+              << " (max " << stats.rob_occupancy_max << ")" << std::endl;
+    std::cout << "Average Issue Queue Occupancy: " << static_cast<double>(stats.issue_queue_occupancy_sum) / cycles << std::endl;
+    std::cout << "Store-to-Load Forwards: " << stats.forwarded_loads << std::endl;
+    std::cout << "Cycles Loads Waited on Older Stores: " << stats.memory_order_stalls << std::endl;
+    std::cout << "Branch Mispredictions: " << branch_mispredictions_ << std::endl;
+    std::cout << "Branch Misprediction Rate: " << ((num_branches_ > 0) ? ((static_cast<double>(branch_mispredictions_) / static_cast<double>(num_branches_)) * 100.0) : 0.0) << "%" << std::endl;
+
+    memory_controller_.PrintCacheStatus();
+}
+
+void RVOOOVM::Run() {
+    ClearStop();
+    ApplyPendingConfig();
+    if (core_.GetStats().cycles == 0) {
+        ConfigureCore();
+    }
+    RestartExecutionLimit();
+
+    while (!stop_requested_ && !Finished()) {
+        CoreCycle(nullptr);
+        std::cout << "Program Counter: " << program_counter_ << std::endl;
+    }
+    if (program_counter_ >= program_size_ && core_.Drained()) {
+        std::cout << "VM_PROGRAM_END" << std::endl;
+        output_status_ = "VM_PROGRAM_END";
+    }
+    PrintStats();
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVOOOVM::DebugRun() {
+    ClearStop();
+    ApplyPendingConfig();
+    if (core_.GetStats().cycles == 0) {
+        ConfigureCore();
+    }
+    RestartExecutionLimit();
+
+    while (!stop_requested_ && !Finished()) {
+        if (std::find(breakpoints_.begin(), breakpoints_.end(), program_counter_) != breakpoints_.end()
+            && program_counter_ < program_size_) {
+            std::cout << "VM_BREAKPOINT_HIT " << program_counter_ << std::endl;
+            output_status_ = "VM_BREAKPOINT_HIT";
+            break;
+        }
+
+        OooCycleDelta delta;
+        CoreCycle(&delta);
+        cycle_undo_stack_.push(delta);
+        while (!cycle_redo_stack_.empty()) {
+            cycle_redo_stack_.pop();
+        }
+        std::cout << "Program Counter: " << program_counter_ << std::endl;
+
+        if (!Finished()) {
+            std::cout << "VM_STEP_COMPLETED" << std::endl;
+            output_status_ = "VM_STEP_COMPLETED";
+        } else {
+            std::cout << "VM_LAST_INSTRUCTION_STEPPED" << std::endl;
+            output_status_ = "VM_LAST_INSTRUCTION_STEPPED";
+        }
+        DumpRegisters(globals::registers_dump_file_path, registers_);
+        DumpState(globals::vm_state_dump_file_path);
+
+        unsigned int delay_ms = GetConfig().getRunStepDelay();
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    }
+    if (program_counter_ >= program_size_ && core_.Drained()) {
+        std::cout << "VM_PROGRAM_END" << std::endl;
+        output_status_ = "VM_PROGRAM_END";
+        PrintStats();
+    }
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVOOOVM::Step() {
+    ApplyPendingConfig();
+    RestartExecutionLimit();
+    if (!Finished()) {
+        if (core_.GetStats().cycles == 0) {
+            ConfigureCore();
+        }
+
+        OooCycleDelta delta;
+        CoreCycle(&delta);
+        cycle_undo_stack_.push(delta);
+        while (!cycle_redo_stack_.empty()) {
+            cycle_redo_stack_.pop();
+        }
+        std::cout << "Program Counter: " << std::hex << program_counter_ << std::dec << std::endl;
+
+        if (!Finished()) {
+            std::cout << "VM_STEP_COMPLETED" << std::endl;
+            output_status_ = "VM_STEP_COMPLETED";
+        } else {
+            std::cout << "VM_LAST_INSTRUCTION_STEPPED" << std::endl;
+            output_status_ = "VM_LAST_INSTRUCTION_STEPPED";
+        }
+    } else {
+        std::cout << "VM_PROGRAM_END" << std::endl;
+        output_status_ = "VM_PROGRAM_END";
+    }
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVOOOVM::Undo() {
+    if (cycle_undo_stack_.empty()) {
+        std::cout << "VM_NO_MORE_UNDO" << std::endl;
+        output_status_ = "VM_NO_MORE_UNDO";
+        return;
+    }
+
+    OooCycleDelta last = cycle_undo_stack_.top();
+    cycle_undo_stack_.pop();
+
+    for (auto it = last.fetched_steps.rbegin(); it != last.fetched_steps.rend(); ++it) {
+        RevertStep(*it);
+    }
+    for (auto it = last.predictor_updates.rbegin(); it != last.predictor_updates.rend(); ++it) {
+        branch_predictor_.Rollback(*it);
+    }
+    for (auto it = last.target_updates.rbegin(); it != last.target_updates.rend(); ++it) {
+        target_predictor_.Rollback(*it);
+    }
+    core_ = last.old_core;
+    num_branches_ = last.old_num_branches;
+    branch_mispredictions_ = last.old_branch_mispredictions;
+    UpdateMetrics();
+    std::cout << "Program Counter: " << program_counter_ << std::endl;
+
+    cycle_redo_stack_.push(last);
+
+    output_status_ = "VM_UNDO_COMPLETED";
+    std::cout << "VM_UNDO_COMPLETED" << std::endl;
+
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+}
+
+void RVOOOVM::Redo() {
+    if (cycle_redo_stack_.empty()) {
+        std::cout << "VM_NO_MORE_REDO" << std::endl;
+        return;
+    }
+
+    OooCycleDelta next = cycle_redo_stack_.top();
+    cycle_redo_stack_.pop();
+
+    for (const StepDelta &step : next.fetched_steps) {
+        ReapplyStep(step);
+    }
+    for (const auto &update : next.predictor_updates) {
+        branch_predictor_.Replay(update);
+    }
+    for (const auto &update : next.target_updates) {
+        target_predictor_.Replay(update);
+    }
+    core_ = next.new_core;
+    num_branches_ = next.new_num_branches;
+    branch_mispredictions_ = next.new_branch_mispredictions;
+    UpdateMetrics();
+
+    DumpRegisters(globals::registers_dump_file_path, registers_);
+    DumpState(globals::vm_state_dump_file_path);
+    std::cout << "Program Counter: " << program_counter_ << std::endl;
+    cycle_undo_stack_.push(next);
+}
+
+void RVOOOVM::Reset() {
+    RVSSVM::Reset();
+    ConfigureCore();
+
+    instructions_fetched_ = 0;
+    limit_restarts_.clear();
+    cycle_undo_stack_ = std::stack<OooCycleDelta>();
+    cycle_redo_stack_ = std::stack<OooCycleDelta>();
+    num_branches_ = 0;
+    branch_mispredictions_ = 0;
+    stall_cycles_ = 0;
+    cpi_ = 0.0f;
+    ipc_ = 0.0f;
+}
+
+std::any RVOOOVM::SaveCoreState() const {
+    return OooState{RVSSVM::SaveCoreState(), core_, instructions_fetched_};
+}
+
+void RVOOOVM::RestoreCoreState(const std::any &state) {
+    const auto &ooo = std::any_cast<const OooState &>(state);
+    RVSSVM::RestoreCoreState(ooo.functional);
+    core_ = ooo.core;
+    instructions_fetched_ = ooo.instructions_fetched;
+    cycle_undo_stack_ = std::stack<OooCycleDelta>();
+    cycle_redo_stack_ = std::stack<OooCycleDelta>();
+}
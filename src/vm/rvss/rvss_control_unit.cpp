@@ -44,6 +44,14 @@ void RVSSControlUnit::SetControlSignals(uint32_t instruction) {
       mem_write_ = true;
       break;
     }
+    case 0b0101111: {// Atomic instructions (LR, SC, AMOs), address is rs1
+      alu_src_ = true;
+      mem_to_reg_ = true;
+      reg_write_ = true;
+      mem_read_ = true;
+      mem_write_ = true;
+      break;
+    }
     case 0b1100011: {// branch_ instructions (BEQ, BNE, BLT, BGE)
       alu_op_ = true;
       branch_ = true;
@@ -342,6 +350,10 @@ alu::AluOp RVSSControlUnit::GetAluSignal(uint32_t instruction, bool ALUOp) {
         return alu::AluOp::kAdd;
         break;
     }
+    case 0b0101111: {// Atomic, address is rs1 + 0
+        return alu::AluOp::kAdd;
+        break;
+    }
     case 0b1100111: {// JALR
         return alu::AluOp::kAdd;
         break;
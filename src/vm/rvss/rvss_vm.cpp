@@ -12,8 +12,10 @@
 #include "config.h"
 
 #include <cctype>
+#include <cerrno>
 #include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <tuple>
 #include <stack>  
 #include <algorithm>
@@ -27,7 +29,7 @@ using instruction_set::Instruction;
 using instruction_set::get_instr_encoding;
 
 
-RVSSVM::RVSSVM() : VmBase() {
+RVSSVM::RVSSVM(vm_config::ConfigSnapshot config) : VmBase(std::move(config)) {
   DumpRegisters(globals::registers_dump_file_path, registers_);
   DumpState(globals::vm_state_dump_file_path);
 }
@@ -133,6 +135,11 @@ void RVSSVM::Execute() {
   }
 
   
+  if (branch_trace_ && opcode==0b1100011) {
+    uint64_t branch_pc = program_counter_ - 4;
+    branch_trace_->branches.push_back({branch_pc, branch_pc + static_cast<int64_t>(imm), branch_flag_});
+  }
+
   if (branch_flag_ && opcode==0b1100011) {
     UpdateProgramCounter(-4);
     UpdateProgramCounter(imm);
@@ -281,18 +288,23 @@ void RVSSVM::HandleSyscall() {
         }
         PrintString(registers_.ReadGpr(10)); // Print string
         if (!globals::vm_as_backend) {
-            std::cout << "]" << std::endl;
+            std::cout << "]\n";
         }
         break;
     }
-    case SYSCALL_EXIT: {
+    case SYSCALL_EXIT:
+    case SYSCALL_LINUX_EXIT:
+    case SYSCALL_EXIT_GROUP: {
         stop_requested_ = true; // Stop the VM
         if (!globals::vm_as_backend) {
             std::cout << "VM_EXIT" << std::endl;
         }
         output_status_ = "VM_EXIT";
-        std::cout << "Exited with exit code: " << registers_.ReadGpr(10) << std::endl;
-        exit(0); // Exit the program
+        exit_code_ = registers_.ReadGpr(10);
+        std::cout << "Exited with exit code: " << exit_code_ << std::endl;
+        if (exit_ends_process_) {
+            exit(0); // Exit the program
+        }
         break;
     }
     case SYSCALL_READ: { // Read
@@ -301,58 +313,21 @@ void RVSSVM::HandleSyscall() {
       uint64_t length = registers_.ReadGpr(12);
 
       if (file_descriptor == 0) {
-        // Read from stdin
-        std::string input;
-        {
-          std::cout << "VM_STDIN_START" << std::endl;
-          output_status_ = "VM_STDIN_START";
-          std::unique_lock<std::mutex> lock(input_mutex_);
-          input_cv_.wait(lock, [this]() { 
-            return !input_queue_.empty(); 
-          });
-          output_status_ = "VM_STDIN_END";
-          std::cout << "VM_STDIN_END" << std::endl;
-
-          input = input_queue_.front();
-          input_queue_.pop();
-        }
-
-
-        std::vector<uint8_t> old_bytes_vec(length, 0);
-        std::vector<uint8_t> new_bytes_vec(length, 0);
-
-        for (size_t i = 0; i < length; ++i) {
-          old_bytes_vec[i] = memory_controller_.ReadByte(buffer_address + i);
-        }
-        
-        for (size_t i = 0; i < input.size() && i < length; ++i) {
-          memory_controller_.WriteByte(buffer_address + i, static_cast<uint8_t>(input[i]));
-        }
-        if (input.size() < length) {
-          memory_controller_.WriteByte(buffer_address + input.size(), '\0');
-        }
-
-        for (size_t i = 0; i < length; ++i) {
-          new_bytes_vec[i] = memory_controller_.ReadByte(buffer_address + i);
-        }
-
-        current_delta_.memory_changes.push_back({
-          buffer_address, 
-          old_bytes_vec, 
-          new_bytes_vec
-        });
-
-        uint64_t old_reg = registers_.ReadGpr(10);
-        unsigned int reg_index = 10;
-        unsigned int reg_type = 0; // 0 for GPR, 1 for CSR, 2 for FPR
-        uint64_t new_reg = std::min(static_cast<uint64_t>(length), static_cast<uint64_t>(input.size()));
-        registers_.WriteGpr(10, new_reg); 
-        if (old_reg != new_reg) {
-          current_delta_.register_changes.push_back({reg_index, reg_type, old_reg, new_reg});
-        }
-
+        // Read from stdin: the line and its terminating NUL, if there is room for it
+        std::string input = ReadInput();
+        std::vector<uint8_t> bytes(input.begin(), input.end());
+        bytes.push_back('\0');
+        bytes.resize(std::min<uint64_t>(length, bytes.size()));
+        StoreSyscallBytes(buffer_address, bytes.data(), bytes.size());
+        SetSyscallResult(std::min<uint64_t>(length, input.size()));
       } else {
-          std::cerr << "Unsupported file descriptor: " << file_descriptor << std::endl;
+        // Longer reads return short, as Linux may
+        std::vector<uint8_t> bytes(std::min<uint64_t>(length, kMaxSyscallTransfer));
+        int64_t result = proxy_kernel_.Read(static_cast<int64_t>(file_descriptor), bytes.data(), bytes.size());
+        if (result > 0) {
+          StoreSyscallBytes(buffer_address, bytes.data(), result);
+        }
+        SetSyscallResult(result);
       }
       break;
     }
@@ -364,32 +339,92 @@ void RVSSVM::HandleSyscall() {
         if (file_descriptor == 1) { // stdout
           std::cout << "VM_STDOUT_START";
           output_status_ = "VM_STDOUT_START";
-          uint64_t bytes_printed = 0;
-          for (uint64_t i = 0; i < length; ++i) {
-              char c = memory_controller_.ReadByte(buffer_address + i);
-              // if (c == '\0') {
-              //     break;
-              // }
-              std::cout << c;
-              bytes_printed++;
-          }
-          std::cout << std::flush; 
+          WriteGuestBuffer(std::cout, buffer_address, length);
           output_status_ = "VM_STDOUT_END";
-          std::cout << "VM_STDOUT_END" << std::endl;
-
-          uint64_t old_reg = registers_.ReadGpr(10);
-          unsigned int reg_index = 10;
-          unsigned int reg_type = 0; // 0 for GPR, 1 for CSR, 2 for FPR
-          uint64_t new_reg = std::min(static_cast<uint64_t>(length), bytes_printed);
-          registers_.WriteGpr(10, new_reg);
-          if (old_reg != new_reg) {
-            current_delta_.register_changes.push_back({reg_index, reg_type, old_reg, new_reg});
+          std::cout << "VM_STDOUT_END";
+          // A front end waits for the marker; on the command line the host buffer is flushed
+          // when it fills or the program stops, not on every call
+          if (globals::vm_as_backend) {
+            std::cout << std::endl;
+          } else {
+            std::cout << '\n';
           }
+          SetSyscallResult(length);
+        } else if (file_descriptor == 2) { // stderr
+          WriteGuestBuffer(std::cerr, buffer_address, length);
+          SetSyscallResult(length);
         } else {
-            std::cerr << "Unsupported file descriptor: " << file_descriptor << std::endl;
+          SetSyscallResult(proxy_kernel_.Write(static_cast<int64_t>(file_descriptor), memory_controller_,
+                                               buffer_address, length));
         }
         break;
     }
+    case SYSCALL_OPENAT: {
+      uint64_t path_address = registers_.ReadGpr(11);
+      uint64_t path_length = memory_controller_.StringLength_d(path_address);
+      if (path_length >= kMaxSyscallPath) {
+        SetSyscallResult(-ENAMETOOLONG);
+        break;
+      }
+      std::string path(path_length, '\0');
+      memory_controller_.ReadSegment_d(path_address, reinterpret_cast<uint8_t *>(path.data()), path_length);
+      SetSyscallResult(proxy_kernel_.OpenAt(GetConfig().getSyscallSandboxDirectory(),
+                                            static_cast<int64_t>(registers_.ReadGpr(10)), path,
+                                            registers_.ReadGpr(12), registers_.ReadGpr(13)));
+      break;
+    }
+    case SYSCALL_CLOSE: {
+      SetSyscallResult(proxy_kernel_.Close(static_cast<int64_t>(registers_.ReadGpr(10))));
+      break;
+    }
+    case SYSCALL_LSEEK: {
+      SetSyscallResult(proxy_kernel_.Seek(static_cast<int64_t>(registers_.ReadGpr(10)),
+                                          static_cast<int64_t>(registers_.ReadGpr(11)), registers_.ReadGpr(12)));
+      break;
+    }
+    case SYSCALL_FSTAT: {
+      proxy_kernel::GuestStat stat;
+      int64_t result = proxy_kernel_.Stat(static_cast<int64_t>(registers_.ReadGpr(10)), stat);
+      if (result == 0) {
+        StoreSyscallBytes(registers_.ReadGpr(11), stat.data(), stat.size());
+      }
+      SetSyscallResult(result);
+      break;
+    }
+    case SYSCALL_CLOCK_GETTIME: {
+      proxy_kernel::GuestTimespec time;
+      int64_t result = proxy_kernel_.ClockGettime(registers_.ReadGpr(10), time);
+      if (result == 0) {
+        StoreSyscallBytes(registers_.ReadGpr(11), time.data(), time.size());
+      }
+      SetSyscallResult(result);
+      break;
+    }
+    case SYSCALL_BRK: {
+      SetSyscallResult(proxy_kernel_.Brk(registers_.ReadGpr(10)));
+      break;
+    }
+    case SYSCALL_MMAP: {
+      const uint64_t length = registers_.ReadGpr(11);
+      int64_t result = proxy_kernel_.Mmap(registers_.ReadGpr(10), length, registers_.ReadGpr(12),
+                                          registers_.ReadGpr(13), static_cast<int64_t>(registers_.ReadGpr(14)),
+                                          registers_.ReadGpr(15));
+      if (result >= 0) {
+        // An anonymous mapping reads as zero, whatever the range held before
+        try {
+          ClearSyscallBytes(static_cast<uint64_t>(result), proxy_kernel::RoundUpToPage(length));
+        } catch (const std::out_of_range &) {
+          proxy_kernel_.Munmap(static_cast<uint64_t>(result), length);
+          result = -ENOMEM;
+        }
+      }
+      SetSyscallResult(result);
+      break;
+    }
+    case SYSCALL_MUNMAP: {
+      SetSyscallResult(proxy_kernel_.Munmap(registers_.ReadGpr(10), registers_.ReadGpr(11)));
+      break;
+    }
     default: {
       std::cerr << "Unknown syscall number: " << syscall_number << std::endl;
       break;
@@ -397,6 +432,33 @@ void RVSSVM::HandleSyscall() {
   }
 }
 
+void RVSSVM::SetSyscallResult(uint64_t value) {
+  uint64_t old_value = registers_.ReadGpr(10);
+  registers_.WriteGpr(10, value);
+  if (old_value != value) {
+    current_delta_.register_changes.push_back({10, 0, old_value, value});
+  }
+}
+
+void RVSSVM::StoreSyscallBytes(uint64_t address, const uint8_t *bytes, size_t size) {
+  std::vector<uint8_t> old_bytes_vec(size, 0);
+  memory_controller_.ReadSegment_d(address, old_bytes_vec.data(), size);
+  memory_controller_.StoreSegment_d(address, bytes, size);
+  current_delta_.memory_changes.push_back({address, std::move(old_bytes_vec), std::vector<uint8_t>(bytes, bytes + size)});
+}
+
+void RVSSVM::ClearSyscallBytes(uint64_t address, uint64_t size) {
+  uint64_t chunk_address = address;
+  memory_controller_.VisitSegment_d(address, size, [&](const uint8_t *data, size_t chunk) {
+    if (std::any_of(data, data + chunk, [](uint8_t byte) { return byte != 0; })) {
+      current_delta_.memory_changes.push_back({chunk_address, std::vector<uint8_t>(data, data + chunk),
+                                               std::vector<uint8_t>(chunk, 0)});
+    }
+    chunk_address += chunk;
+  });
+  memory_controller_.ClearSegment_d(address, size);
+}
+
 void RVSSVM::WriteMemory() {
   uint8_t opcode = current_instruction_ & 0b1111111;
   uint8_t rs2 = (current_instruction_ >> 20) & 0b11111;
@@ -412,6 +474,9 @@ void RVSSVM::WriteMemory() {
   } else if (instruction_set::isDInstruction(current_instruction_)) {
     WriteMemoryDouble();
     return;
+  } else if (opcode == 0b0101111) { // RV64 A
+    WriteMemoryAtomic();
+    return;
   }
 
   if (control_unit_.GetMemRead()) {
@@ -451,48 +516,47 @@ void RVSSVM::WriteMemory() {
   std::vector<uint8_t> old_bytes_vec;
   std::vector<uint8_t> new_bytes_vec;
 
-  // TODO: use direct read to read memory for undo/redo functionality, i.e. ReadByte -> ReadByte_d
-
+  // Undo/redo records read memory directly so that they do not count as cache accesses
 
   if (control_unit_.GetMemWrite()) {
     switch (funct3) {
       case 0b000: {// SB
         addr = execution_result_;
-        old_bytes_vec.push_back(memory_controller_.ReadByte(addr));
+        old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr));
         memory_controller_.WriteByte(execution_result_, registers_.ReadGpr(rs2) & 0xFF);
-        new_bytes_vec.push_back(memory_controller_.ReadByte(addr));
+        new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr));
         break;
       }
       case 0b001: {// SH
         addr = execution_result_;
         for (size_t i = 0; i < 2; ++i) {
-          old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         memory_controller_.WriteHalfWord(execution_result_, registers_.ReadGpr(rs2) & 0xFFFF);
         for (size_t i = 0; i < 2; ++i) {
-          new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         break;
       }
       case 0b010: {// SW
         addr = execution_result_;
         for (size_t i = 0; i < 4; ++i) {
-          old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         memory_controller_.WriteWord(execution_result_, registers_.ReadGpr(rs2) & 0xFFFFFFFF);
         for (size_t i = 0; i < 4; ++i) {
-          new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         break;
       }
       case 0b011: {// SD
         addr = execution_result_;
         for (size_t i = 0; i < 8; ++i) {
-          old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         memory_controller_.WriteDoubleWord(execution_result_, registers_.ReadGpr(rs2) & 0xFFFFFFFFFFFFFFFF);
         for (size_t i = 0; i < 8; ++i) {
-          new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         break;
       }
@@ -524,13 +588,13 @@ void RVSSVM::WriteMemoryFloat() {
   if (control_unit_.GetMemWrite()) { // FSW
     addr = execution_result_;
     for (size_t i = 0; i < 4; ++i) {
-      old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
     uint32_t val = registers_.ReadFpr(rs2) & 0xFFFFFFFF;
     memory_controller_.WriteWord(execution_result_, val);
-    // new_bytes_vec.push_back(memory_controller_.ReadByte(addr));
+    // new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr));
     for (size_t i = 0; i < 4; ++i) {
-      new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
   }
 
@@ -553,11 +617,11 @@ void RVSSVM::WriteMemoryDouble() {
   if (control_unit_.GetMemWrite()) {// FSD
     addr = execution_result_;
     for (size_t i = 0; i < 8; ++i) {
-      old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
     memory_controller_.WriteDoubleWord(execution_result_, registers_.ReadFpr(rs2));
     for (size_t i = 0; i < 8; ++i) {
-      new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
   }
 
@@ -566,6 +630,27 @@ void RVSSVM::WriteMemoryDouble() {
   }
 }
 
+void RVSSVM::WriteMemoryAtomic() {
+  uint8_t rs2 = (current_instruction_ >> 20) & 0b11111;
+  uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
+  uint64_t addr = execution_result_;
+  size_t size = (funct3 == 0b010) ? 4 : 8;
+
+  std::vector<uint8_t> old_bytes_vec;
+  std::vector<uint8_t> new_bytes_vec;
+  for (size_t i = 0; i < size; ++i) {
+    old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
+  }
+  memory_result_ = ExecuteAtomic(current_instruction_, addr, registers_.ReadGpr(rs2));
+  for (size_t i = 0; i < size; ++i) {
+    new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
+  }
+
+  if (old_bytes_vec!=new_bytes_vec) {
+    current_delta_.memory_changes.push_back({addr, old_bytes_vec, new_bytes_vec});
+  }
+}
+
 void RVSSVM::WriteBack() {
   uint8_t opcode = current_instruction_ & 0b1111111;
   uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
@@ -601,7 +686,8 @@ void RVSSVM::WriteBack() {
         registers_.WriteGpr(rd, execution_result_);
         break;
       }
-      case get_instr_encoding(Instruction::kLoadType).opcode: /* Load */ { 
+      case get_instr_encoding(Instruction::kLoadType).opcode: /* Load */
+      case 0b0101111: /* LR, SC, AMOs */ { 
         registers_.WriteGpr(rd, memory_result_);
         break;
       }
@@ -798,17 +884,21 @@ void RVSSVM::WriteBackCsr() {
 
 void RVSSVM::Run() {
   ClearStop();
+  ApplyPendingConfig();
   uint64_t instruction_executed = 0;
 
   while (!stop_requested_ && program_counter_ < program_size_) {
-    if (instruction_executed > vm_config::config.getInstructionExecutionLimit())
+    if (instruction_executed > GetConfig().getInstructionExecutionLimit())
       break;
 
+    CheckpointIfDue();
     Fetch();
     Decode();
     Execute();
     WriteMemory();
     WriteBack();
+    // Nothing is recorded for undo, so the changes are dropped rather than piling up
+    current_delta_ = StepDelta();
     instructions_retired_++;
     instruction_executed++;
     cycle_s_++;
@@ -824,12 +914,14 @@ void RVSSVM::Run() {
 
 void RVSSVM::DebugRun() {
   ClearStop();
+  ApplyPendingConfig();
   uint64_t instruction_executed = 0;
   while (!stop_requested_ && program_counter_ < program_size_) {
-    if (instruction_executed > vm_config::config.getInstructionExecutionLimit())
+    if (instruction_executed > GetConfig().getInstructionExecutionLimit())
       break;
     current_delta_.old_pc = program_counter_;
     if (std::find(breakpoints_.begin(), breakpoints_.end(), program_counter_) == breakpoints_.end()) {
+      CheckpointIfDue();
       Fetch();
       Decode();
       Execute();
@@ -857,7 +949,7 @@ void RVSSVM::DebugRun() {
       DumpRegisters(globals::registers_dump_file_path, registers_);
       DumpState(globals::vm_state_dump_file_path);
 
-      unsigned int delay_ms = vm_config::config.getRunStepDelay();
+      unsigned int delay_ms = GetConfig().getRunStepDelay();
       std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
       
     } else {
@@ -875,8 +967,10 @@ void RVSSVM::DebugRun() {
 }
 
 void RVSSVM::Step() {
+  ApplyPendingConfig();
   current_delta_.old_pc = program_counter_;
   if (program_counter_ < program_size_) {
+    CheckpointIfDue();
     Fetch();
     Decode();
     Execute();
@@ -914,24 +1008,31 @@ void RVSSVM::Step() {
   DumpState(globals::vm_state_dump_file_path);
 }
 
-void RVSSVM::Undo() {
-  if (undo_stack_.empty()) {
-    std::cout << "VM_NO_MORE_UNDO" << std::endl;
-    output_status_ = "VM_NO_MORE_UNDO";
-    return;
-  }
-
-  StepDelta last = undo_stack_.top();
-  undo_stack_.pop();
-
-  // if (!history_.can_undo()) {
-  //     std::cout << "Nothing to undo.\n";
-  //     return;
-  // }
+void RVSSVM::ReplayStep() {
+  Fetch();
+  Decode();
+  Execute();
+  WriteMemory();
+  WriteBack();
+  instructions_retired_++;
+  cycle_s_++;
+  current_delta_ = StepDelta();
+}
 
-  // StepDelta last = history_.undo();
+void RVSSVM::WarmStep() {
+  uint64_t pc = program_counter_;
+  ReplayStep();
+  uint8_t opcode = current_instruction_ & 0b1111111;
+  if (opcode==0b1100011 || opcode==0b1101111 || opcode==0b1100111) {
+    branch_predictor::ResolveRecord predictor_update;
+    branch_predictor::TargetUpdateRecord target_update;
+    // The 5-stage pipeline resolves jumps in decode, one cycle after fetch
+    ResolveControlTransfer(pc, current_instruction_, program_counter_, 1, predictor_update, target_update);
+  }
+}
 
-  for (const auto &change : last.register_changes) {
+void RVSSVM::RevertStep(const StepDelta &delta) {
+  for (const auto &change : delta.register_changes) {
     switch (change.reg_type) {
       case 0: { // GPR
         registers_.WriteGpr(change.reg_index, change.old_value);
@@ -950,13 +1051,62 @@ void RVSSVM::Undo() {
     }
   }
 
-  for (const auto &change : last.memory_changes) {
+  for (const auto &change : delta.memory_changes) {
     for (size_t i = 0; i < change.old_bytes_vec.size(); ++i) {
-      memory_controller_.WriteByte(change.address + i, change.old_bytes_vec[i]);
+      memory_controller_.WriteByte_d(change.address + i, change.old_bytes_vec[i]);
+    }
+  }
+
+  program_counter_ = delta.old_pc;
+}
+
+void RVSSVM::ReapplyStep(const StepDelta &delta) {
+  for (const auto &change : delta.register_changes) {
+    switch (change.reg_type) {
+      case 0: { // GPR
+        registers_.WriteGpr(change.reg_index, change.new_value);
+        break;
+      }
+      case 1: { // CSR
+        registers_.WriteCsr(change.reg_index, change.new_value);
+        break;
+      }
+      case 2: { // FPR
+        registers_.WriteFpr(change.reg_index, change.new_value);
+        break;
+      }
+      default:std::cerr << "Invalid register type: " << change.reg_type << std::endl;
+        break;
+    }
+  }
+
+  for (const auto &change : delta.memory_changes) {
+    for (size_t i = 0; i < change.new_bytes_vec.size(); ++i) {
+      memory_controller_.WriteByte_d(change.address + i, change.new_bytes_vec[i]);
     }
   }
 
-  program_counter_ = last.old_pc;
+  program_counter_ = delta.new_pc;
+}
+
+void RVSSVM::Undo() {
+  if (undo_stack_.empty()) {
+    std::cout << "VM_NO_MORE_UNDO" << std::endl;
+    output_status_ = "VM_NO_MORE_UNDO";
+    return;
+  }
+
+  StepDelta last = undo_stack_.top();
+  undo_stack_.pop();
+
+  // if (!history_.can_undo()) {
+  //     std::cout << "Nothing to undo.\n";
+  //     return;
+  // }
+
+  // StepDelta last = history_.undo();
+
+  RevertStep(last);
   instructions_retired_--;
   cycle_s_--;
   std::cout << "Program Counter: " << program_counter_ << std::endl;
@@ -986,32 +1136,7 @@ void RVSSVM::Redo() {
 
   //   StepDelta next = history_.redo();
 
-  for (const auto &change : next.register_changes) {
-    switch (change.reg_type) {
-      case 0: { // GPR
-        registers_.WriteGpr(change.reg_index, change.new_value);
-        break;
-      }
-      case 1: { // CSR
-        registers_.WriteCsr(change.reg_index, change.new_value);
-        break;
-      }
-      case 2: { // FPR
-        registers_.WriteFpr(change.reg_index, change.new_value);
-        break;
-      }
-      default:std::cerr << "Invalid register type: " << change.reg_type << std::endl;
-        break;
-    }
-  }
-
-  for (const auto &change : next.memory_changes) {
-    for (size_t i = 0; i < change.new_bytes_vec.size(); ++i) {
-      memory_controller_.WriteByte(change.address + i, change.new_bytes_vec[i]);
-    }
-  }
-
-  program_counter_ = next.new_pc;
+  ReapplyStep(next);
   instructions_retired_++;
   cycle_s_++;
   DumpRegisters(globals::registers_dump_file_path, registers_);
@@ -1022,6 +1147,7 @@ void RVSSVM::Redo() {
 }
 
 void RVSSVM::Reset() {
+  ApplyPendingConfig();
   program_counter_ = 0;
   instructions_retired_ = 0;
   cycle_s_ = 0;
@@ -1044,9 +1170,27 @@ void RVSSVM::Reset() {
   current_delta_.new_pc = 0;
   undo_stack_ = std::stack<StepDelta>();
   redo_stack_ = std::stack<StepDelta>();
-
+  ClearHistory();
 }
 
+std::any RVSSVM::SaveCoreState() const {
+  return CoreState{control_unit_, execution_result_, memory_result_, return_address_, branch_flag_, next_pc_,
+                   csr_target_address_, csr_old_value_, csr_write_val_, csr_uimm_};
+}
 
-
-
+void RVSSVM::RestoreCoreState(const std::any &state) {
+  const auto &core = std::any_cast<const CoreState &>(state);
+  control_unit_ = core.control_unit;
+  execution_result_ = core.execution_result;
+  memory_result_ = core.memory_result;
+  return_address_ = core.return_address;
+  branch_flag_ = core.branch_flag;
+  next_pc_ = core.next_pc;
+  csr_target_address_ = core.csr_target_address;
+  csr_old_value_ = core.csr_old_value;
+  csr_write_val_ = core.csr_write_val;
+  csr_uimm_ = core.csr_uimm;
+  current_delta_ = StepDelta();
+  undo_stack_ = std::stack<StepDelta>();
+  redo_stack_ = std::stack<StepDelta>();
+}
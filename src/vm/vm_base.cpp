@@ -5,9 +5,11 @@
  */
 
 #include "vm/vm_base.h"
+#include "assembler/elf_util.h"
 
 #include "globals.h"
 #include "config.h"
+#include "utils.h"
 
 #include <cstdint>
 #include <iostream>
@@ -15,68 +17,364 @@
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
+#include <bit>
 #include <cstring>
 #include <thread>
 
 
+VmBase::VmBase(vm_config::ConfigSnapshot config)
+    : memory_controller_(*config), config_(std::move(config)) {}
+
+void VmBase::Reconfigure(vm_config::ConfigSnapshot config) {
+  pending_config_.store(std::move(config));
+  config_pending_.store(true, std::memory_order_release);
+}
+
+void VmBase::ApplyPendingConfig() {
+  if (!config_pending_.load(std::memory_order_acquire)) {
+    return;
+  }
+  config_pending_.store(false, std::memory_order_relaxed);
+  // A Reconfigure() racing with this leaves the flag set again, and its config for next time
+  if (vm_config::ConfigSnapshot config = pending_config_.exchange(nullptr)) {
+    config_ = std::move(config);
+  }
+}
+
+cache::CacheConfig VmBase::CacheConfigFromVmConfig(const vm_config::VmConfig &config) {
+  cache::CacheConfig cache_config;
+  cache_config.cache_enabled = config.getCacheEnabled();
+  cache_config.lines = config.getNumberOfLines();
+  cache_config.block_size = config.getCacheBlockSize();
+  cache_config.associativity = config.getCacheAssociativity();
+
+  std::string rep_str = config.getCacheReplacementPolicy();
+  if (rep_str == "LRU") {
+    cache_config.replacement_policy = cache::ReplacementPolicy::LRU;
+  } else if (rep_str == "FIFO") {
+    cache_config.replacement_policy = cache::ReplacementPolicy::FIFO;
+  } else if (rep_str == "Random") {
+    cache_config.replacement_policy = cache::ReplacementPolicy::Random;
+  } else {
+    // Default fallback
+    cache_config.replacement_policy = cache::ReplacementPolicy::LRU;
+  }
+
+  std::string miss_str = config.getCacheWriteMissPolicy();
+  if (miss_str == "write_allocate") {
+    cache_config.write_miss_policy = cache::WriteMissPolicy::WriteAllocate;
+  } else {
+    cache_config.write_miss_policy = cache::WriteMissPolicy::NoWriteAllocate;
+  }
+  return cache_config;
+}
+
+branch_predictor::BranchPredictorConfig VmBase::PredictorConfigFromVmConfig(const vm_config::VmConfig &config) {
+  branch_predictor::BranchPredictorConfig predictor_config;
+  predictor_config.one_bit_table_size = config.getOneBitTableSize();
+  predictor_config.bimodal_table_size = config.getBimodalTableSize();
+  predictor_config.gshare_table_size = config.getGshareTableSize();
+  predictor_config.gshare_history_bits = config.getGshareHistoryBits();
+  predictor_config.chooser_table_size = config.getChooserTableSize();
+  predictor_config.tage_table_size = config.getTageTableSize();
+  predictor_config.tage_num_tables = config.getTageNumTables();
+  predictor_config.tage_min_history = config.getTageMinHistory();
+  predictor_config.tage_max_history = config.getTageMaxHistory();
+  return predictor_config;
+}
+
+void VmBase::ResetBranchPredictors() {
+  branch_predictor_.Initialize(PredictorConfigFromVmConfig(*config_));
+  branch_predictor_.Reset();
+
+  branch_predictor::TargetPredictorConfig target_config;
+  target_config.btb_enabled = config_->getBtbEnabled();
+  target_config.btb_entries = config_->getBtbEntries();
+  target_config.btb_associativity = config_->getBtbAssociativity();
+  target_config.ras_enabled = config_->getRasEnabled();
+  target_config.ras_size = config_->getRasSize();
+
+  target_predictor_.Initialize(target_config);
+  target_predictor_.Reset();
+}
+
+VmSnapshot VmBase::TakeSnapshot() const {
+  VmSnapshot snapshot;
+  snapshot.program_counter = program_counter_;
+  snapshot.current_instruction = current_instruction_;
+  snapshot.cycle_s = cycle_s_;
+  snapshot.instructions_retired = instructions_retired_;
+  snapshot.cpi = cpi_;
+  snapshot.ipc = ipc_;
+  snapshot.stall_cycles = stall_cycles_;
+  snapshot.branch_mispredictions = branch_mispredictions_;
+  snapshot.forwarding_events = forwarding_events_;
+  snapshot.num_branches = num_branches_;
+  snapshot.output_status = output_status_;
+  snapshot.registers = registers_;
+  snapshot.memory = memory_controller_.Snapshot();
+  snapshot.alu = alu_;
+  snapshot.branch_predictor = branch_predictor_.SaveState();
+  snapshot.target_predictor = target_predictor_;
+  snapshot.proxy_kernel = proxy_kernel_.SaveState();
+  snapshot.core = SaveCoreState();
+  return snapshot;
+}
+
+void VmBase::RestoreSnapshot(const VmSnapshot &snapshot) {
+  ApplySnapshot(snapshot);
+  ClearHistory();
+}
+
+void VmBase::ApplySnapshot(const VmSnapshot &snapshot) {
+  program_counter_ = snapshot.program_counter;
+  current_instruction_ = snapshot.current_instruction;
+  cycle_s_ = snapshot.cycle_s;
+  instructions_retired_ = snapshot.instructions_retired;
+  cpi_ = snapshot.cpi;
+  ipc_ = snapshot.ipc;
+  stall_cycles_ = snapshot.stall_cycles;
+  branch_mispredictions_ = snapshot.branch_mispredictions;
+  forwarding_events_ = snapshot.forwarding_events;
+  num_branches_ = snapshot.num_branches;
+  output_status_ = snapshot.output_status;
+  registers_ = snapshot.registers;
+  memory_controller_.Restore(snapshot.memory);
+  alu_ = snapshot.alu;
+  branch_predictor_.RestoreState(snapshot.branch_predictor);
+  target_predictor_ = snapshot.target_predictor;
+  proxy_kernel_.RestoreState(snapshot.proxy_kernel);
+  RestoreCoreState(snapshot.core);
+}
+
+void VmBase::ClearHistory() {
+  ApplyPendingConfig();
+  checkpoints_.clear();
+  checkpoint_interval_ = config_->getCheckpointInterval();
+  input_log_.clear();
+  input_position_ = 0;
+  proxy_kernel_.ClearReplies();
+}
+
+void VmBase::AddCheckpoint() {
+  checkpoints_.push_back({StepCount(), input_position_, proxy_kernel_.ReplyPosition(), TakeSnapshot()});
+  if (checkpoints_.size() > config_->getMaxCheckpoints()) {
+    // Keep the oldest and every second one after it, which leaves them twice as far apart
+    size_t kept = 1;
+    for (size_t index = 2; index < checkpoints_.size(); index += 2) {
+      checkpoints_[kept++] = std::move(checkpoints_[index]);
+    }
+    checkpoints_.resize(kept);
+    checkpoint_interval_ *= 2;
+  }
+}
+
+void VmBase::CheckpointIfDue() {
+  if (replaying_) {
+    return;
+  }
+  // Steps before the newest checkpoint, after going back, have been recorded already
+  if (checkpoints_.empty() || StepCount() >= checkpoints_.back().step + checkpoint_interval_) {
+    AddCheckpoint();
+  }
+}
+
+void VmBase::TruncateHistory() {
+  const uint64_t step = StepCount();
+  while (!checkpoints_.empty() && checkpoints_.back().step >= step) {
+    checkpoints_.pop_back();
+  }
+  input_log_.resize(input_position_);
+  proxy_kernel_.TruncateReplies();
+  AddCheckpoint();
+}
+
+uint64_t VmBase::RestoreCheckpoint(uint64_t step) {
+  auto checkpoint = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), step,
+                                     [](uint64_t target, const Checkpoint &c) { return target < c.step; }) - 1;
+  ApplySnapshot(checkpoint->snapshot);
+  input_position_ = checkpoint->input_position;
+  proxy_kernel_.RewindReplies(checkpoint->host_reply_position);
+  return checkpoint->step;
+}
+
+void VmBase::ReplayTo(uint64_t step) {
+  RestoreCheckpoint(step);
+  // The output of these steps was printed when they first ran
+  ConsoleMute mute;
+  replaying_ = true;
+  while (StepCount() < step) {
+    ReplayStep();
+  }
+  replaying_ = false;
+}
+
+void VmBase::ReverseStep(uint64_t n) {
+  const uint64_t step = StepCount();
+  if (checkpoints_.empty() || step <= checkpoints_.front().step) {
+    std::cout << "VM_NO_MORE_REVERSE" << std::endl;
+    output_status_ = "VM_NO_MORE_REVERSE";
+    return;
+  }
+  ReplayTo(std::max(checkpoints_.front().step, step - std::min(step, n)));
+
+  std::cout << "Program Counter: " << program_counter_ << std::endl;
+  std::cout << "VM_REVERSE_STEP_COMPLETED" << std::endl;
+  output_status_ = "VM_REVERSE_STEP_COMPLETED";
+  DumpRegisters(globals::registers_dump_file_path, registers_);
+  DumpState(globals::vm_state_dump_file_path);
+  DumpCoreState();
+}
+
+void VmBase::ReverseContinue() {
+  const uint64_t step = StepCount();
+  if (checkpoints_.empty() || step <= checkpoints_.front().step) {
+    std::cout << "VM_NO_MORE_REVERSE" << std::endl;
+    output_status_ = "VM_NO_MORE_REVERSE";
+    return;
+  }
+
+  // Re-execute one checkpoint interval at a time, newest first, until one holds a breakpoint;
+  // the last one in it is the target. The end-of-program breakpoint is not a stopping point.
+  uint64_t target = checkpoints_.front().step;
+  bool found = false;
+  for (uint64_t end = step; !found && end > checkpoints_.front().step;) {
+    const uint64_t start = RestoreCheckpoint(end - 1);
+    ConsoleMute mute;
+    replaying_ = true;
+    while (true) {
+      if (program_counter_ < program_size_ && CheckBreakpoint(program_counter_)) {
+        target = StepCount();
+        found = true;
+      }
+      if (StepCount() + 1 >= end) {
+        break;
+      }
+      ReplayStep();
+    }
+    replaying_ = false;
+    end = start;
+  }
+  ReplayTo(target);
+
+  std::cout << "Program Counter: " << program_counter_ << std::endl;
+  if (found) {
+    std::cout << "VM_BREAKPOINT_HIT " << program_counter_ << std::endl;
+    output_status_ = "VM_BREAKPOINT_HIT";
+  } else {
+    std::cout << "VM_REVERSE_START_REACHED" << std::endl;
+    output_status_ = "VM_REVERSE_START_REACHED";
+  }
+  DumpRegisters(globals::registers_dump_file_path, registers_);
+  DumpState(globals::vm_state_dump_file_path);
+  DumpCoreState();
+}
+
+bool VmBase::GetSteeringPredictor(branch_predictor::PredictorKind &kind) const {
+  switch (config_->getBranchPredictionType()) {
+    case vm_config::BranchPredictionType::DYNAMIC1BIT:
+      kind = branch_predictor::PredictorKind::OneBit;
+      return true;
+    case vm_config::BranchPredictionType::DYNAMIC2BIT:
+      kind = branch_predictor::PredictorKind::Bimodal;
+      return true;
+    case vm_config::BranchPredictionType::GSHARE:
+      kind = branch_predictor::PredictorKind::Gshare;
+      return true;
+    case vm_config::BranchPredictionType::TOURNAMENT:
+      kind = branch_predictor::PredictorKind::Tournament;
+      return true;
+    case vm_config::BranchPredictionType::TAGE:
+      kind = branch_predictor::PredictorKind::Tage;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool VmBase::ResolveControlTransfer(uint64_t pc, uint32_t instruction, uint64_t next_pc, unsigned int flush_penalty,
+                                    branch_predictor::ResolveRecord &predictor_update,
+                                    branch_predictor::TargetUpdateRecord &target_update) {
+  uint8_t opcode = instruction & 0b1111111;
+  uint8_t rd = (instruction >> 7) & 0b11111;
+  uint8_t rs1 = (instruction >> 15) & 0b11111;
+  bool taken = (next_pc != pc + 4);
+  vm_config::BranchPredictionType bp_type = config_->getBranchPredictionType();
+
+  num_branches_++;
+  if (bp_type == vm_config::BranchPredictionType::NONE) {
+    // Every taken transfer redirects fetch, and none of them counts as a misprediction
+    return taken;
+  }
+
+  bool mispredicted = false;
+  if (opcode == 0b1100011) {
+    uint64_t taken_target = pc + static_cast<int64_t>(ImmGenerator(instruction));
+    bool predicted_taken = false;
+    if (bp_type == vm_config::BranchPredictionType::STATIC) {
+      predicted_taken = (taken_target < pc);
+    } else {
+      branch_predictor::PredictorKind kind;
+      if (GetSteeringPredictor(kind)) {
+        predicted_taken = branch_predictor_.Predict(kind, pc, taken_target);
+      }
+    }
+    mispredicted = (predicted_taken != taken);
+    predictor_update = branch_predictor_.Resolve(pc, taken_target, taken);
+  } else if (opcode == 0b1101111) {
+    // The jal target is known as soon as the instruction is decoded in fetch
+    target_update = target_predictor_.Resolve(pc, next_pc, false, rd, rs1,
+                                              branch_predictor::TargetSource::None, 0, 0);
+  } else {
+    uint64_t predicted_target = 0;
+    branch_predictor::TargetSource source =
+        target_predictor_.Predict(pc, branch_predictor::IsReturn(true, rd, rs1), predicted_target);
+    mispredicted = (source == branch_predictor::TargetSource::None) || (predicted_target != next_pc);
+    target_update = target_predictor_.Resolve(pc, next_pc, true, rd, rs1, source, predicted_target, flush_penalty);
+  }
+
+  if (mispredicted) {
+    branch_mispredictions_++;
+  }
+  return mispredicted;
+}
+
+static_assert(std::endian::native==std::endian::little, "Text words are copied into guest memory in host byte order");
+
 void VmBase::LoadProgram(const AssembledProgram &program) {
   program_ = program;
-  unsigned int counter = 0;
-  for (const auto &instruction: program.text_buffer) {
-    memory_controller_.WriteWord_d(counter, instruction);
-      counter += 4;
+  if (program.segments.empty()) {
+    // Both sections are already laid out, so they are copied a memory block at a time
+    memory_controller_.LoadSegment_d(0, reinterpret_cast<const uint8_t *>(program.text_buffer.data()),
+                                     program.text_buffer.size()*sizeof(uint32_t));
+    program_size_ = program.text_buffer.size()*4;
+
+    memory_controller_.LoadSegment_d(config_->getDataSectionStart(), program.data_image.data(),
+                                     program.data_image.size());
+    proxy_kernel_.Reset(config_->getDataSectionStart() + program.data_image.size());
+  } else {
+    // An ELF executable: the program ends when control leaves the highest executable segment
+    static const std::vector<uint8_t> zeros(4096, 0);
+    program_size_ = 0;
+    uint64_t program_break = 0;
+    for (const ProgramSegment &segment : program.segments) {
+      program_break = std::max(program_break, segment.address + segment.memory_size);
+      memory_controller_.LoadSegment_d(segment.address, segment.bytes.data(), segment.bytes.size());
+      for (uint64_t filled = segment.bytes.size(); filled < segment.memory_size; filled += zeros.size()) {
+        memory_controller_.LoadSegment_d(segment.address + filled, zeros.data(),
+                                         std::min<uint64_t>(zeros.size(), segment.memory_size - filled));
+      }
+      if (segment.executable) {
+        program_size_ = std::max(program_size_, segment.address + segment.memory_size);
+      }
+    }
+    registers_.WriteGpr(2, kElfStackTop);
+    proxy_kernel_.Reset(program_break);
   }
-  program_size_ = counter;
+  program_counter_ = program.entry_point;
   AddBreakpoint(program_size_, false);  // address
+  ClearHistory();
 
-  unsigned int data_counter = 0;
-  uint64_t base_data_address = vm_config::config.getDataSectionStart();
-  auto align = [&](unsigned int alignment) {
-    if (data_counter % alignment != 0)
-      data_counter += alignment - (data_counter % alignment);
-  };
-  for (const auto& data : program.data_buffer) {
-    std::visit([&](auto&& value) {
-      using T = std::decay_t<decltype(value)>; 
-      
-
-      if constexpr (std::is_same_v<T, uint8_t>) {
-        align(1);
-        memory_controller_.WriteByte_d(base_data_address + data_counter, value);  // Write a byte
-        data_counter += 1;
-      } else if constexpr (std::is_same_v<T, uint16_t>) {
-        align(2);
-        memory_controller_.WriteHalfWord_d(base_data_address + data_counter, value);  // Write a halfword (16 bits)
-        data_counter += 2;
-      } else if constexpr (std::is_same_v<T, uint32_t>) {
-        align(4);
-        memory_controller_.WriteWord_d(base_data_address + data_counter, value);  // Write a word (32 bits)
-        data_counter += 4;
-      } else if constexpr (std::is_same_v<T, uint64_t>) {
-        align(8);
-        memory_controller_.WriteDoubleWord_d(base_data_address + data_counter, value);  // Write a double word (64 bits)
-        data_counter += 8;
-      } else if constexpr (std::is_same_v<T, float>) {
-        align(4);
-        uint32_t float_as_int;
-        std::memcpy(&float_as_int, &value, sizeof(float));
-        memory_controller_.WriteWord_d(base_data_address + data_counter, float_as_int);  // Write the float as a word
-        data_counter += 4;
-      } else if constexpr (std::is_same_v<T, double>) {
-        align(8);
-        uint64_t double_as_int;
-        std::memcpy(&double_as_int, &value, sizeof(double));
-        memory_controller_.WriteDoubleWord_d(base_data_address + data_counter, double_as_int);  // Write the double as a double word
-        data_counter += 8;
-      } else if constexpr (std::is_same_v<T, std::string>) {
-        align(1);
-        for (size_t i = 0; i < value.size(); i++) {
-          memory_controller_.WriteByte_d(base_data_address + data_counter, static_cast<uint8_t>(value[i]));  // Write each byte of the string
-          data_counter += 1;
-        }
-      }
-    }, data);
-  }
   std::cout << "VM_PROGRAM_LOADED" << std::endl;
   output_status_ = "VM_PROGRAM_LOADED";
 
@@ -85,6 +383,28 @@ void VmBase::LoadProgram(const AssembledProgram &program) {
 
 }
 
+void VmBase::UpdateProgram(const AssembledProgram &program, const std::vector<unsigned int> &changed_words) {
+    for (unsigned int index : changed_words) {
+        memory_controller_.WriteWord_d(static_cast<uint64_t>(index)*4, program.text_buffer[index]);
+    }
+    memory_controller_.LoadSegment_d(config_->getDataSectionStart(), program.data_image.data(),
+                                     program.data_image.size());
+    proxy_kernel_.Reset(config_->getDataSectionStart() + program.data_image.size());
+
+    // The end of the program moves with its size
+    breakpoints_.erase(std::remove(breakpoints_.begin(), breakpoints_.end(), program_size_), breakpoints_.end());
+    program_ = program;
+    program_size_ = program.text_buffer.size()*4;
+    program_counter_ = program.entry_point;
+    AddBreakpoint(program_size_, false);  // address
+    ClearHistory();
+
+    std::cout << "VM_PROGRAM_LOADED" << std::endl;
+    output_status_ = "VM_PROGRAM_LOADED";
+
+    DumpState(globals::vm_state_dump_file_path);
+}
+
 uint64_t VmBase::GetProgramCounter() const {
     return program_counter_;
 }
@@ -232,29 +552,131 @@ void VmBase::RemoveBreakpoint(uint64_t val, bool is_line) {
 
 }
 
+void VmBase::AddBreakpoint(const std::string &symbol) {
+    auto it = program_.symbol_table.find(symbol);
+    if (it == program_.symbol_table.end() || it->second.isData) {
+        std::cerr << "Invalid text symbol: " << symbol << std::endl;
+        return;
+    }
+    AddBreakpoint(it->second.address, false);
+}
+
+void VmBase::RemoveBreakpoint(const std::string &symbol) {
+    auto it = program_.symbol_table.find(symbol);
+    if (it == program_.symbol_table.end() || it->second.isData) {
+        std::cerr << "Invalid text symbol: " << symbol << std::endl;
+        return;
+    }
+    RemoveBreakpoint(it->second.address, false);
+}
+
 bool VmBase::CheckBreakpoint(uint64_t address) {
     return std::find(breakpoints_.begin(), breakpoints_.end(), address) != breakpoints_.end();
 }
 
 
 void VmBase::PrintString(uint64_t address) {
-    while (true) {
-        char c = memory_controller_.ReadByte_d(address);
-        if (c == '\0') break;
-        std::cout << c;
-        address++;
+    WriteGuestBuffer(std::cout, address, memory_controller_.StringLength_d(address));
+}
+
+void VmBase::WriteGuestBuffer(std::ostream &stream, uint64_t address, uint64_t length) {
+    memory_controller_.VisitSegment_d(address, length, [&stream](const uint8_t *data, size_t size) {
+        stream.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+    });
+}
+
+uint64_t VmBase::AtomicOperation(uint32_t instruction, uint64_t old_value, uint64_t value) {
+    const uint8_t funct5 = (instruction >> 27) & 0b11111;
+    const bool word = ((instruction >> 12) & 0b111) == 0b010;
+    // .w operates on the low 32 bits, sign-extended so signed and unsigned compares work on 64 bits
+    const uint64_t operand = word ? static_cast<uint64_t>(static_cast<int32_t>(value)) : value;
+    const uint64_t unsigned_old = word ? static_cast<uint32_t>(old_value) : old_value;
+    const uint64_t unsigned_operand = word ? static_cast<uint32_t>(operand) : operand;
+
+    switch (funct5) {
+        case 0b00001: return operand; // AMOSWAP
+        case 0b00000: return old_value + operand; // AMOADD
+        case 0b00100: return old_value ^ operand; // AMOXOR
+        case 0b01100: return old_value & operand; // AMOAND
+        case 0b01000: return old_value | operand; // AMOOR
+        case 0b10000: // AMOMIN
+            return std::min(static_cast<int64_t>(old_value), static_cast<int64_t>(operand));
+        case 0b10100: // AMOMAX
+            return std::max(static_cast<int64_t>(old_value), static_cast<int64_t>(operand));
+        case 0b11000: return std::min(unsigned_old, unsigned_operand); // AMOMINU
+        case 0b11100: return std::max(unsigned_old, unsigned_operand); // AMOMAXU
+        default: return old_value;
+    }
+}
+
+uint64_t VmBase::ExecuteAtomic(uint32_t instruction, uint64_t address, uint64_t value) {
+    if (atomic_port_) {
+        return atomic_port_->Execute(*this, instruction, address, value);
     }
+    return ExecuteAtomicLocally(instruction, address, value);
+}
+
+uint64_t VmBase::ExecuteAtomicLocally(uint32_t instruction, uint64_t address, uint64_t value) {
+    const uint8_t funct5 = (instruction >> 27) & 0b11111;
+    const bool word = ((instruction >> 12) & 0b111) == 0b010;
+
+    if (funct5 == 0b00010) { // LR
+        uint64_t loaded = word ? static_cast<uint64_t>(static_cast<int32_t>(memory_controller_.ReadWord(address)))
+                               : memory_controller_.ReadDoubleWord(address);
+        memory_controller_.Reserve(address);
+        return loaded;
+    }
+
+    if (funct5 == 0b00011) { // SC
+        if (!memory_controller_.ConsumeReservation(address)) {
+            return 1;
+        }
+        if (word) {
+            memory_controller_.WriteWord(address, static_cast<uint32_t>(value));
+        } else {
+            memory_controller_.WriteDoubleWord(address, value);
+        }
+        return 0;
+    }
+
+    // AMOs read and write the location as one access; the write probe brings the line in Modified
+    const uint64_t old_value = word
+        ? static_cast<uint64_t>(static_cast<int32_t>(memory_controller_.ReadWord_d(address)))
+        : memory_controller_.ReadDoubleWord_d(address);
+    const uint64_t result = AtomicOperation(instruction, old_value, value);
+    if (word) {
+        memory_controller_.WriteWord(address, static_cast<uint32_t>(result));
+    } else {
+        memory_controller_.WriteDoubleWord(address, result);
+    }
+    return old_value;
 }
 
 void VmBase::DumpState(const std::filesystem::path &filename) {
+    if (filename.empty()) {
+        return;
+    }
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error opening file for dumping VM state: " << filename.string() << std::endl;
         return;
     }
 
+    // Looked up without inserting, since the pc can be anywhere, past the program included
+    auto lookup = [](const std::map<unsigned int, unsigned int> &mapping, unsigned int key) {
+        auto entry = mapping.find(key);
+        return entry == mapping.end() ? 0u : entry->second;
+    };
     unsigned int instruction_number = program_counter_ / 4;
-    unsigned int current_line = program_.instruction_number_line_number_mapping[instruction_number];
+    unsigned int current_line = lookup(program_.instruction_number_line_number_mapping, instruction_number);
+    std::string current_file = program_.filename;
+    auto source = std::upper_bound(program_.source_files.begin(), program_.source_files.end(), instruction_number,
+                                   [](unsigned int instruction, const std::pair<unsigned int, std::string> &file) {
+                                       return instruction < file.first;
+                                   });
+    if (source != program_.source_files.begin()) {
+        current_file = std::prev(source)->second;
+    }
 
     file << "{\n";
     file << "    \"program_counter\": " << "\"0x" 
@@ -263,12 +685,13 @@ void VmBase::DumpState(const std::filesystem::path &filename) {
          << std::dec << std::setfill(' ') 
          << "\",\n";
     file << "    \"current_line\": " << current_line << ",\n";
+    file << "    \"current_file\": " << JsonString(current_file) << ",\n";
     file << "    \"current_instruction\": " << "\"0x" 
          << std::hex << std::setw(8) << std::setfill('0') 
          << current_instruction_ 
          << std::dec << std::setfill(' ') 
          << "\",\n";
-    file << "    \"disassembly_line_number\": " << program_.instruction_number_disassembly_mapping[instruction_number] << ",\n";
+    file << "    \"disassembly_line_number\": " << lookup(program_.instruction_number_disassembly_mapping, instruction_number) << ",\n";
     file << "    \"cycle_count\": " << cycle_s_ << ",\n";
     file << "    \"instructions_retired\": " << instructions_retired_ << ",\n";
     file << "    \"cpi\": " << cpi_ << ",\n";
@@ -279,10 +702,36 @@ void VmBase::DumpState(const std::filesystem::path &filename) {
     file << "    \"misprediction_rate\": " 
          << ((num_branches_ > 0) ? ((static_cast<double>(branch_mispredictions_) / static_cast<double>(num_branches_)) * 100.0) : 0.0) 
          << ",\n";
+    file << "    \"branch_predictors\": {";
+    const auto &predictors = branch_predictor_.GetPredictors();
+    for (size_t i = 0; i < predictors.size(); ++i) {
+        const branch_predictor::PredictorStats &stats = predictors[i]->GetStats();
+        file << "\n        \"" << predictors[i]->GetName() << "\": {"
+             << "\"predictions\": " << stats.predictions << ", "
+             << "\"correct\": " << stats.correct << ", "
+             << "\"accuracy\": "
+             << ((stats.predictions > 0) ? (static_cast<double>(stats.correct) / static_cast<double>(stats.predictions)) * 100.0 : 0.0)
+             << "}";
+        if (i < predictors.size() - 1) {
+            file << ",";
+        }
+    }
+    file << (predictors.empty() ? "" : "\n    ") << "},\n";
+    const branch_predictor::TargetPredictorStats &target_stats = target_predictor_.GetStats();
+    file << "    \"target_predictor\": {"
+         << "\"btb_lookups\": " << target_stats.btb_lookups << ", "
+         << "\"btb_hits\": " << target_stats.btb_hits << ", "
+         << "\"btb_hit_rate\": "
+         << ((target_stats.btb_lookups > 0) ? (static_cast<double>(target_stats.btb_hits) / static_cast<double>(target_stats.btb_lookups)) * 100.0 : 0.0) << ", "
+         << "\"ras_lookups\": " << target_stats.ras_lookups << ", "
+         << "\"ras_hits\": " << target_stats.ras_hits << ", "
+         << "\"ras_hit_rate\": "
+         << ((target_stats.ras_lookups > 0) ? (static_cast<double>(target_stats.ras_hits) / static_cast<double>(target_stats.ras_lookups)) * 100.0 : 0.0) << ", "
+         << "\"cycles_saved\": " << target_stats.cycles_saved
+         << "},\n";
     file << "    \"breakpoints\": [";
     for (size_t i = 0; i < breakpoints_.size(); ++i) {
-        program_.instruction_number_line_number_mapping[breakpoints_[i] / 4];
-        file << program_.instruction_number_line_number_mapping[breakpoints_[i] / 4];
+        file << lookup(program_.instruction_number_line_number_mapping, static_cast<unsigned int>(breakpoints_[i] / 4));
         if (i < breakpoints_.size() - 1) {
             file << ", ";
         }
@@ -295,6 +744,9 @@ void VmBase::DumpState(const std::filesystem::path &filename) {
 }
 
 void VmBase::DumpCacheState(const std::filesystem::path &filename) {
+    if (filename.empty()) {
+        return;
+    }
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error opening file for dumping VM state: " << filename.string() << std::endl;
@@ -315,4 +767,35 @@ void VmBase::DumpCacheState(const std::filesystem::path &filename) {
 
 void VmBase::ModifyRegister(const std::string &reg_name, uint64_t value) {
     registers_.ModifyRegister(reg_name, value);
+    TruncateHistory();
+}
+
+std::string VmBase::ReadInput() {
+    if (input_position_ < input_log_.size()) {
+        return input_log_[input_position_++];
+    }
+
+    std::string input;
+    if (empty_input_when_idle_) {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        if (!input_queue_.empty()) {
+            input = input_queue_.front();
+            input_queue_.pop();
+        }
+    } else {
+        std::cout << "VM_STDIN_START" << std::endl;
+        output_status_ = "VM_STDIN_START";
+        std::unique_lock<std::mutex> lock(input_mutex_);
+        input_cv_.wait(lock, [this]() {
+            return !input_queue_.empty();
+        });
+        output_status_ = "VM_STDIN_END";
+        std::cout << "VM_STDIN_END" << std::endl;
+
+        input = input_queue_.front();
+        input_queue_.pop();
+    }
+    input_log_.push_back(input);
+    input_position_++;
+    return input;
 }
\ No newline at end of file
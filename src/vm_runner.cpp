@@ -5,4 +5,27 @@
  */
 
 #include "vm_runner.h"
+#include "vm/rv5s/rv5s_vm.h"
+#include "vm/rvio/rvio_vm.h"
+#include "vm/rvooo/rvooo_vm.h"
+
+#include <iostream>
+
+std::unique_ptr<VmBase> createVMInstance(vm_config::VmTypes vmType) {
+
+  if (vmType == vm_config::VmTypes::SINGLE_STAGE) {
+    std::cout << "Initializing Single-Stage VM..." << std::endl;
+    return std::make_unique<RVSSVM>();
+  } else if (vmType == vm_config::VmTypes::IN_ORDER) {
+    std::cout << "Initializing In-Order Pipeline VM..." << std::endl;
+    return std::make_unique<RVIOVM>();
+  } else if (vmType == vm_config::VmTypes::OUT_OF_ORDER) {
+    std::cout << "Initializing Out-of-Order VM..." << std::endl;
+    return std::make_unique<RVOOOVM>();
+  } else {
+    std::cout << "Initializing 5-Stage VM..." << std::endl;
+    return std::make_unique<RV5SVM>();
+  }
+
+}
 
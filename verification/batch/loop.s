@@ -0,0 +1,9 @@
+# Sums 1..50 in a loop, long enough that a small cycle limit stops it part way
+.text
+    li t0, 50
+    li t1, 0
+loop:
+    add t1, t1, t0
+    addi t0, t0, -1
+    bne t0, zero, loop
+    mv a0, t1
@@ -0,0 +1,78 @@
+# Maps memory and writes, reads, stats and times a file, leaving what each call returned in
+# s1-s9, so that test_reverse.sh can check re-executed calls give the answers they gave first
+.data
+name: .string "log.txt"
+message: .string "replayed"
+
+.text
+    li a7, 222             # mmap
+    li a0, 0
+    li a1, 4096
+    li a2, 3               # PROT_READ|PROT_WRITE
+    li a3, 0x22            # MAP_PRIVATE|MAP_ANONYMOUS
+    li a4, -1
+    li a5, 0
+    ecall
+    mv s1, a0
+    li t0, 42
+    sd t0, 0(s1)
+
+    li a7, 56              # openat
+    li a0, -100            # AT_FDCWD
+    la a1, name
+    li a2, 0x242           # O_RDWR|O_CREAT|O_TRUNC
+    li a3, 420             # 0644
+    ecall
+    mv s2, a0
+
+    li a7, 64              # write
+    mv a0, s2
+    la a1, message
+    li a2, 8
+    ecall
+    mv s3, a0
+
+    li a7, 62              # lseek back to the start
+    mv a0, s2
+    li a1, 0
+    li a2, 0               # SEEK_SET
+    ecall
+
+    li a7, 63              # read what was written into the mapping
+    mv a0, s2
+    addi a1, s1, 8
+    li a2, 8
+    ecall
+    mv s4, a0
+    ld s5, 8(s1)
+
+    li a7, 80              # fstat
+    mv a0, s2
+    addi a1, s1, 64
+    ecall
+    ld s6, 112(s1)         # st_size
+
+    li a7, 113             # clock_gettime
+    li a0, 1               # CLOCK_MONOTONIC
+    addi a1, s1, 256
+    ecall
+    ld s7, 264(s1)         # tv_nsec
+
+    li a7, 57              # close
+    mv a0, s2
+    ecall
+
+    li a7, 222             # a second mapping, below the first
+    li a0, 0
+    li a1, 4096
+    li a2, 3
+    li a3, 0x22
+    li a4, -1
+    li a5, 0
+    ecall
+    mv s8, a0
+
+    li a7, 214             # brk
+    li a0, 0
+    ecall
+    mv s9, a0
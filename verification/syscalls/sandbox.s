@@ -0,0 +1,42 @@
+# Opens files that must stay inside the sandbox. test_sandbox.sh lays the sandbox out with
+# "dangling" -> ../escaped.txt (which does not exist yet) and "outside" -> .. and checks
+# the results left in s1-s5 (-13 is EACCES)
+.data
+dangling: .string "dangling"
+created:  .string "created.txt"
+dotdot:   .string "../escaped.txt"
+through:  .string "outside/escaped.txt"
+rooted:   .string "/sub/../created.txt"
+
+.text
+    li a7, 56              # openat
+    li a0, -100            # AT_FDCWD
+    la a1, dangling
+    li a2, 0x241           # O_WRONLY|O_CREAT|O_TRUNC
+    li a3, 420             # 0644
+    ecall
+    mv s1, a0              # EACCES: the link is never followed, even to create its target
+
+    li a0, -100
+    la a1, created
+    li a2, 0x241
+    ecall
+    mv s2, a0              # 3: a new file inside the sandbox
+
+    li a0, -100
+    la a1, dotdot
+    li a2, 0x241
+    ecall
+    mv s3, a0              # EACCES
+
+    li a0, -100
+    la a1, through
+    li a2, 0x241
+    ecall
+    mv s4, a0              # EACCES
+
+    li a0, -100
+    la a1, rooted
+    li a2, 0               # O_RDONLY
+    ecall
+    mv s5, a0              # 4: ".." that stays inside is fine
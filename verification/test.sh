@@ -102,9 +102,13 @@ modes["STALL"]="multi_stage true false none"
 modes["FORWARDING"]="multi_stage true true none"
 modes["STATIC"]="multi_stage true true static"
 modes["DYNAMIC"]="multi_stage true true dynamic_1bit"
+modes["BIMODAL"]="multi_stage true true dynamic_2bit"
+modes["GSHARE"]="multi_stage true true gshare"
+modes["TOURNAMENT"]="multi_stage true true tournament"
+modes["TAGE"]="multi_stage true true tage"
 
 # Order of execution
-mode_order=("NAIVE" "STALL" "FORWARDING" "STATIC" "DYNAMIC")
+mode_order=("NAIVE" "STALL" "FORWARDING" "STATIC" "DYNAMIC" "BIMODAL" "GSHARE" "TOURNAMENT" "TAGE")
 
 # 1. Build
 echo -e "${BOLD}Building Simulator...${NC}"
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+# --- Configuration ---
+SIM_EXE="$(realpath ../build/vm)"
+TEST_FILE="$(realpath batch/loop.s)"
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Colors
+if command -v tput > /dev/null; then
+    RED=$(tput setaf 1)
+    GREEN=$(tput setaf 2)
+    BOLD=$(tput bold)
+    NC=$(tput sgr0)
+else
+    RED=""
+    GREEN=""
+    BOLD=""
+    NC=""
+fi
+
+# --- Helper Functions ---
+
+# A column of one job's row in the report
+# Usage: read_field <manifest line> <column>
+read_field() {
+    python3 -c "import csv, sys
+for row in csv.DictReader(open('report.csv')):
+    if row['line'] == sys.argv[1]:
+        print(row[sys.argv[2]])" "$1" "$2"
+}
+
+failures=0
+check() {
+    local name=$1
+    local expected=$2
+    local actual=$3
+    if [ "$expected" == "$actual" ]; then
+        printf "%-45s | ${GREEN}PASS${NC}\n" "$name"
+    else
+        printf "%-45s | ${RED}FAIL${NC} (expected %s, got %s)\n" "$name" "$expected" "$actual"
+        failures=$((failures + 1))
+    fi
+}
+
+# --- Main Execution ---
+
+echo -e "${BOLD}Building Simulator...${NC}"
+(cd ../build && make > /dev/null)
+
+echo -e "\n${BOLD}=== Batch Suite ===${NC}"
+
+cd "$WORK_DIR"
+PIPELINE="Execution.processor_type=multi_stage Execution.hazard_detection=true Execution.forwarding=true"
+cat > manifest.txt <<MANIFEST
+$TEST_FILE $PIPELINE Execution.instruction_execution_limit=60
+$TEST_FILE $PIPELINE Execution.instruction_execution_limit=100000
+$TEST_FILE Execution.processor_type=single_stage Execution.instruction_execution_limit=100000
+MANIFEST
+
+$SIM_EXE --batch manifest.txt report.csv > /dev/null 2>&1
+
+check "multi_stage stopped by the cycle limit"        stopped "$(read_field 1 status)"
+check "multi_stage runs exactly limit cycles"         60      "$(read_field 1 cycles)"
+check "multi_stage drains the pipeline before end"    end     "$(read_field 2 status)"
+check "multi_stage retires every instruction"         153     "$(read_field 2 instructions)"
+check "single_stage runs to the end"                  end     "$(read_field 3 status)"
+check "single_stage retires every instruction"        153     "$(read_field 3 instructions)"
+
+if [ $failures -eq 0 ]; then
+    echo -e "\n${GREEN}All tests passed.${NC}"
+else
+    echo -e "\n${RED}$failures test(s) failed.${NC}"
+    exit 1
+fi
@@ -0,0 +1,157 @@
+#!/bin/bash
+
+# --- Configuration ---
+SIM_EXE="$(realpath ../build/vm)"
+LOOP_FILE="$(realpath batch/loop.s)"
+SYSCALL_FILE="$(realpath reverse/syscalls.s)"
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Colors
+if command -v tput > /dev/null; then
+    RED=$(tput setaf 1)
+    GREEN=$(tput setaf 2)
+    BOLD=$(tput bold)
+    NC=$(tput sgr0)
+else
+    RED=""
+    GREEN=""
+    BOLD=""
+    NC=""
+fi
+
+# --- Helper Functions ---
+
+# Sends a command to the session and waits for the line that says it is done. A command that
+# arrives while the previous one still runs is dropped without a reply, so it is sent again.
+# Usage: send <command> <pattern of the reply>
+send() {
+    local line
+    for ((attempt = 0; attempt < 100; attempt++)); do
+        echo "$1" >&"${VM[1]}"
+        while read -r -t 0.1 -u "${VM[0]}" line; do
+            [[ "$line" =~ ^($2) ]] && return
+        done
+    done
+}
+
+# Usage: send_steps <count>
+send_steps() {
+    for ((n = 0; n < $1; n++)); do
+        send "step" "VM_STEP_COMPLETED|VM_LAST_INSTRUCTION_STEPPED"
+    done
+    # A step dumps the registers after it replies; a snapshot is only taken once it has finished
+    send "snapshot" VM_SNAPSHOT_TAKEN
+}
+
+# Usage: start_session <file>
+start_session() {
+    coproc VM { "$SIM_EXE" --start-vm 2> /dev/null; }
+    VM_SESSION=$VM_PID
+    send "load $1" VM_PROGRAM_LOADED
+}
+
+end_session() {
+    echo "exit" >&"${VM[1]}"
+    wait "$VM_SESSION"
+}
+
+# Steps a program in an interactive session, leaving the registers in <name>.json
+# Usage: run_straight <file> <steps> <name>
+run_straight() {
+    start_session "$1"
+    send_steps "$2"
+    cp vm_state/registers_dump.json "$3.json"
+    end_session
+}
+
+# Steps a program, goes back with reverse_step and steps forward again in one session,
+# leaving the registers before going back in <name>_first.json and after in <name>_again.json
+# Usage: run_reversed <file> <steps> <back> <name>
+run_reversed() {
+    start_session "$1"
+    send_steps "$2"
+    cp vm_state/registers_dump.json "$4_first.json"
+    send "rs $3" VM_REVERSE_STEP_COMPLETED
+    send_steps "$3"
+    cp vm_state/registers_dump.json "$4_again.json"
+    end_session
+}
+
+# The general purpose registers that differ between two dumps, or "none"
+# Usage: differing_gprs <dump> <dump> [register to ignore]
+differing_gprs() {
+    python3 -c "import json, sys
+a = json.load(open(sys.argv[1]))['gp_registers']
+b = json.load(open(sys.argv[2]))['gp_registers']
+names = [name for name in a if a[name] != b.get(name) and name not in sys.argv[3:]]
+print(' '.join(names) or 'none')" "$@"
+}
+
+# Value of a general purpose register in a dump, as a signed decimal
+# Usage: read_gpr <dump> <register number>
+read_gpr() {
+    python3 -c "import json, sys
+value = int(json.load(open(sys.argv[1]))['gp_registers']['x' + sys.argv[2]], 16)
+print(value - (1 << 64) if value >> 63 else value)" "$1" "$2"
+}
+
+# Whether two files have the same bytes
+same_file() {
+    cmp -s "$1" "$2" && echo yes || echo no
+}
+
+failures=0
+check() {
+    local name=$1
+    local expected=$2
+    local actual=$3
+    if [ "$expected" == "$actual" ]; then
+        printf "%-50s | ${GREEN}PASS${NC}\n" "$name"
+    else
+        printf "%-50s | ${RED}FAIL${NC} (expected %s, got %s)\n" "$name" "$expected" "$actual"
+        failures=$((failures + 1))
+    fi
+}
+
+# --- Main Execution ---
+
+echo -e "${BOLD}Building Simulator...${NC}"
+(cd ../build && make > /dev/null)
+
+echo -e "\n${BOLD}=== Reverse Step Suite ===${NC}"
+
+cd "$WORK_DIR"
+# Writes a default config.ini, which then takes a checkpoint every 8 steps, so going back
+# restores one and re-executes the steps after it
+$SIM_EXE --assemble "$LOOP_FILE" > /dev/null 2>&1
+sed -i 's/^checkpoint_interval=.*/checkpoint_interval=8/' vm_state/config.ini
+sed -i 's/^sandbox_directory=.*/sandbox_directory=sb/' vm_state/config.ini
+mkdir -p sb
+
+for core in single_stage multi_stage; do
+    sed -i "s/^processor_type=.*/processor_type=$core/" vm_state/config.ini
+    run_straight "$LOOP_FILE" 100 "loop_$core"
+    run_reversed "$LOOP_FILE" 100 37 "loop_$core"
+    check "$core: loop has started summing"                yes  "$([ "$(read_gpr "loop_$core.json" 6)" -gt 0 ] && echo yes || echo no)"
+    check "$core: loop matches a straight run"             none "$(differing_gprs "loop_$core.json" "loop_${core}_again.json")"
+    check "$core: loop matches itself before going back"   yes  "$(same_file "loop_${core}_first.json" "loop_${core}_again.json")"
+done
+
+# Syscalls are only made by the single-cycle core
+sed -i "s/^processor_type=.*/processor_type=single_stage/" vm_state/config.ini
+run_straight "$SYSCALL_FILE" 64 syscalls
+run_reversed "$SYSCALL_FILE" 64 60 syscalls
+
+check "syscalls: the write returned its length"          8    "$(read_gpr syscalls.json 19)"
+check "syscalls: re-executed calls give the same answers" yes  "$(same_file syscalls_first.json syscalls_again.json)"
+# clock_gettime (s7, x23) tells the time of each run
+check "syscalls: match a straight run but for the clock"  none "$(differing_gprs syscalls.json syscalls_again.json x23)"
+check "syscalls: the write reaches the file once"         replayed "$(cat sb/log.txt 2> /dev/null)"
+
+if [ $failures -eq 0 ]; then
+    echo -e "\n${GREEN}All tests passed.${NC}"
+else
+    echo -e "\n${RED}$failures test(s) failed.${NC}"
+    exit 1
+fi
@@ -0,0 +1,76 @@
+#!/bin/bash
+
+# --- Configuration ---
+SIM_EXE="$(realpath ../build/vm)"
+TEST_FILE="$(realpath syscalls/sandbox.s)"
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Colors
+if command -v tput > /dev/null; then
+    RED=$(tput setaf 1)
+    GREEN=$(tput setaf 2)
+    BOLD=$(tput bold)
+    NC=$(tput sgr0)
+else
+    RED=""
+    GREEN=""
+    BOLD=""
+    NC=""
+fi
+
+# --- Helper Functions ---
+
+# Value of a general purpose register in the last run's dump, as a signed decimal
+# Usage: read_gpr <register number>
+read_gpr() {
+    python3 -c "import json, sys
+value = int(json.load(open('vm_state/registers_dump.json'))['gp_registers']['x$1'], 16)
+print(value - (1 << 64) if value >> 63 else value)"
+}
+
+failures=0
+check() {
+    local name=$1
+    local expected=$2
+    local actual=$3
+    if [ "$expected" == "$actual" ]; then
+        printf "%-40s | ${GREEN}PASS${NC}\n" "$name"
+    else
+        printf "%-40s | ${RED}FAIL${NC} (expected %s, got %s)\n" "$name" "$expected" "$actual"
+        failures=$((failures + 1))
+    fi
+}
+
+# --- Main Execution ---
+
+echo -e "${BOLD}Building Simulator...${NC}"
+(cd ../build && make > /dev/null)
+
+echo -e "\n${BOLD}=== Syscall Sandbox Suite ===${NC}"
+
+cd "$WORK_DIR"
+# Writes a default config.ini, which is then pointed at the sandbox
+$SIM_EXE --assemble "$TEST_FILE" > /dev/null 2>&1
+sed -i 's/^sandbox_directory=.*/sandbox_directory=sb/' vm_state/config.ini
+
+mkdir -p sb/sub
+ln -s ../escaped.txt sb/dangling
+ln -s .. sb/outside
+
+$SIM_EXE --run "$TEST_FILE" > /dev/null 2>&1
+
+check "dangling symlink with O_CREAT"   -13 "$(read_gpr 9)"
+check "O_CREAT inside the sandbox"      3   "$(read_gpr 18)"
+check "../ out of the sandbox"          -13 "$(read_gpr 19)"
+check "directory symlink out"           -13 "$(read_gpr 20)"
+check "/sub/../ staying inside"         4   "$(read_gpr 21)"
+check "nothing created outside"         no  "$([ -e escaped.txt ] && echo yes || echo no)"
+check "file created inside"             yes "$([ -f sb/created.txt ] && echo yes || echo no)"
+
+if [ $failures -eq 0 ]; then
+    echo -e "\n${GREEN}All tests passed.${NC}"
+else
+    echo -e "\n${RED}$failures test(s) failed.${NC}"
+    exit 1
+fi